@@ -58,6 +58,7 @@ void ShowNetworkUI() {
 	static char playerName[64] = "Player1";
 	if (!ne.isHosting && !ne.isClient) {
 		ImGui::InputText("Name", playerName, IM_ARRAYSIZE(playerName));
+		ImGui::Checkbox("Network I/O thread", &ne.useIoThread);
 		ImGui::Separator();
 		ImGui::InputText("Port", port, IM_ARRAYSIZE(port));
 		ImGui::SameLine();
@@ -94,7 +95,25 @@ void ShowNetworkUI() {
 		std::string portText = "Port: " + std::string(port);
 		ImGui::Text(portText.c_str());
 
-		extern AsteroidScene* g_AsteroidScene;
+		if (ne.isClient && ne.clock.IsSynced()) {
+			ImGui::Separator();
+			ImGui::Text("RTT: %.1f ms (min %.1f, deviation %.1f)", ne.clock.GetRtt() * 1000.0,
+				ne.clock.GetMinRtt() * 1000.0, ne.clock.GetRttDeviation() * 1000.0);
+			ImGui::Text("Ahead of host: %.1f ticks (target %.1f), rate %.3f", -ne.clock.GetOffset(),
+				ne.clock.GetLeadTicks(), ne.clock.GetRate());
+		}
+
+		if (ne.isClient && ne.interpolation.IsRunning()) {
+			const InterpolationStats& stats = ne.interpolation.stats;
+			ImGui::Separator();
+			ImGui::Text("Interpolation delay: %.1f ticks (jitter %.2f, snapshot every %.1f)",
+				ne.interpolation.GetDelay(), ne.interpolation.GetJitter(), ne.interpolation.GetInterval());
+			ImGui::Text("Buffer depth: %.1f ticks", stats.depthTicks);
+			ImGui::Text("Underruns: %llu  Extrapolated: %llu / %llu", static_cast<unsigned long long>(stats.underruns),
+				static_cast<unsigned long long>(stats.extrapolations), static_cast<unsigned long long>(stats.samples));
+		}
+
+		extern thread_local AsteroidScene* g_AsteroidScene;
 		if (g_AsteroidScene) {
 			ImGui::Separator();
 			ImGui::Text("Scores:");
@@ -138,6 +157,7 @@ void Application::Run() {
 	Timer timer;
 	std::unique_ptr<Window> m_context;
 	timer.Start();
+	NetworkEngine::GetInstance().fixedDeltaTime = timer.GetFixedDT();
 
 	m_context = std::make_unique<Window>("Asteroid Shooter", 1920, 1080, false);
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
@@ -185,23 +205,14 @@ void Application::Run() {
 		as.Update(timer.GetDeltaTime());
 		for (int i = 0; i < timer.GetFixedSteps(); ++i) {
 			//as.Update(timer.GetDeltaTime(), timer.GetFixedDT(), timer.GetFixedSteps());
-			//if (isHost) {
-			//	if (simulationTick % 120 == 0) { // Every 60 ticks (1 second) send sync.
-					//NetworkEngine::GetInstance().SendTickSync(simulationTick);
-					//std::cout << simulationTick << std::endl;
-			//	}
-			//} else if (isClient) {
-				//std::cout << localTick << std::endl;
-				//NetworkEngine::GetInstance().ProcessTickSync(simulationTick, localTick);
-			//}
 			as.FixedUpdate(timer.GetFixedDT());
 
-			NetworkEngine::GetInstance().simulationTick++;
-			NetworkEngine::GetInstance().localTick++;
+			NetworkEngine::GetInstance().AdvanceTick();
 		}
 		as.Render();
 		as.ProcessEvents();
 		NetworkEngine::GetInstance().Update(timer.GetDeltaTime());
+		timer.SetTimeScale(NetworkEngine::GetInstance().GetTickRate()); // A client's ticks keep pace with the host's
 
 		ImGui::Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -209,7 +220,7 @@ void Application::Run() {
 
 		m_context->SwapBuffers();
 	}
-	extern AsteroidScene* g_AsteroidScene;
+	extern thread_local AsteroidScene* g_AsteroidScene;
 	std::vector<HighScore> currentHighscores;
 	for (const auto& score : g_AsteroidScene->GetAllScores()) {
 		currentHighscores.push_back(HighScore{std::to_string(score.first), score.second });
@@ -1,45 +1,21 @@
 #include "Asteroid.hpp"
 #include <glm/glm.hpp>
-#include "Networking/NetworkUtils.hpp"
-#include "Networking/NetworkEngine.hpp"
+#include "Networking/Messages.hpp"
 
-Asteroid::Asteroid()
+void Asteroid::FixedUpdate(EntityPool<Asteroid>& asteroids, double fixedDT)
 {
+	const float dt = static_cast<float>(fixedDT);
+	for (size_t i = 0; i < asteroids.Size(); ++i) {
+		asteroids.position[i] += asteroids.velocity[i] * dt;
+	}
 }
 
-void Asteroid::Update(double)
+void Asteroid::Deserialize(EntityPool<Asteroid>& asteroids, uint32_t index, const ObjectStateMsg& state)
 {
-	
-}
-
-void Asteroid::FixedUpdate(double fixedDT)
-{
-	position += velocity * static_cast<float>(fixedDT);
-}
-
-std::vector<char> Asteroid::Serialize()
-{
-	std::vector<char> packet;
-
-	NetworkUtils::WriteToPacket(packet, networkID, NetworkUtils::DATA_TYPE::DT_LONG);
-	NetworkUtils::WriteToPacket(packet, NetworkEngine::GetInstance().localTick, NetworkUtils::DATA_TYPE::DT_LONG);
-	NetworkUtils::WriteVec2(packet, position);
-	NetworkUtils::WriteToPacket(packet, NetworkUtils::FloatToNetwork(rotation), NetworkUtils::DATA_TYPE::DT_LONG);
-	NetworkUtils::WriteVec2(packet, velocity);
-
-	return packet;
-}
-
-void Asteroid::Deserialize(const char* packet)
-{
-	uint32_t packetTick{};
-	NetworkUtils::ReadFromPacket(packet, 5, packetTick, NetworkUtils::DATA_TYPE::DT_LONG);
-	if (packetTick < lastReceivedTick) return;
+	if (state.tick < asteroids.lastReceivedTick[index]) return;
 
-	lastReceivedTick = packetTick;
-	NetworkUtils::ReadVec2(packet, 9, position);
-	uint32_t tempRot{};
-	NetworkUtils::ReadFromPacket(packet, 17, tempRot, NetworkUtils::DATA_TYPE::DT_LONG);
-	rotation = NetworkUtils::NetworkToFloat(tempRot);
-	NetworkUtils::ReadVec2(packet, 21, velocity);
+	asteroids.lastReceivedTick[index] = state.tick;
+	asteroids.position[index] = state.position;
+	asteroids.rotation[index] = state.rotation;
+	asteroids.velocity[index] = state.velocity;
 }
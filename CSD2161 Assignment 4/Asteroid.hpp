@@ -1,18 +1,13 @@
 #pragma once
-#include "GameObject.hpp"
-#include "Networking/NetworkObject.hpp"
-
-class Asteroid : public GameObject, public NetworkObject {
-public:
-	Asteroid();
-	void Update(double) override;
-	void FixedUpdate(double) override;
-
-	std::vector<char> Serialize() override;
-	void Deserialize(const char*) override;
-
-	glm::vec3 velocity = glm::vec3(0.f);
+#include <cstdint>
+#include "EntityPool.hpp"
 
+struct ObjectStateMsg;
 
+/**
+ * \brief Asteroids need nothing beyond the common components; this holds their systems.
+ */
+struct Asteroid {
+	static void FixedUpdate(EntityPool<Asteroid>& asteroids, double fixedDT);
+	static void Deserialize(EntityPool<Asteroid>& asteroids, uint32_t index, const ObjectStateMsg& state);
 };
-
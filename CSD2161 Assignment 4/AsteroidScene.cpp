@@ -9,20 +9,20 @@
 #include "Networking/NetworkEngine.hpp"
 #include <iostream>
 #include "Asteroid.hpp"
-#include <unordered_set>
+#include <algorithm>
+#include <cmath>
 
 #define MAX_LOCAL_GAMEOBJECTS 1250
 const double asteroidSpawnRate = 5.0;
-double asteroidSpawnTimer = 0.0;
-bool gameStarted = false;
-std::unordered_map<NetworkID, int> playerScores;
 
-AsteroidScene* g_AsteroidScene = nullptr;
+thread_local AsteroidScene* g_AsteroidScene = nullptr; // Per thread: a server thread may run several matches
 extern std::string g_PlayerName;
 
 void AsteroidScene::Initialize() {
+#ifndef HEADLESS_SERVER
 	GraphicsEngine::GetInstance().Init();
-	gameObjects.reserve(MAX_LOCAL_GAMEOBJECTS);
+#endif
+	entities.Reserve(MAX_LOCAL_GAMEOBJECTS);
 
 	g_AsteroidScene = this; // Set the global pointer
 }
@@ -30,29 +30,13 @@ void AsteroidScene::Initialize() {
 void AsteroidScene::Update(double dt) {
 	//std::cout << NetworkEngine::GetInstance().localTick << std::endl;
 
+	Player::Update(entities.players, dt);
+	PlayerBullet::Update(entities.bullets, dt);
 
-	for (auto& go : gameObjects) {
-		if (go->isActive) {
-			go->Update(dt);
-
-			//if (go->type != GameObject::GO_PLAYER) {
-			//	if (go->position.x > 1920.f || go->position.x < -1920.f || go->position.y > 1080.f || go->position.y < 1080.f)
-			//		go->isActive = false;
-			//} else {
-			//	if (go->position.x > 960.f)
-			//		go->position.x = -950.f;
-			//	else if (go->position.x < -960.f)
-			//		go->position.x = 950.f;
-			//}
-		}
-	}
 	if (gameStarted && NetworkEngine::GetInstance().isHosting) {
 		asteroidSpawnTimer += dt;
 		//std::cout << asteroidSpawnTimer << std::endl;
 		if (asteroidSpawnTimer >= asteroidSpawnRate) {
-			static std::random_device rd;
-			static std::mt19937 gen(rd());
-
 			std::uniform_real_distribution<float> posXDist(-20.f, 20.f);
 			std::uniform_real_distribution<float> posYDist(-15.f, 15.f);
 
@@ -61,30 +45,20 @@ void AsteroidScene::Update(double dt) {
 			std::uniform_real_distribution<float> velocityX(-2.f, 2.f);
 			std::uniform_real_distribution<float> velocityY(-2.f, 2.f);
 
-			auto asteroid = std::make_unique<Asteroid>();
-			asteroid->networkID = NetworkEngine::GetInstance().GenerateID();
-			asteroid->position = glm::vec3(posXDist(gen), posYDist(gen), 0.f);
-			float randomScale = scaleDist(gen);
-			asteroid->scale = glm::vec3(randomScale, randomScale, 1.f);
-			asteroid->velocity = glm::vec3(velocityX(gen), velocityY(gen), 0.f);
-			asteroid->rotation = 0.f;
-			asteroid->type = GameObject::GO_ASTEROID;
-			asteroid->meshType = Mesh::MESH_TYPE::QUAD;
-			asteroid->textured = true;
-			asteroid->textureType = Texture::TEXTURE_TYPE::TEX_ASTEROID;
-
-			std::vector<char> packet;
-			packet.push_back(NetworkEngine::CMDID::GAME_EVENT);
-			//packet.push_back(static_cast<char>(1));
-			packet.push_back(static_cast<char>(EventType::SpawnAsteroid));
+			SpawnAsteroidMsg spawn;
+			spawn.networkID = NetworkEngine::GetInstance().GenerateID();
+			spawn.position = glm::vec3(posXDist(random), posYDist(random), 0.f);
+			float randomScale = scaleDist(random);
+			spawn.scale = glm::vec3(randomScale, randomScale, 1.f);
+			spawn.velocity = glm::vec3(velocityX(random), velocityY(random), 0.f);
 
-			NetworkID netNID = htonl(asteroid->networkID);
-			packet.insert(packet.end(), reinterpret_cast<char*>(&netNID),
-				reinterpret_cast<char*>(&netNID) + sizeof(netNID));
+			PacketBuffer packet;
+			PacketWriter writer(packet);
+			writer.WriteU8(NetworkEngine::CMDID::GAME_EVENT);
+			//packet.push_back(static_cast<char>(1));
+			writer.WriteU8(static_cast<uint8_t>(EventType::SpawnAsteroid));
 
-			NetworkUtils::WriteVec3(packet, asteroid->position);
-			NetworkUtils::WriteVec3(packet, asteroid->scale);
-			NetworkUtils::WriteVec3(packet, asteroid->velocity);
+			Schema::Encode(writer, spawn);
 
 			//int16_t posX = static_cast<int16_t>(asteroid->position.x * 100);
 			//int16_t posY = static_cast<int16_t>(asteroid->position.y * 100);
@@ -114,92 +88,89 @@ void AsteroidScene::Update(double dt) {
 			//packet.insert(packet.end(), reinterpret_cast<char*>(&velY),
 			//	reinterpret_cast<char*>(&velY) + sizeof(velY));
 
-			Asteroid* rawAsteroid = asteroid.get();
-			gameObjects.push_back(std::move(asteroid));
-			networkedObjects[rawAsteroid->networkID] = rawAsteroid;
+			SpawnAsteroid(spawn.networkID, spawn.position, spawn.scale, spawn.velocity);
 
 			NetworkEngine::GetInstance().HandleClientEvent(packet);
 
 			//NetworkEngine::GetInstance().SendToAllClients(packet);
-			std::cout << "Server asteroid spawned at: " << rawAsteroid->position.x << ", " << rawAsteroid->position.y << "with id: " << rawAsteroid->networkID << "\n";
+			std::cout << "Server asteroid spawned at: " << spawn.position.x << ", " << spawn.position.y << "with id: " << spawn.networkID << "\n";
 			asteroidSpawnTimer = 0.0;
 		}
 	}
 }
 
 void AsteroidScene::FixedUpdate(double fixedDT) {
-	for (auto& go : gameObjects) {
-		if (go->isActive) {
-			go->FixedUpdate(fixedDT);
-
-			if (go->type != GameObject::GO_PLAYER) {
-				if (go->position.x > 50.f || go->position.x < -50.f)
-					go->isActive = false;
-			} else {
-				std::cout << go->position.y << std::endl;
-				if (go->position.x > 46.f)
-					go->position.x = -45.f;
-				else if (go->position.x < -46.f)
-					go->position.x = 45.f;
-			}
-		}
-	}
+	Player::FixedUpdate(entities.players, prediction, fixedDT);
+	Asteroid::FixedUpdate(entities.asteroids, fixedDT);
+
+	// Anything but players is gone once it leaves the play area
+	auto outOfBounds = [](const auto& pool) {
+		return [&pool](uint32_t i) { return pool.position[i].x > 50.f || pool.position[i].x < -50.f; };
+	};
+	entities.DestroyIf(entities.asteroids, outOfBounds(entities.asteroids));
+	entities.DestroyIf(entities.bullets, outOfBounds(entities.bullets));
 
 	// Setting only host to detect for collision
 	if (!NetworkEngine::GetInstance().isHosting)
 		return; 
 	
-	//Loop through all pairs of game objects to check for collisions
-	for (size_t i = 0; i < gameObjects.size(); ++i) {
-		for (size_t j = i + 1; j < gameObjects.size(); ++j) {
-
-			auto* a = dynamic_cast<NetworkObject*>(gameObjects[i].get());
-			auto* b = dynamic_cast<NetworkObject*>(gameObjects[j].get());
-			if (!a || !b) continue;
-
-			//Determining object if its bullet/asteroid
-			auto* bullet = dynamic_cast<PlayerBullet*>(a);
-			auto* asteroid = dynamic_cast<Asteroid*>(b);
-
-			//swap if undetected
-			if (!bullet || !asteroid) {
-				bullet = dynamic_cast<PlayerBullet*>(b);
-				asteroid = dynamic_cast<Asteroid*>(a);
-			}
-
-			//if not bullet-asteroid pair continue
-			if (!bullet || !asteroid) continue;
-
-			//distance between bullet and asteroid
-			float dist = glm::length(bullet->position - asteroid->position);
-
+	// Broadphase: asteroids go into this tick's grid, then every bullet only tests the asteroids in the cells around
+	// it. Its positions go out in the snapshot for the next tick, so that is the tick they are recorded as.
+	NetworkEngine& ne = NetworkEngine::GetInstance();
+	const auto& asteroids = entities.asteroids;
+	auto& bullets = entities.bullets;
+	const Tick tick = ne.simulationTick + 1;
+	lagCompensation.Record(tick, asteroids);
+	if (asteroids.Size() == 0) return;
+
+	// A client aimed at asteroids it was shown some ticks ago; its bullets are tested against those
+	viewDelays.clear();
+	auto viewDelay = [&](NetworkID player) {
+		for (const auto& [id, delay] : viewDelays) {
+			if (id == player) return delay;
+		}
+		const Tick delay = static_cast<Tick>(std::lround(ne.GetClientViewDelay(player)));
+		viewDelays.emplace_back(player, delay);
+		return delay;
+	};
+
+	for (uint32_t b = 0; b < bullets.Size(); ++b) {
+		// Events run a few ticks after they are raised, the bullet keeps overlapping until then
+		if (bullets.extra[b].hitPending) continue;
+
+		const float bulletScale = bullets.scale[b].x;
+		const NetworkID bulletID = bullets.networkID[b];
+		const uint32_t scorer = bullets.owner[b];
+		const Tick seen = tick - viewDelay(scorer);
+		const float searchRadius = (bulletScale + lagCompensation.GetMaxSize(seen)) * 0.5f;
+
+		lagCompensation.Query(seen, glm::vec2(bullets.position[b]), searchRadius, [&](NetworkID asteroidID, float dist, float asteroidScale) {
 			//CollisionDistance 
-			float collisionDist = (bullet->scale.x + asteroid->scale.x) * 0.5f;
+			float collisionDist = (bulletScale + asteroidScale) * 0.5f;
 
-			//Push a collisionEvent into event queue of both objects
-			if (dist < collisionDist) {
+			//Push a collisionEvent into event queue of both objects; one since destroyed cannot be hit any more
+			if (dist < collisionDist && !bullets.extra[b].hitPending && entities.Contains(asteroidID)) {
+				bullets.extra[b].hitPending = true;
 				if (NetworkEngine::GetInstance().isHosting && NetworkEngine::GetInstance().GetNumConnectedClients() > 0) {
-					std::vector<char> packet;
-					packet.push_back(NetworkEngine::CMDID::GAME_EVENT);
-					packet.push_back(static_cast<char>(EventType::Collision));
+					PacketBuffer packet;
+					PacketWriter writer(packet);
+					writer.WriteU8(NetworkEngine::CMDID::GAME_EVENT);
+					writer.WriteU8(static_cast<uint8_t>(EventType::Collision));
 
-					NetworkID netIDA = htonl(bullet->networkID);
-					NetworkID netIDB = htonl(asteroid->networkID);
-					packet.insert(packet.end(), reinterpret_cast<char*>(&netIDA), reinterpret_cast<char*>(&netIDA) + sizeof(netIDA));
-					packet.insert(packet.end(), reinterpret_cast<char*>(&netIDB), reinterpret_cast<char*>(&netIDB) + sizeof(netIDB));
+					Schema::Encode(writer, CollisionMsg{ bulletID, asteroidID, scorer });
 
 					NetworkEngine::GetInstance().HandleClientEvent(packet);
 				}
 				else if (NetworkEngine::GetInstance().isClient) {
-					auto collision = std::make_unique<CollisionEvent>(bullet->networkID, asteroid->networkID);
+					auto collision = std::make_unique<CollisionEvent>(bulletID, asteroidID, scorer);
 					NetworkEngine::GetInstance().SendEventToServer(std::move(collision));
 				}
 				else if (NetworkEngine::GetInstance().isHosting) {
-					EventQueue::GetInstance().Push(std::make_unique<CollisionEvent>(bullet->networkID, asteroid->networkID));
+					EventQueue::GetInstance().Push(std::make_unique<CollisionEvent>(bulletID, asteroidID, scorer));
 				}
 				
 			}
-		}
+		});
 	}
 
 }
@@ -210,82 +181,57 @@ void AsteroidScene::ProcessEvents() {
 		switch (event->type) {
 		case EventType::FireBullet: {
 			auto* fire = static_cast<FireBulletEvent*>(event.get());
-			glm::vec3 dir(cos(fire->rotation), sin(fire->rotation), 0.f);
-			auto bullet = std::make_unique<PlayerBullet>(fire->position, dir, fire->ownerId);
-			bullet->networkID = event.get()->id;
-			NetworkObject* rawBullet = bullet.get();
-			gameObjects.push_back(std::move(bullet));
-			networkedObjects[rawBullet->networkID] = rawBullet;
-
+			SpawnBullet(fire->id, fire->position, fire->rotation, fire->ownerId);
 			break;
 		}
 		case EventType::RequestStartGame: {
-			std::vector<char> packet;
-			packet.push_back(static_cast<char>(NetworkEngine::CMDID::GAME_EVENT));
-			packet.push_back(static_cast<char>(EventType::StartGame));
-			// push number of events;
-			packet.push_back(static_cast<uint8_t>(NetworkEngine::GetInstance().GetNumConnectedClients() + 1));
+			std::vector<RosterEntryMsg> roster;
+#ifdef HEADLESS_SERVER
+			// Dedicated server has no player of its own, the roster is only the connected clients
+			size_t clientEntry = 0;
+#else
+			size_t clientEntry = 1; // Roster entry 0 is the host's own player
 
 			{
-				auto localPlayer = std::make_unique<Player>();
-				localPlayer->networkID = NetworkEngine::GetInstance().GenerateID();
-				localPlayer->position = glm::vec3(0, 0, 0);
-				localPlayer->scale = glm::vec3(1.5f, 1.5f, 1.5f);
-				localPlayer->rotation = 0.f;
-				localPlayer->type = GameObject::GO_PLAYER;
-				localPlayer->meshType = Mesh::MESH_TYPE::QUAD;
-				localPlayer->isLocal = true;
-				localPlayer->color = { 0.2f, 1.f, 0.2f, 1.f };
-				localPlayer->textured = true;
-				localPlayer->textureType = Texture::TEXTURE_TYPE::TEX_PLAYER;
-				//NetworkEngine::GetInstance().playerNames[localPlayer->networkID] = g_PlayerName;
-
-				Player* rawPlayerPtr = localPlayer.get();
-				gameObjects.push_back(std::move(localPlayer));
-				networkedObjects[rawPlayerPtr->networkID] = rawPlayerPtr;
-				packet.push_back(static_cast<char>(EventType::PlayerJoined));
-				NetworkID netNID = htonl(rawPlayerPtr->networkID);
-				packet.insert(packet.end(), reinterpret_cast<char*>(&netNID),
-					reinterpret_cast<char*>(&netNID) + sizeof(netNID));
+				const NetworkID localID = NetworkEngine::GetInstance().GenerateID();
+				SpawnPlayer(localID, true);
+				//NetworkEngine::GetInstance().playerNames[localID] = g_PlayerName;
+				roster.push_back(RosterEntryMsg{ static_cast<uint8_t>(EventType::PlayerJoined), localID });
 
 				//uint8_t nameLen = (uint8_t)std::min<size_t>(g_PlayerName.size(), 255);
 				//packet.push_back(nameLen);
 				//packet.insert(packet.end(), g_PlayerName.begin(), g_PlayerName.begin() + nameLen);
 
 			}
+#endif
 
 			for (int i = 0; i < NetworkEngine::GetInstance().GetNumConnectedClients(); ++i) {
-				auto remotePlayer = std::make_unique<Player>();
-				remotePlayer->networkID = NetworkEngine::GetInstance().GenerateID();
-				remotePlayer->position = glm::vec3(0, 0, 0);
-				remotePlayer->scale = glm::vec3(1.5f, 1.5f, 1.5f);
-				remotePlayer->rotation = 0.f;
-				remotePlayer->type = GameObject::GO_PLAYER;
-				remotePlayer->meshType = Mesh::MESH_TYPE::QUAD;
-				remotePlayer->isLocal = false;
-				remotePlayer->color = { 0.2f, 0.2f, 1.f, 1.f };
-				remotePlayer->textured = true;
-				remotePlayer->textureType = Texture::TEXTURE_TYPE::TEX_PLAYER;
-
-				Player* rawRemote = remotePlayer.get();
-				gameObjects.push_back(std::move(remotePlayer));
-				networkedObjects[rawRemote->networkID] = rawRemote;
-				packet.push_back(static_cast<char>(EventType::PlayerJoined));
-				NetworkID netNID = htonl(rawRemote->networkID);
-				packet.insert(packet.end(), reinterpret_cast<char*>(&netNID),
-					reinterpret_cast<char*>(&netNID) + sizeof(netNID));
+				const NetworkID remoteID = NetworkEngine::GetInstance().GenerateID();
+				SpawnPlayer(remoteID, false);
+				roster.push_back(RosterEntryMsg{ static_cast<uint8_t>(EventType::PlayerJoined), remoteID });
 
 				//auto newClientOpt = NetworkEngine::GetInstance().clientManager.GetClientByAddr(clientAddr);
-				//auto& remotePlayerName = NetworkEngine::GetInstance().playerNames[rawRemote->networkID];
+				//auto& remotePlayerName = NetworkEngine::GetInstance().playerNames[remoteID];
 				//uint8_t nameLen = (uint8_t)std::min<size_t>(remotePlayerName.size(), 255);
 				//packet.push_back(nameLen);
 				//packet.insert(packet.end(), remotePlayerName.begin(), remotePlayerName.begin() + nameLen);
 			}
 			EventID eid = NetworkEngine::GetInstance().GenerateEventID();
-			int i = 1;
-			for (auto& client : NetworkEngine::GetInstance().clientManager.GetClients()) {
-				std::vector<char> clientPacket(packet);
-				clientPacket[i++ * 5 + 3] = static_cast<char>(EventType::SpawnPlayer);
+			for (auto& client : NetworkEngine::GetInstance().clientManager.GetClientsNonConst()) {
+				// Same roster for everyone, except the client's own entry is sent as SpawnPlayer
+				if (clientEntry < roster.size()) NetworkEngine::GetInstance().clientManager.SetPlayer(client, roster[clientEntry].networkID);
+				client.inputs.Reset();
+				PacketBuffer clientPacket;
+				PacketWriter writer(clientPacket);
+				writer.WriteU8(static_cast<uint8_t>(NetworkEngine::CMDID::GAME_EVENT));
+				writer.WriteU8(static_cast<uint8_t>(EventType::StartGame));
+				Schema::Encode(writer, RosterHeaderMsg{ static_cast<uint8_t>(roster.size()) });
+				for (size_t entry = 0; entry < roster.size(); ++entry) {
+					RosterEntryMsg rosterEntry = roster[entry];
+					if (entry == clientEntry) rosterEntry.type = static_cast<uint8_t>(EventType::SpawnPlayer);
+					Schema::Encode(writer, rosterEntry);
+				}
+				++clientEntry;
 				//NetworkEngine::GetInstance().HandleClientEvent(clientPacket);
 				NetworkEngine::GetInstance().SendtoClientSameEvent(client, eid,clientPacket);
 			}
@@ -294,76 +240,19 @@ void AsteroidScene::ProcessEvents() {
 		}
 		case EventType::SpawnPlayer: {
 			auto* spawnEvent = static_cast<SpawnPlayerEvent*>(event.get());
-			auto newPlayer = std::make_unique<Player>();
-			newPlayer->networkID = spawnEvent->networkID;
-			newPlayer->position = glm::vec3(0, 0, 0);
-			newPlayer->scale = glm::vec3(1.5f, 1.5f, 1.5f);
-			newPlayer->rotation = 0.f;
-			newPlayer->type = GameObject::GO_PLAYER;
-			newPlayer->meshType = Mesh::MESH_TYPE::QUAD;
-			newPlayer->isLocal = true;
-			newPlayer->color = { 0.2f, 1.f, 0.2f, 1.f };
-			newPlayer->textured = true;
-			newPlayer->textureType = Texture::TEXTURE_TYPE::TEX_PLAYER;
-			//std::string playerName = 
-			//std::cout << "Local Player Network ID: " << newPlayer->networkID << std::endl;
-			//NetworkEngine::GetInstance().playerNames[newPlayer->networkID] = playerName;
-
-			Player* rawPlayerPtr = newPlayer.get();
-
-			gameObjects.push_back(std::move(newPlayer));
-
-			networkedObjects[rawPlayerPtr->networkID] = dynamic_cast<NetworkObject*>(rawPlayerPtr);
+			//std::cout << "Local Player Network ID: " << spawnEvent->networkID << std::endl;
+			SpawnPlayer(spawnEvent->networkID, true);
 			break;
 		}
 		case EventType::PlayerJoined: {
 			auto* joinEvent = static_cast<PlayerJoinedEvent*>(event.get());
-			auto newPlayer = std::make_unique<Player>();
-			newPlayer->networkID = joinEvent->networkID;
-			newPlayer->position = glm::vec3(0, 0, 0);
-			newPlayer->scale = glm::vec3(1.5f, 1.5f, 1.5f);
-			newPlayer->rotation = 0.f;
-			newPlayer->type = GameObject::GO_PLAYER;
-			newPlayer->meshType = Mesh::MESH_TYPE::QUAD;
-			newPlayer->isLocal = false;
-			newPlayer->color = { 0.2f, 0.2f, 1.f, 1.f };
-			newPlayer->textured = true;
-			newPlayer->textureType = Texture::TEXTURE_TYPE::TEX_PLAYER;
-
-			Player* rawPlayerPtr = newPlayer.get();
-
-			gameObjects.push_back(std::move(newPlayer));
-
-			networkedObjects[rawPlayerPtr->networkID] = dynamic_cast<NetworkObject*>(rawPlayerPtr);
-			break;
-		}
-		case EventType::PlayerUpdate: {
-			auto* updateEvent = static_cast<PlayerUpdate*>(event.get());
-			uint32_t rcvID;
-			std::memcpy(&rcvID, &updateEvent->packet[1], sizeof(rcvID));
-			rcvID = ntohl(rcvID);
-			networkedObjects.at(rcvID)->Deserialize(updateEvent->packet.data());
-			
+			SpawnPlayer(joinEvent->networkID, false);
 			break;
 		}
 		case EventType::SpawnAsteroid: {
 			auto* spawnEvent = static_cast<SpawnAsteroidEvent*>(event.get());
-			auto asteroid = std::make_unique<Asteroid>();
-			asteroid->networkID = spawnEvent->networkID;
-			asteroid->position = spawnEvent->initialPosition;
-			asteroid->scale = spawnEvent->initialScale;
-			asteroid->velocity = spawnEvent->initialVelocity;
-			asteroid->rotation = 0.f;
-			asteroid->type = GameObject::GO_ASTEROID;
-			asteroid->meshType = Mesh::MESH_TYPE::QUAD;
-			asteroid->color = { 1.f, 1.f, 1.f, 1.f };
-			asteroid->textured = true;
-			asteroid->textureType = Texture::TEXTURE_TYPE::TEX_ASTEROID;
-
-			Asteroid* rawAsteroid = asteroid.get();
-			gameObjects.push_back(std::move(asteroid));
-			networkedObjects[rawAsteroid->networkID] = rawAsteroid;
-			std::cout << "Client asteroid spawned at: " << spawnEvent->initialPosition.x << ", " << spawnEvent->initialPosition.y << "with id :"<< rawAsteroid->networkID <<"\n";
+			SpawnAsteroid(spawnEvent->networkID, spawnEvent->initialPosition, spawnEvent->initialScale, spawnEvent->initialVelocity);
+			std::cout << "Client asteroid spawned at: " << spawnEvent->initialPosition.x << ", " << spawnEvent->initialPosition.y << "with id :"<< spawnEvent->networkID <<"\n";
 			break;
 		}
 		case EventType::Collision: {
@@ -373,30 +262,26 @@ void AsteroidScene::ProcessEvents() {
 
 			std::cout << "[CollisionEvent] Received. Objects to delete: ID A = " << idA << ", ID B = " << idB << "\n";
 
-			std::unordered_set<NetworkID> idsToDelete;
-			NetworkID scoringPlayer = 0;
+			NetworkID scoringPlayer = collision->scorer; // Set even when this client never saw the bullet
 
 			NetworkID ids[2] = { idA, idB };
+			bool toDelete[2] = { false, false };
 
 			// First: figure out what to delete and who should get score
 			for (int i = 0; i < 2; ++i) {
-				NetworkID id = ids[i];
-				auto it = networkedObjects.find(id);
-				if (it != networkedObjects.end()) {
-					auto* obj = it->second;
-
-					// Skip deleting local player
-					if (auto* player = dynamic_cast<Player*>(obj)) {
-						if (player->isLocal) continue;
-					}
-
-					// Track who owns the bullet
-					if (auto* bullet = dynamic_cast<PlayerBullet*>(obj)) {
-						scoringPlayer = bullet->playerID;  // bullet's owner
-					}
-
-					idsToDelete.insert(id);
+				EntityType type;
+				uint32_t index;
+				if (!entities.Find(ids[i], type, index)) continue;
+
+				// Skip deleting local player
+				if (type == ENTITY_PLAYER && entities.players.extra[index].isLocal) continue;
+
+				// Track who owns the bullet
+				if (type == ENTITY_BULLET && scoringPlayer == 0) {
+					scoringPlayer = entities.bullets.owner[index];  // bullet's owner
 				}
+
+				toDelete[i] = true;
 			}
 
 			// Award score BEFORE deleting the bullet
@@ -405,17 +290,8 @@ void AsteroidScene::ProcessEvents() {
 				std::cout << "[Score] +1 point to player ID: " << scoringPlayer << std::endl;
 			}
 
-			// Now remove from gameObjects
-			auto it = std::remove_if(gameObjects.begin(), gameObjects.end(),
-				[&](const std::unique_ptr<GameObject>& go) {
-					auto* netObj = dynamic_cast<NetworkObject*>(go.get());
-					return netObj && idsToDelete.count(netObj->networkID);
-				});
-			gameObjects.erase(it, gameObjects.end());
-
-			// Remove from map
-			for (NetworkID id : idsToDelete) {
-				networkedObjects.erase(id);
+			for (int i = 0; i < 2; ++i) {
+				if (toDelete[i]) entities.Destroy(ids[i]);
 			}
 
 			break;
@@ -425,7 +301,7 @@ void AsteroidScene::ProcessEvents() {
 		case EventType::PlayerLeft: {
 			auto* playerLeft = static_cast<PlayerLeftEvent*>(event.get());
 			std::cout << "[Scene] Processing PlayerLeftEvent for NetworkID: " << playerLeft->networkID << std::endl;
-			RemoveGameObject(playerLeft->networkID);
+			RemoveEntity(playerLeft->networkID);
 			break;
 		}
 
@@ -435,20 +311,17 @@ void AsteroidScene::ProcessEvents() {
 }
 
 void AsteroidScene::Render() {
-	GraphicsEngine::GetInstance().Render(gameObjects);
+#ifndef HEADLESS_SERVER
+	GraphicsEngine::GetInstance().Render(entities);
+#endif
 }
 
 void AsteroidScene::Exit() {
-	gameObjects.clear();
+	entities.Clear();
 
 	g_AsteroidScene = nullptr; // Clear the global pointer
 }
 
-std::unordered_map<NetworkID, NetworkObject*>& AsteroidScene::GetNetworkedObjects() {
-	return networkedObjects;
-	
-}
-
 std::unordered_map<NetworkID, int>& AsteroidScene::GetPlayerScores() {
 	return playerScores;
 }
@@ -467,43 +340,47 @@ const std::unordered_map<NetworkID, int>& AsteroidScene::GetAllScores() const {
 	return playerScores;
 }
 
-NetworkObject * AsteroidScene::GetNetworkedObject(NetworkID id) {
-	auto it = networkedObjects.find(id);
-	if (it != networkedObjects.end()) {
-		return it->second;
-		
-	}
-	return nullptr;
-	
+void AsteroidScene::ApplyState(const ObjectStateMsg& state) {
+	entities.Apply(state);
 }
 
-void AsteroidScene::AddGameObject(std::unique_ptr<GameObject> obj, NetworkObject * netObj) {
-	if (netObj) {
-		// Check if ID already exists due to race conditions
-		if (networkedObjects.count(netObj->networkID)) {
-		std::cerr << "[Scene] Warning: NetworkObject with ID " << netObj->networkID << " already exists. Replacing." << std::endl;
-			     // Consider removing the old one first if necessary
-				RemoveGameObject(netObj->networkID);
-			
-		}
-		networkedObjects[netObj->networkID] = netObj;
-		std::cout << "[Scene] Added NetworkObject with ID: " << netObj->networkID << std::endl;
-		
+void AsteroidScene::ReconcileLocalPlayer(const PlayerStateAckMsg& ack) {
+	PlayerPool& players = entities.players;
+	for (uint32_t i = 0; i < players.Size(); ++i) {
+		if (!players.extra[i].isLocal) continue;
+		prediction.Reconcile(ack, players.position[i], players.velocity[i], players.rotation[i]);
+		return;
 	}
-	 gameObjects.push_back(std::move(obj));
 }
 
-void AsteroidScene::RemoveGameObject(NetworkID id) {
-	std::cout << "[Scene] Attempting to remove GameObject with NetworkID: " << id << std::endl;
-	networkedObjects.erase(id);
-	
-		// Remove from the main gameObjects vector
-		gameObjects.erase(std::remove_if(gameObjects.begin(), gameObjects.end(),
-			[id](const std::unique_ptr<GameObject>& obj) {
-				// Check if the GameObject is also a NetworkObject and has the matching ID
-				NetworkObject * netObj = dynamic_cast<NetworkObject*>(obj.get());
-				return netObj && netObj->networkID == id;
-				}), gameObjects.end());
-	
+void AsteroidScene::RemoveEntity(NetworkID id) {
+	std::cout << "[Scene] Attempting to remove entity with NetworkID: " << id << std::endl;
+	entities.Destroy(id);
 }
 
+void AsteroidScene::SpawnPlayer(NetworkID id, bool isLocal) {
+	PlayerPool& players = entities.players;
+	const uint32_t i = entities.Create(ENTITY_PLAYER, id);
+	players.scale[i] = glm::vec3(1.5f, 1.5f, 1.5f);
+	players.extra[i].isLocal = isLocal;
+	if (isLocal) prediction.Reset();
+}
+
+void AsteroidScene::SpawnAsteroid(NetworkID id, const glm::vec3& position, const glm::vec3& scale, const glm::vec3& velocity) {
+	auto& asteroids = entities.asteroids;
+	const uint32_t i = entities.Create(ENTITY_ASTEROID, id);
+	asteroids.position[i] = position;
+	asteroids.scale[i] = scale;
+	asteroids.velocity[i] = velocity;
+}
+
+void AsteroidScene::SpawnBullet(NetworkID id, const glm::vec3& position, float rotation, uint32_t ownerID) {
+	auto& bullets = entities.bullets;
+	const uint32_t i = entities.Create(ENTITY_BULLET, id);
+	const glm::vec3 dir(cos(rotation), sin(rotation), 0.f);
+	bullets.position[i] = position;
+	bullets.rotation[i] = static_cast<float>(atan2(dir.y, dir.x));
+	bullets.velocity[i] = dir * PlayerBullet::SPEED;
+	bullets.scale[i] = glm::vec3(PlayerBullet::SIZE);
+	bullets.owner[i] = ownerID;
+}
@@ -3,8 +3,13 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
-#include "GameObject.hpp"
-#include "Networking/NetworkObject.hpp"
+#include <random>
+#include "EntityStore.hpp"
+#include "PlayerPrediction.hpp"
+#include "LagCompensation.hpp"
+
+struct ObjectStateMsg;
+struct PlayerStateAckMsg;
 
 class AsteroidScene {
 public:
@@ -15,19 +20,27 @@ public:
 	void Render();
 	void Exit();
 
-	std::unordered_map<NetworkID, NetworkObject*>& GetNetworkedObjects();
-	NetworkObject* GetNetworkedObject(NetworkID id);
-	void AddGameObject(std::unique_ptr<GameObject> obj, NetworkObject* netObj); // To add objects received over network
-	void RemoveGameObject(NetworkID id); // To remove objects (e.g., on PlayerLeft)
+	void ApplyState(const ObjectStateMsg& state); // Network update for a known entity
+	void ReconcileLocalPlayer(const PlayerStateAckMsg& ack); // Client, the host's result for our input commands
+	void RemoveEntity(NetworkID id); // To remove objects (e.g., on PlayerLeft)
 
 	void AddScore(NetworkID playerId, int points);
 	int GetScore(NetworkID playerId) const;
 	const std::unordered_map<NetworkID, int>& GetAllScores() const;
 	std::unordered_map<NetworkID, int>& GetPlayerScores();
 
-	std::vector<std::unique_ptr<GameObject>> gameObjects;
+	EntityStore entities;
+	LagCompensation lagCompensation; // Host, past asteroid positions for collisions; also the broadphase
 private:
-	std::unordered_map<NetworkID, NetworkObject*> networkedObjects;
+	void SpawnPlayer(NetworkID id, bool isLocal);
+	void SpawnAsteroid(NetworkID id, const glm::vec3& position, const glm::vec3& scale, const glm::vec3& velocity);
+	void SpawnBullet(NetworkID id, const glm::vec3& position, float rotation, uint32_t ownerID);
+
 	std::unordered_map<NetworkID, int> playerScores;
+	bool gameStarted = false;
+	double asteroidSpawnTimer = 0.0; // Host
+	std::mt19937 random{ std::random_device{}() }; // Host, where asteroids spawn
+	PlayerPrediction prediction; // Client, the local player's unacknowledged input commands
+	std::vector<std::pair<NetworkID, Tick>> viewDelays; // Host, per fixed step: bullet owner, ticks behind us it sees
 };
 
@@ -0,0 +1,300 @@
+#include "BotApplication.hpp"
+
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include "Core/CpuTime.hpp"
+
+namespace {
+	std::atomic<bool> botsRunning{ true }; // Lock-free, so the signal handler may store to it
+
+	void OnShutdownSignal(int) {
+		botsRunning.store(false);
+	}
+
+	void PrintUsage(const char* exe) {
+		std::cout << "Usage: " << exe << " [--host <ip>] [--port <port>] [--bots <n>] [--threads <n>] [--tick-rate <hz>]"
+			<< " [--duration <seconds>] [--stats <seconds>] [--pattern <idle|spin|orbit|zigzag|random>]"
+			<< " [--fire-rate <shots/s>] [--turn-seconds <s>] [--seed <n>] [--verbose <0|1>]"
+			<< " [--impair-send <spec>] [--impair-receive <spec>] [--impair-seed <n>]\n"
+			<< "  <spec> is latency=<ms>,jitter=<ms>,loss=<%>,burst=<n>,duplicate=<%>,reorder=<%>,reorder-delay=<ms>,rate=<kB/s>,queue=<ms>\n";
+	}
+
+	// Sums over a set of bots
+	struct BotTotals {
+		size_t bots = 0;
+		size_t connected = 0;
+		size_t playing = 0;
+		BotMetrics sum;
+		double connectMsMax = 0.0;
+
+		void Add(BotClient& bot) {
+			++bots;
+			if (!bot.IsConnected()) return;
+			++connected;
+			if (bot.IsPlaying()) ++playing;
+
+			const BotMetrics& metrics = bot.CollectMetrics();
+			sum.connectMs += metrics.connectMs;
+			sum.shotsFired += metrics.shotsFired;
+			sum.shotsCommitted += metrics.shotsCommitted;
+			sum.commitMsSum += metrics.commitMsSum;
+			sum.commitMsMax = std::max(sum.commitMsMax, metrics.commitMsMax);
+			sum.snapshots += metrics.snapshots;
+			sum.bytesSent += metrics.bytesSent;
+			sum.bytesReceived += metrics.bytesReceived;
+			connectMsMax = std::max(connectMsMax, metrics.connectMs);
+		}
+
+		void Add(const BotTotals& other) {
+			bots += other.bots;
+			connected += other.connected;
+			playing += other.playing;
+			sum.connectMs += other.sum.connectMs;
+			sum.shotsFired += other.sum.shotsFired;
+			sum.shotsCommitted += other.sum.shotsCommitted;
+			sum.commitMsSum += other.sum.commitMsSum;
+			sum.commitMsMax = std::max(sum.commitMsMax, other.sum.commitMsMax);
+			sum.snapshots += other.sum.snapshots;
+			sum.bytesSent += other.sum.bytesSent;
+			sum.bytesReceived += other.sum.bytesReceived;
+			connectMsMax = std::max(connectMsMax, other.connectMsMax);
+		}
+	};
+
+	// What the bots did between two BotTotals, per bot and second
+	void PrintRates(std::ostream& out, const BotTotals& now, const BotTotals& before, double seconds) {
+		const double botSeconds = static_cast<double>(now.connected) * seconds;
+		const double perBotSecond = botSeconds > 0.0 ? 1.0 / botSeconds : 0.0;
+		const uint64_t committed = now.sum.shotsCommitted - before.sum.shotsCommitted;
+
+		out << " snapshots/s/bot=" << static_cast<double>(now.sum.snapshots - before.sum.snapshots) * perBotSecond
+			<< " kB/s_in/bot=" << static_cast<double>(now.sum.bytesReceived - before.sum.bytesReceived) / 1024.0 * perBotSecond
+			<< " kB/s_out/bot=" << static_cast<double>(now.sum.bytesSent - before.sum.bytesSent) / 1024.0 * perBotSecond
+			<< " shots=" << now.sum.shotsFired - before.sum.shotsFired
+			<< " committed=" << committed
+			<< " commit_ms_avg=" << (committed ? (now.sum.commitMsSum - before.sum.commitMsSum) / static_cast<double>(committed) : 0.0);
+	}
+
+	std::mutex reportOutput; // Threads print their reports whole
+
+	// Runs this thread's bots every frame until the time is up. They join one a frame, the ones already in
+	// keep playing meanwhile; the time starts, and played is taken, once the last has.
+	void RunBots(const BotConfig& config, size_t thread, const std::vector<BotClient*>& bots, std::ostream& out,
+		BotTotals& played, double& playedSeconds) {
+		std::vector<BotClient*> connected;
+		size_t joining = 0;
+
+		const auto frameDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(1.0 / config.tickRate));
+		auto start = std::chrono::steady_clock::now();
+		auto nextFrame = start;
+
+		const auto statsInterval = std::chrono::seconds(config.statsInterval);
+		auto statsStart = start;
+		BotTotals statsBase;
+		double statsCpuBase = CpuTime::GetProcessSeconds();
+		double busyMicros = 0.0;
+		uint64_t botFrames = 0;
+
+		while (botsRunning.load(std::memory_order_relaxed)) {
+			if (joining < bots.size()) {
+				BotClient* bot = bots[joining++];
+				ImpairmentSettings impairment = config.impairment;
+				impairment.seed += static_cast<uint32_t>(bot->GetIndex());
+				if (bot->Connect(config.host, config.port, config.tickRate, impairment)) {
+					connected.push_back(bot);
+				}
+				else {
+					std::lock_guard<std::mutex> lock(reportOutput);
+					out << "[Bots] Bot " << bot->GetIndex() << " could not connect to " << config.host << ":" << config.port << "\n";
+				}
+				if (joining == bots.size()) {
+					if (connected.empty()) break;
+					start = std::chrono::steady_clock::now();
+					for (BotClient* joined : bots) played.Add(*joined);
+				}
+			}
+
+			const auto busyStart = std::chrono::steady_clock::now();
+			if (joining == bots.size() && config.duration > 0 && busyStart - start >= std::chrono::seconds(config.duration)) break;
+
+			for (BotClient* bot : connected) bot->Frame();
+			const auto busyEnd = std::chrono::steady_clock::now();
+			busyMicros += std::chrono::duration<double, std::micro>(busyEnd - busyStart).count();
+			botFrames += connected.size();
+
+			if (config.statsInterval > 0 && busyEnd - statsStart >= statsInterval) {
+				const double seconds = std::chrono::duration<double>(busyEnd - statsStart).count();
+				const double cpu = CpuTime::GetProcessSeconds();
+				BotTotals totals;
+				for (BotClient* bot : bots) totals.Add(*bot);
+
+				std::ostringstream report;
+				report << "[Bots] thread=" << thread << " bots=" << totals.bots << " connected=" << totals.connected
+					<< " playing=" << totals.playing
+					<< " frame_us/bot=" << (botFrames ? busyMicros / static_cast<double>(botFrames) : 0.0);
+				PrintRates(report, totals, statsBase, seconds);
+				report << " process_cpu=" << (cpu - statsCpuBase) / seconds * 100.0 << "%\n";
+				{
+					std::lock_guard<std::mutex> lock(reportOutput);
+					out << report.str() << std::flush;
+				}
+				statsBase = totals;
+				statsCpuBase = cpu;
+				statsStart = busyEnd;
+				busyMicros = 0.0;
+				botFrames = 0;
+			}
+
+			// Sleep until the next frame; if we fell behind, resync rather than burst
+			nextFrame += frameDuration;
+			const auto now = std::chrono::steady_clock::now();
+			if (nextFrame < now) nextFrame = now;
+			else std::this_thread::sleep_until(nextFrame);
+		}
+		playedSeconds = joining == bots.size() ? std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() : 0.0;
+
+		for (BotClient* bot : connected) bot->Exit();
+	}
+}
+
+BotConfig BotConfig::FromCommandLine(int argc, char* argv[]) {
+	BotConfig cfg;
+
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+		if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+			PrintUsage(argv[0]);
+			std::exit(0);
+		}
+		if (!value) {
+			std::cerr << "[Bots] Missing value for " << arg << "\n";
+			break;
+		}
+
+		if (std::strcmp(arg, "--host") == 0) {
+			cfg.host = value;
+		} else if (std::strcmp(arg, "--port") == 0) {
+			cfg.port = value;
+		} else if (std::strcmp(arg, "--bots") == 0) {
+			cfg.bots = static_cast<size_t>(std::max(1, std::atoi(value)));
+		} else if (std::strcmp(arg, "--threads") == 0) {
+			cfg.threads = static_cast<size_t>(std::max(1, std::atoi(value)));
+		} else if (std::strcmp(arg, "--tick-rate") == 0) {
+			cfg.tickRate = std::max(1, std::atoi(value));
+		} else if (std::strcmp(arg, "--duration") == 0) {
+			cfg.duration = std::max(0, std::atoi(value));
+		} else if (std::strcmp(arg, "--stats") == 0) {
+			cfg.statsInterval = std::max(0, std::atoi(value));
+		} else if (std::strcmp(arg, "--fire-rate") == 0) {
+			cfg.behaviour.fireRate = std::max(0.0, std::atof(value));
+		} else if (std::strcmp(arg, "--turn-seconds") == 0) {
+			cfg.behaviour.turnSeconds = std::max(0.05, std::atof(value));
+		} else if (std::strcmp(arg, "--seed") == 0) {
+			cfg.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		} else if (std::strcmp(arg, "--verbose") == 0) {
+			cfg.verbose = std::atoi(value) != 0;
+		} else if (std::strcmp(arg, "--impair-send") == 0 || std::strcmp(arg, "--impair-receive") == 0) {
+			LinkImpairment& link = std::strcmp(arg, "--impair-send") == 0 ? cfg.impairment.send : cfg.impairment.receive;
+			if (!link.Parse(value)) {
+				std::cerr << "[Bots] Could not read " << arg << " " << value << "\n";
+				PrintUsage(argv[0]);
+			}
+		} else if (std::strcmp(arg, "--impair-seed") == 0) {
+			cfg.impairment.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		} else if (std::strcmp(arg, "--pattern") == 0) {
+			if (std::strcmp(value, "idle") == 0) {
+				cfg.behaviour.pattern = BotPattern::Idle;
+			} else if (std::strcmp(value, "spin") == 0) {
+				cfg.behaviour.pattern = BotPattern::Spin;
+			} else if (std::strcmp(value, "orbit") == 0) {
+				cfg.behaviour.pattern = BotPattern::Orbit;
+			} else if (std::strcmp(value, "zigzag") == 0) {
+				cfg.behaviour.pattern = BotPattern::Zigzag;
+			} else if (std::strcmp(value, "random") == 0) {
+				cfg.behaviour.pattern = BotPattern::Random;
+			} else {
+				std::cerr << "[Bots] Unknown pattern " << value << ", keeping the default\n";
+			}
+		} else {
+			std::cerr << "[Bots] Unknown option " << arg << "\n";
+			PrintUsage(argv[0]);
+			continue;
+		}
+		++i; // consumed the value
+	}
+
+	cfg.threads = std::min(cfg.threads, cfg.bots);
+	return cfg;
+}
+
+int BotApplication::Run() {
+	std::signal(SIGINT, OnShutdownSignal);
+	std::signal(SIGTERM, OnShutdownSignal);
+
+	// The game's client code prints for every event it runs; hundreds of bots doing that would mostly measure the console
+	std::ostream out(std::cout.rdbuf());
+	std::streambuf* console = std::cout.rdbuf();
+	std::streambuf* errors = std::cerr.rdbuf();
+	if (!config.verbose) {
+		std::cout.rdbuf(nullptr);
+		std::cerr.rdbuf(nullptr);
+	}
+
+	out << "[Bots] " << config.bots << " bots on " << config.threads << " thread(s) to " << config.host << ":" << config.port
+		<< ", " << config.behaviour.fireRate << " shots/s each, seed " << config.seed << "\n";
+	if (config.impairment.IsEnabled()) {
+		out << "[Bots] Simulated network, seed " << config.impairment.seed
+			<< ", send: " << config.impairment.send.ToString() << ", receive: " << config.impairment.receive.ToString() << "\n";
+	}
+
+	std::vector<std::unique_ptr<BotClient>> bots;
+	for (size_t i = 0; i < config.bots; ++i) {
+		bots.push_back(std::make_unique<BotClient>(i, config.behaviour, config.seed + static_cast<uint32_t>(i)));
+	}
+
+	// Bot i is connected, run and exited by thread i % threads alone, so its packets stay in one thread's pool
+	std::vector<std::thread> threads;
+	std::vector<BotTotals> played(config.threads); // Each thread's bots when the last of them had joined
+	std::vector<double> playedSeconds(config.threads, 0.0);
+	for (size_t thread = 0; thread < config.threads; ++thread) {
+		std::vector<BotClient*> mine;
+		for (size_t i = thread; i < bots.size(); i += config.threads) mine.push_back(bots[i].get());
+
+		threads.emplace_back([this, thread, mine = std::move(mine), &out, &played, &playedSeconds]() {
+			RunBots(config, thread, mine, out, played[thread], playedSeconds[thread]);
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	// Rates are over the time every bot was in, not while they were joining
+	BotTotals totals, joined;
+	double botSeconds = 0.0;
+	for (size_t i = 0; i < bots.size(); ++i) {
+		totals.Add(*bots[i]);
+		if (bots[i]->IsConnected()) botSeconds += playedSeconds[i % config.threads];
+	}
+	for (const BotTotals& thread : played) joined.Add(thread);
+
+	out << "[Bots] Summary bots=" << totals.bots << " connected=" << totals.connected << " playing=" << totals.playing
+		<< " connect_ms_avg=" << (totals.connected ? totals.sum.connectMs / static_cast<double>(totals.connected) : 0.0)
+		<< " connect_ms_max=" << totals.connectMsMax;
+	PrintRates(out, totals, joined, totals.connected ? botSeconds / static_cast<double>(totals.connected) : 0.0);
+	out << " commit_ms_max=" << totals.sum.commitMsMax << "\n";
+
+	std::cout.rdbuf(console);
+	std::cerr.rdbuf(errors);
+	return totals.connected == totals.bots ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include "BotClient.hpp"
+
+/**
+ * \brief Settings for the bot load generator, parsed from the command line.
+ *
+ * Usage: AsteroidBots [--host <ip>] [--port <port>] [--bots <n>] [--threads <n>] [--tick-rate <hz>]
+ *                    [--duration <seconds>] [--stats <seconds>] [--pattern <idle|spin|orbit|zigzag|random>]
+ *                    [--fire-rate <shots/s>] [--turn-seconds <s>] [--seed <n>] [--verbose <0|1>]
+ *                    [--impair-send <spec>] [--impair-receive <spec>] [--impair-seed <n>]
+ */
+struct BotConfig {
+	std::string host = "127.0.0.1";
+	std::string port = "1234";
+	size_t bots = 100;
+	size_t threads = 1;			// The bots are spread over these
+	int tickRate = 60;			// Must match the server's
+	int duration = 60;			// Seconds the bots play once their thread has connected them (0 = until Ctrl+C)
+	int statsInterval = 5;		// Seconds between reports (0 = only the summary)
+	BotBehaviour behaviour;
+	uint32_t seed = 1;			// Bot i's script is seeded with seed + i, so a run can be repeated
+	bool verbose = false;		// Let the game's own console output through
+	ImpairmentSettings impairment; // A simulated network in front of each bot, bot i's seeded with seed + i
+
+	static BotConfig FromCommandLine(int argc, char* argv[]);
+};
+
+/**
+ * \brief Headless load generator: many scripted clients in one process, each a BotClient, run by a few threads
+ *        at the client's frame rate. Reports what the bots see; the server's --stats reports what it costs.
+ */
+class BotApplication {
+public:
+	explicit BotApplication(const BotConfig& cfg) : config(cfg) {}
+	~BotApplication() = default;
+
+	int Run();
+
+private:
+	BotConfig config;
+};
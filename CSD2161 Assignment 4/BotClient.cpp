@@ -0,0 +1,156 @@
+#include "BotClient.hpp"
+
+#include <algorithm>
+#include "Events/Event.hpp"
+#include "PlayerBullet.hpp"
+#include "Networking/PlayerInput.hpp"
+
+extern thread_local AsteroidScene* g_AsteroidScene;
+
+BotClient::BotClient(size_t index, const BotBehaviour& behaviour, uint32_t seed)
+	: index(index), behaviour(behaviour), random(seed) {
+	// Bots started together should not all turn and shoot on the same frame
+	std::uniform_real_distribution<double> phase(0.0, 1.0);
+	if (behaviour.fireRate > 0.0) fireTimer = phase(random) / behaviour.fireRate;
+	turnTimer = phase(random) * behaviour.turnSeconds;
+	turningLeft = (index & 1) == 0;
+}
+
+bool BotClient::Connect(const std::string& host, const std::string& port, double tickRate, const ImpairmentSettings& impairment) {
+	Bind();
+
+	timer.SetFixedDeltaTime(1.0 / tickRate);
+	network.fixedDeltaTime = timer.GetFixedDT();
+	network.impairment = impairment;
+	network.Initialize();
+
+	const auto start = Clock::now();
+	if (!network.Connect(host, port, "bot" + std::to_string(index))) {
+		network.Exit();
+		return false;
+	}
+	metrics.connectMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	network.socketManager.GetTransport().ResetStats(); // The handshake is not what the match costs
+
+	scene.Initialize();
+	timer.Start();
+	return true;
+}
+
+void BotClient::Frame() {
+	Bind();
+	timer.Update();
+	const double dt = timer.GetDeltaTime();
+
+	PlayerPool& players = scene.entities.players;
+	NetworkID self = 0;
+	for (uint32_t i = 0; i < players.Size(); ++i) {
+		if (!players.extra[i].isLocal) continue;
+
+		self = players.networkID[i];
+		players.extra[i].heldButtons = Steer();
+		fireTimer -= dt;
+		if (behaviour.fireRate > 0.0 && fireTimer <= 0.0) {
+			Fire(players.position[i], players.rotation[i], self);
+			fireTimer = std::max(fireTimer + 1.0 / behaviour.fireRate, 0.0);
+		}
+		break;
+	}
+	playing = self != 0;
+	turnTimer += dt;
+
+	scene.Update(dt);
+	for (int i = 0; i < timer.GetFixedSteps(); ++i) {
+		scene.FixedUpdate(timer.GetFixedDT());
+
+		network.AdvanceTick();
+	}
+	scene.ProcessEvents();
+	if (self != 0) MatchCommits(self);
+
+	network.Update(dt);
+	timer.SetTimeScale(network.GetTickRate()); // A client's ticks keep pace with the host's
+}
+
+void BotClient::Exit() {
+	Bind();
+	CollectMetrics();
+	scene.Exit();
+	network.Exit();
+	Unbind();
+}
+
+void BotClient::Bind() {
+	NetworkEngine::Bind(&network);
+	EventQueue::Bind(&events);
+	g_AsteroidScene = &scene;
+}
+
+void BotClient::Unbind() {
+	NetworkEngine::Bind(nullptr);
+	EventQueue::Bind(nullptr);
+	g_AsteroidScene = nullptr;
+}
+
+const BotMetrics& BotClient::CollectMetrics() {
+	Transport& transport = network.socketManager.GetTransport();
+	metrics.bytesSent += transport.GetStats().bytesSent;
+	metrics.bytesReceived += transport.GetStats().bytesReceived;
+	transport.ResetStats();
+	metrics.snapshots = network.interpolation.stats.snapshots;
+	return metrics;
+}
+
+uint8_t BotClient::Steer() {
+	switch (behaviour.pattern) {
+	case BotPattern::Idle:
+		return 0;
+	case BotPattern::Spin:
+		return BUTTON_ROTATE_LEFT;
+	case BotPattern::Orbit:
+		return BUTTON_THRUST | BUTTON_ROTATE_LEFT;
+	case BotPattern::Zigzag:
+		if (turnTimer >= behaviour.turnSeconds) {
+			turnTimer = 0.0;
+			turningLeft = !turningLeft;
+		}
+		return BUTTON_THRUST | (turningLeft ? BUTTON_ROTATE_LEFT : BUTTON_ROTATE_RIGHT);
+	case BotPattern::Random:
+		if (turnTimer >= behaviour.turnSeconds) {
+			turnTimer = 0.0;
+			randomButtons = static_cast<uint8_t>(std::uniform_int_distribution<int>(0, 7)(random));
+		}
+		return randomButtons;
+	}
+	return 0;
+}
+
+void BotClient::Fire(const glm::vec3& position, float rotation, NetworkID self) {
+	network.SendEventToServer(std::make_unique<FireBulletEvent>(position, rotation, self));
+	shotsWaiting.push_back(Clock::now());
+	++metrics.shotsFired;
+
+	// Shots the host never ran (dropped, or the match is over) stop being waited for
+	const auto expired = Clock::now() - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(MAX_COMMIT_WAIT));
+	while (!shotsWaiting.empty() && shotsWaiting.front() < expired) shotsWaiting.pop_front();
+}
+
+void BotClient::MatchCommits(NetworkID self) {
+	// Bullets are given rising IDs by the host, ours come back in the order we fired them
+	const EntityPool<PlayerBullet>& bullets = scene.entities.bullets;
+	const auto now = Clock::now();
+	NetworkID newest = newestBullet;
+	for (uint32_t i = 0; i < bullets.Size(); ++i) {
+		const NetworkID id = bullets.networkID[i];
+		if (bullets.owner[i] != self || id <= newestBullet) continue;
+		newest = std::max(newest, id);
+		if (shotsWaiting.empty()) continue;
+
+		const double ms = std::chrono::duration<double, std::milli>(now - shotsWaiting.front()).count();
+		shotsWaiting.pop_front();
+		++metrics.shotsCommitted;
+		metrics.commitMsSum += ms;
+		metrics.commitMsMax = std::max(metrics.commitMsMax, ms);
+	}
+	newestBullet = newest;
+}
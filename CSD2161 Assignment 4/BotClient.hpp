@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <random>
+#include <string>
+#include "AsteroidScene.hpp"
+#include "Core/Timer.hpp"
+#include "Events/EventQueue.hpp"
+#include "Networking/NetworkEngine.hpp"
+
+// How a bot flies: the PlayerButtons it holds
+enum class BotPattern {
+	Idle,	// Nothing
+	Spin,	// Turns on the spot
+	Orbit,	// Thrusts while turning, in a circle
+	Zigzag,	// Thrusts, turning left then right
+	Random	// Any buttons, changed every so often
+};
+
+struct BotBehaviour {
+	BotPattern pattern = BotPattern::Orbit;
+	double fireRate = 2.0;		// Shots a second (0 = never)
+	double turnSeconds = 1.0;	// Zigzag: how long each way is held; Random: how long one choice is
+};
+
+/**
+ * \brief What one bot has measured since it connected.
+ */
+struct BotMetrics {
+	double connectMs = 0.0;			// The handshake in NetworkEngine::Connect
+	uint64_t shotsFired = 0;
+	uint64_t shotsCommitted = 0;	// Came back as our bullet
+	double commitMsSum = 0.0;		// Sending a FireBulletEvent to running the event it became
+	double commitMsMax = 0.0;
+	uint64_t snapshots = 0;
+	uint64_t bytesSent = 0;
+	uint64_t bytesReceived = 0;
+};
+
+/**
+ * \brief One scripted player for load tests: a network session, event queue and scene of its own, run as the
+ *        game's client runs them but with a script in place of the window and keyboard.
+ *
+ * Like ServerMatch it binds its own before it runs, so one thread can run many bots in turn. A bot connects,
+ * runs and exits on the same thread.
+ */
+class BotClient {
+public:
+	static constexpr double MAX_COMMIT_WAIT = 5.0; // Seconds a shot is waited for before it counts as lost
+
+	BotClient(size_t index, const BotBehaviour& behaviour, uint32_t seed);
+
+	// With impairment, the bot's socket sits behind a simulated network
+	bool Connect(const std::string& host, const std::string& port, double tickRate, const ImpairmentSettings& impairment = {});
+	// A client frame as Application runs it, after steering and firing by the script
+	void Frame();
+	void Exit();
+
+	void Bind();
+	static void Unbind();
+
+	inline size_t GetIndex() const { return index; }
+	inline bool IsConnected() const { return network.isClient; }
+	inline bool IsPlaying() const { return playing; } // Has a ship, once the match starts
+
+	// Brings the transport's counters into the metrics first
+	const BotMetrics& CollectMetrics();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	uint8_t Steer();
+	void Fire(const glm::vec3& position, float rotation, NetworkID self);
+	void MatchCommits(NetworkID self); // Our new bullets against the shots still waiting
+
+	size_t index;
+	BotBehaviour behaviour;
+	std::mt19937 random;
+	NetworkEngine network;
+	EventQueue events;
+	AsteroidScene scene;
+	Timer timer;
+
+	bool playing = false;
+	double fireTimer = 0.0;
+	double turnTimer = 0.0;
+	uint8_t randomButtons = 0;
+	bool turningLeft = true;
+	std::deque<Clock::time_point> shotsWaiting; // Oldest first
+	NetworkID newestBullet = 0;					// Of ours, already matched
+	BotMetrics metrics;
+};
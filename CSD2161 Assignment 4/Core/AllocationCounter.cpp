@@ -0,0 +1,51 @@
+#include "AllocationCounter.hpp"
+
+#ifdef TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+	std::atomic<uint64_t> allocationCount{ 0 };
+	thread_local uint64_t threadAllocationCount = 0;
+
+	void* CountedAlloc(std::size_t size) {
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+		++threadAllocationCount;
+		if (size == 0) size = 1;
+		return std::malloc(size);
+	}
+}
+
+void* operator new(std::size_t size) {
+	if (void* ptr = CountedAlloc(size)) return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+	if (void* ptr = CountedAlloc(size)) return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return CountedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return CountedAlloc(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+bool AllocationCounter::IsEnabled() { return true; }
+uint64_t AllocationCounter::GetCount() { return allocationCount.load(std::memory_order_relaxed); }
+uint64_t AllocationCounter::GetThreadCount() { return threadAllocationCount; }
+
+#else
+
+bool AllocationCounter::IsEnabled() { return false; }
+uint64_t AllocationCounter::GetCount() { return 0; }
+uint64_t AllocationCounter::GetThreadCount() { return 0; }
+
+#endif
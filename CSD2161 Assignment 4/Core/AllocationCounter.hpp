@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * \brief Counts global operator new calls so the server can report heap allocations per tick.
+ *
+ * Counting is only compiled in when TRACK_ALLOCATIONS is defined, which replaces the global
+ * operator new/delete in AllocationCounter.cpp. Otherwise IsEnabled() is false and the count stays 0.
+ */
+namespace AllocationCounter {
+	bool IsEnabled();
+	uint64_t GetCount();
+	uint64_t GetThreadCount(); // Made by the calling thread only
+}
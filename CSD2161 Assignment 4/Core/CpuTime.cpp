@@ -0,0 +1,29 @@
+#include "CpuTime.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+#include <cstdint>
+
+namespace CpuTime {
+	double GetProcessSeconds() {
+#ifdef _WIN32
+		FILETIME created, exited, kernel, user;
+		if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0.0;
+		// 100 ns units
+		auto seconds = [](const FILETIME& time) {
+			return static_cast<double>((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 1.0e-7;
+		};
+		return seconds(kernel) + seconds(user);
+#else
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+		auto seconds = [](const timeval& time) {
+			return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) * 1.0e-6;
+		};
+		return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+#endif
+	}
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+/**
+ * \brief CPU time the whole process has used, every thread and the kernel's share included, so a headless
+ *        build can report how much of a core it takes: the difference over an interval, divided by its length.
+ */
+namespace CpuTime {
+	double GetProcessSeconds();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <glm/vec2.hpp>
+#include <glm/geometric.hpp>
+
+/**
+ * \brief Uniform grid over the XY plane for radius queries.
+ *
+ * Items are plain indices chosen by the caller. Rebuild it with Clear/Insert/Build whenever positions change;
+ * entries live in one array sorted by cell, so a rebuild reuses its memory and a query is one binary search
+ * per row of cells it touches.
+ */
+class SpatialGrid {
+public:
+	explicit SpatialGrid(float cellSize = 16.f) : cellSize(cellSize) {}
+
+	void Clear() { entries.clear(); }
+
+	void Insert(uint32_t item, const glm::vec2& position) {
+		entries.push_back(Entry{ CellKey(CellCoord(position.x), CellCoord(position.y)), item, position });
+	}
+
+	// Call once after the last Insert, before querying
+	void Build() {
+		std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.cell < b.cell; });
+	}
+
+	// Calls visit(item, distance) for every item within radius of center, in no particular order
+	template <typename Visit>
+	void Query(const glm::vec2& center, float radius, Visit&& visit) const {
+		const int32_t x0 = CellCoord(center.x - radius), x1 = CellCoord(center.x + radius);
+		const int32_t y0 = CellCoord(center.y - radius), y1 = CellCoord(center.y + radius);
+
+		for (int32_t y = y0; y <= y1; ++y) {
+			// Cells of one row are contiguous in key order
+			auto it = std::lower_bound(entries.begin(), entries.end(), CellKey(x0, y),
+				[](const Entry& e, uint64_t key) { return e.cell < key; });
+			const uint64_t last = CellKey(x1, y);
+			for (; it != entries.end() && it->cell <= last; ++it) {
+				const float distance = glm::length(it->position - center);
+				if (distance <= radius) visit(it->item, distance);
+			}
+		}
+	}
+
+	inline size_t Size() const { return entries.size(); }
+
+private:
+	struct Entry {
+		uint64_t cell;
+		uint32_t item;
+		glm::vec2 position;
+	};
+
+	int32_t CellCoord(float v) const {
+		const float cell = v / cellSize;
+		if (!(cell == cell)) return 0; // NaN
+		return static_cast<int32_t>(std::floor(std::clamp(cell, -1e9f, 1e9f)));
+	}
+
+	// Row major with the sign bit flipped, so keys sort the same way the coordinates do
+	static uint64_t CellKey(int32_t x, int32_t y) {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(y) ^ 0x80000000u) << 32) | (static_cast<uint32_t>(x) ^ 0x80000000u);
+	}
+
+	float cellSize;
+	std::vector<Entry> entries;
+};
@@ -27,7 +27,7 @@ void Timer::Update() {
 }
 
 void Timer::CalculateNumOfSteps(double dt) {
-    fixedAccumulator += dt;
+    fixedAccumulator += dt * timeScale;
     const int maxSteps = 10;
     fixedSteps = 0;
     while (fixedAccumulator >= fixedDeltaTime && fixedSteps < maxSteps) {
@@ -23,6 +23,7 @@ class Timer {
 
     double fixedDeltaTime = 1.0 / 60.0;         /**< The fixed delta time used to update time-based systems. */
     double fixedAccumulator = 0.0;              /**< Used in computing the difference between deltaTime and fixedDeltaTime. */
+    double timeScale = 1.0;                     /**< How fast fixed steps run relative to real time. */
     int fixedSteps = 0;
     int frame_counter = 0;
     double fpsTimer = 0.0;
@@ -90,6 +91,12 @@ public:
 
     inline void SetFixedDeltaTime(double dt) { fixedDeltaTime = dt; }
 
+    /**
+     * \brief Runs fixed steps faster (above 1) or slower than real time, e.g. to keep a client's tick in step with the host's.
+     * \param scale Fixed steps per fixedDeltaTime of real time.
+     */
+    inline void SetTimeScale(double scale) { timeScale = scale; }
+
 private:
     /**
      * \brief Calculates the number of steps to update time-based systems.
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/vec3.hpp>
+#include "Networking/NetworkObject.hpp"
+
+/**
+ * \brief Stable reference to an entity in an EntityPool. Survives other entities being removed;
+ *        once its own entity is removed the generation no longer matches and the handle goes stale.
+ */
+struct EntityHandle {
+	uint32_t slot = 0;
+	uint32_t generation = 0; // 0 is never issued, so a default handle refers to nothing
+
+	bool IsValid() const { return generation != 0; }
+};
+
+/**
+ * \brief Dense storage for one entity type, one array per component.
+ *
+ * Index i of every array is the same entity and entities are kept packed, so systems walk each array
+ * linearly. Removal moves the last entity into the hole, which changes that entity's index but not its handle.
+ * Extra holds the components only this type has.
+ */
+template <typename Extra>
+class EntityPool {
+public:
+	std::vector<NetworkID> networkID;
+	std::vector<glm::vec3> position;
+	std::vector<glm::vec3> velocity;
+	std::vector<float> rotation;
+	std::vector<glm::vec3> scale;
+	std::vector<uint32_t> owner;          // NetworkID of the player that created it, 0 for none
+	std::vector<Tick> lastReceivedTick;   // Newest network state applied
+	std::vector<Extra> extra;
+
+	// Appends an entity with default components at index Size() - 1
+	EntityHandle Add(NetworkID id) {
+		uint32_t slot;
+		if (!freeSlots.empty()) {
+			slot = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else {
+			slot = static_cast<uint32_t>(slots.size());
+			slots.push_back(Slot{});
+		}
+		slots[slot].index = static_cast<uint32_t>(networkID.size());
+		if (++slots[slot].generation == 0) slots[slot].generation = 1;
+
+		networkID.push_back(id);
+		position.emplace_back(0.f);
+		velocity.emplace_back(0.f);
+		rotation.push_back(0.f);
+		scale.emplace_back(1.f);
+		owner.push_back(0);
+		lastReceivedTick.push_back(0);
+		extra.emplace_back();
+		slotOf.push_back(slot);
+
+		return EntityHandle{ slot, slots[slot].generation };
+	}
+
+	void Remove(EntityHandle handle) {
+		if (!IsAlive(handle)) return;
+
+		const uint32_t index = slots[handle.slot].index;
+		const uint32_t last = static_cast<uint32_t>(networkID.size() - 1);
+		if (index != last) {
+			networkID[index] = networkID[last];
+			position[index] = position[last];
+			velocity[index] = velocity[last];
+			rotation[index] = rotation[last];
+			scale[index] = scale[last];
+			owner[index] = owner[last];
+			lastReceivedTick[index] = lastReceivedTick[last];
+			extra[index] = std::move(extra[last]);
+			slotOf[index] = slotOf[last];
+			slots[slotOf[index]].index = index;
+		}
+
+		networkID.pop_back();
+		position.pop_back();
+		velocity.pop_back();
+		rotation.pop_back();
+		scale.pop_back();
+		owner.pop_back();
+		lastReceivedTick.pop_back();
+		extra.pop_back();
+		slotOf.pop_back();
+
+		++slots[handle.slot].generation; // Stales every handle to the removed entity
+		freeSlots.push_back(handle.slot);
+	}
+
+	bool IsAlive(EntityHandle handle) const {
+		return handle.IsValid() && handle.slot < slots.size() && slots[handle.slot].generation == handle.generation;
+	}
+
+	// Current index of a live entity
+	uint32_t IndexOf(EntityHandle handle) const { return slots[handle.slot].index; }
+	EntityHandle HandleAt(uint32_t index) const { return EntityHandle{ slotOf[index], slots[slotOf[index]].generation }; }
+
+	inline size_t Size() const { return networkID.size(); }
+
+	void Reserve(size_t count) {
+		networkID.reserve(count);
+		position.reserve(count);
+		velocity.reserve(count);
+		rotation.reserve(count);
+		scale.reserve(count);
+		owner.reserve(count);
+		lastReceivedTick.reserve(count);
+		extra.reserve(count);
+		slotOf.reserve(count);
+		slots.reserve(count);
+	}
+
+	void Clear() {
+		while (!networkID.empty()) Remove(HandleAt(static_cast<uint32_t>(networkID.size() - 1)));
+	}
+
+private:
+	struct Slot {
+		uint32_t index = 0;
+		uint32_t generation = 0;
+	};
+
+	std::vector<Slot> slots;          // Handle slot -> dense index
+	std::vector<uint32_t> slotOf;     // Dense index -> handle slot
+	std::vector<uint32_t> freeSlots;
+};
@@ -0,0 +1,83 @@
+#include "EntityStore.hpp"
+
+#include <iostream>
+#include "Networking/Messages.hpp"
+
+uint32_t EntityStore::Create(EntityType type, NetworkID id) {
+	if (byNetworkID.count(id)) {
+		std::cerr << "[Scene] Warning: Entity with ID " << id << " already exists. Replacing." << std::endl;
+		Destroy(id);
+	}
+
+	return WithPool(type, [&](auto& pool) {
+		byNetworkID[id] = Entry{ type, pool.Add(id) };
+		return static_cast<uint32_t>(pool.Size() - 1);
+	});
+}
+
+bool EntityStore::Destroy(NetworkID id) {
+	auto it = byNetworkID.find(id);
+	if (it == byNetworkID.end()) return false;
+
+	const Entry entry = it->second;
+	byNetworkID.erase(it);
+	WithPool(entry.type, [&](auto& pool) { pool.Remove(entry.handle); });
+	return true;
+}
+
+bool EntityStore::Find(NetworkID id, EntityType& type, uint32_t& index) const {
+	auto it = byNetworkID.find(id);
+	if (it == byNetworkID.end()) return false;
+
+	type = it->second.type;
+	switch (type) {
+	case ENTITY_PLAYER: index = players.IndexOf(it->second.handle); break;
+	case ENTITY_BULLET: index = bullets.IndexOf(it->second.handle); break;
+	default: index = asteroids.IndexOf(it->second.handle); break;
+	}
+	return true;
+}
+
+size_t EntityStore::Size() const {
+	return players.Size() + bullets.Size() + asteroids.Size();
+}
+
+void EntityStore::Reserve(size_t count) {
+	players.Reserve(count);
+	bullets.Reserve(count);
+	asteroids.Reserve(count);
+	byNetworkID.reserve(count);
+}
+
+void EntityStore::Clear() {
+	players.Clear();
+	bullets.Clear();
+	asteroids.Clear();
+	byNetworkID.clear();
+}
+
+void EntityStore::Serialize(EntityType type, uint32_t index, Tick tick, ObjectStateMsg& state) const {
+	auto write = [&](const auto& pool) {
+		state.networkID = pool.networkID[index];
+		state.tick = tick;
+		state.position = pool.position[index];
+		state.rotation = pool.rotation[index];
+		state.objectType = static_cast<uint8_t>(type);
+		state.velocity = pool.velocity[index];
+	};
+	if (type == ENTITY_PLAYER) write(players);
+	else if (type == ENTITY_ASTEROID) write(asteroids);
+}
+
+void EntityStore::Apply(const ObjectStateMsg& state) {
+	EntityType type;
+	uint32_t index;
+	if (!Find(state.networkID, type, index)) return;
+
+	if (type == ENTITY_PLAYER) {
+		if (!players.extra[index].isLocal) Player::Deserialize(players, index, state);
+	}
+	else if (type == ENTITY_ASTEROID) {
+		Asteroid::Deserialize(asteroids, index, state);
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include "EntityPool.hpp"
+#include "Player.hpp"
+#include "Asteroid.hpp"
+#include "PlayerBullet.hpp"
+
+struct ObjectStateMsg;
+
+// Values go on the wire as ObjectStateMsg::objectType
+enum EntityType : uint8_t {
+	ENTITY_PLAYER,
+	ENTITY_BULLET,
+	ENTITY_ASTEROID
+};
+
+/**
+ * \brief Every entity in the scene: one dense pool per type, and where each NetworkID lives.
+ *
+ * Indices into a pool are only good until the next Destroy of that type; keep the NetworkID
+ * (or a pool handle) across frames instead.
+ */
+class EntityStore {
+public:
+	PlayerPool players;
+	EntityPool<PlayerBullet> bullets;
+	EntityPool<Asteroid> asteroids;
+
+	// Adds an entity with default components and returns its index in the type's pool.
+	// An entity already using id is replaced.
+	uint32_t Create(EntityType type, NetworkID id);
+	bool Destroy(NetworkID id); // O(1), the last entity of the same type takes its place
+	bool Find(NetworkID id, EntityType& type, uint32_t& index) const;
+	inline bool Contains(NetworkID id) const { return byNetworkID.count(id) != 0; }
+
+	// Drops the entities of one type that match pred(index) in a single pass
+	template <typename Extra, typename Pred>
+	void DestroyIf(EntityPool<Extra>& pool, Pred&& pred) {
+		for (uint32_t i = static_cast<uint32_t>(pool.Size()); i-- > 0;) {
+			if (!pred(i)) continue;
+			byNetworkID.erase(pool.networkID[i]);
+			pool.Remove(pool.HandleAt(i)); // Swaps in the last entity, which was already checked
+		}
+	}
+
+	size_t Size() const;
+	void Reserve(size_t count);
+	void Clear();
+
+	// Replicated state of a player or asteroid
+	void Serialize(EntityType type, uint32_t index, Tick tick, ObjectStateMsg& state) const;
+	// Network update for whatever has state.networkID. Local players and bullets are never overwritten.
+	void Apply(const ObjectStateMsg& state);
+
+private:
+	struct Entry {
+		EntityType type;
+		EntityHandle handle;
+	};
+
+	template <typename Visit>
+	auto WithPool(EntityType type, Visit&& visit) {
+		switch (type) {
+		case ENTITY_PLAYER: return visit(players);
+		case ENTITY_BULLET: return visit(bullets);
+		default: return visit(asteroids);
+		}
+	}
+
+	std::unordered_map<NetworkID, Entry> byNetworkID;
+};
@@ -2,9 +2,10 @@
 #include <memory>
 #include <string>
 #include <glm/vec3.hpp>
-#include <WinSock2.h>
+#include "../Networking/NetworkPlatform.hpp"
 #include "../Networking/NetworkObject.hpp"
-#include "../Networking/NetworkUtils.hpp" // Include for serialization utils
+#include "../Networking/PacketBuffer.hpp"
+#include "../Networking/Messages.hpp"
 
 using NetworkID = uint32_t;
 using EventID = uint32_t;
@@ -24,7 +25,7 @@ enum class EventType {
     FireBullet, //Player fires a bullet
 	Collision, //Collision between two objects
 
-    PlayerUpdate, //Player position update
+    PlayerUpdate, //Unused, players move by input commands (PLAYER_INPUT)
 
     //Rendering
     RenderBullet, //Render bullet
@@ -49,14 +50,13 @@ struct FireBulletEvent : public GameEvent {
     }
 
     // Simple serialization for FireBulletEvent
-    std::vector<char> Serialize() const {
-        std::vector<char> data;
+    void Serialize(PacketWriter& writer) const {
         // Type is handled by the wrapper message (GAME_EVENT / BROADCAST_EVENT)
-        NetworkUtils::WriteVec3(data, position);
-        NetworkUtils::WriteToPacket(data, NetworkUtils::FloatToNetwork(rotation), NetworkUtils::DATA_TYPE::DT_LONG);
-        uint32_t netOwnerId = htonl(ownerId);
-        NetworkUtils::WriteToPacket(data, netOwnerId, NetworkUtils::DATA_TYPE::DT_LONG);
-        return data;
+        FireBulletMsg msg;
+        msg.position = position;
+        msg.rotation = rotation;
+        msg.ownerId = ownerId;
+        Schema::Encode(writer, msg);
     }
 };
 
@@ -109,42 +109,29 @@ struct SpawnAsteroidEvent : public GameEvent {
     glm::vec3 initialScale;
     glm::vec3 initialVelocity;
 
-    SpawnAsteroidEvent(uint32_t id, const std::vector<char>& packet) : networkID(id) {
-        //int16_t posX, posY, scaX, scaY, velX, velY;
-
-        NetworkUtils::ReadVec3(packet.data(), 5, initialPosition);
-        NetworkUtils::ReadVec3(packet.data(), 17, initialScale);
-        NetworkUtils::ReadVec3(packet.data(), 29, initialVelocity);
-
+    SpawnAsteroidEvent(const SpawnAsteroidMsg& msg)
+        : networkID(msg.networkID), initialPosition(msg.position), initialScale(msg.scale), initialVelocity(msg.velocity)
+    {
         type = EventType::SpawnAsteroid;
     }
 };
 
 struct CollisionEvent : public GameEvent {
-    CollisionEvent(NetworkID a, NetworkID b)
-        : idA(a), idB(b) {
+    CollisionEvent(NetworkID a, NetworkID b, uint32_t scorer = 0)
+        : idA(a), idB(b), scorer(scorer) {
         type = EventType::Collision;
     }
     NetworkID idA;
     NetworkID idB;
+    uint32_t scorer;
 
     // Simple serialization for FireBulletEvent
-    std::vector<char> Serialize() const {
-        std::vector<char> data;
-        
-        uint32_t netA = htonl(idA);
-        NetworkUtils::WriteToPacket(data, netA, NetworkUtils::DATA_TYPE::DT_LONG);
-        uint32_t netB = htonl(idB);
-        NetworkUtils::WriteToPacket(data, netB, NetworkUtils::DATA_TYPE::DT_LONG);
-        return data;
+    void Serialize(PacketWriter& writer) const {
+        CollisionMsg msg;
+        msg.idA = idA;
+        msg.idB = idB;
+        msg.scorer = scorer;
+        Schema::Encode(writer, msg);
     }
 };
 
-struct PlayerUpdate : public GameEvent {
-    std::vector<char> packet;
-
-    PlayerUpdate(const char* rawPacket, size_t length) {
-        type = EventType::PlayerUpdate;
-        packet.assign(rawPacket, rawPacket + length);
-    }
-};
@@ -1,16 +1,26 @@
 #include "EventQueue.hpp"
 
+namespace {
+    thread_local EventQueue* boundQueue = nullptr;
+}
+
 EventQueue& EventQueue::GetInstance() {
+    if (boundQueue) return *boundQueue;
     static EventQueue eq;
     return eq;
 }
 
+void EventQueue::Bind(EventQueue* queue) {
+    boundQueue = queue;
+}
+
 void EventQueue::Push(std::unique_ptr<GameEvent> event) {
     events.emplace_back(std::move(event));
 }
 
-std::vector<std::unique_ptr<GameEvent>> EventQueue::Drain() {
-    std::vector<std::unique_ptr<GameEvent>> drained = std::move(events);
-    events.clear();
-    return drained;
-}
\ No newline at end of file
+std::vector<std::unique_ptr<GameEvent>>& EventQueue::Drain() {
+    // Both vectors keep their capacity, so steady state draining does not allocate
+    drainedEvents.clear();
+    drainedEvents.swap(events);
+    return drainedEvents;
+}
@@ -8,12 +8,16 @@
 class EventQueue {
 public:
     static EventQueue& GetInstance();
+    // Makes GetInstance() on this thread return queue, one match's own; nullptr goes back to the process-wide one
+    static void Bind(EventQueue* queue);
 
     void Push(std::unique_ptr<GameEvent> event);
 
-    std::vector<std::unique_ptr<GameEvent>> Drain();
+    // Swaps the pending events out; the returned list stays valid until the next Drain
+    std::vector<std::unique_ptr<GameEvent>>& Drain();
 
 private:
     std::vector<std::unique_ptr<GameEvent>> events;
+    std::vector<std::unique_ptr<GameEvent>> drainedEvents;
 	std::vector<std::unique_ptr<GameEvent>> broadcastQueue;
 };
\ No newline at end of file
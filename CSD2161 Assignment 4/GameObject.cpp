@@ -1 +0,0 @@
-#include "GameObject.hpp"
\ No newline at end of file
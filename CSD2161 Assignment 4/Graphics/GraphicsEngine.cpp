@@ -3,7 +3,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "ShaderUtils.hpp"
-#include "../GameObject.hpp"
+#include "../EntityStore.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
@@ -81,7 +81,7 @@ void GraphicsEngine::Init() {
     textures[Texture::TEXTURE_TYPE::TEX_PLAYER] = playerTexture;
 }
 
-void GraphicsEngine::Render(std::vector<std::unique_ptr<GameObject>>& gameObjects) {
+void GraphicsEngine::Render(const EntityStore& entities) {
     glClearColor(0.f, 0.f, 0.f, 1.f);
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -99,27 +99,36 @@ void GraphicsEngine::Render(std::vector<std::unique_ptr<GameObject>>& gameObject
     glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
     glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
 
-    for (const auto& go : gameObjects) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, go->position);
-        model = glm::rotate(model, go->rotation, glm::vec3(0, 0, 1));
-        model = glm::scale(model, go->scale);
+    const Mesh& quad = meshes[Mesh::MESH_TYPE::QUAD];
+    glBindVertexArray(quad.VAO);
 
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform4fv(colorLoc, 1, glm::value_ptr(go->color));
-
-        if (go->textured) {
+    // Every entity is a quad; the type decides the texture, color(i) the tint
+    auto drawPool = [&](const auto& pool, bool textured, Texture::TEXTURE_TYPE textureType, auto color) {
+        if (textured) {
             glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, textures[go->textureType]);
-            glUniform1i(useTexLoc, true);
-        } else {
-            glUniform1i(useTexLoc, false);
+            glBindTexture(GL_TEXTURE_2D, textures[textureType]);
         }
+        glUniform1i(useTexLoc, textured);
 
-        const Mesh& mesh = meshes[go->meshType];
-        glBindVertexArray(mesh.VAO);
-        glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0);
-    }
+        for (uint32_t i = 0; i < pool.Size(); ++i) {
+            glm::mat4 model = glm::mat4(1.0f);
+            model = glm::translate(model, pool.position[i]);
+            model = glm::rotate(model, pool.rotation[i], glm::vec3(0, 0, 1));
+            model = glm::scale(model, pool.scale[i]);
+
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+            glUniform4fv(colorLoc, 1, glm::value_ptr(color(i)));
+            glDrawElements(GL_TRIANGLES, quad.indexCount, GL_UNSIGNED_INT, 0);
+        }
+    };
+
+    const glm::vec4 white(1.f);
+    const glm::vec4 localColor(0.2f, 1.f, 0.2f, 1.f);
+    const glm::vec4 remoteColor(0.2f, 0.2f, 1.f, 1.f);
+    drawPool(entities.asteroids, true, Texture::TEXTURE_TYPE::TEX_ASTEROID, [&](uint32_t) { return white; });
+    drawPool(entities.bullets, false, Texture::TEXTURE_TYPE::TEX_ASTEROID, [&](uint32_t) { return white; });
+    drawPool(entities.players, true, Texture::TEXTURE_TYPE::TEX_PLAYER,
+        [&](uint32_t i) { return entities.players.extra[i].isLocal ? localColor : remoteColor; });
     glBindVertexArray(0);
     glUseProgram(0);
 }
@@ -9,7 +9,7 @@
 #include "Texture.hpp"
 
 typedef unsigned int GLuint;
-class GameObject;
+class EntityStore;
 
 class GraphicsEngine {
 	GLuint shaderProgram;
@@ -22,7 +22,7 @@ public:
 	static GraphicsEngine& GetInstance();
 
 	void Init();
-	void Render(std::vector<std::unique_ptr<GameObject>>&);
+	void Render(const EntityStore& entities);
 	void UpdateProjection(int width, int height);
 	GLuint LoadTexture(const std::string& filePath);
 };
@@ -0,0 +1,50 @@
+#include "LagCompensation.hpp"
+
+#include <algorithm>
+
+void LagCompensation::SetDepth(Tick ticks) {
+	frames = std::vector<Frame>(static_cast<size_t>(ticks) + 1);
+	newest = 0;
+	held = 0;
+}
+
+void LagCompensation::Record(Tick tick, const EntityPool<Asteroid>& asteroids) {
+	Frame& frame = frames[tick % frames.size()];
+	frame.tick = tick;
+	frame.recorded = true;
+	frame.maxSize = 0.f;
+	frame.grid.Clear();
+	frame.networkID.clear();
+	frame.size.clear();
+
+	for (uint32_t i = 0; i < asteroids.Size(); ++i) {
+		frame.grid.Insert(i, glm::vec2(asteroids.position[i]));
+		frame.networkID.push_back(asteroids.networkID[i]);
+		frame.size.push_back(asteroids.scale[i].x);
+		frame.maxSize = std::max(frame.maxSize, asteroids.scale[i].x);
+	}
+	frame.grid.Build();
+
+	// A tick that went backwards (never on the host) simply restarts the history there
+	if (held == 0 || static_cast<int32_t>(tick - newest) != 1) held = 1;
+	else held = std::min(held + 1, frames.size());
+	newest = tick;
+}
+
+Tick LagCompensation::Resolve(Tick tick) const {
+	if (held == 0) return tick;
+	const int32_t age = std::clamp(static_cast<int32_t>(newest - tick), 0, static_cast<int32_t>(held - 1));
+	return newest - static_cast<Tick>(age);
+}
+
+float LagCompensation::GetMaxSize(Tick tick) const {
+	const Frame* frame = Find(tick);
+	return frame ? frame->maxSize : 0.f;
+}
+
+const LagCompensation::Frame* LagCompensation::Find(Tick tick) const {
+	if (held == 0) return nullptr;
+	const Tick resolved = Resolve(tick);
+	const Frame& frame = frames[resolved % frames.size()];
+	return frame.recorded && frame.tick == resolved ? &frame : &frames[newest % frames.size()];
+}
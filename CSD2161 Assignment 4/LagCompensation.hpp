@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/vec2.hpp>
+#include "EntityPool.hpp"
+#include "Asteroid.hpp"
+#include "Core/SpatialGrid.hpp"
+
+/**
+ * \brief Host: where every asteroid was on each of the last few ticks, so a client's bullet can be tested
+ *        against the asteroids as that client was shown them rather than where they are now.
+ *
+ * One frame per tick in a fixed ring of depth + 1, the newest being the current tick. A frame is the
+ * broadphase grid of that tick plus the ID and size of each asteroid in it, and reuses its arrays when the
+ * ring comes round, so memory stays at (depth + 1) x the most asteroids seen at once.
+ */
+class LagCompensation {
+public:
+	static constexpr Tick DEFAULT_DEPTH_TICKS = 30; // 500 ms at 60 Hz
+
+	// How many ticks back queries can go, 0 for only the current one. Drops what is held.
+	void SetDepth(Tick ticks);
+	inline Tick GetDepth() const { return static_cast<Tick>(frames.size() - 1); }
+
+	// Once per fixed step, after the asteroids have moved: their positions on tick
+	void Record(Tick tick, const EntityPool<Asteroid>& asteroids);
+
+	// The tick a query for tick is answered from: itself if held, else the newest or oldest held
+	Tick Resolve(Tick tick) const;
+
+	// Largest asteroid on the tick Resolve(tick) picks, for sizing query radii
+	float GetMaxSize(Tick tick) const;
+
+	// Calls visit(networkID, distance, size) for every asteroid within radius of center on Resolve(tick).
+	// False if nothing has been recorded yet.
+	template <typename Visit>
+	bool Query(Tick tick, const glm::vec2& center, float radius, Visit&& visit) const {
+		const Frame* frame = Find(tick);
+		if (!frame) return false;
+		frame->grid.Query(center, radius, [&](uint32_t item, float distance) {
+			visit(frame->networkID[item], distance, frame->size[item]);
+		});
+		return true;
+	}
+
+private:
+	struct Frame {
+		Tick tick = 0;
+		bool recorded = false;
+		float maxSize = 0.f;
+		SpatialGrid grid{ 8.f }; // Cells a bit larger than the biggest asteroid
+		std::vector<NetworkID> networkID; // By grid item
+		std::vector<float> size;          // Diameter, by grid item
+	};
+
+	const Frame* Find(Tick tick) const;
+
+	std::vector<Frame> frames = std::vector<Frame>(DEFAULT_DEPTH_TICKS + 1);
+	Tick newest = 0;
+	size_t held = 0; // Frames recorded since the last SetDepth, up to frames.size()
+};
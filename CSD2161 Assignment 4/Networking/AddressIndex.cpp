@@ -0,0 +1,71 @@
+#include "AddressIndex.hpp"
+
+void AddressIndex::Insert(const sockaddr_in& addr, uint32_t value) {
+	if ((count + 1) * 2 > slots.size()) Grow();
+
+	const uint64_t key = KeyOf(addr);
+	for (size_t i = HomeOf(key);; i = (i + 1) & (slots.size() - 1)) {
+		if (slots[i].key == key) {
+			slots[i].value = value;
+			return;
+		}
+		if (slots[i].key == 0) {
+			slots[i] = Slot{ key, value };
+			++count;
+			return;
+		}
+	}
+}
+
+uint32_t AddressIndex::Find(const sockaddr_in& addr) const {
+	if (count == 0) return NOT_FOUND;
+
+	const uint64_t key = KeyOf(addr);
+	for (size_t i = HomeOf(key);; i = (i + 1) & (slots.size() - 1)) {
+		if (slots[i].key == key) return slots[i].value;
+		if (slots[i].key == 0) return NOT_FOUND;
+	}
+}
+
+void AddressIndex::Erase(const sockaddr_in& addr) {
+	if (count == 0) return;
+
+	const size_t mask = slots.size() - 1;
+	const uint64_t key = KeyOf(addr);
+	size_t hole = HomeOf(key);
+	while (slots[hole].key != key) {
+		if (slots[hole].key == 0) return;
+		hole = (hole + 1) & mask;
+	}
+
+	// Move back every later entry of the run that may sit in the hole, so no probe ever stops short of it
+	for (size_t i = (hole + 1) & mask; slots[i].key != 0; i = (i + 1) & mask) {
+		const size_t home = HomeOf(slots[i].key);
+		if (((i - home) & mask) >= ((i - hole) & mask)) {
+			slots[hole] = slots[i];
+			hole = i;
+		}
+	}
+	slots[hole] = Slot{};
+	--count;
+}
+
+void AddressIndex::Clear() {
+	slots.assign(slots.size(), Slot{});
+	count = 0;
+}
+
+void AddressIndex::Grow() {
+	std::vector<Slot> old = std::move(slots);
+	slots = std::vector<Slot>(old.empty() ? 16 : old.size() * 2);
+	count = 0;
+	for (const Slot& slot : old) {
+		if (slot.key == 0) continue;
+		for (size_t i = HomeOf(slot.key);; i = (i + 1) & (slots.size() - 1)) {
+			if (slots[i].key != 0) continue;
+			slots[i] = slot;
+			++count;
+			break;
+		}
+	}
+}
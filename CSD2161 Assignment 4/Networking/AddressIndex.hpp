@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "NetworkPlatform.hpp"
+
+/**
+ * \brief Flat open-addressing hash map from a UDP endpoint (IPv4 address and port) to a 32-bit value.
+ *
+ * Linear probing over one power-of-two array kept at most half full, so a lookup is a hash and usually a
+ * single cache line. Erase shifts the rest of the probe run back instead of leaving tombstones, so lookups
+ * stay short however many clients come and go.
+ */
+class AddressIndex {
+public:
+	static constexpr uint32_t NOT_FOUND = 0;
+
+	// Adds or replaces; value must not be NOT_FOUND
+	void Insert(const sockaddr_in& addr, uint32_t value);
+	uint32_t Find(const sockaddr_in& addr) const;
+	void Erase(const sockaddr_in& addr);
+	void Clear();
+
+	inline size_t Size() const { return count; }
+
+private:
+	struct Slot {
+		uint64_t key = 0; // 0 = empty; no client sends from 0.0.0.0:0
+		uint32_t value = NOT_FOUND;
+	};
+
+	static inline uint64_t KeyOf(const sockaddr_in& addr) {
+		return (static_cast<uint64_t>(addr.sin_addr.s_addr) << 16) | addr.sin_port;
+	}
+	inline size_t HomeOf(uint64_t key) const {
+		// splitmix64 finalizer, so neighbouring ports land far apart
+		key ^= key >> 30; key *= 0xbf58476d1ce4e5b9ull;
+		key ^= key >> 27; key *= 0x94d049bb133111ebull;
+		key ^= key >> 31;
+		return static_cast<size_t>(key) & (slots.size() - 1);
+	}
+	void Grow();
+
+	std::vector<Slot> slots;
+	size_t count = 0;
+};
@@ -0,0 +1,35 @@
+#include "Bandwidth.hpp"
+
+#include <algorithm>
+
+void TokenBucket::Refill(Clock::time_point now, double bytesPerSecond, double burstBytes) {
+	if (!started) {
+		started = true;
+		tokens = burstBytes;
+	}
+	else {
+		tokens += std::chrono::duration<double>(now - lastRefill).count() * bytesPerSecond;
+	}
+	tokens = std::min(tokens, burstBytes);
+	lastRefill = now;
+}
+
+void PriorityAccumulator::Begin() {
+	next.clear();
+	cursor = 0;
+}
+
+PriorityAccumulator::Entry& PriorityAccumulator::Add(NetworkID networkID, float gain) {
+	while (cursor < current.size() && current[cursor].networkID < networkID) ++cursor;
+
+	Entry entry{ networkID, 0.f, 0 };
+	if (cursor < current.size() && current[cursor].networkID == networkID) entry = current[cursor++];
+	entry.priority += gain;
+	++entry.staleRounds;
+	next.push_back(entry);
+	return next.back();
+}
+
+void PriorityAccumulator::End() {
+	current.swap(next);
+}
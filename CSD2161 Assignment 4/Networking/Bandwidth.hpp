@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Messages.hpp"
+
+/**
+ * \brief Byte budget of one client's link: fills at the configured rate up to a burst, every send takes
+ *        its size out. It may go below zero by the one packet that overdrew it, which the next refills pay back.
+ */
+class TokenBucket {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	void Refill(Clock::time_point now, double bytesPerSecond, double burstBytes);
+	inline void Consume(size_t bytes) { tokens -= static_cast<double>(bytes); }
+	inline double Available() const { return tokens; } // Bytes, may be negative
+
+private:
+	double tokens = 0.0;
+	Clock::time_point lastRefill{};
+	bool started = false;
+};
+
+// What the host's scheduler did for one client since its last reset
+struct BandwidthStats {
+	uint64_t bytesSent = 0;
+	uint64_t messagesSent = 0;
+	uint64_t datagramsSent = 0;     // Fewer than messagesSent by however many were bundled
+	uint64_t snapshotsSent = 0;
+	uint64_t snapshotsSkipped = 0;  // Rounds with no budget left for even an empty snapshot
+	uint64_t objectsDeferred = 0;   // Due for a refresh but over budget, left for a later snapshot
+	uint64_t reliableDeferred = 0;  // Reliable sends held back a tick for budget
+	uint32_t maxStaleRounds = 0;    // Longest an object in range has gone without a refresh, in snapshots
+};
+
+/**
+ * \brief Per-client priority of every object in range, raised each snapshot round by how much the client
+ *        needs it (type weight x relevance) and dropped to zero when it is sent, so the longer an object waits
+ *        the more it wins over the others.
+ *
+ * A round is Begin, then Add for each candidate in increasing networkID order, then End. Objects not added in a
+ * round are forgotten; both lists stay sorted, so carrying priorities over is one merge walk without lookups.
+ */
+class PriorityAccumulator {
+public:
+	struct Entry {
+		NetworkID networkID = 0;
+		float priority = 0.f;
+		uint32_t staleRounds = 0; // Rounds since it was last sent
+	};
+
+	void Begin();
+	Entry& Add(NetworkID networkID, float gain); // Valid until the next Add
+	void End();
+
+	inline Entry& At(size_t index) { return next[index]; } // Index in Add order, during the round
+	inline void Clear() { current.clear(); next.clear(); }
+
+private:
+	std::vector<Entry> current; // Last round, sorted by networkID
+	std::vector<Entry> next;    // This round
+	size_t cursor = 0;
+};
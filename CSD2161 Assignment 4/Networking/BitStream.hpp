@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * \brief Packs values of arbitrary bit width into a byte buffer, least significant bit first.
+ *        Running out of room flags the writer as failed instead of writing past capacity.
+ */
+class BitWriter {
+public:
+	BitWriter(char* out, size_t outCapacity) : data(reinterpret_cast<uint8_t*>(out)), capacity(outCapacity) {}
+
+	void WriteBits(uint32_t value, unsigned bits) {
+		if (bits < 32) value &= (1u << bits) - 1u;
+		scratch |= static_cast<uint64_t>(value) << scratchBits;
+		scratchBits += bits;
+		while (scratchBits >= 8) {
+			PutByte(static_cast<uint8_t>(scratch));
+			scratch >>= 8;
+			scratchBits -= 8;
+		}
+	}
+
+	void WriteBool(bool value) { WriteBits(value ? 1u : 0u, 1); }
+
+	// groupBits of payload per group plus one continuation bit; small groups suit values that are usually 0
+	void WriteVarint(uint32_t value, unsigned groupBits = 7) {
+		const uint32_t groupMask = (1u << groupBits) - 1u;
+		while (value > groupMask) {
+			WriteBits((value & groupMask) | (1u << groupBits), groupBits + 1);
+			value >>= groupBits;
+		}
+		WriteBits(value, groupBits + 1);
+	}
+
+	void WriteSignedVarint(int32_t value, unsigned groupBits = 7) {
+		WriteVarint((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31), groupBits); // zigzag
+	}
+
+	// Flushes the last partial byte. Returns false if anything did not fit.
+	bool Finish() {
+		if (scratchBits > 0) PutByte(static_cast<uint8_t>(scratch));
+		scratch = 0;
+		scratchBits = 0;
+		return !failed;
+	}
+
+	inline size_t BytesUsed() const { return used; }
+
+private:
+	void PutByte(uint8_t byte) {
+		if (used >= capacity) { failed = true; return; }
+		data[used++] = byte;
+	}
+
+	uint8_t* data;
+	size_t capacity;
+	size_t used = 0;
+	uint64_t scratch = 0;
+	unsigned scratchBits = 0;
+	bool failed = false;
+};
+
+/**
+ * \brief Reads values written by BitWriter. Reading past the end returns zeros and flags the reader as failed.
+ */
+class BitReader {
+public:
+	BitReader(const char* in, size_t inSize) : data(reinterpret_cast<const uint8_t*>(in)), size(inSize) {}
+
+	uint32_t ReadBits(unsigned bits) {
+		while (scratchBits < bits) {
+			if (used >= size) { failed = true; return 0; }
+			scratch |= static_cast<uint64_t>(data[used++]) << scratchBits;
+			scratchBits += 8;
+		}
+		const uint32_t value = static_cast<uint32_t>(bits < 32 ? scratch & ((1ull << bits) - 1ull) : scratch);
+		scratch >>= bits;
+		scratchBits -= bits;
+		return value;
+	}
+
+	bool ReadBool() { return ReadBits(1) != 0; }
+
+	uint32_t ReadVarint(unsigned groupBits = 7) {
+		uint32_t value = 0;
+		for (unsigned shift = 0; shift < 32; shift += groupBits) {
+			const uint32_t group = ReadBits(groupBits + 1);
+			value |= (group & ((1u << groupBits) - 1u)) << shift;
+			if (!(group >> groupBits)) return value;
+		}
+		failed = true; // Longer than any 32 bit value
+		return 0;
+	}
+
+	int32_t ReadSignedVarint(unsigned groupBits = 7) {
+		const uint32_t zigzag = ReadVarint(groupBits);
+		return static_cast<int32_t>((zigzag >> 1) ^ (0u - (zigzag & 1u)));
+	}
+
+	// Whole bytes consumed so far, including a partially read last byte
+	inline size_t BytesUsed() const { return used; }
+	inline bool Ok() const { return !failed; }
+
+private:
+	const uint8_t* data;
+	size_t size;
+	size_t used = 0;
+	uint64_t scratch = 0;
+	unsigned scratchBits = 0;
+	bool failed = false;
+};
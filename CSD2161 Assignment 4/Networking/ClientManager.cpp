@@ -1,48 +1,47 @@
 #include "ClientManager.hpp"
 #include <iostream>
 #include <array>
-#include <WS2tcpip.h>
+#include <algorithm>
+#include <random>
 
-void ClientManager::AddClient(const sockaddr_in& addr)
+std::optional<std::reference_wrapper<Client>> ClientManager::AddClient(const sockaddr_in& addr)
 {
+	if (auto existing = GetClientByAddr(addr)) return existing;
+	if (clients.size() >= MAX_CLIENTS) return std::nullopt;
+
 	char ipBuffer[INET_ADDRSTRLEN];
 	inet_ntop(AF_INET, &(addr.sin_addr), ipBuffer, INET_ADDRSTRLEN);
 	std::string ip(ipBuffer);
 
-	if (IsKnownClient(addr)) return;
+	uint32_t slot = freeSlot;
+	if (slot != NO_SLOT) freeSlot = slots[slot].index;
+	else {
+		slot = static_cast<uint32_t>(slots.size());
+		slots.emplace_back();
+	}
+	slots[slot].index = static_cast<uint32_t>(clients.size());
 
 	uint16_t port = ntohs(addr.sin_port);
 	Client client;
 	client.lastHeartbeatTime = std::chrono::steady_clock::now(); // Initialize heartbeat time
 	client.address = addr;
+	client.joinAddress = addr;
 	client.ipAddress = ip;
 	client.udpPort = port;
 	client.isConnected = true;
 	client.clientID = nextClientID++; // Assign and increment the ID
-	clients.push_back(client);
+	client.connectionID = MakeConnectionID(slot, slots[slot].generation);
+	client.connectionNonce = std::random_device{}(); // Not a seeded generator, whose next outputs could be worked out
+	clients.push_back(std::move(client));
+	byAddress.Insert(addr, clients.back().connectionID);
 
-	std::cout << "New client connected: " << ip << ":" << port << " (ID: " << client.clientID << ")\n";
+	std::cout << "New client connected: " << ip << ":" << port << " (ID: " << clients.back().clientID << ")\n";
+	return std::ref(clients.back());
 }
 
 bool ClientManager::IsKnownClient(const sockaddr_in& addr) const
 {
-	/*std::array<char, INET_ADDRSTRLEN> ipBuffer{};
-	inet_ntop(AF_INET, &(addr.sin_addr), ipBuffer.data(), ipBuffer.size());
-	std::string incomingIP(ipBuffer.data());
-	uint16_t port = ntohs(addr.sin_port);
-
-	for (const auto& client : clients) {
-		if (client.ipAddress == incomingIP && client.udpPort == port)
-			return true;
-	}
-	return false;*/
-
-	auto it = std::find_if(clients.cbegin(), clients.cend(),
-		[&addr](const Client& c) {
-			return c.address.sin_addr.s_addr == addr.sin_addr.s_addr &&
-				c.address.sin_port == addr.sin_port;
-			});
-	return it != clients.cend();
+	return byAddress.Find(addr) != AddressIndex::NOT_FOUND;
 }
 
 const std::vector<Client>& ClientManager::GetClients() const
@@ -56,41 +55,102 @@ std::vector<Client>& ClientManager::GetClientsNonConst()
 }
 
 std::optional<std::reference_wrapper<Client>> ClientManager::GetClientByAddr(const sockaddr_in& addr) {
-	auto it = std::find_if(clients.begin(), clients.end(),
-		[&addr](const Client& c) {
-			return c.address.sin_addr.s_addr == addr.sin_addr.s_addr &&
-				c.address.sin_port == addr.sin_port;
-		});
-	
-	if (it != clients.end()) {
-		return std::ref(*it);	
+	const uint32_t index = IndexOf(byAddress.Find(addr));
+	if (index != NO_SLOT) {
+		return std::ref(clients[index]);
 	}
 	return std::nullopt;
 }
 
 std::optional<std::reference_wrapper<const Client>> ClientManager::GetClientByAddr(const sockaddr_in& addr) const
 {
-	auto it = std::find_if(clients.begin(), clients.end(),
-		[&addr](const Client& c) {
-			return c.address.sin_addr.s_addr == addr.sin_addr.s_addr &&
-				c.address.sin_port == addr.sin_port;
-		});
-
-	if (it != clients.end()) {
-		return std::ref(*it);
+	const uint32_t index = IndexOf(byAddress.Find(addr));
+	if (index != NO_SLOT) {
+		return std::cref(clients[index]);
+	}
+	return std::nullopt;
+}
+
+std::optional<std::reference_wrapper<Client>> ClientManager::GetClientByConnection(ConnectionID connectionID)
+{
+	const uint32_t index = IndexOf(connectionID);
+	if (index != NO_SLOT) {
+		return std::ref(clients[index]);
+	}
+	return std::nullopt;
+}
+
+std::optional<std::reference_wrapper<Client>> ClientManager::GetClientByPlayer(NetworkID playerID)
+{
+	auto it = byPlayer.find(playerID);
+	const uint32_t index = it != byPlayer.end() ? IndexOf(it->second) : NO_SLOT;
+	if (index != NO_SLOT) {
+		return std::ref(clients[index]);
+	}
+	return std::nullopt;
+}
+
+std::optional<std::reference_wrapper<const Client>> ClientManager::GetClientByPlayer(NetworkID playerID) const
+{
+	auto it = byPlayer.find(playerID);
+	const uint32_t index = it != byPlayer.end() ? IndexOf(it->second) : NO_SLOT;
+	if (index != NO_SLOT) {
+		return std::cref(clients[index]);
 	}
 	return std::nullopt;
 }
 
+void ClientManager::SetPlayer(Client& client, NetworkID playerID)
+{
+	if (client.playerID != 0) byPlayer.erase(client.playerID);
+	client.playerID = playerID;
+	if (playerID != 0) byPlayer[playerID] = client.connectionID;
+}
+
+void ClientManager::Rebind(Client& client, const sockaddr_in& addr)
+{
+	byAddress.Erase(client.address);
+	byAddress.Insert(addr, client.connectionID);
+
+	char ipBuffer[INET_ADDRSTRLEN];
+	inet_ntop(AF_INET, &(addr.sin_addr), ipBuffer, INET_ADDRSTRLEN);
+	client.address = addr;
+	client.ipAddress = ipBuffer;
+	client.udpPort = ntohs(addr.sin_port);
+}
+
 void ClientManager::RemoveClient(const sockaddr_in& addr) {
-	clients.erase(
-		std::remove_if(clients.begin(), clients.end(),
-			[&addr](const Client& c) {
-				return c.address.sin_addr.s_addr == addr.sin_addr.s_addr &&
-					c.address.sin_port == addr.sin_port;
-			}),
-		clients.end()
-	);
+	RemoveClient(byAddress.Find(addr));
+}
+
+void ClientManager::RemoveClient(ConnectionID connectionID) {
+	const uint32_t index = IndexOf(connectionID);
+	if (index == NO_SLOT) return;
+
+	const uint32_t slot = connectionID & 0xFFFF;
+	byAddress.Erase(clients[index].address);
+	if (clients[index].playerID != 0) byPlayer.erase(clients[index].playerID);
+
+	// The last client takes the hole, and its slot follows it
+	if (index + 1 != clients.size()) {
+		clients[index] = std::move(clients.back());
+		slots[clients[index].connectionID & 0xFFFF].index = index;
+	}
+	clients.pop_back();
+
+	if (++slots[slot].generation == 0) slots[slot].generation = 1;
+	slots[slot].index = freeSlot;
+	freeSlot = slot;
 
 	//std::cout << "Client removed: " << inet_ntoa(addr.sin_addr) << ":" << ntohs(addr.sin_port) << std::endl;
 }
+
+uint32_t ClientManager::IndexOf(ConnectionID connectionID) const {
+	const uint32_t slot = connectionID & 0xFFFF;
+	if (connectionID == 0 || slot >= slots.size()) return NO_SLOT;
+
+	// A free slot's index is the next free one, so the ID is checked against the client it leads to as well
+	const Slot& entry = slots[slot];
+	if (MakeConnectionID(slot, entry.generation) != connectionID || entry.index >= clients.size()) return NO_SLOT;
+	return clients[entry.index].connectionID == connectionID ? entry.index : NO_SLOT;
+}
@@ -1,9 +1,18 @@
 #pragma once
 #include <vector>
 #include <string>
-#include <winsock2.h>
+#include "NetworkPlatform.hpp"
 #include <optional>
 #include <chrono>
+#include <functional>
+#include <unordered_map>
+#include "Snapshot.hpp"
+#include "ReliableChannel.hpp"
+#include "PlayerInput.hpp"
+#include "ClockSync.hpp"
+#include "Bandwidth.hpp"
+#include "AddressIndex.hpp"
+#include "MessageAggregator.hpp"
 
 // Forward declare NetworkEngine types
 using ClientID = uint32_t;
@@ -11,11 +20,30 @@ using TimePoint = std::chrono::steady_clock::time_point;
 
 struct Client {
 	sockaddr_in address;
+	sockaddr_in joinAddress; // Where its REQ_CONNECTION came from, kept when it moves
 	ClientID clientID;
 	std::string ipAddress;
 	uint16_t udpPort = 0;
 	bool isConnected = false;
 	TimePoint lastHeartbeatTime; // Track when the host last heard from this client
+	NetworkID playerID = 0; // Player this client controls, 0 until the match starts; set through ClientManager::SetPlayer
+	ConnectionID connectionID = 0; // What its packets name it by, stays valid while it is connected
+	uint32_t connectionNonce = 0; // And what they must carry along with it
+
+	// Snapshots sent to this client, kept as baselines until it acks a newer one
+	SnapshotHistory sentSnapshots;
+	SnapshotSequence lastSnapshotSent = 0;
+	SnapshotSequence lastSnapshotAcked = 0; // 0 = none, the next snapshot is sent in full
+	double interpolationDelay = 0.0; // Ticks it shows other objects behind the newest snapshot, from its acks
+
+	ReliableSender reliable; // Lockstep events and commits until this client acks them
+	PlayerInputQueue inputs; // Commands for playerID not run yet
+	ClientClock clock; // Its RTT and how far ahead of our tick it runs
+
+	TokenBucket bandwidth; // Bytes we may still send it
+	PriorityAccumulator priorities; // How overdue each object in its range is
+	BandwidthStats sendStats;
+	MessageAggregator outbox; // What we send it this frame, in as few datagrams as fit
 
 	// Basic comparison for searching, might need adjustment based on sockaddr_in usage
 	bool operator==(const sockaddr_in& other) const {
@@ -26,19 +54,62 @@ struct Client {
 
 
 
+/**
+ * \brief The host's clients, dense in one vector so per-tick loops walk them in order.
+ *
+ * A client is found by the connection ID its packets carry, through a slot table (slot index plus a generation
+ * that changes when the slot is reused, so a stale ID finds nothing), by address through an AddressIndex, or by
+ * the player it controls. All are O(1). Removing swaps the last client into the hole: references to clients do not survive it,
+ * connection IDs do.
+ */
 class ClientManager {
 public:
-	void AddClient(const sockaddr_in& addr);
+	static constexpr size_t MAX_CLIENTS = 0x10000; // Slot numbers are the low 16 bits of a connection ID
+	static constexpr uint32_t TAG_SHIFT = 24;
+
+	// For hosts sharing one port: every connection ID from here on carries tag (not 0) in its top 8 bits, in place
+	// of half the generation, so whoever reads the port can tell whose client a packet is from
+	void SetConnectionTag(uint8_t connectionTag) { tag = connectionTag; }
+	static inline uint8_t GetConnectionTag(ConnectionID connectionID) { return static_cast<uint8_t>(connectionID >> TAG_SHIFT); }
+
+	// The new client, or the one already at addr; none once MAX_CLIENTS are connected
+	std::optional<std::reference_wrapper<Client>> AddClient(const sockaddr_in& addr);
 	bool IsKnownClient(const sockaddr_in& addr) const;
 	const std::vector<Client>& GetClients() const;
 	std::vector<Client>& GetClientsNonConst();
 
 	std::optional<std::reference_wrapper<Client>> GetClientByAddr(const sockaddr_in& addr);
 	std::optional<std::reference_wrapper<const Client>> GetClientByAddr(const sockaddr_in & addr) const;
+	std::optional<std::reference_wrapper<Client>> GetClientByConnection(ConnectionID connectionID);
+	std::optional<std::reference_wrapper<Client>> GetClientByPlayer(NetworkID playerID);
+	std::optional<std::reference_wrapper<const Client>> GetClientByPlayer(NetworkID playerID) const;
+
+	// Hands client the player playerID, 0 for none
+	void SetPlayer(Client& client, NetworkID playerID);
+
+	// Moves client to a new address, after its NAT mapping changed. Only for a packet that carried its nonce.
+	void Rebind(Client& client, const sockaddr_in& addr);
 	void RemoveClient(const sockaddr_in& addr);
+	void RemoveClient(ConnectionID connectionID);
 
 private:
+	struct Slot {
+		uint16_t generation = 1; // Never 0, so no connection ID is 0
+		uint32_t index = 0;      // Into clients while in use, the next free slot while not
+	};
+	static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+	inline ConnectionID MakeConnectionID(uint32_t slot, uint16_t generation) const {
+		if (tag != 0) generation = static_cast<uint16_t>((tag << 8) | (generation & 0xFF));
+		return (static_cast<ConnectionID>(generation) << 16) | slot;
+	}
+	uint32_t IndexOf(ConnectionID connectionID) const; // Into clients, NO_SLOT if it names no client
+
 	std::vector<Client> clients;
+	std::vector<Slot> slots;
+	uint32_t freeSlot = NO_SLOT;
+	AddressIndex byAddress; // To connection IDs
+	std::unordered_map<NetworkID, ConnectionID> byPlayer;
 	ClientID nextClientID = 1; // Start client IDs from 1
+	uint8_t tag = 0; // 0 = connection IDs are not tagged
 };
-
@@ -0,0 +1,128 @@
+#include "ClockSync.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	uint32_t ToMicros(double seconds) {
+		return static_cast<uint32_t>(static_cast<uint64_t>(seconds * 1.0e6));
+	}
+}
+
+void ClientClock::OnPing(const ClockPingMsg& ping, Tick hostTick, double hostPhase, double tickSeconds) {
+	if (ping.rtt == 0) return; // The client has no round trip yet, so nothing to say about its clock
+
+	rtt = static_cast<double>(ping.rtt) / 1.0e6;
+	rttDeviation = static_cast<double>(ping.rttDeviation) / 1.0e6;
+
+	// Where the client's tick is now, if the ping took half the round trip to get here
+	const double sample = static_cast<double>(static_cast<int32_t>(ping.clientTick - hostTick))
+		+ rtt / 2.0 / tickSeconds - hostPhase;
+	offsetTicks = synced ? offsetTicks + (sample - offsetTicks) / 8.0 : sample;
+	synced = true;
+}
+
+void ClockSync::Reset() {
+	*this = ClockSync{};
+}
+
+bool ClockSync::NextPing(double nowSeconds, Tick localTick, ClockPingMsg& ping) {
+	const double interval = pingsSent < FAST_PINGS ? FAST_PING_INTERVAL : PING_INTERVAL;
+	if (nowSeconds - lastPing < interval) return false;
+	lastPing = nowSeconds;
+	++pingsSent;
+
+	ping.clientTime = ToMicros(nowSeconds);
+	ping.clientTick = localTick;
+	ping.rtt = synced ? std::max(ToMicros(smoothedRtt), 1u) : 0;
+	ping.rttDeviation = synced ? ToMicros(rttDeviation) : 0;
+	return true;
+}
+
+void ClockSync::OnPong(const ClockPongMsg& pong, double nowSeconds, double tickSeconds) {
+	const double rtt = static_cast<double>(ToMicros(nowSeconds) - pong.clientTime) / 1.0e6;
+	if (rtt > MAX_RTT) return; // Not one of ours, or so stale it says nothing about now
+	this->tickSeconds = tickSeconds;
+
+	Sample& sample = samples[next];
+	sample.time = nowSeconds;
+	sample.rtt = rtt;
+	sample.offset = static_cast<double>(pong.hostTick) + static_cast<double>(pong.hostPhase)
+		+ rtt / 2.0 / tickSeconds - nowSeconds / tickSeconds;
+	next = (next + 1) % WINDOW;
+	count = std::min(count + 1, WINDOW);
+
+	// RFC 6298 smoothing, for how far ahead to run; the offset itself comes from the quickest round trip
+	if (!synced) {
+		smoothedRtt = rtt;
+		rttDeviation = rtt / 2.0;
+	}
+	else {
+		rttDeviation += (std::abs(smoothedRtt - rtt) - rttDeviation) / 4.0;
+		smoothedRtt += (rtt - smoothedRtt) / 8.0;
+	}
+	synced = true;
+
+	Refit();
+	lead = (smoothedRtt / 2.0 + JITTER_MULTIPLIER * rttDeviation) / tickSeconds + TARGET_MARGIN_TICKS;
+}
+
+void ClockSync::Refit() {
+	best = 0;
+	for (size_t i = 1; i < count; ++i) {
+		if (samples[i].rtt < samples[best].rtt) best = i;
+	}
+	minRtt = samples[best].rtt;
+
+	// Drift: least squares slope of the offset over the round trips close to the quickest
+	const double limit = minRtt * 1.5 + 0.002;
+	double meanTime = 0.0, meanOffset = 0.0;
+	size_t used = 0;
+	for (size_t i = 0; i < count; ++i) {
+		if (samples[i].rtt > limit) continue;
+		meanTime += samples[i].time;
+		meanOffset += samples[i].offset;
+		++used;
+	}
+	if (used < 3) return;
+	meanTime /= static_cast<double>(used);
+	meanOffset /= static_cast<double>(used);
+
+	double covariance = 0.0, variance = 0.0;
+	for (size_t i = 0; i < count; ++i) {
+		if (samples[i].rtt > limit) continue;
+		const double dt = samples[i].time - meanTime;
+		covariance += dt * (samples[i].offset - meanOffset);
+		variance += dt * dt;
+	}
+	if (variance < 1.0) return; // Under about two seconds of spread, too short to tell drift from noise
+
+	drift = std::clamp(covariance / variance * tickSeconds, -MAX_DRIFT, MAX_DRIFT);
+}
+
+double ClockSync::EstimateHostTick(double nowSeconds) const {
+	const Sample& from = samples[best];
+	return from.offset + (nowSeconds - from.time) * drift / tickSeconds + nowSeconds / tickSeconds;
+}
+
+double ClockSync::Steer(double nowSeconds, Tick& localTick) {
+	if (!synced) return rate = 1.0;
+
+	const double hostTick = EstimateHostTick(nowSeconds);
+	const double local = static_cast<double>(localTick);
+	offset = hostTick - local;
+
+	const double target = hostTick + lead;
+	const double distance = target - local;
+	if (std::abs(distance) > SNAP_TICKS) {
+		localTick = static_cast<Tick>(static_cast<int64_t>(std::llround(target)));
+		offset = hostTick - static_cast<double>(localTick);
+		error = 0.0;
+		++snaps;
+		return rate = 1.0;
+	}
+
+	error += (distance - error) * 0.1;
+	rate = 1.0 + std::clamp(error * SLEW_PER_TICK, -MAX_SLEW, MAX_SLEW);
+	return rate;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "Messages.hpp"
+
+/**
+ * \brief What the host knows about one client's clock, from the estimates its CLOCK_PINGs carry.
+ */
+struct ClientClock {
+	bool synced = false;
+	double rtt = 0.0;          // Seconds
+	double rttDeviation = 0.0; // Seconds
+	double offsetTicks = 0.0;  // How far the client's tick runs ahead of ours, smoothed
+
+	// hostTick and hostPhase: where our clock was when the ping was handled
+	void OnPing(const ClockPingMsg& ping, Tick hostTick, double hostPhase, double tickSeconds);
+};
+
+/**
+ * \brief Client estimate of the host's tick clock from CLOCK_PING / CLOCK_PONG round trips, and the rate our
+ *        own tick should run at to stay a little ahead of it.
+ *
+ * Each round trip tells us the host's tick when the pong arrived, if the way back took half the RTT. Queueing
+ * only ever adds delay, so of the last WINDOW round trips the one with the smallest RTT is trusted: the offset
+ * comes from it, carried forward by the drift fitted over the round trips that were nearly as quick.
+ *
+ * Our tick aims to run half the RTT plus a margin ahead of the host's, so what we do on a tick reaches the host
+ * before it gets there. It is brought there by running fixed steps up to MAX_SLEW faster or slower, and only
+ * jumps when more than SNAP_TICKS off (the first sync, a host restart).
+ */
+class ClockSync {
+public:
+	static constexpr size_t WINDOW = 16;
+	static constexpr size_t FAST_PINGS = 4;              // Sent FAST_PING_INTERVAL apart after a Reset
+	static constexpr double PING_INTERVAL = 0.5;         // Seconds
+	static constexpr double FAST_PING_INTERVAL = 0.05;   // Seconds
+	static constexpr double MAX_RTT = 5.0;               // Seconds, a pong slower than this is dropped
+	static constexpr double TARGET_MARGIN_TICKS = 2.0;   // Ahead of the host on top of the trip there
+	static constexpr double JITTER_MULTIPLIER = 2.0;     // RTT deviations added to the margin
+	static constexpr double MAX_SLEW = 0.05;             // Fraction our tick rate is changed by at most
+	static constexpr double SLEW_PER_TICK = 0.02;        // Rate change per tick of error
+	static constexpr double SNAP_TICKS = 30.0;
+	static constexpr double MAX_DRIFT = 0.01;            // Host ticks per local tick, either way
+
+	void Reset();
+
+	// CLOCK_PING to send now, if one is due
+	bool NextPing(double nowSeconds, Tick localTick, ClockPingMsg& ping);
+	void OnPong(const ClockPongMsg& pong, double nowSeconds, double tickSeconds);
+
+	// Where the host's tick is at nowSeconds, with the fraction of it
+	double EstimateHostTick(double nowSeconds) const;
+
+	// Once per frame: how fast fixed steps should run (1 = real time) to bring localTick to the target.
+	// Sets localTick outright if it is too far off to slew.
+	double Steer(double nowSeconds, Tick& localTick);
+
+	inline bool IsSynced() const { return synced; }
+	inline double GetRtt() const { return smoothedRtt; }    // Seconds
+	inline double GetMinRtt() const { return minRtt; }      // Seconds, over the window
+	inline double GetRttDeviation() const { return rttDeviation; } // Seconds
+	inline double GetOffset() const { return offset; }      // Host tick minus ours at the same moment, at the last Steer
+	inline double GetDrift() const { return drift; }        // Host ticks per local tick, minus one
+	inline double GetLeadTicks() const { return lead; }     // Target distance ahead of the host
+	inline double GetRate() const { return rate; }
+	inline uint32_t GetSnaps() const { return snaps; }
+
+private:
+	struct Sample {
+		double time = 0.0;   // Local seconds the pong arrived
+		double rtt = 0.0;    // Seconds
+		double offset = 0.0; // Host tick minus local seconds / tickSeconds
+	};
+
+	void Refit();
+
+	std::array<Sample, WINDOW> samples{};
+	size_t count = 0;
+	size_t next = 0;
+	size_t pingsSent = 0;
+	double lastPing = -1.0e9;
+
+	bool synced = false;
+	double tickSeconds = 1.0 / 60.0;
+	size_t best = 0;
+	double drift = 0.0;
+	double minRtt = 0.0;
+	double smoothedRtt = 0.0;
+	double rttDeviation = 0.0;
+	double lead = TARGET_MARGIN_TICKS;
+
+	double offset = 0.0;
+	double error = 0.0; // Smoothed distance of localTick from the target
+	double rate = 1.0;
+	uint32_t snaps = 0;
+};
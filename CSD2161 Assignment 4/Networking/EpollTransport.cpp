@@ -0,0 +1,210 @@
+#include "EpollTransport.hpp"
+
+#ifdef NET_TRANSPORT_EPOLL
+
+#include <iostream>
+#include <cerrno>
+#include <algorithm>
+#include <sys/epoll.h>
+
+EpollTransport::EpollTransport() {
+	// The send queue's iovecs and message headers point into its slot array for the lifetime
+	// of the object, only the lengths change per call.
+	for (size_t i = 0; i < TX_BATCH; ++i) {
+		txIov[i] = { txSlots[i].data, 0 };
+		txMsgs[i] = {};
+		txMsgs[i].msg_hdr.msg_name = &txSlots[i].addr;
+		txMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		txMsgs[i].msg_hdr.msg_iov = &txIov[i];
+		txMsgs[i].msg_hdr.msg_iovlen = 1;
+	}
+}
+
+EpollTransport::~EpollTransport() {
+	Close();
+}
+
+bool EpollTransport::Open(const sockaddr_in* localAddr) {
+	Close();
+
+	sock = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+	if (sock == INVALID_SOCKET) {
+		std::cerr << "socket() failed. Error: " << errno << "\n";
+		return false;
+	}
+
+	if (localAddr) {
+		int reuse = 1;
+		setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		if (bind(sock, reinterpret_cast<const sockaddr*>(localAddr), sizeof(*localAddr)) != 0) {
+			std::cerr << "bind() failed. Error: " << errno << "\n";
+			Close();
+			return false;
+		}
+	}
+
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (epollFd < 0) {
+		std::cerr << "epoll_create1() failed. Error: " << errno << "\n";
+		Close();
+		return false;
+	}
+
+	epoll_event ev{};
+	ev.events = EPOLLIN;
+	ev.data.fd = sock;
+	if (epoll_ctl(epollFd, EPOLL_CTL_ADD, sock, &ev) != 0) {
+		std::cerr << "epoll_ctl() failed. Error: " << errno << "\n";
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void EpollTransport::Close() {
+	if (sock != INVALID_SOCKET) {
+		Flush();
+		closesocket(sock);
+		sock = INVALID_SOCKET;
+	}
+	if (epollFd >= 0) {
+		::close(epollFd);
+		epollFd = -1;
+	}
+	rxHead = rxCount = 0;
+	txCount = 0;
+}
+
+bool EpollTransport::SendTo(const sockaddr_in& to, const char* data, size_t size) {
+	if (sock == INVALID_SOCKET || size > MAX_PACKET_SIZE) return false;
+
+	if (txCount == TX_BATCH) Flush();
+
+	Datagram& slot = txSlots[txCount];
+	slot.addr = to;
+	std::memcpy(slot.data, data, size);
+	txIov[txCount].iov_len = size;
+	++txCount;
+	return true;
+}
+
+void EpollTransport::Flush() {
+	SendBatch(txMsgs.data(), txCount);
+	txCount = 0;
+}
+
+size_t EpollTransport::SendBatch(mmsghdr* msgs, size_t count) {
+	size_t sent = 0;
+	size_t delivered = 0;
+	while (sent < count) {
+		++stats.syscalls;
+		int result = sendmmsg(sock, &msgs[sent], static_cast<unsigned int>(count - sent), 0);
+		if (result > 0) {
+			for (int i = 0; i < result; ++i) {
+				stats.bytesSent += msgs[sent + i].msg_len;
+			}
+			sent += static_cast<size_t>(result);
+			delivered += static_cast<size_t>(result);
+			continue;
+		}
+		if (result < 0 && errno == EINTR) continue;
+
+		// Socket buffer full or a per-datagram error (e.g. ICMP unreachable reported on the
+		// head message). Skip that datagram like a lossy link would and carry on with the rest.
+		++sent;
+	}
+	stats.datagramsSent += delivered;
+	return delivered;
+}
+
+bool EpollTransport::FillReceiveBatch() {
+	rxHead = rxCount = 0;
+	rxCount = ReceiveMany(rxSlots.data(), RX_BATCH);
+	return rxCount > 0;
+}
+
+int EpollTransport::ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) {
+	if (sock == INVALID_SOCKET) return 0;
+	if (rxHead == rxCount && !FillReceiveBatch()) return 0;
+
+	const Datagram& slot = rxSlots[rxHead++];
+	size_t len = std::min(slot.size, capacity);
+
+	from = slot.addr;
+	std::memcpy(buffer, slot.data, len);
+	return static_cast<int>(len);
+}
+
+size_t EpollTransport::ReceiveMany(Datagram* out, size_t maxCount) {
+	if (sock == INVALID_SOCKET || maxCount == 0) return 0;
+
+	// Hand out anything left over from a ReceiveFrom batch first to keep arrival order
+	size_t count = 0;
+	while (rxHead < rxCount && count < maxCount) {
+		out[count++] = rxSlots[rxHead++];
+	}
+	if (count > 0) return count;
+
+	size_t batch = std::min(maxCount, RX_BATCH);
+	for (size_t i = 0; i < batch; ++i) {
+		batchIov[i] = { out[i].data, sizeof(out[i].data) };
+		batchMsgs[i] = {};
+		batchMsgs[i].msg_hdr.msg_name = &out[i].addr;
+		batchMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		batchMsgs[i].msg_hdr.msg_iov = &batchIov[i];
+		batchMsgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	++stats.syscalls;
+	int result = recvmmsg(sock, batchMsgs.data(), static_cast<unsigned int>(batch), MSG_DONTWAIT, nullptr);
+	if (result <= 0) return 0;
+
+	const auto now = std::chrono::steady_clock::now();
+	for (int i = 0; i < result; ++i) {
+		out[i].size = batchMsgs[i].msg_len;
+		out[i].receivedTime = now;
+		stats.bytesReceived += batchMsgs[i].msg_len;
+	}
+	stats.datagramsReceived += static_cast<uint64_t>(result);
+	return static_cast<size_t>(result);
+}
+
+bool EpollTransport::SendToMany(const sockaddr_in* to, size_t count, const char* data, size_t size) {
+	if (sock == INVALID_SOCKET || size > MAX_PACKET_SIZE) return false;
+
+	// Queued unicast sends go out first so per-peer ordering is preserved
+	Flush();
+
+	// Every message shares one iovec over the caller's payload, only the destination differs
+	iovec payload = { const_cast<char*>(data), size };
+	size_t delivered = 0;
+	for (size_t offset = 0; offset < count; offset += RX_BATCH) {
+		size_t batch = std::min(count - offset, RX_BATCH);
+		for (size_t i = 0; i < batch; ++i) {
+			batchMsgs[i] = {};
+			batchMsgs[i].msg_hdr.msg_name = const_cast<sockaddr_in*>(&to[offset + i]);
+			batchMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+			batchMsgs[i].msg_hdr.msg_iov = &payload;
+			batchMsgs[i].msg_hdr.msg_iovlen = 1;
+		}
+		delivered += SendBatch(batchMsgs.data(), batch);
+	}
+	return delivered == count;
+}
+
+bool EpollTransport::WaitForData(int timeoutMs) {
+	if (sock == INVALID_SOCKET) return false;
+
+	Flush();
+	if (rxHead < rxCount) return true;
+
+	epoll_event ev{};
+	int result;
+	do {
+		++stats.syscalls;
+		result = epoll_wait(epollFd, &ev, 1, timeoutMs);
+	} while (result < 0 && errno == EINTR);
+	return result > 0;
+}
+
+#endif
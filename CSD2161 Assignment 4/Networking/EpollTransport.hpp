@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Transport.hpp"
+
+#ifdef NET_TRANSPORT_EPOLL
+
+#include <array>
+#include <sys/socket.h>
+
+/**
+ * \brief Linux backend: a non-blocking UDP socket registered with epoll.
+ *
+ * Receives are drained RX_BATCH datagrams at a time with one recvmmsg() call, either
+ * straight into the caller's buffers (ReceiveMany) or into an internal batch handed out
+ * one by one (ReceiveFrom). Sends are queued and written with one sendmmsg() call per
+ * TX_BATCH datagrams when Flush() is called or the queue fills up. SendToMany fans one
+ * payload out to many addresses with every message pointing at the same buffer.
+ */
+class EpollTransport : public Transport {
+public:
+	static constexpr size_t RX_BATCH = 64;
+	static constexpr size_t TX_BATCH = 64;
+
+	EpollTransport();
+	~EpollTransport() override;
+
+	bool Startup() override { return true; }
+	void Shutdown() override { Close(); }
+
+	bool Open(const sockaddr_in* localAddr) override;
+	void Close() override;
+	bool IsOpen() const override { return sock != INVALID_SOCKET; }
+
+	bool SendTo(const sockaddr_in& to, const char* data, size_t size) override;
+	int ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) override;
+	bool WaitForData(int timeoutMs) override;
+	void Flush() override;
+
+	size_t ReceiveMany(Datagram* out, size_t maxCount) override;
+	bool SendToMany(const sockaddr_in* to, size_t count, const char* data, size_t size) override;
+
+private:
+	bool FillReceiveBatch();
+	size_t SendBatch(mmsghdr* msgs, size_t count);
+
+	SOCKET sock = INVALID_SOCKET;
+	int epollFd = -1;
+
+	// Receive batch for ReceiveFrom, filled by ReceiveMany and consumed from rxHead up to rxCount
+	std::array<Datagram, RX_BATCH> rxSlots;
+	size_t rxHead = 0;
+	size_t rxCount = 0;
+
+	// Send queue, written by sendmmsg
+	std::array<Datagram, TX_BATCH> txSlots;
+	std::array<iovec, TX_BATCH> txIov;
+	std::array<mmsghdr, TX_BATCH> txMsgs;
+	size_t txCount = 0;
+
+	// Scratch headers for the zero-copy batch calls, pointed at caller memory per call
+	std::array<iovec, RX_BATCH> batchIov;
+	std::array<mmsghdr, RX_BATCH> batchMsgs;
+};
+
+#endif
@@ -0,0 +1,21 @@
+#include "EventJitterBuffer.hpp"
+
+#include <algorithm>
+
+void EventJitterBuffer::Reset(Tick currentTick) {
+	for (auto& bucket : buckets) bucket.clear();
+	releasedUpTo = currentTick;
+	count = 0;
+}
+
+bool EventJitterBuffer::Insert(ScheduledEvent&& event) {
+	if (static_cast<int32_t>(event.tick - releasedUpTo) <= 0) return false;
+
+	std::vector<ScheduledEvent>& bucket = buckets[event.tick % WINDOW_TICKS];
+	auto it = std::find_if(bucket.begin(), bucket.end(), [&](const ScheduledEvent& other) {
+		return other.tick == event.tick ? other.eventID > event.eventID : static_cast<int32_t>(other.tick - event.tick) > 0;
+	});
+	bucket.insert(it, std::move(event));
+	++count;
+	return true;
+}
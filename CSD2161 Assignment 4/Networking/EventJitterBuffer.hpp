@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include "PacketBuffer.hpp"
+#include "Messages.hpp"
+
+// An event the host has stamped with the tick every peer runs it on
+struct ScheduledEvent {
+	Tick tick = 0;
+	EventID eventID = 0;
+	NetworkID networkID = 0; // ID the host assigned to the object the event creates
+	PacketHandle eventData;  // EventType + specific data
+};
+
+/**
+ * \brief Holds scheduled events until their tick comes up. One bucket per tick in a ring, so inserting and
+ *        releasing only touch the buckets of the ticks involved. The tick counter may jump either way
+ *        (tick syncs); every tick in between is still released once, in order.
+ */
+class EventJitterBuffer {
+public:
+	static constexpr size_t WINDOW_TICKS = 128; // Further ahead than this still works, it only shares a bucket
+
+	// Starts releasing after currentTick, dropping anything held
+	void Reset(Tick currentTick);
+
+	// Takes event unless its tick has already been released, in which case the caller runs it now (late).
+	// Events of one tick run in EventID order whatever order they arrived in, so every peer agrees.
+	bool Insert(ScheduledEvent&& event);
+
+	// Calls run(event) for every event due up to and including currentTick, oldest tick first
+	template <typename Run>
+	void Release(Tick currentTick, Run&& run) {
+		int32_t behind = static_cast<int32_t>(currentTick - releasedUpTo);
+		if (behind <= 0) {
+			releasedUpTo = currentTick; // Clock went back, the ticks after it are due again
+			return;
+		}
+		if (behind > static_cast<int32_t>(WINDOW_TICKS)) {
+			releasedUpTo = currentTick - WINDOW_TICKS; // Every bucket still gets visited once
+			behind = WINDOW_TICKS;
+		}
+
+		for (int32_t i = 0; i < behind; ++i) {
+			const Tick tick = ++releasedUpTo;
+			std::vector<ScheduledEvent>& bucket = buckets[tick % WINDOW_TICKS];
+			size_t kept = 0;
+			for (size_t e = 0; e < bucket.size(); ++e) {
+				if (static_cast<int32_t>(bucket[e].tick - tick) > 0) {
+					bucket[kept++] = std::move(bucket[e]);
+					continue;
+				}
+				run(bucket[e]);
+				--count;
+			}
+			bucket.resize(kept);
+		}
+	}
+
+	inline size_t Size() const { return count; }
+
+private:
+	std::array<std::vector<ScheduledEvent>, WINDOW_TICKS> buckets;
+	Tick releasedUpTo = 0;
+	size_t count = 0;
+};
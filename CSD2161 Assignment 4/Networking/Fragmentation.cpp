@@ -0,0 +1,61 @@
+#include "Fragmentation.hpp"
+
+#include <cstring>
+
+const std::vector<char>* FragmentAssembler::Add(const FragmentHeaderMsg& header, const char* data, size_t size, Clock::time_point now) {
+	if (header.count == 0 || header.count > MAX_FRAGMENTS || header.index >= header.count) return nullptr;
+
+	// Every part but the last is exactly PAYLOAD_SIZE, so where it goes follows from its index
+	const bool last = header.index + 1 == header.count;
+	if (size == 0 || size > PAYLOAD_SIZE || (!last && size != PAYLOAD_SIZE)) return nullptr;
+
+	Assembly* assembly = nullptr;
+	for (auto& slot : slots) {
+		if (slot.active && slot.messageID == header.messageID) assembly = &slot;
+	}
+	if (!assembly) assembly = &Claim(header.messageID, header.count, now);
+	if (assembly->count != header.count || assembly->parts.test(header.index)) return nullptr;
+
+	std::memcpy(assembly->data.data() + header.index * PAYLOAD_SIZE, data, size);
+	assembly->parts.set(header.index);
+	if (last) assembly->size = header.index * PAYLOAD_SIZE + size;
+	if (++assembly->received < assembly->count) return nullptr;
+
+	assembly->active = false;
+	assembly->data.resize(assembly->size);
+	return &assembly->data;
+}
+
+FragmentAssembler::Assembly& FragmentAssembler::Claim(uint16_t messageID, uint16_t count, Clock::time_point now) {
+	Assembly* claimed = &slots[0];
+	for (auto& slot : slots) {
+		if (!slot.active) {
+			claimed = &slot;
+			break;
+		}
+		if (slot.started < claimed->started) claimed = &slot;
+	}
+	if (claimed->active) ++expired;
+
+	claimed->active = true;
+	claimed->messageID = messageID;
+	claimed->count = count;
+	claimed->received = 0;
+	claimed->size = 0;
+	claimed->started = now;
+	claimed->parts.reset();
+	claimed->data.resize(count * PAYLOAD_SIZE); // Keeps its capacity from earlier messages
+	return *claimed;
+}
+
+void FragmentAssembler::Expire(Clock::time_point now) {
+	for (auto& slot : slots) {
+		if (!slot.active || std::chrono::duration<double>(now - slot.started).count() < TIMEOUT) continue;
+		slot.active = false;
+		++expired;
+	}
+}
+
+void FragmentAssembler::Reset() {
+	for (auto& slot : slots) slot.active = false;
+}
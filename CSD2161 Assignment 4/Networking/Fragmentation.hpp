@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Messages.hpp"
+
+/**
+ * \brief Client side of messages too long for one packet. The host splits such a message every PAYLOAD_SIZE
+ *        bytes and sends the parts as FRAGMENT messages on the client's reliable stream, so each part is acked
+ *        and resent on its own and a lost one costs one packet, not the whole message.
+ *
+ * Parts are copied straight to their offset in one of SLOTS buffers, which keep their capacity from message to
+ * message. A message still missing parts after TIMEOUT seconds is dropped, as is the oldest one when a new
+ * message finds every slot taken.
+ */
+class FragmentAssembler {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr size_t PAYLOAD_SIZE = 1400;  // Bytes per part, all but the last
+	static constexpr size_t MAX_FRAGMENTS = 128;  // Well inside ReliableSender::WINDOW; sent RELIABLE_RECEIVE_WINDOW at a time
+	static constexpr size_t MAX_MESSAGE_SIZE = PAYLOAD_SIZE * MAX_FRAGMENTS;
+	static constexpr size_t SLOTS = 4;            // Messages being put together at once
+	static constexpr double TIMEOUT = 10.0;
+
+	// Takes one part. Returns the whole message once its last part is in, valid until the next Add; else nullptr.
+	const std::vector<char>* Add(const FragmentHeaderMsg& header, const char* data, size_t size, Clock::time_point now);
+
+	void Expire(Clock::time_point now);
+	void Reset();
+
+	inline uint64_t GetExpired() const { return expired; }
+
+private:
+	struct Assembly {
+		bool active = false;
+		uint16_t messageID = 0;
+		uint16_t count = 0;
+		uint16_t received = 0;
+		size_t size = 0; // Known once the last part is in
+		Clock::time_point started{};
+		std::bitset<MAX_FRAGMENTS> parts;
+		std::vector<char> data;
+	};
+
+	Assembly& Claim(uint16_t messageID, uint16_t count, Clock::time_point now);
+
+	std::array<Assembly, SLOTS> slots;
+	uint64_t expired = 0; // Messages dropped unfinished
+};
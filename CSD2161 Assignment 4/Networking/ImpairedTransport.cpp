@@ -0,0 +1,273 @@
+#include "ImpairedTransport.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+bool LinkImpairment::IsEnabled() const {
+	return latencyMs > 0.0 || jitterMs > 0.0 || lossPercent > 0.0 || duplicatePercent > 0.0
+		|| reorderPercent > 0.0 || rateKBps > 0.0;
+}
+
+bool LinkImpairment::Parse(const char* spec) {
+	std::string rest(spec);
+	while (!rest.empty()) {
+		const size_t comma = rest.find(',');
+		const std::string item = rest.substr(0, comma);
+		rest = comma == std::string::npos ? "" : rest.substr(comma + 1);
+		if (item.empty()) continue;
+
+		const size_t equals = item.find('=');
+		if (equals == std::string::npos) return false;
+		const std::string key = item.substr(0, equals);
+		const double value = std::max(0.0, std::atof(item.c_str() + equals + 1));
+
+		if (key == "latency") latencyMs = value;
+		else if (key == "jitter") jitterMs = value;
+		else if (key == "loss") lossPercent = std::min(value, 100.0);
+		else if (key == "burst") burstLength = value;
+		else if (key == "duplicate") duplicatePercent = std::min(value, 100.0);
+		else if (key == "reorder") reorderPercent = std::min(value, 100.0);
+		else if (key == "reorder-delay") reorderDelayMs = value;
+		else if (key == "rate") rateKBps = value;
+		else if (key == "queue") queueMs = value;
+		else return false;
+	}
+	return true;
+}
+
+std::string LinkImpairment::ToString() const {
+	std::ostringstream out;
+	const char* separator = "";
+	auto put = [&](const char* key, double value) {
+		out << separator << key << "=" << value;
+		separator = ",";
+	};
+	if (latencyMs > 0.0) put("latency", latencyMs);
+	if (jitterMs > 0.0) put("jitter", jitterMs);
+	if (lossPercent > 0.0) put("loss", lossPercent);
+	if (lossPercent > 0.0 && burstLength > 0.0) put("burst", burstLength);
+	if (duplicatePercent > 0.0) put("duplicate", duplicatePercent);
+	if (reorderPercent > 0.0) {
+		put("reorder", reorderPercent);
+		put("reorder-delay", reorderDelayMs);
+	}
+	if (rateKBps > 0.0) {
+		put("rate", rateKBps);
+		put("queue", queueMs);
+	}
+	return IsEnabled() ? out.str() : "none";
+}
+
+ImpairedTransport::Link::Link(const LinkImpairment& settings, uint32_t seed) : settings(settings), random(seed) {}
+
+bool ImpairedTransport::Link::Later(const Held& a, const Held& b) {
+	return a.due != b.due ? a.due > b.due : a.order > b.order;
+}
+
+ImpairedTransport::Clock::duration ImpairedTransport::Link::Millis(double ms) const {
+	return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms));
+}
+
+bool ImpairedTransport::Link::Lose() {
+	const double loss = settings.lossPercent / 100.0;
+	if (loss <= 0.0) return false;
+	if (settings.burstLength <= 0.0) return percent(random) < settings.lossPercent;
+
+	// Two states: bad loses everything and lasts burstLength datagrams on average; good is entered often enough
+	// that the share of time spent in bad is the loss rate
+	const double leaveBad = 1.0 / std::max(settings.burstLength, 1.0);
+	const double enterBad = loss >= 1.0 ? 1.0 : std::min(1.0, loss * leaveBad / (1.0 - loss));
+	const double roll = percent(random) / 100.0;
+	inBurst = inBurst ? roll >= leaveBad : roll < enterBad;
+	return inBurst;
+}
+
+void ImpairedTransport::Link::Submit(const sockaddr_in& addr, const char* data, size_t size, Clock::time_point now) {
+	if (Lose()) {
+		++stats.lost;
+		return;
+	}
+
+	const int copies = settings.duplicatePercent > 0.0 && percent(random) < settings.duplicatePercent ? 2 : 1;
+	if (copies > 1) ++stats.duplicated;
+
+	for (int copy = 0; copy < copies; ++copy) {
+		if (held.size() >= MAX_HELD) {
+			++stats.queueDrops;
+			return;
+		}
+
+		// Queued behind what is already on the link, at its rate
+		Clock::time_point departs = now;
+		if (settings.rateKBps > 0.0) {
+			const Clock::time_point start = std::max(now, linkFree);
+			if (start - now > Millis(settings.queueMs)) {
+				++stats.queueDrops;
+				continue;
+			}
+			linkFree = start + Millis(static_cast<double>(size) * 1000.0 / (settings.rateKBps * 1024.0));
+			departs = linkFree;
+		}
+
+		double delayMs = settings.latencyMs;
+		if (settings.jitterMs > 0.0) {
+			delayMs += std::uniform_real_distribution<double>(-settings.jitterMs, settings.jitterMs)(random);
+		}
+		Clock::time_point due = departs + Millis(std::max(delayMs, 0.0));
+
+		if (settings.reorderPercent > 0.0 && percent(random) < settings.reorderPercent) {
+			due += Millis(settings.reorderDelayMs); // Whatever is sent next may arrive first
+			++stats.reordered;
+		}
+		else {
+			due = std::max(due, lastInOrder);
+			lastInOrder = due;
+		}
+
+		uint32_t slot;
+		if (!freeSlots.empty()) {
+			slot = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else {
+			slot = static_cast<uint32_t>(slots.size());
+			slots.emplace_back();
+		}
+		Datagram& datagram = slots[slot];
+		datagram.addr = addr;
+		datagram.size = size;
+		datagram.receivedTime = due; // When it arrives, as far as the other end can tell
+		std::memcpy(datagram.data, data, size);
+
+		held.push_back(Held{ due, nextOrder++, slot });
+		std::push_heap(held.begin(), held.end(), Later);
+	}
+}
+
+const Datagram* ImpairedTransport::Link::Due(Clock::time_point now) const {
+	if (held.empty() || held.front().due > now) return nullptr;
+	return &slots[held.front().slot];
+}
+
+void ImpairedTransport::Link::Pop() {
+	std::pop_heap(held.begin(), held.end(), Later);
+	freeSlots.push_back(held.back().slot);
+	held.pop_back();
+	++stats.passed;
+}
+
+bool ImpairedTransport::Link::NextDue(Clock::time_point& when) const {
+	if (held.empty()) return false;
+	when = held.front().due;
+	return true;
+}
+
+void ImpairedTransport::Link::Clear() {
+	for (const Held& entry : held) freeSlots.push_back(entry.slot);
+	held.clear();
+	inBurst = false;
+	linkFree = lastInOrder = Clock::time_point{};
+}
+
+ImpairedTransport::ImpairedTransport(std::unique_ptr<Transport> inner, const ImpairmentSettings& settings)
+	: inner(std::move(inner)), sending(settings.send, settings.seed), receiving(settings.receive, settings.seed ^ 0x9E3779B9u) {}
+
+bool ImpairedTransport::Open(const sockaddr_in* localAddr) {
+	sending.Clear();
+	receiving.Clear();
+	return inner->Open(localAddr);
+}
+
+void ImpairedTransport::Close() {
+	inner->Close();
+	sending.Clear();
+	receiving.Clear();
+}
+
+bool ImpairedTransport::SendTo(const sockaddr_in& to, const char* data, size_t size) {
+	if (size > MAX_PACKET_SIZE) return false;
+	sending.Submit(to, data, size, Clock::now());
+	return true;
+}
+
+int ImpairedTransport::ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) {
+	Release();
+	const Datagram* datagram = receiving.Due(Clock::now());
+	if (!datagram) return 0;
+
+	const size_t size = std::min(datagram->size, capacity);
+	std::memcpy(buffer, datagram->data, size);
+	from = datagram->addr;
+	receiving.Pop();
+	return static_cast<int>(size);
+}
+
+bool ImpairedTransport::WaitForData(int timeoutMs) {
+	const auto until = Clock::now() + std::chrono::milliseconds(timeoutMs);
+	for (;;) {
+		Release();
+		inner->Flush();
+		const auto now = Clock::now();
+		if (receiving.Due(now)) return true;
+		if (now >= until) return false;
+
+		// Wake for whichever comes first: the timeout, or something held falling due either way
+		Clock::time_point wake = until, next;
+		if (receiving.NextDue(next)) wake = std::min(wake, next);
+		if (sending.NextDue(next)) wake = std::min(wake, next);
+		const auto waitMs = std::chrono::ceil<std::chrono::milliseconds>(wake - now).count();
+		inner->WaitForData(static_cast<int>(std::max<long long>(waitMs, 0)));
+	}
+}
+
+void ImpairedTransport::Flush() {
+	Release();
+	inner->Flush();
+	CollectStats();
+}
+
+size_t ImpairedTransport::ReceiveMany(Datagram* out, size_t maxCount) {
+	Release();
+	const auto now = Clock::now();
+	size_t count = 0;
+	while (count < maxCount) {
+		const Datagram* datagram = receiving.Due(now);
+		if (!datagram) break;
+		out[count].addr = datagram->addr;
+		out[count].size = datagram->size;
+		out[count].receivedTime = datagram->receivedTime;
+		std::memcpy(out[count].data, datagram->data, datagram->size);
+		receiving.Pop();
+		++count;
+	}
+	CollectStats();
+	return count;
+}
+
+void ImpairedTransport::Release() {
+	const auto now = Clock::now();
+	while (const Datagram* datagram = sending.Due(now)) {
+		inner->SendTo(datagram->addr, datagram->data, datagram->size);
+		sending.Pop();
+	}
+
+	size_t received;
+	while ((received = inner->ReceiveMany(batch.data(), batch.size())) > 0) {
+		for (size_t i = 0; i < received; ++i) {
+			receiving.Submit(batch[i].addr, batch[i].data, batch[i].size, batch[i].receivedTime);
+		}
+	}
+}
+
+void ImpairedTransport::CollectStats() {
+	const TransportStats& io = inner->GetStats();
+	stats.syscalls += io.syscalls;
+	stats.datagramsSent += io.datagramsSent;
+	stats.datagramsReceived += io.datagramsReceived;
+	stats.bytesSent += io.bytesSent;
+	stats.bytesReceived += io.bytesReceived;
+	inner->ResetStats();
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Transport.hpp"
+
+/**
+ * \brief What a simulated link does to the datagrams going one way over it.
+ */
+struct LinkImpairment {
+	double latencyMs = 0.0;			// One way
+	double jitterMs = 0.0;			// Each datagram is delayed latency +- up to this, but stays in order
+	double lossPercent = 0.0;		// Average share of datagrams lost
+	double burstLength = 0.0;		// Average run of losses; above 0 losses come in bursts (Gilbert-Elliott), else independently
+	double duplicatePercent = 0.0;	// Datagrams sent twice, each copy delayed on its own
+	double reorderPercent = 0.0;	// Datagrams held back reorderDelayMs more than those after them
+	double reorderDelayMs = 20.0;
+	double rateKBps = 0.0;			// Link capacity in kB/s (0 = unlimited); datagrams queue behind each other
+	double queueMs = 200.0;			// With a rate: datagrams that would wait longer than this for the link are dropped
+
+	bool IsEnabled() const;
+
+	// Reads "latency=50,jitter=10,loss=2,burst=3,duplicate=1,reorder=1,reorder-delay=20,rate=256,queue=200",
+	// any of them in any order. False, leaving the rest as they were, at the first it does not know.
+	bool Parse(const char* spec);
+	std::string ToString() const; // In the same form, only what is set; "none" if nothing is
+};
+
+/**
+ * \brief Both directions of a simulated link, and the seed that makes what it does repeatable.
+ */
+struct ImpairmentSettings {
+	LinkImpairment send;	// Datagrams we send
+	LinkImpairment receive;	// Datagrams sent to us
+	uint32_t seed = 1;
+
+	inline bool IsEnabled() const { return send.IsEnabled() || receive.IsEnabled(); }
+};
+
+/**
+ * \brief What a link did, since the stats were last reset.
+ */
+struct ImpairmentStats {
+	uint64_t passed = 0;		// Handed on, copies included
+	uint64_t lost = 0;
+	uint64_t queueDrops = 0;	// Over the rate's queue, or over MAX_HELD
+	uint64_t duplicated = 0;
+	uint64_t reordered = 0;
+};
+
+/**
+ * \brief Wraps another transport in a simulated network, for testing the protocol under latency, jitter, loss,
+ *        duplication, reordering and a bandwidth cap on one machine. Each direction has its own LinkImpairment.
+ *
+ * Datagrams are held until they are due and handed on by whichever call comes next (ReceiveMany, Flush,
+ * WaitForData...), so on a socket only read once a frame they are due to the frame; under a ThreadedTransport
+ * the I/O thread polls every millisecond. Each direction draws from its own generator seeded from the settings'
+ * seed, so the same datagrams in the same order are lost, duplicated and reordered the same way every run.
+ */
+class ImpairedTransport : public Transport {
+public:
+	static constexpr size_t MAX_HELD = 4096; // Datagrams held each way
+
+	ImpairedTransport(std::unique_ptr<Transport> inner, const ImpairmentSettings& settings);
+
+	bool Startup() override { return inner->Startup(); }
+	void Shutdown() override { inner->Shutdown(); }
+
+	bool Open(const sockaddr_in* localAddr) override;
+	void Close() override; // Drops whatever is still held
+	bool IsOpen() const override { return inner->IsOpen(); }
+
+	bool SendTo(const sockaddr_in& to, const char* data, size_t size) override;
+	int ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) override;
+	bool WaitForData(int timeoutMs) override;
+	void Flush() override;
+	size_t ReceiveMany(Datagram* out, size_t maxCount) override;
+
+	inline const ImpairmentStats& GetSendStats() const { return sending.stats; }
+	inline const ImpairmentStats& GetReceiveStats() const { return receiving.stats; }
+	inline void ResetImpairmentStats() { sending.stats = receiving.stats = ImpairmentStats{}; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	// One direction: its settings, its own random state, and the datagrams it holds until they are due
+	class Link {
+	public:
+		Link(const LinkImpairment& settings, uint32_t seed);
+
+		// Decides the datagram's fate and holds every copy that survives
+		void Submit(const sockaddr_in& addr, const char* data, size_t size, Clock::time_point now);
+		// The earliest held datagram if it is due by now, else nullptr; Pop() releases it
+		const Datagram* Due(Clock::time_point now) const;
+		void Pop();
+		bool NextDue(Clock::time_point& when) const;
+		void Clear();
+
+		ImpairmentStats stats;
+
+	private:
+		struct Held {
+			Clock::time_point due;
+			uint64_t order;	// Ties go first come, first served
+			uint32_t slot;
+		};
+		static bool Later(const Held& a, const Held& b);
+
+		bool Lose();
+		Clock::duration Millis(double ms) const;
+
+		LinkImpairment settings;
+		std::mt19937 random;
+		std::uniform_real_distribution<double> percent{ 0.0, 100.0 };
+		bool inBurst = false;				// Gilbert-Elliott: the bad state, which loses everything
+		Clock::time_point linkFree{};		// Rate: when the last datagram queued has gone out
+		Clock::time_point lastInOrder{};	// Jitter does not let a datagram overtake this one
+		uint64_t nextOrder = 0;
+
+		std::vector<Held> held;				// Min-heap on due
+		std::vector<Datagram> slots;		// Their payloads
+		std::vector<uint32_t> freeSlots;
+	};
+
+	void Release(); // Sends what is due, takes in what arrived
+	void CollectStats();
+
+	std::unique_ptr<Transport> inner;
+	Link sending;
+	Link receiving;
+	std::array<Datagram, 64> batch; // Read off the inner transport
+};
@@ -0,0 +1,128 @@
+#include "InterestManager.hpp"
+
+#include <algorithm>
+#include "../EntityStore.hpp"
+
+void InterestManager::Capture(const EntityStore& entities, Tick tick) {
+	// Everything but bullets, which are short lived and recreated by their FireBullet events
+	world.clear();
+	auto capture = [&](EntityType type, const auto& pool) {
+		for (uint32_t i = 0; i < pool.Size(); ++i) {
+			ObjectStateMsg state;
+			entities.Serialize(type, i, tick, state);
+			world.push_back(WorldEntry{ StateEncoding::Quantize(state), glm::vec2(pool.position[i]) });
+		}
+	};
+	capture(ENTITY_PLAYER, entities.players);
+	capture(ENTITY_ASTEROID, entities.asteroids);
+	std::sort(world.begin(), world.end(),
+		[](const WorldEntry& a, const WorldEntry& b) { return a.state.networkID < b.state.networkID; });
+
+	grid.Clear();
+	for (uint32_t i = 0; i < world.size(); ++i) {
+		grid.Insert(i, world[i].position);
+	}
+	grid.Build();
+}
+
+void InterestManager::Select(Client& client, const Snapshot* baseline, Snapshot& snapshot, size_t budgetBits) {
+	snapshot.states.clear();
+
+	inRange.clear();
+	glm::vec2 viewpoint;
+	if (GetViewpoint(client, viewpoint)) {
+		grid.Query(viewpoint, settings.cullRadius, [&](uint32_t index, float distance) {
+			if (world[index].state.networkID != client.playerID) inRange.emplace_back(index, distance);
+		});
+	}
+	else {
+		for (uint32_t i = 0; i < world.size(); ++i) {
+			if (world[i].state.networkID != client.playerID) inRange.emplace_back(i, 0.f);
+		}
+	}
+
+	// Too many to fit: keep the nearest
+	if (inRange.size() > SnapshotEncoding::MAX_OBJECTS) {
+		std::nth_element(inRange.begin(), inRange.begin() + SnapshotEncoding::MAX_OBJECTS, inRange.end(),
+			[](const auto& a, const auto& b) { return a.second < b.second; });
+		inRange.resize(SnapshotEncoding::MAX_OBJECTS);
+	}
+	std::sort(inRange.begin(), inRange.end()); // World order is networkID order
+
+	// Every object gains priority; new ones and those that have built up a full refresh are due
+	PriorityAccumulator& priorities = client.priorities;
+	priorities.Begin();
+	candidates.clear();
+	size_t present = 0;
+	for (uint32_t i = 0; i < inRange.size(); ++i) {
+		const auto& [index, distance] = inRange[i];
+		const StateEncoding::QuantizedState& state = world[index].state;
+
+		const float relevance = distance > settings.radius ? settings.radius / distance : 1.f;
+		PriorityAccumulator::Entry& entry = priorities.Add(state.networkID, WeightOf(state.objectType) * relevance);
+
+		const bool known = baseline && baseline->Find(state.networkID);
+		if (known) ++present;
+		if (!known || entry.priority >= 1.f) candidates.push_back(i);
+	}
+
+	const size_t removed = baseline ? baseline->states.size() - std::min(baseline->states.size(), present) : 0;
+	const size_t reserved = SnapshotEncoding::OverheadBits(removed);
+	size_t remaining = budgetBits > reserved ? budgetBits - reserved : 0;
+
+	std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) {
+		return priorities.At(a).priority > priorities.At(b).priority;
+	});
+
+	selected.assign(inRange.size(), false);
+	for (uint32_t i : candidates) {
+		const StateEncoding::QuantizedState& state = world[inRange[i].first].state;
+		const size_t bits = SnapshotEncoding::EntryBits(baseline ? baseline->Find(state.networkID) : nullptr, state);
+		if (bits > remaining) {
+			++client.sendStats.objectsDeferred;
+			continue;
+		}
+		remaining -= bits;
+		selected[i] = true;
+		priorities.At(i).priority = 0.f;
+		priorities.At(i).staleRounds = 0;
+	}
+
+	for (uint32_t i = 0; i < inRange.size(); ++i) {
+		const StateEncoding::QuantizedState& state = world[inRange[i].first].state;
+		client.sendStats.maxStaleRounds = std::max(client.sendStats.maxStaleRounds, priorities.At(i).staleRounds);
+		if (selected[i]) {
+			snapshot.states.push_back(state);
+			continue;
+		}
+		// Not sent: an object the client has keeps what it has, a new one waits until it fits
+		const StateEncoding::QuantizedState* previous = baseline ? baseline->Find(state.networkID) : nullptr;
+		if (previous) snapshot.states.push_back(*previous);
+	}
+	priorities.End();
+}
+
+bool InterestManager::IsRelevant(const Client& client, const glm::vec2& position) const {
+	glm::vec2 viewpoint;
+	if (!GetViewpoint(client, viewpoint)) return true;
+	return glm::length(position - viewpoint) <= settings.cullRadius;
+}
+
+bool InterestManager::GetViewpoint(const Client& client, glm::vec2& viewpoint) const {
+	if (client.playerID == 0) return false;
+
+	auto it = std::lower_bound(world.begin(), world.end(), client.playerID,
+		[](const WorldEntry& entry, NetworkID id) { return entry.state.networkID < id; });
+	if (it == world.end() || it->state.networkID != client.playerID) return false;
+
+	viewpoint = it->position;
+	return true;
+}
+
+float InterestManager::WeightOf(uint8_t objectType) const {
+	switch (objectType) {
+	case ENTITY_PLAYER: return settings.playerWeight;
+	case ENTITY_ASTEROID: return settings.asteroidWeight;
+	default: return 1.f;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <glm/vec2.hpp>
+#include "../Core/SpatialGrid.hpp"
+#include "ClientManager.hpp"
+
+class EntityStore;
+
+struct InterestSettings {
+	float radius = 30.f;        // Objects this close to a client's player go out in every snapshot
+	float cullRadius = 100.f;   // Objects and events farther away are not sent to that client at all
+
+	// Priority by type, greater than 0. Every snapshot an object gains weight x relevance, relevance being 1
+	// within radius and radius / distance past it, and it is sent once that adds up to 1 and the budget allows.
+	float playerWeight = 2.f;
+	float asteroidWeight = 1.f;
+};
+
+/**
+ * \brief Host side area-of-interest filtering, centred on each client's own player.
+ *
+ * The replicated objects are captured into a SpatialGrid once per snapshot round, then every client only
+ * looks at the cells around its player. Clients without a player yet (before the match starts) get everything.
+ *
+ * What goes into a client's snapshot is scheduled by its PriorityAccumulator: objects that are due are sent
+ * highest priority first until the packet's bit budget runs out, and the rest wait, gaining priority, for the
+ * next snapshot.
+ */
+class InterestManager {
+public:
+	InterestSettings settings;
+
+	// Collects players and asteroids, sorted by networkID, and indexes them by position
+	void Capture(const EntityStore& entities, Tick tick);
+
+	// Fills snapshot with what client should see this time, its delta against baseline taking at most budgetBits
+	// for the objects. Objects in range but not sent keep their state from baseline, so the delta leaves them out.
+	void Select(Client& client, const Snapshot* baseline, Snapshot& snapshot, size_t budgetBits);
+
+	// Whether an event happening at position should be sent to client
+	bool IsRelevant(const Client& client, const glm::vec2& position) const;
+
+private:
+	struct WorldEntry {
+		StateEncoding::QuantizedState state;
+		glm::vec2 position;
+	};
+
+	bool GetViewpoint(const Client& client, glm::vec2& viewpoint) const;
+	float WeightOf(uint8_t objectType) const;
+
+	std::vector<WorldEntry> world;
+	SpatialGrid grid{ 16.f };
+	std::vector<std::pair<uint32_t, float>> inRange; // World index and distance, reused by Select
+	std::vector<uint32_t> candidates; // Positions in inRange that are due, by priority
+	std::vector<bool> selected;       // By position in inRange
+};
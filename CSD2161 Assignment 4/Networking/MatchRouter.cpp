@@ -0,0 +1,192 @@
+#include "MatchRouter.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include "NetworkEngine.hpp"
+
+bool MatchRouter::Port::SendTo(const sockaddr_in& to, const char* data, size_t size) {
+	if (size > MAX_PACKET_SIZE) return false;
+
+	Datagram* slot = outbound->BeginPush();
+	if (!slot) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	slot->addr = to;
+	slot->size = size;
+	std::memcpy(slot->data, data, size);
+	outbound->EndPush();
+
+	++stats.datagramsSent;
+	stats.bytesSent += size;
+	return true;
+}
+
+int MatchRouter::Port::ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) {
+	Datagram* datagram = inbound->Front();
+	if (!datagram) return 0;
+
+	const size_t size = std::min(datagram->size, capacity);
+	std::memcpy(buffer, datagram->data, size);
+	from = datagram->addr;
+	inbound->Pop();
+	return static_cast<int>(size);
+}
+
+bool MatchRouter::Port::WaitForData(int timeoutMs) {
+	const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (!inbound->Front()) {
+		if (std::chrono::steady_clock::now() >= until) return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+	}
+	return true;
+}
+
+size_t MatchRouter::Port::ReceiveMany(Datagram* out, size_t maxCount) {
+	size_t count = 0;
+	while (count < maxCount) {
+		Datagram* datagram = inbound->Front();
+		if (!datagram) break;
+		out[count].addr = datagram->addr;
+		out[count].size = datagram->size;
+		out[count].receivedTime = datagram->receivedTime;
+		std::memcpy(out[count].data, datagram->data, datagram->size);
+		inbound->Pop();
+
+		++stats.datagramsReceived;
+		stats.bytesReceived += out[count].size;
+		++count;
+	}
+	return count;
+}
+
+void MatchRouter::Port::ReleasePeer(const sockaddr_in& addr) {
+	sockaddr_in* slot = released->BeginPush();
+	if (!slot) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	*slot = addr;
+	released->EndPush();
+}
+
+MatchRouter::MatchRouter(size_t matchCount, size_t playersPerMatch)
+	: ports(std::min(matchCount, MAX_MATCHES), nullptr), playersPerMatch(playersPerMatch), placed(ports.size(), 0) {}
+
+MatchRouter::~MatchRouter() {
+	Close();
+}
+
+std::unique_ptr<MatchRouter::Port> MatchRouter::CreatePort(size_t index) {
+	auto port = std::make_unique<Port>();
+	ports[index] = port.get();
+	return port;
+}
+
+bool MatchRouter::Open(const std::string& port, const ImpairmentSettings& impairment) {
+	if (std::find(ports.begin(), ports.end(), nullptr) != ports.end()) return false;
+	if (impairment.IsEnabled()) {
+		socket.SetTransport(std::make_unique<ImpairedTransport>(Transport::Create(), impairment));
+	}
+	if (!socket.Initialize() || !socket.Host(port)) return false;
+
+	running.store(true);
+	thread = std::thread(&MatchRouter::Run, this);
+	return true;
+}
+
+void MatchRouter::Close() {
+	running.store(false);
+	if (thread.joinable()) {
+		thread.join();
+		socket.Cleanup();
+		socket.Shutdown();
+	}
+}
+
+void MatchRouter::Run() {
+	Transport& transport = socket.GetTransport();
+	while (running.load(std::memory_order_relaxed)) {
+		// What the matches queued goes out first, and the places they gave back are free before anyone asks
+		for (size_t i = 0; i < ports.size(); ++i) {
+			while (Datagram* datagram = ports[i]->outbound->Front()) {
+				transport.SendTo(datagram->addr, datagram->data, datagram->size);
+				ports[i]->outbound->Pop();
+			}
+			while (sockaddr_in* addr = ports[i]->released->Front()) {
+				Release(*addr, i);
+				ports[i]->released->Pop();
+			}
+		}
+
+		size_t received;
+		while ((received = socket.ReceiveBatch()) > 0) {
+			for (size_t i = 0; i < received; ++i) {
+				Route(socket.GetReceived(i));
+			}
+		}
+
+		socket.Flush();
+		transport.WaitForData(POLL_MS);
+	}
+}
+
+void MatchRouter::Route(const Datagram& datagram) {
+	if (datagram.size == 0) return;
+
+	size_t match = ports.size();
+	if (static_cast<NetworkEngine::CMDID>(datagram.data[0]) == NetworkEngine::REQ_CONNECTION) {
+		match = Place(datagram.addr);
+	}
+	else if (datagram.size >= 1 + NetworkEngine::HOST_TRAILER_SIZE) {
+		// [ConnectionMsg][ReliableAckMsg] ends everything after the handshake
+		PacketReader trailer(datagram.data + datagram.size - NetworkEngine::HOST_TRAILER_SIZE, NetworkEngine::HOST_TRAILER_SIZE);
+		ConnectionMsg connection;
+		Schema::Decode(trailer, connection);
+		const uint8_t tag = ClientManager::GetConnectionTag(connection.connectionID);
+		if (tag != 0) match = tag - 1;
+	}
+	if (match >= ports.size()) {
+		unroutable.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Port& port = *ports[match];
+	Datagram* slot = port.inbound->BeginPush();
+	if (!slot) {
+		port.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	slot->addr = datagram.addr;
+	slot->size = datagram.size;
+	slot->receivedTime = datagram.receivedTime;
+	std::memcpy(slot->data, datagram.data, datagram.size);
+	port.inbound->EndPush();
+}
+
+size_t MatchRouter::Place(const sockaddr_in& addr) {
+	// A repeated request, or a player coming back, goes where it went before
+	const uint32_t known = placedAt.Find(addr);
+	if (known != AddressIndex::NOT_FOUND) return known - 1;
+
+	size_t match = 0;
+	for (size_t i = 0; i < ports.size(); ++i) {
+		const bool hasRoom = playersPerMatch == 0 || placed[i] < playersPerMatch;
+		if (hasRoom && ports[i]->acceptingJoins.load(std::memory_order_relaxed)) {
+			match = i;
+			break;
+		}
+		if (placed[i] < placed[match]) match = i;
+	}
+
+	placedAt.Insert(addr, static_cast<uint32_t>(match + 1));
+	++placed[match];
+	return match;
+}
+
+void MatchRouter::Release(const sockaddr_in& addr, size_t match) {
+	// A request it has sent again since may have been placed elsewhere already
+	if (placedAt.Find(addr) != match + 1) return;
+	placedAt.Erase(addr);
+	--placed[match];
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SocketManager.hpp"
+#include "SpscQueue.hpp"
+#include "AddressIndex.hpp"
+#include "ImpairedTransport.hpp"
+
+/**
+ * \brief One UDP port for every match a server process runs. An I/O thread owns the socket and hands each
+ *        datagram to its match through that match's Port, a Transport whose two queues stand in for a socket.
+ *
+ * After the handshake a packet is routed by the tag in the connection ID its trailer ends with
+ * (ClientManager::SetConnectionTag). A REQ_CONNECTION goes to the match its address was sent to before; a new
+ * address goes to the first match still open to joins with room for it, else to the one given the fewest. The
+ * place is held until the match drops that client or turns it away.
+ */
+class MatchRouter {
+public:
+	static constexpr size_t MAX_MATCHES = 255; // Connection tags are 1-255
+	static constexpr size_t QUEUE_SIZE = 256;  // Datagrams each way, per match
+	static constexpr int POLL_MS = 1;          // Longest a queued send waits for the router's thread
+
+	/**
+	 * \brief What one match's SocketManager sees. Sends are queued for the router's thread and receives come off
+	 *        what it routed here; opening and closing it leave the shared socket alone.
+	 */
+	class Port : public Transport {
+	public:
+		bool Startup() override { return true; }
+		void Shutdown() override {}
+		bool Open(const sockaddr_in*) override { return true; }
+		void Close() override {}
+		bool IsOpen() const override { return true; }
+
+		// Queued for the router's thread; false if the queue is full
+		bool SendTo(const sockaddr_in& to, const char* data, size_t size) override;
+		int ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) override;
+		bool WaitForData(int timeoutMs) override;
+		size_t ReceiveMany(Datagram* out, size_t maxCount) override;
+		// Queued for the router's thread, which gives the address's place in this match back
+		void ReleasePeer(const sockaddr_in& addr) override;
+
+		// Whether new players may still be sent here; a match closes once it starts
+		inline void SetOpen(bool open) { acceptingJoins.store(open, std::memory_order_relaxed); }
+
+		// Datagrams lost because a queue was full, either way
+		inline uint64_t GetDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+	private:
+		friend class MatchRouter;
+
+		using Queue = SpscQueue<Datagram, QUEUE_SIZE>;
+		std::unique_ptr<Queue> inbound = std::make_unique<Queue>();  // Router's thread -> match
+		std::unique_ptr<Queue> outbound = std::make_unique<Queue>(); // Match -> router's thread
+		std::unique_ptr<SpscQueue<sockaddr_in, QUEUE_SIZE>> released = std::make_unique<SpscQueue<sockaddr_in, QUEUE_SIZE>>();
+		std::atomic<bool> acceptingJoins{ true };
+		std::atomic<uint64_t> dropped{ 0 };
+	};
+
+	// playersPerMatch: how many addresses one match is sent before the next is tried (0 = no limit)
+	MatchRouter(size_t matchCount, size_t playersPerMatch);
+	~MatchRouter();
+
+	// The transport of match index, for its SocketManager. Each must be created before Open, and the router
+	// closed before any of them is destroyed.
+	std::unique_ptr<Port> CreatePort(size_t index);
+
+	// Binds the socket and starts the thread. With impairment, the socket sits behind a simulated network.
+	bool Open(const std::string& port, const ImpairmentSettings& impairment = {});
+	void Close();
+
+	// Datagrams that named no match, or came too short to name one
+	inline uint64_t GetUnroutable() const { return unroutable.load(std::memory_order_relaxed); }
+
+private:
+	void Run();
+	void Route(const Datagram& datagram); // Router's thread
+	size_t Place(const sockaddr_in& addr); // Router's thread, the match a new player goes to
+	void Release(const sockaddr_in& addr, size_t match); // Router's thread, match is done with addr
+
+	SocketManager socket;
+	std::vector<Port*> ports;
+	size_t playersPerMatch;
+	std::vector<size_t> placed; // Addresses sent to each match
+	AddressIndex placedAt;      // Address to match + 1
+
+	std::thread thread;
+	std::atomic<bool> running{ false };
+	std::atomic<uint64_t> unroutable{ 0 };
+};
@@ -0,0 +1,37 @@
+#include "MessageAggregator.hpp"
+
+#include <cstring>
+
+bool MessageAggregator::Fits(size_t size) const {
+	if (count == 0) return size + trailerSize <= MAX_PACKET_SIZE;
+	// The first message gains its bundle header when the second joins it
+	const size_t header = count == 1 ? HEADER_SIZE : 0;
+	return datagram.size + header + Schema::WireSize<BundleEntryMsg> + size + trailerSize <= MAX_PACKET_SIZE;
+}
+
+bool MessageAggregator::Append(const char* message, size_t size) {
+	if (size == 0 || !Fits(size)) return false;
+
+	if (count == 0) {
+		std::memcpy(datagram.data, message, size);
+		datagram.size = size;
+		count = 1;
+		return true;
+	}
+
+	if (count == 1) {
+		// Second message: the first moves up behind the bundle header and its own length
+		const size_t first = datagram.size;
+		std::memmove(datagram.data + HEADER_SIZE, datagram.data, first);
+		PacketWriter header(datagram);
+		header.WriteU8(COMMAND);
+		Schema::Encode(header, BundleEntryMsg{ static_cast<uint16_t>(first) });
+		datagram.size = HEADER_SIZE + first;
+	}
+
+	PacketWriter writer = PacketWriter::Append(datagram);
+	Schema::Encode(writer, BundleEntryMsg{ static_cast<uint16_t>(size) });
+	writer.WriteBytes(message, size);
+	++count;
+	return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include "PacketBuffer.hpp"
+#include "Messages.hpp"
+
+/**
+ * \brief Packs the messages queued for one peer during a frame into as few datagrams as they fit in,
+ *        so small messages stop paying 28 bytes of IP/UDP header each.
+ *
+ * A lone message goes out as it is. Once a second one is added the datagram becomes a BUNDLE:
+ * [COMMAND] then [BundleEntryMsg][message] for each, every message still starting with its own CMDID.
+ * trailerSize bytes are kept free at the end for whatever the owner appends to each datagram.
+ */
+class MessageAggregator {
+public:
+	static constexpr uint8_t COMMAND = 0x12; // NetworkEngine::BUNDLE
+	static constexpr size_t HEADER_SIZE = 1 + Schema::WireSize<BundleEntryMsg>; // What the first message costs once bundled
+
+	explicit MessageAggregator(size_t trailerSize = 0) : trailerSize(trailerSize) {}
+
+	// Whether a message of size bytes still fits in the pending datagram
+	bool Fits(size_t size) const;
+	// False if it does not fit; Flush and try again, unless it does not fit in an empty one either
+	bool Append(const char* message, size_t size);
+
+	// Hands the pending datagram to send(PacketBuffer&), which may append the trailer, and starts the next one
+	template <typename Send>
+	void Flush(Send&& send) {
+		if (count == 0) return;
+		send(datagram);
+		Clear();
+	}
+	inline void Clear() { datagram.size = 0; count = 0; }
+
+	inline bool Empty() const { return count == 0; }
+	inline size_t GetCount() const { return count; }
+
+	// Calls visit(message, size) for each message in a BUNDLE datagram (trailer already taken off).
+	// False if it is malformed; the messages before the fault have been visited.
+	template <typename Char, typename Visit>
+	static bool ForEach(Char* data, size_t size, Visit&& visit) {
+		PacketReader reader(data + 1, size - 1);
+		while (reader.Remaining() > 0) {
+			BundleEntryMsg entry;
+			Schema::Decode(reader, entry);
+			const size_t offset = 1 + reader.Offset();
+			if (entry.length == 0 || !reader.Consume(entry.length)) return false;
+			visit(data + offset, static_cast<size_t>(entry.length));
+		}
+		return true;
+	}
+
+private:
+	PacketBuffer datagram;
+	size_t count = 0;
+	size_t trailerSize;
+};
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include "PacketSchema.hpp"
+
+using Tick = uint32_t;
+using NetworkID = uint32_t;
+using EventID = uint32_t;
+using ConnectionID = uint32_t; // Host-assigned handle of a client's connection, 0 = none
+
+// Wire layout of every packet, declared once. Each packet starts with its CMDID byte, which is
+// written and dispatched on by NetworkEngine; the messages below describe what follows it.
+//
+//   REQ_CONNECTION       [ConnectRequestMsg][name bytes]
+//   RSP_CONNECTION       [ConnectionMsg]
+//   HEARTBEAT, REQ_RECONNECT, RSP_RECONNECT   (no payload)
+//   CLOCK_PING           [ClockPingMsg]
+//   CLOCK_PONG           [ClockPongMsg]
+//   PLAYER_INPUT         [PlayerInputMsg] then count x [buttons u8] (PlayerButton), oldest first
+//   GAME_EVENT           [EventType u8][event payload]
+//   BROADCAST_EVENT      [ReliableHeaderMsg][EventHeaderMsg][EventType u8][event payload]
+//   ACK_EVENT            (no payload, only the ack trailer)
+//   COMMIT_EVENT         [ReliableHeaderMsg][CommitEventMsg]
+//   SCHEDULED_EVENT      [ReliableHeaderMsg][ScheduledEventMsg][EventType u8][event payload]
+//   SNAPSHOT             [SnapshotHeaderMsg][PlayerStateAckMsg][delta from the baseline snapshot] (Snapshot.hpp)
+//   SNAPSHOT_ACK         [SnapshotAckMsg]
+//   INITIAL_STATE_OBJECT [WorldStateMsg] then players x [WorldPlayerMsg] then asteroids x [SpawnAsteroidMsg]
+//   FRAGMENT             [ReliableHeaderMsg][FragmentHeaderMsg][part of a message too long for one packet]
+//   BUNDLE               count x [BundleEntryMsg][message], each message one of the above from its CMDID on
+//
+// Every client -> host packet except REQ_CONNECTION also ends in a [ConnectionMsg][ReliableAckMsg] trailer: the
+// connection ID and nonce from RSP_CONNECTION, which identify the client even if its address changes, then its acks for
+// the BROADCAST_EVENT, COMMIT_EVENT, SCHEDULED_EVENT and FRAGMENT messages received so far (ReliableChannel.hpp).
+// A message split into FRAGMENTs is handled once all of them are in (Fragmentation.hpp).
+// A BUNDLE has one trailer after its last message, the messages in it have none (MessageAggregator.hpp).
+//
+// Event payloads by EventType:
+//   FireBullet     [FireBulletMsg]
+//   Collision      [CollisionMsg]
+//   SpawnAsteroid  [SpawnAsteroidMsg]
+//   StartGame      [RosterHeaderMsg] then count x [RosterEntryMsg]
+
+struct ConnectRequestMsg {
+	uint8_t nameLength = 0;
+};
+
+struct ConnectionMsg {
+	ConnectionID connectionID = 0;
+	uint32_t nonce = 0; // Random per connection, so an ID that is easy to guess is not enough to pass for the client
+};
+
+// Client -> Host. Times are the sender's steady clock in microseconds, wrapping; only differences matter.
+// rtt and rttDeviation are the client's current estimates (0 until it has one), so the host knows them too.
+struct ClockPingMsg {
+	uint32_t clientTime = 0;
+	Tick clientTick = 0;
+	uint32_t rtt = 0;
+	uint32_t rttDeviation = 0;
+};
+
+// Host -> Client, straight back: the ping's clientTime and the host's tick when it answered.
+// hostPhase is how far into hostTick it was, in ticks [0, 1).
+struct ClockPongMsg {
+	uint32_t clientTime = 0;
+	Tick hostTick = 0;
+	float hostPhase = 0.f;
+};
+
+// Position update of a Player or Asteroid. Quantized and bit-packed by StateEncoding, not Schema.
+struct ObjectStateMsg {
+	NetworkID networkID = 0;
+	Tick tick = 0;
+	uint8_t objectType = 0; // EntityType
+	glm::vec3 position{ 0.f };
+	float rotation = 0.f;
+	glm::vec3 velocity{ 0.f };
+};
+
+// Per-client sequence number of a message the host resends until it is acknowledged
+struct ReliableHeaderMsg {
+	uint16_t sequence = 0;
+};
+
+// ack and everything before it arrived; bit i of ackBits set means ack + 2 + i arrived too
+struct ReliableAckMsg {
+	uint16_t ack = 0;
+	uint32_t ackBits = 0;
+};
+
+// Part index of count of message messageID, which is split every FragmentAssembler::PAYLOAD_SIZE bytes
+struct FragmentHeaderMsg {
+	uint16_t messageID = 0;
+	uint16_t index = 0;
+	uint16_t count = 0;
+};
+
+// Length of the message that follows it in a BUNDLE, its CMDID included
+struct BundleEntryMsg {
+	uint16_t length = 0;
+};
+
+struct EventHeaderMsg {
+	EventID eventID = 0;
+};
+
+struct CommitEventMsg {
+	EventID eventID = 0;
+	NetworkID networkID = 0; // ID the host assigned to the object the event creates
+};
+
+// An event every peer runs on executeTick, without waiting for a commit
+struct ScheduledEventMsg {
+	EventID eventID = 0;
+	NetworkID networkID = 0; // ID the host assigned to the object the event creates
+	Tick executeTick = 0;
+};
+
+// baseline is the snapshot the delta applies to, 0 for a full snapshot
+struct SnapshotHeaderMsg {
+	uint32_t sequence = 0;
+	uint32_t baseline = 0;
+	Tick tick = 0;
+};
+
+// interpolationDelay: ticks the client shows other objects behind the newest snapshot, for lag compensation
+struct SnapshotAckMsg {
+	uint32_t sequence = 0;
+	float interpolationDelay = 0.f;
+};
+
+// Input commands for newestTick and the count - 1 client ticks before it
+struct PlayerInputMsg {
+	Tick newestTick = 0;
+	uint8_t count = 0;
+};
+
+// Where the host's run of the client's input commands up to inputTick left its ship. Sent unquantized,
+// so a client that predicted the same commands gets exactly the same numbers.
+struct PlayerStateAckMsg {
+	Tick inputTick = 0; // 0 = no command run yet, ignore the rest
+	glm::vec3 position{ 0.f };
+	float rotation = 0.f;
+	glm::vec3 velocity{ 0.f };
+};
+
+struct FireBulletMsg {
+	glm::vec3 position{ 0.f };
+	float rotation = 0.f;
+	uint32_t ownerId = 0;
+};
+
+struct CollisionMsg {
+	NetworkID idA = 0;
+	NetworkID idB = 0;
+	uint32_t scorer = 0; // Owner of the bullet, so clients that never saw it still award the point
+};
+
+struct SpawnAsteroidMsg {
+	NetworkID networkID = 0;
+	glm::vec3 position{ 0.f };
+	glm::vec3 scale{ 0.f };
+	glm::vec3 velocity{ 0.f };
+};
+
+// Everything a client joining mid-match needs to know of, as it was on tick. Sent fragmented.
+struct WorldStateMsg {
+	Tick tick = 0;
+	uint16_t players = 0;
+	uint16_t asteroids = 0;
+};
+
+// Another player's ship; where it is comes with the snapshots
+struct WorldPlayerMsg {
+	NetworkID networkID = 0;
+};
+
+struct RosterHeaderMsg {
+	uint8_t count = 0;
+};
+
+// SpawnPlayer for the receiving client's own player, PlayerJoined for everyone else's
+struct RosterEntryMsg {
+	uint8_t type = 0;
+	NetworkID networkID = 0;
+};
+
+namespace Schema {
+	template <> struct MessageSchema<ConnectRequestMsg> : FieldList<
+		Field<&ConnectRequestMsg::nameLength, U8>> {};
+
+	template <> struct MessageSchema<ConnectionMsg> : FieldList<
+		Field<&ConnectionMsg::connectionID, U32>,
+		Field<&ConnectionMsg::nonce, U32>> {};
+
+	template <> struct MessageSchema<ClockPingMsg> : FieldList<
+		Field<&ClockPingMsg::clientTime, U32>,
+		Field<&ClockPingMsg::clientTick, U32>,
+		Field<&ClockPingMsg::rtt, U32>,
+		Field<&ClockPingMsg::rttDeviation, U32>> {};
+
+	template <> struct MessageSchema<ClockPongMsg> : FieldList<
+		Field<&ClockPongMsg::clientTime, U32>,
+		Field<&ClockPongMsg::hostTick, U32>,
+		Field<&ClockPongMsg::hostPhase, F32>> {};
+
+	template <> struct MessageSchema<ReliableHeaderMsg> : FieldList<
+		Field<&ReliableHeaderMsg::sequence, U16>> {};
+
+	template <> struct MessageSchema<ReliableAckMsg> : FieldList<
+		Field<&ReliableAckMsg::ack, U16>,
+		Field<&ReliableAckMsg::ackBits, U32>> {};
+
+	template <> struct MessageSchema<FragmentHeaderMsg> : FieldList<
+		Field<&FragmentHeaderMsg::messageID, U16>,
+		Field<&FragmentHeaderMsg::index, U16>,
+		Field<&FragmentHeaderMsg::count, U16>> {};
+
+	template <> struct MessageSchema<BundleEntryMsg> : FieldList<
+		Field<&BundleEntryMsg::length, U16>> {};
+
+	template <> struct MessageSchema<EventHeaderMsg> : FieldList<
+		Field<&EventHeaderMsg::eventID, U32>> {};
+
+	template <> struct MessageSchema<CommitEventMsg> : FieldList<
+		Field<&CommitEventMsg::eventID, U32>,
+		Field<&CommitEventMsg::networkID, U32>> {};
+
+	template <> struct MessageSchema<ScheduledEventMsg> : FieldList<
+		Field<&ScheduledEventMsg::eventID, U32>,
+		Field<&ScheduledEventMsg::networkID, U32>,
+		Field<&ScheduledEventMsg::executeTick, U32>> {};
+
+	template <> struct MessageSchema<SnapshotHeaderMsg> : FieldList<
+		Field<&SnapshotHeaderMsg::sequence, U32>,
+		Field<&SnapshotHeaderMsg::baseline, U32>,
+		Field<&SnapshotHeaderMsg::tick, U32>> {};
+
+	template <> struct MessageSchema<SnapshotAckMsg> : FieldList<
+		Field<&SnapshotAckMsg::sequence, U32>,
+		Field<&SnapshotAckMsg::interpolationDelay, F32>> {};
+
+	template <> struct MessageSchema<PlayerInputMsg> : FieldList<
+		Field<&PlayerInputMsg::newestTick, U32>,
+		Field<&PlayerInputMsg::count, U8>> {};
+
+	template <> struct MessageSchema<PlayerStateAckMsg> : FieldList<
+		Field<&PlayerStateAckMsg::inputTick, U32>,
+		Field<&PlayerStateAckMsg::position, Vec2>,
+		Field<&PlayerStateAckMsg::rotation, F32>,
+		Field<&PlayerStateAckMsg::velocity, Vec2>> {};
+
+	template <> struct MessageSchema<FireBulletMsg> : FieldList<
+		Field<&FireBulletMsg::position, Vec3>,
+		Field<&FireBulletMsg::rotation, F32>,
+		Field<&FireBulletMsg::ownerId, U32>> {};
+
+	template <> struct MessageSchema<CollisionMsg> : FieldList<
+		Field<&CollisionMsg::idA, U32>,
+		Field<&CollisionMsg::idB, U32>,
+		Field<&CollisionMsg::scorer, U32>> {};
+
+	template <> struct MessageSchema<SpawnAsteroidMsg> : FieldList<
+		Field<&SpawnAsteroidMsg::networkID, U32>,
+		Field<&SpawnAsteroidMsg::position, Vec3>,
+		Field<&SpawnAsteroidMsg::scale, Vec3>,
+		Field<&SpawnAsteroidMsg::velocity, Vec3>> {};
+
+	template <> struct MessageSchema<WorldStateMsg> : FieldList<
+		Field<&WorldStateMsg::tick, U32>,
+		Field<&WorldStateMsg::players, U16>,
+		Field<&WorldStateMsg::asteroids, U16>> {};
+
+	template <> struct MessageSchema<WorldPlayerMsg> : FieldList<
+		Field<&WorldPlayerMsg::networkID, U32>> {};
+
+	template <> struct MessageSchema<RosterHeaderMsg> : FieldList<
+		Field<&RosterHeaderMsg::count, U8>> {};
+
+	template <> struct MessageSchema<RosterEntryMsg> : FieldList<
+		Field<&RosterEntryMsg::type, U8>,
+		Field<&RosterEntryMsg::networkID, U32>> {};
+}
+
+// The original hand-written layouts, kept byte for byte
+static_assert(Schema::WireSize<FireBulletMsg> == 20, "FireBullet payload changed size");
+static_assert(Schema::WireSize<SpawnAsteroidMsg> == 40, "SpawnAsteroid payload changed size");
+static_assert(Schema::WireSize<RosterEntryMsg> == 5, "StartGame roster entry changed size");
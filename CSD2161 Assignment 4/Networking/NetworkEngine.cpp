@@ -2,100 +2,111 @@
 
 #include <iostream>
 
-#include "ws2tcpip.h"		// getaddrinfo()
-
 #include "../Events/EventQueue.hpp"
+#include "StateEncoding.hpp"
+#include "ThreadedTransport.hpp"
 #include "../AsteroidScene.hpp" // HACK: Include scene for now for state access.
 #include <thread>
 #include <algorithm>
+#include <cmath>
 
-// Tell the Visual Studio linker to include the following library in linking.
-// Alternatively, we could add this file to the linker command-line parameters,
-// but including it in the source code simplifies the configuration.
-#pragma comment(lib, "ws2_32.lib")
-
-#ifndef WINSOCK_VERSION
-#define WINSOCK_VERSION     2
-#endif
-#define WINSOCK_SUBVERSION  2
 #define MAX_STR_LEN         1000
 
 //extern Tick simulationTick;
 //extern Tick localTick;
 
 // HACK: Temporary global scene pointer for state sync.
-extern AsteroidScene * g_AsteroidScene;
+extern thread_local AsteroidScene * g_AsteroidScene;
+
+namespace {
+	thread_local NetworkEngine* boundEngine = nullptr; // The match this thread is running, if any
+}
 
 NetworkEngine& NetworkEngine::GetInstance() {
+	if (boundEngine) return *boundEngine;
 	static NetworkEngine ne;
 	return ne;
 }
 
-void NetworkEngine::Initialize() {
-	WSADATA wsaData{};
-	SecureZeroMemory(&wsaData, sizeof(wsaData));
+void NetworkEngine::Bind(NetworkEngine* engine) {
+	boundEngine = engine;
+}
 
-	int errorCode = WSAStartup(MAKEWORD(WINSOCK_VERSION, WINSOCK_SUBVERSION), &wsaData);
-	if (NO_ERROR != errorCode) {
-		std::cerr << "WSAStartup() failed.\n";
-		return;
+void NetworkEngine::Initialize() {
+	if (!socketManager.Initialize()) {
+		std::cerr << "Socket transport failed to start.\n";
 	}
 }
 
 void NetworkEngine::Update(double) {
-	std::vector<char> data;
-	sockaddr_in sender{};
-
 	if (isHosting) {
 
-		if (simulationTick % 120 == 0) { // Every 120 ticks (2 second) send sync.
-			SendTickSync();
-		}
-
-		// Resend packets that have timed out
-		CheckAckTimeouts();
+		RefillBandwidth();
 
-		// Check for client timeouts and timed-out events before processing new packets
+		// Check for client timeouts before processing new packets
 		CheckTimeoutsAndHeartbeats();
 
-		while (socketManager.ReceiveFromClient(data, sender)) {
-			
-			if (data.empty()) continue;
+		UpdateInputDelay();
 
-			switch (static_cast<CMDID>(data[0]))
-			{
-			case REQ_CONNECTION:
-				HandleIncomingConnection(data, sender);
-				break;
-			case GAME_DATA: // Player position updates (state sync)
-				// Optional: Could add client ID verification here
-				EventQueue::GetInstance().Push(std::make_unique<PlayerUpdate>(data.data(), data.size()));
-				SendToOtherClients(sender, data); // Still broadcast state updates immediately
-				break;
-			case GAME_EVENT: // Client submitting an action event for lockstep
-				HandleClientEvent(data);
-				break;
-			case ACK_EVENT: // Client acknowledging receipt of a broadcast event
-				HandleAckEvent(data, sender);
-				break;
-			case HEARTBEAT: // Client sending keep-alive
-				HandleHeartbeat(sender);
-				break;
-			default:
-				// Optional: Log unknown packet type
-				break;
+		// Drain the socket a batch at a time; packets are handled in place in the receive ring
+		size_t received;
+		while ((received = socketManager.ReceiveBatch()) > 0) {
+			for (size_t i = 0; i < received; ++i) {
+				const Datagram& packet = socketManager.GetReceived(i);
+				const char* data = packet.data;
+				size_t size = packet.size;
+				const sockaddr_in& sender = packet.addr;
+
+				if (size == 0) continue;
+
+				if (static_cast<CMDID>(data[0]) == REQ_CONNECTION) {
+					HandleIncomingConnection(data, size, sender);
+					continue;
+				}
+
+				// Everything after the handshake ends in the client's connection ID and its acks for our reliable
+				// messages. The ID, not the address, says who sent it; one lookup serves the whole packet.
+				if (size < 1 + HOST_TRAILER_SIZE) continue;
+				size -= HOST_TRAILER_SIZE;
+
+				PacketReader trailer(data + size, HOST_TRAILER_SIZE);
+				ConnectionMsg connection;
+				ReliableAckMsg ack;
+				Schema::Decode(trailer, connection);
+				Schema::Decode(trailer, ack);
+
+				auto clientOpt = clientManager.GetClientByConnection(connection.connectionID);
+				if (!clientOpt) continue;
+				Client& client = clientOpt.value().get();
+				if (connection.nonce != client.connectionNonce) continue; // Someone else trying IDs, not the client
+				if (!(client == sender)) {
+					std::cout << "[Host] Client ID: " << client.clientID << " moved from " << client.ipAddress << ":" << client.udpPort;
+					clientManager.Rebind(client, sender);
+					std::cout << " to " << client.ipAddress << ":" << client.udpPort << std::endl;
+				}
+				HandleReliableAck(ack, client);
+				HandleHeartbeat(client, packet.receivedTime);
+
+				ForEachMessage(data, size, [&](const char* message, size_t messageSize) {
+					HandleClientMessage(message, messageSize, client);
+				});
 			}
 		}
-	} else if (isClient) {
 
-		// Client-side heartbeat sending
-		auto now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastHeartbeatSentTime).count() >= HEARTBEAT_INTERVAL_MS) {
-			char heartbeatCmd = CMDID::HEARTBEAT;
-			socketManager.SendToHost(heartbeatCmd);
-			lastHeartbeatSentTime = now;
+		// Reliable messages first, snapshots get what budget is left
+		SendDueReliable();
+
+		if (g_AsteroidScene && simulationTick - lastSnapshotTick >= snapshotIntervalTicks) {
+			lastSnapshotTick = simulationTick;
+			SendSnapshots();
 		}
 
+		// One datagram per client for the frame, where it all fits
+		for (auto& client : clientManager.GetClientsNonConst()) {
+			FlushToClient(client);
+		}
+	} else if (isClient) {
+
 		//auto now = std::chrono::steady_clock::now();
 		//auto timeSinceLastResponse = std::chrono::duration_cast<std::chrono::seconds>(
 		//	now - lastServerResponseTime
@@ -108,59 +119,151 @@ void NetworkEngine::Update(double) {
 		//	AttemptReconnect();
 		//}
 
-		while (socketManager.ReceiveFromHost(data)) {
-			if (data.empty()) continue;
-
+		size_t received;
+		while ((received = socketManager.ReceiveBatch()) > 0) {
 			lastServerResponseTime = std::chrono::steady_clock::now();
 
-			switch (static_cast<CMDID>(data[0])) {
-			case TICK_SYNC: {
-				Tick receivedTick;
-				std::memcpy(&receivedTick, &data[1], sizeof(receivedTick));
-				localTick = ntohl(receivedTick);
-				break;
+			for (size_t i = 0; i < received; ++i) {
+				const Datagram& packet = socketManager.GetReceived(i);
+				if (packet.size == 0) continue;
+
+				ForEachMessage(packet.data, packet.size, [&](const char* message, size_t messageSize) {
+					HandleHostMessage(message, messageSize, packet.receivedTime);
+				});
 			}
-			case GAME_DATA: {
-				EventQueue::GetInstance().Push(std::make_unique<PlayerUpdate>(data.data(), data.size()));
-				break;
+		}
+
+		UpdateClock();
+		fragments.Expire(std::chrono::steady_clock::now());
+
+		// Anything else we send carries the acks and keeps us alive; only with nothing queued for a while does
+		// a heartbeat or a bare ack go out, unless the I/O thread sends those
+		const auto now = std::chrono::steady_clock::now();
+		if (!ioThreaded && hostOutbox.Empty()) {
+			PacketBuffer keepAlive;
+			PacketWriter writer(keepAlive);
+			if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSentToHost.load()).count() >= HEARTBEAT_INTERVAL_MS) {
+				writer.WriteU8(CMDID::HEARTBEAT);
 			}
-			case BROADCAST_EVENT: // Host broadcasting an event for lockstep
-				HandleBroadcastEvent(data);
-				break;
-			case COMMIT_EVENT: // Host commanding the client to process a specific event
-				HandleCommitEvent(data);
-				break;
-			case INITIAL_STATE_OBJECT: // Host sending initial state for an object
-				// HandleInitialStateObject(data);
-				break;
-			case FULL_STATE_SNAPSHOT:
-				HandleFullStateSnapshot(data);
-				break;
-			default:
-				// Optional: Log unknown packet type
-				break;
+			else if (ackPending && std::chrono::duration_cast<std::chrono::milliseconds>(now - ackPendingSince).count() >= ACK_DELAY_MS) {
+				writer.WriteU8(CMDID::ACK_EVENT);
 			}
+			if (keepAlive.size > 0) SendToHost(keepAlive);
 		}
+
+		FlushToHost();
+	}
+
+	// Send everything queued this frame in as few syscalls as the transport allows
+	socketManager.Flush();
+}
+
+void NetworkEngine::HandleClientMessage(const char* data, size_t size, Client& client) {
+	switch (static_cast<CMDID>(data[0]))
+	{
+	case PLAYER_INPUT: // Client's input commands, other clients see the result in their next snapshot
+		HandlePlayerInput(data, size, client);
+		break;
+	case GAME_EVENT: // Client submitting an action event for lockstep
+		HandleClientEvent(data, size);
+		break;
+	case ACK_EVENT: // Nothing but the ack trailer, already handled
+		break;
+	case HEARTBEAT: // Nothing but the keep-alive every datagram is, already handled
+		break;
+	case CLOCK_PING:
+		HandleClockPing(data, size, client);
+		break;
+	case SNAPSHOT_ACK:
+		HandleSnapshotAck(data, size, client);
+		break;
+	default:
+		// Optional: Log unknown packet type
+		break;
+	}
+}
+
+void NetworkEngine::HandleHostMessage(const char* data, size_t size, TimePoint receivedTime) {
+	// Acked with whatever we send next. A repeat means the host missed our ack, so it is acked again.
+	// With the I/O thread this has been done there already, and repeats never get here.
+	const CMDID command = static_cast<CMDID>(data[0]);
+	if (!ioThreaded && IsReliable(command)) {
+		MarkAckPending();
+		if (!AcceptReliable(data, size)) return;
+	}
+
+	switch (command) {
+	case CLOCK_PONG:
+		HandleClockPong(data, size, receivedTime);
+		break;
+	case BROADCAST_EVENT: // Host broadcasting an event for lockstep
+		HandleBroadcastEvent(data, size);
+		break;
+	case COMMIT_EVENT: // Host commanding the client to process a specific event
+		HandleCommitEvent(data, size);
+		break;
+	case SCHEDULED_EVENT: // Host telling the client when to process an event
+		HandleScheduledEvent(data, size);
+		break;
+	case INITIAL_STATE_OBJECT: // Host sending what was in the world when we joined
+		HandleInitialState(data, size);
+		break;
+	case FRAGMENT:
+		HandleFragment(data, size, receivedTime);
+		break;
+	case SNAPSHOT:
+		HandleSnapshot(data, size, receivedTime);
+		break;
+	default:
+		// Optional: Log unknown packet type
+		break;
 	}
 }
 
 
 bool NetworkEngine::Host(std::string portNumber) {
+	StartIoThread(true);
 	isHosting = socketManager.Host(portNumber);
 
 	if (isHosting) {
 		isClient = false; 
+		scheduledEvents.Reset(simulationTick);
 		std::cout << "Hosting on IP: " << GetIPAddress() << " Port: " << portNumber << std::endl;
 	}
 	return isHosting;
 }
 
 bool NetworkEngine::Connect(std::string host, std::string portNumber, const std::string& playerName) {
+	reliableReceiver.Reset();
+	ackPending = false;
+	connectionID = 0;
+	connectionNonce = 0;
+	hostOutbox.Clear();
+	fragments.Reset();
+	lastSentToHost = std::chrono::steady_clock::now();
+	StartIoThread(false);
+
+	PacketBuffer response;
 	isClient = socketManager.ConnectWithHandshake(host, portNumber,
-		CMDID::REQ_CONNECTION, CMDID::RSP_CONNECTION, playerName);
+		CMDID::REQ_CONNECTION, CMDID::RSP_CONNECTION, playerName, &response);
+
+	ConnectionMsg connection;
+	PacketReader reader(response.data + 1, response.size > 0 ? response.size - 1 : 0);
+	if (isClient && (!Schema::Decode(reader, connection) || connection.connectionID == 0)) {
+		std::cerr << "[Client] Host sent no connection ID." << std::endl;
+		socketManager.Cleanup();
+		isClient = false;
+	}
 
 	if (isClient) {
+		connectionNonce.store(connection.nonce, std::memory_order_relaxed);
+		connectionID.store(connection.connectionID, std::memory_order_release);
 		isHosting = false;
+		receivedSnapshots.Clear();
+		lastReceivedSnapshot = 0;
+		interpolation.Reset();
+		clock.Reset();
+		scheduledEvents.Reset(localTick);
 		std::cout << "Connected to host: " << host << " Port: " << portNumber << std::endl;
 	}
 
@@ -169,7 +272,31 @@ bool NetworkEngine::Connect(std::string host, std::string portNumber, const std:
 
 void NetworkEngine::Exit() {	
 	socketManager.Cleanup();
-	WSACleanup();
+	socketManager.Shutdown();
+}
+
+void NetworkEngine::AdvanceTick() {
+	++simulationTick;
+	++localTick;
+
+	// Scheduled events are stamped in host ticks; a client runs them by its estimate of that clock
+	if (isHosting) {
+		lastTickTime = std::chrono::steady_clock::now();
+		const uint64_t micros = static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::microseconds>(lastTickTime.time_since_epoch()).count());
+		publishedTick.store((static_cast<uint64_t>(simulationTick) << 32) | (micros & 0xFFFFFFFFu), std::memory_order_release);
+		scheduledEvents.Release(simulationTick, [this](ScheduledEvent& event) {
+			ProcessHostEvent(event.eventID, event.networkID, *event.eventData);
+		});
+	}
+	else if (isClient) {
+		if (clock.IsSynced()) {
+			scheduledEvents.Release(GetHostTick(), [this](ScheduledEvent& event) {
+				ProcessClientEvent(event.eventID, event.networkID, *event.eventData);
+			});
+		}
+		interpolation.Advance();
+	}
 }
 
 void NetworkEngine::AttemptReconnect() {
@@ -200,29 +327,26 @@ void NetworkEngine::AttemptReconnect() {
 void NetworkEngine::SendEventToServer(std::unique_ptr<GameEvent> eventt) {
 	if (!isClient) return;
 
-	std::vector<char> packet;
-	packet.push_back(CMDID::GAME_EVENT); // Mark as client-submitted event
-	packet.push_back(static_cast<char>(eventt->type)); // Add the event type
+	PacketBuffer packet;
+	PacketWriter writer(packet);
+	writer.WriteU8(CMDID::GAME_EVENT); // Mark as client-submitted event
+	writer.WriteU8(static_cast<uint8_t>(eventt->type)); // Add the event type
 
 	// Serialize the specific event data
 	switch (eventt->type) {
 	case EventType::FireBullet: {
-		auto fireEvent = static_cast<FireBulletEvent*>(eventt.get());
-		std::vector<char> eventData = fireEvent->Serialize();
-		packet.insert(packet.end(), eventData.begin(), eventData.end());
+		static_cast<FireBulletEvent*>(eventt.get())->Serialize(writer);
 		break;
 	}
 	case EventType::Collision: {
-		auto collisionEvent = static_cast<CollisionEvent*>(eventt.get());
-		std::vector<char> eventData = collisionEvent->Serialize();
-		packet.insert(packet.end(), eventData.begin(), eventData.end());
+		static_cast<CollisionEvent*>(eventt.get())->Serialize(writer);
 		break;
 	} 
 	}// end switch
 
 
-	if (packet.size() > 2) { // Ensure we actually added event data
-		socketManager.SendToHost(packet);
+	if (writer.Size() > 2) { // Ensure we actually added event data
+		SendToHost(packet);
 	}
 	else {
 		std::cerr << "Warning: Tried to send unknown or empty event type: " << static_cast<int>(eventt->type) << std::endl;
@@ -233,13 +357,13 @@ void NetworkEngine::ServerBroadcastEvent(std::unique_ptr<GameEvent> event)
 {
 	if (!isHosting) return;
 
-	std::vector<char> data;
+	PacketHandle data = PacketPool::GetInstance().Acquire();
+	PacketWriter writer(*data);
 	switch (event->type) {
 	case EventType::FireBullet: {
 		auto fireEvent = static_cast<FireBulletEvent*>(event.get());
-		data.push_back(static_cast<char>(EventType::FireBullet));
-		std::vector<char> eventData = fireEvent->Serialize();
-		data.insert(data.end(), eventData.begin(), eventData.end());
+		writer.WriteU8(static_cast<uint8_t>(EventType::FireBullet));
+		fireEvent->Serialize(writer);
 		break;
 	}
 	} // end switch
@@ -247,71 +371,228 @@ void NetworkEngine::ServerBroadcastEvent(std::unique_ptr<GameEvent> event)
 	EventID currentEventID = nextEventID++;
 	//EventType eventType = event->type;
 
-	PendingEventInfo info;
-	info.eventData = std::move(data);
-	info.broadcastTime = std::chrono::steady_clock::now();
-	pendingAcks[currentEventID] = std::move(info);
-	
-	// Prepare broadcast packet
-	std::vector<char> broadcastPacket;
-	broadcastPacket.push_back(CMDID::BROADCAST_EVENT); // Mark as broadcast event
-	EventID netEventID = htonl(currentEventID);
-	broadcastPacket.insert(broadcastPacket.end(), reinterpret_cast<char*>(&netEventID), reinterpret_cast<char*>(&netEventID) + sizeof(netEventID));
-	// Append the original event data (EventType + SpecificData)
-	broadcastPacket.insert(broadcastPacket.end(), 
-		pendingAcks[currentEventID].eventData.begin(), pendingAcks[currentEventID].eventData.end());
+	BroadcastPendingEvent(currentEventID, std::move(data));
+}
 
-	std::cout << "[Host] Broadcasting Event ID: " << currentEventID << std::endl;
-	SendToAllClients(broadcastPacket); // Broadcast to everyone
+void NetworkEngine::BroadcastPendingEvent(EventID eventID, PacketHandle eventData) {
+	if (eventDelivery == EventDelivery::Scheduled) {
+		ScheduleEvent(eventID, std::move(eventData));
+		return;
+	}
+
+	PendingEventInfo& pending = ClaimPendingEvent(eventID);
+	pending.eventData = std::move(eventData);
+
+	PacketBuffer body;
+	WriteBroadcastBody(body, eventID, pending.eventData.Data(), pending.eventData.Size());
+
+	for (auto& client : clientManager.GetClientsNonConst()) {
+		if (!client.isConnected || !WantsEvent(client, *pending.eventData)) continue;
+		if (SendReliable(client, BROADCAST_EVENT, body, eventID, true)) pending.recipients.push_back(client.clientID);
+	}
+	pending.acksOutstanding = pending.recipients.size();
+
+	if (pending.recipients.empty()) {
+		CommitEvent(pending);
+		return;
+	}
+	std::cout << "[Host] Broadcasting Event ID: " << eventID << " to " << pending.recipients.size() << " client(s)" << std::endl;
+}
+
+void NetworkEngine::ScheduleEvent(EventID eventID, PacketHandle eventData) {
+	// Stamped now and never waited on: it runs on that tick everywhere, however slow any one client is
+	ScheduledEventMsg header;
+	header.eventID = eventID;
+	header.networkID = nextID++;
+	header.executeTick = simulationTick + inputDelayTicks;
+
+	PacketBuffer body;
+	PacketWriter writer(body);
+	Schema::Encode(writer, header);
+	writer.WriteBytes(eventData.Data(), eventData.Size());
+
+	for (auto& client : clientManager.GetClientsNonConst()) {
+		if (!client.isConnected || !WantsEvent(client, *eventData)) continue;
+		SendReliable(client, SCHEDULED_EVENT, body, eventID, false);
+	}
+
+	scheduledEvents.Insert(ScheduledEvent{ header.executeTick, eventID, header.networkID, std::move(eventData) });
+}
+
+bool NetworkEngine::WantsEvent(const Client& client, const PacketBuffer& eventData) const {
+	// Bullets only matter to players near enough to see them; everything else changes shared state
+	PacketReader reader(eventData);
+	FireBulletMsg fire;
+	if (static_cast<EventType>(reader.ReadU8()) != EventType::FireBullet || !Schema::Decode(reader, fire)) return true;
+	return interest.IsRelevant(client, glm::vec2(fire.position.x, fire.position.y));
+}
+
+void NetworkEngine::UpdateInputDelay() {
+	// Clients run events by their estimate of our tick, so an event has to reach the farthest one before its
+	// tick comes: half its RTT plus twice the RTT deviation, on top of the minimum.
+	double worst = 0.0;
+	for (const auto& client : clientManager.GetClients()) {
+		if (client.isConnected && client.clock.synced) worst = std::max(worst, client.clock.rtt / 2.0 + 2.0 * client.clock.rttDeviation);
+	}
+	const Tick delayTicks = static_cast<Tick>(std::ceil(worst / fixedDeltaTime));
+	inputDelayTicks = std::min(MIN_INPUT_DELAY_TICKS + delayTicks, MAX_INPUT_DELAY_TICKS);
+}
+
+NetworkEngine::PendingEventInfo& NetworkEngine::ClaimPendingEvent(EventID eventID) {
+	PendingEventInfo& pending = pendingEvents[eventID % EVENT_WINDOW];
+	if (pending.isPending) {
+		std::cerr << "[Host] " << EVENT_WINDOW << " events waiting for ACKs, committing Event ID: " << pending.eventID << " early." << std::endl;
+		CommitEvent(pending);
+	}
+	pending.eventID = eventID;
+	pending.isPending = true;
+	pending.eventData.Reset();
+	pending.recipients.clear();
+	pending.acksOutstanding = 0;
+	return pending;
+}
+
+void NetworkEngine::OnEventDelivered(EventID eventID) {
+	PendingEventInfo& pending = pendingEvents[eventID % EVENT_WINDOW];
+	if (!pending.isPending || pending.eventID != eventID || pending.acksOutstanding == 0) return;
+	if (--pending.acksOutstanding > 0) return;
+
+	std::cout << "[Host] All ACKs received for Event ID: " << eventID << ". Committing." << std::endl;
+	CommitEvent(pending);
+}
+
+bool NetworkEngine::SendReliable(Client& client, CMDID command, const PacketBuffer& body, EventID eventID, bool isBroadcast) {
+	if (client.reliable.IsFull()) {
+		std::cerr << "[Host] Client " << client.clientID << " has " << ReliableSender::WINDOW
+			<< " unacknowledged messages and would miss Event ID: " << eventID << ", disconnecting it." << std::endl;
+		DisconnectClient(client);
+		return false;
+	}
+
+	PacketHandle packet = PacketPool::GetInstance().Acquire();
+	PacketWriter writer(*packet);
+	writer.WriteU8(command);
+	Schema::Encode(writer, ReliableHeaderMsg{ client.reliable.NextSequence() });
+	writer.WriteBytes(body.data, body.size);
+
+	client.reliable.Push(std::move(packet), eventID, isBroadcast); // Goes out with this tick's SendDueReliable
+	return true;
+}
+
+bool NetworkEngine::SendFragmented(Client& client, const char* message, size_t size) {
+	const size_t count = (size + FragmentAssembler::PAYLOAD_SIZE - 1) / FragmentAssembler::PAYLOAD_SIZE;
+	if (count == 0 || count > FragmentAssembler::MAX_FRAGMENTS || count > client.reliable.GetRoom()) {
+		std::cerr << "[Host] Cannot send Client " << client.clientID << " a " << size << " byte message in "
+			<< client.reliable.GetRoom() << " free reliable slots." << std::endl;
+		return false;
+	}
+
+	// Each part is a reliable message of its own, acked and resent by itself
+	const uint16_t messageID = nextFragmentedID++;
+	for (size_t index = 0; index < count; ++index) {
+		const size_t offset = index * FragmentAssembler::PAYLOAD_SIZE;
+		const size_t length = std::min(FragmentAssembler::PAYLOAD_SIZE, size - offset);
+
+		PacketHandle packet = PacketPool::GetInstance().Acquire();
+		PacketWriter writer(*packet);
+		writer.WriteU8(CMDID::FRAGMENT);
+		Schema::Encode(writer, ReliableHeaderMsg{ client.reliable.NextSequence() });
+		Schema::Encode(writer, FragmentHeaderMsg{ messageID, static_cast<uint16_t>(index), static_cast<uint16_t>(count) });
+		writer.WriteBytes(message + offset, length);
+		client.reliable.Push(std::move(packet), 0, false);
+	}
+	return true;
+}
+
+void NetworkEngine::DropReliable(Client& client) {
+	// Recipients that dropped do not hold their events up
+	client.reliable.Clear([this](const ReliableSender::Entry& entry) {
+		if (entry.isBroadcast) OnEventDelivered(entry.eventID);
+	});
+}
+
+void NetworkEngine::DisconnectClient(Client& client) {
+	if (!client.isConnected) return;
+	// Removed later, since callers may be walking the client list
+	client.isConnected = false;
+	disconnectedClients.push_back(client.connectionID);
+	DropReliable(client);
 }
 
-void NetworkEngine::SendToAllClients(std::vector<char> packet)
+void NetworkEngine::SendToAllClients(const PacketBuffer& packet)
 {
+	SendToAllClients(packet.data, packet.size);
+}
+
+void NetworkEngine::SendToAllClients(const char* data, size_t size)
+{
+	fanoutAddrs.clear();
 	for (auto& client : clientManager.GetClients()) {
-		socketManager.SendToClient(client.address, packet);
+		fanoutAddrs.push_back(client.address);
 	}
+	socketManager.SendToClients(fanoutAddrs.data(), fanoutAddrs.size(), data, size);
 }
 
-void NetworkEngine::SendToClient(const Client & client, const std::vector<char>&packet)
+void NetworkEngine::SendToClient(const Client & client, const PacketBuffer& packet)
 {
 	if (isHosting && client.isConnected) {
 		socketManager.SendToClient(client.address, packet);
 	}
 }
 
-void NetworkEngine::SendtoClientSameEvent(const Client& client, EventID eid, const std::vector<char>& data) {
-	// Store event data for ACK tracking (skip CMDID)
-	PendingEventInfo info;
-	info.eventData.assign(data.begin() + 1, data.end()); // Store EventType + SpecificData
-	info.broadcastTime = std::chrono::steady_clock::now(); // Record broadcast time
-	pendingAcks[eid] = std::move(info);
-
-	// Prepare broadcast packet
-	std::vector<char> broadcastPacket;
-	broadcastPacket.push_back(CMDID::BROADCAST_EVENT);
-	EventID netEventID = htonl(eid);
-	broadcastPacket.insert(broadcastPacket.end(), reinterpret_cast<char*>(&netEventID), reinterpret_cast<char*>(&netEventID) + sizeof(netEventID));
-	// Append the original event data (EventType + SpecificData)
-	broadcastPacket.insert(broadcastPacket.end(), data.begin() + 1, data.end());
+bool NetworkEngine::SendToHost(const PacketBuffer& packet)
+{
+	if (!hostOutbox.Fits(packet.size)) FlushToHost();
+	return hostOutbox.Append(packet.data, packet.size);
+}
+
+void NetworkEngine::FlushToHost()
+{
+	hostOutbox.Flush([this](PacketBuffer& datagram) {
+		PacketWriter writer = PacketWriter::Append(datagram);
+		WriteHostTrailer(writer);
+		ackPending = false;
+		lastSentToHost = std::chrono::steady_clock::now();
+		socketManager.SendToHost(datagram);
+	});
+}
+
+void NetworkEngine::SendtoClientSameEvent(Client& client, EventID eid, const PacketBuffer& data) {
+	if (data.size < 2 || !client.isConnected) return; // Need at least CMDID and EventType
+
+	// Every client gets its own copy of this event under the same ID, so the commit waits for all of them
+	PendingEventInfo* pending = &pendingEvents[eid % EVENT_WINDOW];
+	if (!pending->isPending || pending->eventID != eid) {
+		pending = &ClaimPendingEvent(eid);
+		pending->eventData = PacketHandle::Copy(data.data + 1, data.size - 1); // Store EventType + SpecificData
+	}
+
+	PacketBuffer body;
+	WriteBroadcastBody(body, eid, data.data + 1, data.size - 1);
+	if (SendReliable(client, BROADCAST_EVENT, body, eid, true)) {
+		pending->recipients.push_back(client.clientID);
+		++pending->acksOutstanding;
+	}
 
 	std::cout << "[Host] Broadcasting Event ID: " << eid << std::endl;
-	SendToClient(client, broadcastPacket); // Broadcast to everyone
 }
 
-void NetworkEngine::SendToOtherClients(const sockaddr_in& reqClient, std::vector<char> packet)
+void NetworkEngine::SendToOtherClients(const sockaddr_in& reqClient, const char* data, size_t size)
 {
+	fanoutAddrs.clear();
 	for (auto& client : clientManager.GetClients()) {
 		if (client.address.sin_addr.s_addr == reqClient.sin_addr.s_addr &&
 			client.address.sin_port == reqClient.sin_port) continue;
 
-		socketManager.SendToClient(client.address, packet);	
+		fanoutAddrs.push_back(client.address);
 	}
+	socketManager.SendToClients(fanoutAddrs.data(), fanoutAddrs.size(), data, size);
 }
 
 // Host side handling
-void NetworkEngine::HandleIncomingConnection(const std::vector<char>& data, const sockaddr_in& clientAddr)
+void NetworkEngine::HandleIncomingConnection(const char* data, size_t size, const sockaddr_in& clientAddr)
 {
-	if (data.empty() || (data[0] != REQ_CONNECTION && data[0] != REQ_RECONNECT)) return;
+	if (size == 0 || (data[0] != REQ_CONNECTION && data[0] != REQ_RECONNECT)) return;
 
 	if (data[0] == CMDID::REQ_RECONNECT) {
 		// Find existing client
@@ -322,46 +603,97 @@ void NetworkEngine::HandleIncomingConnection(const std::vector<char>& data, cons
 			client.isConnected = true;
 			socketManager.SendToClient(clientAddr, static_cast<char>(CMDID::RSP_RECONNECT));
 
-			// Resend game state
-			//SendFullStateUpdate(client);
-			SendFullStateSnapshot(clientAddr);
+			// Resend game state: its baselines may be gone, so the next snapshot goes out in full
+			client.lastSnapshotAcked = 0;
+			SendInitialState(client);
 		}
-	} else if (!clientManager.IsKnownClient(clientAddr)) {
-		uint8_t nameLen = 0;
-		if (data.size() > 1) {
-			nameLen = static_cast<uint8_t>(data[1]);
+	} else if (auto known = clientManager.GetClientByAddr(clientAddr)) {
+		SendConnectionResponse(known.value().get()); // Our answer was lost and it is asking again
+	} else {
+		if (maxClients != 0 && clientManager.GetClients().size() >= maxClients) {
+			std::cerr << "[Host] Server full (" << maxClients << " players), ignoring REQ_CONNECTION.\n";
+			socketManager.ReleaseClient(clientAddr); // It may find room elsewhere
+			return;
 		}
+
+		PacketReader reader(data + 1, size - 1);
+		ConnectRequestMsg request;
+		Schema::Decode(reader, request);
+		const char* name = reader.Consume(request.nameLength);
 		// ensure we have enough bytes:
-		if (data.size() < 2 + nameLen) {
+		if (!reader.Ok()) {
 			std::cerr << "[Host] Invalid REQ_CONNECTION: Not enough data for name.\n";
+			socketManager.ReleaseClient(clientAddr);
 			return;
 		}
-		std::string playerName(data.begin() + 2, data.begin() + 2 + nameLen);
+		std::string playerName(name, name + request.nameLength);
 
-		clientManager.AddClient(clientAddr);
+		auto newClientOpt = clientManager.AddClient(clientAddr);
 		//EventQueue::GetInstance().Push(std::make_unique<ClientJoinedEvent>());
 
-		auto newClientOpt = clientManager.GetClientByAddr(clientAddr);
 		if (newClientOpt) {
-			socketManager.SendToClient(clientAddr, static_cast<char>(RSP_CONNECTION)); // Send ACK first
 			auto& clientRef = newClientOpt.value().get();
+			SendConnectionResponse(clientRef); // Send ACK first
 			playerNames[clientRef.clientID] = playerName;
-			//SendInitialState(newClientOpt.value().get()); // Then send current state
+			SendInitialState(clientRef); // Then the world, if the match is already on
 
 		}
+		else socketManager.ReleaseClient(clientAddr);
 	}
 }
 
-void NetworkEngine::SendTickSync() {
-	std::vector<char> packet;
-	packet.reserve(5);
-	packet.push_back(CMDID::TICK_SYNC);
-	NetworkUtils::WriteToPacket(packet, simulationTick, NetworkUtils::DATA_TYPE::DT_LONG);
-	SendToAllClients(packet);
+void NetworkEngine::SendConnectionResponse(const Client& client)
+{
+	PacketBuffer response;
+	PacketWriter writer(response);
+	writer.WriteU8(RSP_CONNECTION);
+	Schema::Encode(writer, ConnectionMsg{ client.connectionID, client.connectionNonce });
+	socketManager.SendToClient(client.address, response);
 }
 
-void NetworkEngine::HandleClientEvent(const std::vector<char>& data) {
-	if (data.size() < 2) return; // Need at least CMDID and EventType
+void NetworkEngine::SendInitialState(Client& client)
+{
+	// Before the match starts there is nothing; the StartGame roster brings the players
+	if (!g_AsteroidScene) return;
+	const EntityStore& entities = g_AsteroidScene->entities;
+	if (entities.players.Size() == 0 && entities.asteroids.Size() == 0) return;
+
+	// Its own ship, if it had one, it knows of already
+	WorldStateMsg world{ simulationTick, 0, static_cast<uint16_t>(std::min<size_t>(entities.asteroids.Size(), UINT16_MAX)) };
+	for (uint32_t i = 0; i < entities.players.Size(); ++i) {
+		if (entities.players.networkID[i] != client.playerID) ++world.players;
+	}
+
+	largeMessage.assign(1, static_cast<char>(CMDID::INITIAL_STATE_OBJECT));
+	auto append = [this](const auto& msg) {
+		const size_t at = largeMessage.size();
+		largeMessage.resize(at + Schema::WireSize<std::decay_t<decltype(msg)>>);
+		Schema::Store(largeMessage.data() + at, msg);
+	};
+	append(world);
+	for (uint32_t i = 0; i < entities.players.Size(); ++i) {
+		if (entities.players.networkID[i] != client.playerID) append(WorldPlayerMsg{ entities.players.networkID[i] });
+	}
+	const EntityPool<Asteroid>& asteroids = entities.asteroids;
+	for (uint32_t i = 0; i < world.asteroids; ++i) {
+		append(SpawnAsteroidMsg{ asteroids.networkID[i], asteroids.position[i], asteroids.scale[i], asteroids.velocity[i] });
+	}
+
+	if (SendFragmented(client, largeMessage.data(), largeMessage.size())) {
+		std::cout << "[Host] Sending Client ID: " << client.clientID << " the world: " << world.players << " player(s), "
+			<< world.asteroids << " asteroid(s), " << largeMessage.size() << " bytes." << std::endl;
+	}
+}
+
+void NetworkEngine::WriteBroadcastBody(PacketBuffer& out, EventID eventID, const char* eventData, size_t size) const {
+	PacketWriter writer(out);
+	Schema::Encode(writer, EventHeaderMsg{ eventID });
+	// Append the original event data (EventType + SpecificData)
+	writer.WriteBytes(eventData, size);
+}
+
+void NetworkEngine::HandleClientEvent(const char* data, size_t size) {
+	if (size < 2) return; // Need at least CMDID and EventType
 
 	// Optional: Verify client is known
 	// auto clientOpt = clientManager.GetClientByAddr(clientAddr);
@@ -373,157 +705,108 @@ void NetworkEngine::HandleClientEvent(const std::vector<char>& data) {
 	std::cout << "[Host] Received GAME_EVENT (Type: " << static_cast<int>(eventType) << "), Assigning ID: " << currentEventID << std::endl;
 
 	// Store event data for ACK tracking (skip CMDID)
-	PendingEventInfo info;	
-	info.eventData.assign(data.begin() + 1, data.end()); // Store EventType + SpecificData
-	info.broadcastTime = std::chrono::steady_clock::now(); // Record broadcast time
-	pendingAcks[currentEventID] = std::move(info);
-
-	// Prepare broadcast packet
-	std::vector<char> broadcastPacket;
-	broadcastPacket.push_back(CMDID::BROADCAST_EVENT);
-	EventID netEventID = htonl(currentEventID);
-	broadcastPacket.insert(broadcastPacket.end(), reinterpret_cast<char*>(&netEventID), reinterpret_cast<char*>(&netEventID) + sizeof(netEventID));
-	// Append the original event data (EventType + SpecificData)
-	broadcastPacket.insert(broadcastPacket.end(), data.begin() + 1, data.end());
-
-	std::cout << "[Host] Broadcasting Event ID: " << currentEventID << std::endl;
-	SendToAllClients(broadcastPacket); // Broadcast to everyone
+	BroadcastPendingEvent(currentEventID, PacketHandle::Copy(data + 1, size - 1)); // Store EventType + SpecificData
 }
 
-void NetworkEngine::HandleHeartbeat(const sockaddr_in& clientAddr) {
-	auto clientOpt = clientManager.GetClientByAddr(clientAddr);
-	if (clientOpt) {
-		//std::cout << "[Host] Received Heartbeat from Client ID: " << clientOpt.value().get().clientID << std::endl;
-		clientOpt.value().get().lastHeartbeatTime = std::chrono::steady_clock::now();
-		
-		// Keep the client marked as connected
-		if (!clientOpt.value().get().isConnected) {
-			std::cout << "[Host] Reconnected Client ID: " << clientOpt.value().get().clientID << std::endl;
-			clientOpt.value().get().isConnected = true;
-			
-		}
-		
-	}
-	else {
-		std::cerr << "[Host] Received Heartbeat from unknown client." << std::endl;
-		         // Optionally send a disconnect or ignore
-			
+void NetworkEngine::HandleHeartbeat(Client& client, TimePoint receivedTime) {
+	//std::cout << "[Host] Received Heartbeat from Client ID: " << client.clientID << std::endl;
+	client.lastHeartbeatTime = std::max(client.lastHeartbeatTime, receivedTime);
+	
+	// Keep the client marked as connected
+	if (!client.isConnected) {
+		std::cout << "[Host] Reconnected Client ID: " << client.clientID << std::endl;
+		client.isConnected = true;
 	}
 }
 
-void NetworkEngine::HandleAckEvent(const std::vector<char>& data, const sockaddr_in& clientAddr) {
-	if (data.size() < 1 + sizeof(EventID)) return; // Need CMDID + EventID
-
-	EventID eventID;
-	std::memcpy(&eventID, &data[1], sizeof(EventID));
-	eventID = ntohl(eventID);
+void NetworkEngine::HandleReliableAck(const ReliableAckMsg& ack, Client& client) {
+	client.reliable.Acknowledge(ack, [this](const ReliableSender::Entry& entry) {
+		if (entry.isBroadcast) OnEventDelivered(entry.eventID);
+	});
+}
 
-	auto clientOpt = clientManager.GetClientByAddr(clientAddr);
-	if (!clientOpt) {
-		std::cerr << "[Host] Received ACK for event " << eventID << " from unknown client." << std::endl;
-		return;
+void NetworkEngine::CommitEvent(PendingEventInfo& pendingInfo) {
+	const EventID eventID = pendingInfo.eventID;
+	pendingInfo.isPending = false;
+
+	// Prepare commit packet
+	CommitEventMsg commit;
+	commit.eventID = eventID;
+	commit.networkID = nextID++;
+
+	PacketBuffer commitBody;
+	PacketWriter writer(commitBody);
+	Schema::Encode(writer, commit);
+	// Send commit command to the clients that have the event, reliably, since they hold it until then
+	for (auto& client : clientManager.GetClientsNonConst()) {
+		if (!client.isConnected) continue;
+		if (std::find(pendingInfo.recipients.begin(), pendingInfo.recipients.end(), client.clientID) == pendingInfo.recipients.end()) continue;
+		SendReliable(client, COMMIT_EVENT, commitBody, eventID, false);
 	}
-	ClientID senderClientID = clientOpt.value().get().clientID;
 
+	// Process the event locally
+	ProcessHostEvent(eventID, commit.networkID, *pendingInfo.eventData);
+	pendingInfo.eventData.Reset();
+}
 
-	auto it = pendingAcks.find(eventID);
-	if (it == pendingAcks.end()) {
-		std::cerr << "[Host] Received ACK for unknown or already committed Event ID: " << eventID << " from Client " << senderClientID << std::endl;
-		return; // Ignore ACK for unknown/committed event
-	}
+void NetworkEngine::ProcessHostEvent(EventID eventID, NetworkID networkID, const PacketBuffer& eventData) {
+	PacketReader eventReader(eventData);
+	EventType eventType = static_cast<EventType>(eventReader.ReadU8());
+	switch (eventType) {
+	case EventType::FireBullet: {
+		FireBulletMsg fire;
+		if (!Schema::Decode(eventReader, fire)) {
+			std::cerr << "[Host] Insufficient data for FireBulletEvent ID: " << eventID << std::endl;
+			break;
+		}
 
-	// Record the ACK
-	auto& pendingInfo = it->second;
-	auto insertResult = pendingInfo.acksReceived.insert(senderClientID);
+		auto it2 = std::make_unique<FireBulletEvent>(fire.position, fire.rotation, fire.ownerId);
+		it2->id = networkID;
 
-	if (insertResult.second) { // Check if insert actually happened (avoid double counting)
-		std::cout 
-			<< "[Host] Received ACK for Event ID: " << eventID << " from Client " << senderClientID
-			<< " (" << pendingInfo.acksReceived.size() << "/" << clientManager.GetClients().size() << ")" 
-			<< std::endl;
+		EventQueue::GetInstance().Push(std::move(it2));
+		break;
 	}
-
-	// Check if all connected clients have ACKed
-	if (pendingInfo.acksReceived.size() >= GetNumConnectedClients()) {
-		std::cout << "[Host] All ACKs received for Event ID: " << eventID << ". Committing." << std::endl;
-
-		// Prepare commit packet
-		std::vector<char> commitPacket;
-		commitPacket.push_back(CMDID::COMMIT_EVENT);
-		EventID netEventID = htonl(eventID);
-		NetworkID newNetworkID = htonl(nextID++);
-		commitPacket.insert(commitPacket.end(), reinterpret_cast<char*>(&netEventID), reinterpret_cast<char*>(&netEventID) + sizeof(netEventID));
-		commitPacket.insert(commitPacket.end(), reinterpret_cast<char*>(&newNetworkID), reinterpret_cast<char*>(&newNetworkID) + sizeof(newNetworkID));
-		// Send commit command to all clients
-		SendToAllClients(commitPacket);
-
-
-		// Process the event locally
-		EventType eventType = static_cast<EventType>(pendingInfo.eventData[0]);
-		std::vector<char>& eventData = pendingInfo.eventData;
-		size_t offset = 1; // Skip the EventType byte
-		switch (eventType) {
-		case EventType::FireBullet: {
-			if (eventData.size() < offset + (sizeof(float) * 3) + sizeof(float) + sizeof(uint32_t)) { // Basic size check for vec3 + float + uint32
-				std::cerr << "[Host] Insufficient data for FireBulletEvent ID: " << eventID << std::endl;
-				break;
-			}
-			glm::vec3 pos;
-			float rot;
-			uint32_t ownerId;
-			NetworkUtils::ReadVec3(eventData.data(), offset, pos); offset += 12; // 3 * 4 bytes for vec3
-			uint32_t tempRot;
-			NetworkUtils::ReadFromPacket(eventData.data(), offset, tempRot, NetworkUtils::DATA_TYPE::DT_LONG); offset += 4;
-			rot = NetworkUtils::NetworkToFloat(tempRot);
-			uint32_t tempOwner;
-			NetworkUtils::ReadFromPacket(eventData.data(), offset, tempOwner, NetworkUtils::DATA_TYPE::DT_LONG); offset += 4;
-			ownerId = tempOwner;
-
-			auto it2 = std::make_unique<FireBulletEvent>(pos, rot, ownerId);
-			it2->id = ntohl(newNetworkID);
-
-			EventQueue::GetInstance().Push(std::move(it2));
-			break;
-		}
-		case EventType::Collision: {
-			NetworkID a, b;
-			std::memcpy(&a, &eventData[offset], sizeof(NetworkID)); offset += sizeof(NetworkID);
-			std::memcpy(&b, &eventData[offset], sizeof(NetworkID)); offset += sizeof(NetworkID);
-			a = ntohl(a);
-			b = ntohl(b);
-			auto it2 = std::make_unique<CollisionEvent>(a, b);
-			it2->id = ntohl(newNetworkID);
-			EventQueue::GetInstance().Push(std::move(it2));
-			break;
-		}
-		case EventType::StartGame: {
-			
-			
-			
-			break;
-		}
-		default: {
-			std::cerr << "[Host] Cannot process unknown committed event type: " << static_cast<int>(eventType) << std::endl;
+	case EventType::Collision: {
+		CollisionMsg collision;
+		if (!Schema::Decode(eventReader, collision)) {
+			std::cerr << "[Host] Insufficient data for CollisionEvent ID: " << eventID << std::endl;
 			break;
 		}
-			
-		} // end switch
-
-
-		// Remove event from pending list
-		pendingAcks.erase(it);
+		auto it2 = std::make_unique<CollisionEvent>(collision.idA, collision.idB, collision.scorer);
+		it2->id = networkID;
+		EventQueue::GetInstance().Push(std::move(it2));
+		break;
 	}
+	case EventType::StartGame: {
+		
+		
+		
+		break;
+	}
+	default: {
+		std::cerr << "[Host] Cannot process unknown committed event type: " << static_cast<int>(eventType) << std::endl;
+		break;
+	}
+		
+	} // end switch
 }
 
 //Client-Side Handling
-void NetworkEngine::HandleBroadcastEvent(const std::vector<char>& data) {
-	if (data.size() < 1 + sizeof(EventID) + 1) return; // CMDID + EventID + EventType
+void NetworkEngine::MarkAckPending() {
+	if (!ackPending) ackPendingSince = std::chrono::steady_clock::now();
+	ackPending = true;
+}
 
-	EventID eventID;
-	std::memcpy(&eventID, &data[1], sizeof(EventID));
-	eventID = ntohl(eventID);
+void NetworkEngine::HandleBroadcastEvent(const char* data, size_t size) {
+	PacketReader reader(data + 1, size - 1);
+	ReliableHeaderMsg reliable;
+	EventHeaderMsg header;
+	Schema::Decode(reader, reliable);
+	Schema::Decode(reader, header);
+	EventType eventType = static_cast<EventType>(reader.ReadU8());
+	if (!reader.Ok()) return; // CMDID + Sequence + EventID + EventType
 
-	EventType eventType = static_cast<EventType>(data[1 + sizeof(EventID)]);
+	EventID eventID = header.eventID;
 
 	if (pendingClientEvents.find(eventID) != pendingClientEvents.end()) {
 		std::cerr << "[Client] Received duplicate BROADCAST_EVENT for ID: " << eventID << std::endl;
@@ -532,30 +815,20 @@ void NetworkEngine::HandleBroadcastEvent(const std::vector<char>& data) {
 		std::cout << "[Client] Received BROADCAST_EVENT (Type: " << static_cast<int>(eventType) << ") ID: " << eventID << std::endl;
 		// Store the event data (excluding CMDID and EventID) for later processing
 		// Start copying after the EventID
-		pendingClientEvents[eventID].assign(data.begin() + 1 + sizeof(EventID), data.end());
+		const size_t eventStart = 1 + Schema::WireSize<ReliableHeaderMsg> + Schema::WireSize<EventHeaderMsg>;
+		pendingClientEvents[eventID] = PacketHandle::Copy(data + eventStart, size - eventStart);
 	}
-
-	// Send ACK back to host
-	std::vector<char> ackPacket;
-	ackPacket.push_back(CMDID::ACK_EVENT);
-	EventID netEventID = htonl(eventID);
-	ackPacket.insert(ackPacket.end(), reinterpret_cast<char*>(&netEventID), reinterpret_cast<char*>(&netEventID) + sizeof(netEventID));
-	socketManager.SendToHost(ackPacket);
-
-	std::cout << "[Client] Sent ACK for Event ID: " << eventID << std::endl;
-
 }
 
-void NetworkEngine::HandleCommitEvent(const std::vector<char>& data) {
-	if (data.size() < 1 + sizeof(EventID)) return; // CMDID + EventID
-
-	EventID eventID;
-	std::memcpy(&eventID, &data[1], sizeof(EventID));
-	eventID = ntohl(eventID);
+void NetworkEngine::HandleCommitEvent(const char* data, size_t size) {
+	PacketReader reader(data + 1, size - 1);
+	ReliableHeaderMsg reliable;
+	CommitEventMsg commit;
+	Schema::Decode(reader, reliable);
+	if (!Schema::Decode(reader, commit)) return; // CMDID + Sequence + EventID + NetworkID
 
-	NetworkID networkID;
-	std::memcpy(&networkID, &data[1 + sizeof(EventID)], sizeof(NetworkID));
-	networkID = ntohl(networkID);
+	EventID eventID = commit.eventID;
+	NetworkID networkID = commit.networkID;
 
 	std::cout << "[Client] Received COMMIT_EVENT for ID: " << eventID << std::endl;
 
@@ -567,14 +840,22 @@ void NetworkEngine::HandleCommitEvent(const std::vector<char>& data) {
 	}
 
 	// Retrieve the stored event data
-	const std::vector<char>& eventData = it->second;
-	if (eventData.empty()) {
+	const PacketBuffer& eventData = *it->second;
+	if (eventData.size == 0) {
 		std::cerr << "[Client] Stored event data for ID: " << eventID << " is empty." << std::endl;
 		pendingClientEvents.erase(it);
 		return;
 	}
 
-	EventType eventType = static_cast<EventType>(eventData[0]);
+	ProcessClientEvent(eventID, networkID, eventData);
+
+	// Remove the processed event from the pending map
+	pendingClientEvents.erase(it);
+}
+
+void NetworkEngine::ProcessClientEvent(EventID eventID, NetworkID networkID, const PacketBuffer& eventData) {
+	PacketReader eventReader(eventData);
+	EventType eventType = static_cast<EventType>(eventReader.ReadU8());
 	std::cout << "[Client] Processing Event ID: " << eventID << " (Type: " << static_cast<int>(eventType) << ")" << std::endl;
 
 	// Reconstruct and push the event to the local queue
@@ -583,43 +864,34 @@ void NetworkEngine::HandleCommitEvent(const std::vector<char>& data) {
 
 	switch (eventType) {
 	case EventType::FireBullet: {
-		int offset = 1;
-		if (eventData.size() < offset + (sizeof(float) * 3) + sizeof(float) + sizeof(uint32_t)) { // Basic size check for vec3 + float + uint32
+		FireBulletMsg fire;
+		if (!Schema::Decode(eventReader, fire)) {
 			std::cerr << "[Client] Insufficient data for FireBulletEvent ID: " << eventID << std::endl;
 			break;
 		}
-		glm::vec3 pos;
-		float rot;
-		uint32_t ownerId;
-		NetworkUtils::ReadVec3(eventData.data(), offset, pos); offset += 12; // 3 * 4 bytes for vec3
-		uint32_t tempRot;
-		NetworkUtils::ReadFromPacket(eventData.data(), offset, tempRot, NetworkUtils::DATA_TYPE::DT_LONG); offset += 4;
-		rot = NetworkUtils::NetworkToFloat(tempRot);
-		uint32_t tempOwner;
-		NetworkUtils::ReadFromPacket(eventData.data(), offset, tempOwner, NetworkUtils::DATA_TYPE::DT_LONG); offset += 4;
-		ownerId = tempOwner;
-
-		auto it2 = std::make_unique<FireBulletEvent>(pos, rot, ownerId);
+
+		auto it2 = std::make_unique<FireBulletEvent>(fire.position, fire.rotation, fire.ownerId);
 		it2->id = networkID;
 
 		EventQueue::GetInstance().Push(std::move(it2));
 		break;
 	}
 	case EventType::StartGame: {
-		int offset = 2;
-		for (uint8_t i = 0; i < eventData[1]; ++i) {
-			uint8_t eventTypeData = eventData[offset++];
-			NetworkID networkID;
-			std::memcpy(&networkID, &eventData[offset], sizeof(networkID));
-			networkID = ntohl(networkID);
-			offset += sizeof(networkID);
-
-			switch (eventTypeData) {
+		RosterHeaderMsg roster;
+		Schema::Decode(eventReader, roster);
+		for (uint8_t i = 0; i < roster.count; ++i) {
+			RosterEntryMsg entry;
+			if (!Schema::Decode(eventReader, entry)) {
+				std::cerr << "[Client] StartGame roster for Event ID: " << eventID << " is truncated." << std::endl;
+				break;
+			}
+
+			switch (entry.type) {
 			case static_cast<uint8_t>(EventType::SpawnPlayer):
-				EventQueue::GetInstance().Push(std::make_unique<SpawnPlayerEvent>(networkID));
+				EventQueue::GetInstance().Push(std::make_unique<SpawnPlayerEvent>(entry.networkID));
 				break;
 			case static_cast<uint8_t>(EventType::PlayerJoined):
-				EventQueue::GetInstance().Push(std::make_unique<PlayerJoinedEvent>(networkID));
+				EventQueue::GetInstance().Push(std::make_unique<PlayerJoinedEvent>(entry.networkID));
 				break;
 			}
 		}
@@ -703,22 +975,27 @@ void NetworkEngine::HandleCommitEvent(const std::vector<char>& data) {
 		//break;
 	}
 	case EventType::SpawnAsteroid: {
+		// The asteroid keeps the ID the host gave it when spawning, not the commit's
+		SpawnAsteroidMsg spawn;
+		if (!Schema::Decode(eventReader, spawn)) {
+			std::cerr << "[Client] Insufficient data for SpawnAsteroidEvent ID: " << eventID << std::endl;
+			break;
+		}
 
-		std::memcpy(&networkID, &eventData[1], sizeof(networkID));
-		networkID = ntohl(networkID);
-
-		EventQueue::GetInstance().Push(std::make_unique<SpawnAsteroidEvent>(networkID, eventData));	
+		EventQueue::GetInstance().Push(std::make_unique<SpawnAsteroidEvent>(spawn));	
 		break;
 	}
 	case EventType::Collision: {
- 		int offset = 1;
-		NetworkID idA,idB;
-		std::memcpy(&idA, &eventData[offset], sizeof(idA));
-		std::memcpy(&idB, &eventData[offset + sizeof(idA)], sizeof(idB));
-		idA = ntohl(idA);
-		idB = ntohl(idB);
-
-		auto it2 = std::make_unique<CollisionEvent>(idA, idB);
+		CollisionMsg collision;
+		if (!Schema::Decode(eventReader, collision)) {
+			std::cerr << "[Client] Insufficient data for CollisionEvent ID: " << eventID << std::endl;
+			break;
+		}
+
+		recentlyDestroyed[nextDestroyed++ % recentlyDestroyed.size()] = collision.idA;
+		recentlyDestroyed[nextDestroyed++ % recentlyDestroyed.size()] = collision.idB;
+
+		auto it2 = std::make_unique<CollisionEvent>(collision.idA, collision.idB, collision.scorer);
 		it2->id = networkID;
 		EventQueue::GetInstance().Push(std::move(it2));
 		break;
@@ -729,58 +1006,364 @@ void NetworkEngine::HandleCommitEvent(const std::vector<char>& data) {
 		std::cerr << "[Client] Cannot process unknown committed event type: " << static_cast<int>(eventType) << std::endl;
 		break;
 	}
+}
 
+void NetworkEngine::HandleScheduledEvent(const char* data, size_t size) {
+	PacketReader reader(data + 1, size - 1);
+	ReliableHeaderMsg reliable;
+	ScheduledEventMsg header;
+	Schema::Decode(reader, reliable);
+	Schema::Decode(reader, header);
+	if (!reader.Ok() || reader.Remaining() == 0) return; // CMDID + Sequence + header + EventType
+
+	ScheduledEvent event{ header.executeTick, header.eventID, header.networkID, PacketHandle::Copy(reader.Current(), reader.Remaining()) };
+	if (scheduledEvents.Insert(std::move(event))) return;
+
+	// Its tick has passed here already; running it now keeps us as close as we can get
+	std::cerr << "[Client] Scheduled Event ID: " << header.eventID << " arrived "
+		<< static_cast<int32_t>(GetHostTick() - header.executeTick) << " tick(s) late." << std::endl;
+	ProcessClientEvent(header.eventID, header.networkID, *event.eventData);
+}
 
-	// Remove the processed event from the pending map
-	pendingClientEvents.erase(it);
+void NetworkEngine::HandleFragment(const char* data, size_t size, TimePoint receivedTime) {
+	PacketReader reader(data + 1, size - 1);
+	ReliableHeaderMsg reliable;
+	FragmentHeaderMsg header;
+	Schema::Decode(reader, reliable);
+	if (!Schema::Decode(reader, header)) return;
+
+	const std::vector<char>* message = fragments.Add(header, reader.Current(), reader.Remaining(), receivedTime);
+	if (!message || message->empty()) return;
+
+	// Handled as if it had come in one piece; it is never itself on the reliable stream, nor another fragment
+	const CMDID command = static_cast<CMDID>((*message)[0]);
+	if (IsReliable(command) || command == BUNDLE) return;
+	HandleHostMessage(message->data(), message->size(), receivedTime);
 }
 
+void NetworkEngine::HandleInitialState(const char* data, size_t size) {
+	PacketReader reader(data + 1, size - 1);
+	WorldStateMsg world;
+	if (!Schema::Decode(reader, world) || !g_AsteroidScene) return;
+
+	// What we know of already is left to the snapshots, and what an event destroyed after the host sent this
+	// stays destroyed
+	const EntityStore& entities = g_AsteroidScene->entities;
+	auto isKnown = [&](NetworkID networkID) {
+		EntityType type;
+		uint32_t index;
+		return entities.Find(networkID, type, index) ||
+			std::find(recentlyDestroyed.begin(), recentlyDestroyed.end(), networkID) != recentlyDestroyed.end();
+	};
+
+	size_t spawned = 0;
+	for (uint16_t i = 0; i < world.players; ++i) {
+		WorldPlayerMsg player;
+		if (!Schema::Decode(reader, player)) break;
+		if (isKnown(player.networkID)) continue;
+		EventQueue::GetInstance().Push(std::make_unique<PlayerJoinedEvent>(player.networkID));
+		++spawned;
+	}
+	for (uint16_t i = 0; i < world.asteroids; ++i) {
+		SpawnAsteroidMsg asteroid;
+		if (!Schema::Decode(reader, asteroid)) break;
+		if (isKnown(asteroid.networkID)) continue;
+		EventQueue::GetInstance().Push(std::make_unique<SpawnAsteroidEvent>(asteroid));
+		++spawned;
+	}
+	if (!reader.Ok()) std::cerr << "[Client] World state from tick " << world.tick << " is truncated." << std::endl;
+	std::cout << "[Client] Received the world as of tick " << world.tick << ", " << spawned << " object(s) new to us." << std::endl;
+}
 
-void NetworkEngine::ProcessTickSync(Tick&, Tick&) 
-{
+void NetworkEngine::HandleClockPing(const char* data, size_t size, Client& client) {
+	PacketReader reader(data + 1, size - 1);
+	ClockPingMsg ping;
+	if (!Schema::Decode(reader, ping)) return;
 
+	// Answered at once, so the client's round trip is the network's
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastTickTime).count();
+	const double phase = std::clamp(elapsed / fixedDeltaTime, 0.0, 0.999);
+	client.clock.OnPing(ping, simulationTick, phase, fixedDeltaTime);
+	if (ioThreaded) return; // The I/O thread has answered it
+
+	PacketBuffer pong;
+	WriteClockPong(pong, ping, simulationTick, phase);
+	SendBudgeted(client, pong);
+}
+
+void NetworkEngine::WriteClockPong(PacketBuffer& out, const ClockPingMsg& ping, Tick tick, double phase) const {
+	PacketWriter writer(out);
+	writer.WriteU8(CMDID::CLOCK_PONG);
+	Schema::Encode(writer, ClockPongMsg{ ping.clientTime, tick, static_cast<float>(phase) });
+}
+
+void NetworkEngine::StartIoThread(bool host) {
+	ioThreaded = useIoThread;
+	std::unique_ptr<Transport> impaired;
+	if (impairment.IsEnabled()) {
+		impaired = std::make_unique<ImpairedTransport>(Transport::Create(), impairment);
+	}
+	if (!ioThreaded) {
+		if (impaired) {
+			socketManager.SetTransport(std::move(impaired));
+			socketManager.GetTransport().Startup();
+		}
+		return;
+	}
+
+	ThreadedTransport::IoHandler handler;
+	if (host) {
+		handler.receive = [this](Datagram& datagram, Transport& socket) { return HostIoReceive(datagram, socket); };
+	}
+	else {
+		ioAckDue = false;
+		handler.receive = [this](Datagram& datagram, Transport& socket) { return ClientIoReceive(datagram, socket); };
+		handler.poll = [this](Transport& socket) { ClientIoPoll(socket); };
+	}
+	socketManager.SetTransport(std::make_unique<ThreadedTransport>(impaired ? std::move(impaired) : Transport::Create(), std::move(handler)));
+	socketManager.GetTransport().Startup();
 }
 
-void NetworkEngine::SendFullStateSnapshot(const sockaddr_in& clientAddr) {
-	std::vector<char> packet;
-	packet.push_back(CMDID::FULL_STATE_SNAPSHOT);
+bool NetworkEngine::HostIoReceive(Datagram& datagram, Transport& socket) {
+	if (datagram.size < 1 + HOST_TRAILER_SIZE || static_cast<CMDID>(datagram.data[0]) == REQ_CONNECTION) return false;
+
+	// The tick and how far into it we are, from what AdvanceTick last published
+	const uint64_t published = publishedTick.load(std::memory_order_acquire);
+	const uint32_t now = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+	const double elapsed = static_cast<double>(now - static_cast<uint32_t>(published)) / 1.0e6;
+	const double phase = std::clamp(elapsed / fixedDeltaTime, 0.0, 0.999);
+
+	ForEachMessage(datagram.data, datagram.size - HOST_TRAILER_SIZE, [&](const char* message, size_t size) {
+		if (static_cast<CMDID>(message[0]) != CLOCK_PING) return;
 
-	size_t activeCount = std::count_if(g_AsteroidScene->gameObjects.begin(), g_AsteroidScene->gameObjects.end(), [](const std::unique_ptr<GameObject>& obj) {
-		return obj->isActive;
+		PacketReader reader(message + 1, size - 1);
+		ClockPingMsg ping;
+		if (!Schema::Decode(reader, ping)) return;
+
+		PacketBuffer pong;
+		WriteClockPong(pong, ping, static_cast<Tick>(published >> 32), phase);
+		socket.SendTo(datagram.addr, pong.data, pong.size);
 	});
+	return false; // The simulation still takes the client's clock estimates and acks from it
+}
 
-	NetworkUtils::WriteToPacket(packet, activeCount, NetworkUtils::DT_LONG);
+bool NetworkEngine::ClientIoReceive(Datagram& datagram, Transport&) {
+	if (datagram.size == 0) return false;
 
-	for (auto& go : g_AsteroidScene->gameObjects) {
-		if (go->isActive) {
-			if (go->type == GameObject::GO_BULLET) continue;
-			packet.push_back(static_cast<char>(go->type));
-			auto temp = dynamic_cast<NetworkObject*>(go.get())->Serialize();
-			packet.insert(packet.end(), temp.begin(), temp.end());
+	// Acked at the end of this pass. A repeat is blanked to UNKNOWN, so the simulation skips it; a datagram
+	// with nothing else in it goes no further.
+	bool forward = false;
+	ForEachMessage(datagram.data, datagram.size, [&](char* message, size_t size) {
+		const CMDID command = static_cast<CMDID>(message[0]);
+		if (!IsReliable(command)) {
+			forward = true;
+			return;
 		}
-	}
+		ioAckDue = true;
+		if (AcceptReliable(message, size)) forward = true;
+		else message[0] = static_cast<char>(UNKNOWN);
+	});
+	return !forward;
+}
+
+void NetworkEngine::ClientIoPoll(Transport& socket) {
+	// connectionID is stored once the handshake is done, after the server address it is sent to
+	if (connectionID.load(std::memory_order_acquire) == 0) return;
+
+	// Heartbeats only when the simulation has not sent anything for a while either
+	const auto now = std::chrono::steady_clock::now();
+	CMDID command;
+	if (ioAckDue) command = ACK_EVENT;
+	else if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSentToHost.load()).count() >= HEARTBEAT_INTERVAL_MS) command = HEARTBEAT;
+	else return;
+
+	PacketBuffer packet;
+	PacketWriter writer(packet);
+	writer.WriteU8(command);
+	WriteHostTrailer(writer);
+	socket.SendTo(socketManager.serverInfo.address, packet.data, packet.size);
+	ioAckDue = false;
+	lastSentToHost = now;
+}
+
+bool NetworkEngine::AcceptReliable(const char* data, size_t size) {
+	PacketReader reader(data + 1, size - 1);
+	ReliableHeaderMsg reliable;
+	if (!Schema::Decode(reader, reliable)) return false;
+	return reliableReceiver.Accept(reliable.sequence);
+}
 
-	socketManager.SendToClient(clientAddr, packet);
+void NetworkEngine::WriteHostTrailer(PacketWriter& writer) const {
+	Schema::Encode(writer, ConnectionMsg{ connectionID.load(std::memory_order_relaxed), connectionNonce.load(std::memory_order_relaxed) });
+	Schema::Encode(writer, reliableReceiver.GetAck());
 }
 
-void NetworkEngine::HandleFullStateSnapshot(const std::vector<char>& data) {
-	size_t offset = 1;
-	uint32_t totalObjects;
-	NetworkUtils::ReadFromPacket(data.data(), offset, totalObjects, NetworkUtils::DT_LONG);
-	offset += sizeof(totalObjects);
+void NetworkEngine::HandleClockPong(const char* data, size_t size, TimePoint receivedTime) {
+	PacketReader reader(data + 1, size - 1);
+	ClockPongMsg pong;
+	if (!Schema::Decode(reader, pong)) return;
 
-	for (uint32_t i = 0; i < totalObjects; i++) {
-		char objType = data[offset++];
+	// Timed from when it came off the socket, not from when this frame got round to it
+	const bool wasSynced = clock.IsSynced();
+	clock.OnPong(pong, std::chrono::duration<double>(receivedTime.time_since_epoch()).count(), fixedDeltaTime);
+	if (!wasSynced && clock.IsSynced()) std::cout << "[Client] Clock synced, RTT " << clock.GetRtt() * 1000.0 << " ms." << std::endl;
+}
+
+void NetworkEngine::UpdateClock() {
+	const double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
 
-		uint32_t netID;
-		NetworkUtils::ReadFromPacket(data.data(), offset, netID, NetworkUtils::DT_LONG);
-		offset += sizeof(netID);
+	ClockPingMsg ping;
+	if (clock.NextPing(now, localTick, ping)) {
+		PacketBuffer packet;
+		PacketWriter writer(packet);
+		writer.WriteU8(CMDID::CLOCK_PING);
+		Schema::Encode(writer, ping);
+		SendToHost(packet);
+	}
 
-		switch (objType) {
+	const uint32_t snaps = clock.GetSnaps();
+	clock.Steer(now, localTick);
+	if (clock.GetSnaps() != snaps && snaps != 0) {
+		std::cerr << "[Client] Tick clock was too far from the host's to slew, jumped to " << localTick << "." << std::endl;
+	}
+}
 
+void NetworkEngine::SendSnapshots() {
+	interest.Capture(g_AsteroidScene->entities, localTick);
 
+	for (auto& client : clientManager.GetClientsNonConst()) {
+		if (!client.isConnected) continue;
+
+		// Whatever budget the reliable messages left, up to one packet; no room for an empty snapshot skips a round
+		constexpr size_t overhead = 1 + Schema::WireSize<SnapshotHeaderMsg> + Schema::WireSize<PlayerStateAckMsg> + 2;
+		const double available = std::min(client.bandwidth.Available(), static_cast<double>(MAX_PACKET_SIZE));
+		if (available < static_cast<double>(overhead)) {
+			++client.sendStats.snapshotsSkipped;
+			continue;
+		}
+		const size_t budgetBits = (static_cast<size_t>(available) - overhead) * 8;
+
+		const SnapshotSequence sequence = ++client.lastSnapshotSent;
+		Snapshot& snapshot = client.sentSnapshots.Insert(sequence, simulationTick);
+
+		// Falls back to a full snapshot once the acked baseline has dropped out of the history
+		const Snapshot* baseline = client.sentSnapshots.Find(client.lastSnapshotAcked);
+		interest.Select(client, baseline, snapshot, budgetBits);
+
+		// The client's own ship is left out of the snapshot; it gets the unquantized result of its commands instead
+		PlayerStateAckMsg own;
+		EntityType type;
+		uint32_t index;
+		const PlayerPool& players = g_AsteroidScene->entities.players;
+		if (g_AsteroidScene->entities.Find(client.playerID, type, index) && type == ENTITY_PLAYER) {
+			own.inputTick = client.inputs.GetLastProcessed();
+			own.position = players.position[index];
+			own.rotation = players.rotation[index];
+			own.velocity = players.velocity[index];
 		}
+
+		PacketBuffer packet;
+		PacketWriter writer(packet);
+		writer.WriteU8(CMDID::SNAPSHOT);
+		Schema::Encode(writer, SnapshotHeaderMsg{ sequence, baseline ? baseline->sequence : 0, simulationTick });
+		Schema::Encode(writer, own);
+		if (!SnapshotEncoding::EncodeDelta(writer, baseline, snapshot)) {
+			std::cerr << "[Host] Snapshot " << sequence << " for Client " << client.clientID << " does not fit in one packet." << std::endl;
+			continue;
+		}
+		SendBudgeted(client, packet);
+		++client.sendStats.snapshotsSent;
+	}
+}
+
+void NetworkEngine::HandlePlayerInput(const char* data, size_t size, Client& client) {
+	PacketReader reader(data + 1, size - 1);
+	PlayerInputMsg input;
+	if (!Schema::Decode(reader, input) || reader.Remaining() < input.count) return;
+
+	// Nothing for ticks the client cannot have reached yet, or running its commands faster than real time would
+	// move its ship faster. Until its clock is known there is nothing to hold them against; it resends them.
+	if (!client.clock.synced) return;
+	const Tick clientTick = simulationTick + static_cast<Tick>(std::lround(client.clock.offsetTicks));
+	client.inputs.Receive(input.newestTick, reinterpret_cast<const uint8_t*>(reader.Current()), input.count,
+		clientTick + PlayerInputQueue::MAX_LEAD_TICKS);
+}
+
+bool NetworkEngine::NextPlayerInput(NetworkID playerID, uint8_t& buttons) {
+	auto client = clientManager.GetClientByPlayer(playerID);
+	return client && client->get().isConnected && client->get().inputs.Next(simulationTick, buttons);
+}
+
+bool NetworkEngine::GetClientClock(NetworkID playerID, ClientClock& result) const {
+	auto client = clientManager.GetClientByPlayer(playerID);
+	if (!client) return false;
+	result = client->get().clock;
+	return result.synced;
+}
+
+double NetworkEngine::GetClientViewDelay(NetworkID playerID) const {
+	auto found = clientManager.GetClientByPlayer(playerID);
+	if (!found) return 0.0;
+	const Client& client = *found;
+	if (!client.isConnected || !client.clock.synced) return 0.0;
+	// A snapshot reaches it half a round trip after we send it, and is shown interpolationDelay later still
+	return client.clock.rtt / 2.0 / fixedDeltaTime + client.interpolationDelay;
+}
+
+void NetworkEngine::HandleSnapshotAck(const char* data, size_t size, Client& client) {
+	PacketReader reader(data + 1, size - 1);
+	SnapshotAckMsg ack;
+	if (!Schema::Decode(reader, ack)) return;
+
+	const double delay = static_cast<double>(ack.interpolationDelay);
+	client.interpolationDelay = delay > 0.0 ? std::min(delay, InterpolationClock::MAX_DELAY_TICKS) : 0.0;
+
+	// Acks can arrive out of order, only ever move the baseline forward
+	if (ack.sequence > client.lastSnapshotAcked && ack.sequence <= client.lastSnapshotSent) {
+		client.lastSnapshotAcked = ack.sequence;
+	}
+}
+
+void NetworkEngine::HandleSnapshot(const char* data, size_t size, TimePoint receivedTime) {
+	PacketReader reader(data + 1, size - 1);
+	SnapshotHeaderMsg header;
+	PlayerStateAckMsg own;
+	if (!Schema::Decode(reader, header) || !Schema::Decode(reader, own)) return;
+	if (header.sequence <= lastReceivedSnapshot) return; // Late or duplicate, a newer one is already applied
+
+	const Snapshot* baseline = receivedSnapshots.Find(header.baseline);
+	if (header.baseline != 0 && !baseline) {
+		std::cerr << "[Client] Dropping snapshot " << header.sequence << ", baseline " << header.baseline << " is gone." << std::endl;
+		return;
+	}
+
+	Snapshot& snapshot = receivedSnapshots.Insert(header.sequence, header.tick);
+	if (!SnapshotEncoding::DecodeDelta(reader, baseline, snapshot)) {
+		std::cerr << "[Client] Malformed snapshot " << header.sequence << "." << std::endl;
+		snapshot.sequence = 0;
+		return;
+	}
+	lastReceivedSnapshot = header.sequence;
+	// When it came off the socket, not when this frame got round to it, or the frame's own timing shows up as jitter
+	interpolation.OnSnapshot(header.tick, std::chrono::duration<double>(receivedTime.time_since_epoch()).count(), fixedDeltaTime);
+
+	PacketBuffer ackPacket;
+	PacketWriter writer(ackPacket);
+	writer.WriteU8(CMDID::SNAPSHOT_ACK);
+	Schema::Encode(writer, SnapshotAckMsg{ header.sequence, static_cast<float>(interpolation.GetDelay()) });
+	SendToHost(ackPacket);
+
+	// Objects are still created and destroyed by lockstep events; the snapshot only moves the ones we know.
+	// Entries the host left as they were in the baseline may be older than what we already applied.
+	if (!g_AsteroidScene) return;
+	for (const auto& state : snapshot.states) {
+		const StateEncoding::QuantizedState* previous = baseline ? baseline->Find(state.networkID) : nullptr;
+		if (previous && *previous == state) continue;
+
+		g_AsteroidScene->ApplyState(StateEncoding::Dequantize(state, snapshot.tick));
 	}
+	g_AsteroidScene->ReconcileLocalPlayer(own);
 }
 
 size_t NetworkEngine::GetNumConnectedClients() const
@@ -798,8 +1381,6 @@ void NetworkEngine::CheckTimeoutsAndHeartbeats() {
 	if (!isHosting) return;
 	
 	auto now = std::chrono::steady_clock::now();
-	std::vector<sockaddr_in> clientsToDisconnect;
-	std::vector<EventID> eventsToTimeout;
 			
 	//Check Client Heartbeats
 	for (auto& client : clientManager.GetClientsNonConst()) { // Need non-const access
@@ -808,8 +1389,7 @@ void NetworkEngine::CheckTimeoutsAndHeartbeats() {
 		auto timeSinceHeartbeat = std::chrono::duration_cast<std::chrono::milliseconds>(now - client.lastHeartbeatTime).count();
 		if (timeSinceHeartbeat > CLIENT_TIMEOUT_MS) {
 			std::cerr << "[Host] Client ID: " << client.clientID << " timed out (Last Heartbeat: " << timeSinceHeartbeat << "ms ago)." << std::endl;
-			client.isConnected = false; // Mark as disconnected
-			clientsToDisconnect.push_back(client.address);
+			DisconnectClient(client);
 			
 			// TODO: Broadcast PlayerLeftEvent via lockstep
 			// Need a mechanism to inject server-side events into the lockstep flow
@@ -819,46 +1399,57 @@ void NetworkEngine::CheckTimeoutsAndHeartbeats() {
 		
 	}
 
-	// Optionally, remove clients entirely after disconnect handling
-	for(sockaddr_in add : clientsToDisconnect) { 
-		clientManager.RemoveClient(add);
+	// Optionally, remove clients entirely after disconnect handling; these and any dropped since the last check
+	for (ConnectionID connection : disconnectedClients) { 
+		if (auto client = clientManager.GetClientByConnection(connection)) socketManager.ReleaseClient(client.value().get().joinAddress);
+		clientManager.RemoveClient(connection);
 	}
-		
-		
-	// Check Pending Event Timeouts
-	for (auto const& [eventID, pendingInfo] : pendingAcks) {
-		auto timeSinceBroadcast = std::chrono::duration_cast<std::chrono::milliseconds>(now - pendingInfo.broadcastTime).count();
-		
-		if (timeSinceBroadcast > EVENT_TIMEOUT_MS) {
-			std::cerr << "[Host] Event ID: " << eventID << " timed out (" << timeSinceBroadcast << "ms). Discarding." << std::endl;
-			eventsToTimeout.push_back(eventID);
-			// Don't send COMMIT. Clients waiting for it will eventually need their own timeout/cleanup.
-				
-		}
-		
-	}
-	
-	// Remove timed-out events
-	for (EventID id : eventsToTimeout) {
-		pendingAcks.erase(id);
+	disconnectedClients.clear();
+}
+
+void NetworkEngine::RefillBandwidth()
+{
+	// A burst of a tenth of a second, and never less than a couple of full packets
+	const double burst = std::max(clientBytesPerSecond * 0.1, 2.0 * MAX_PACKET_SIZE);
+	const auto now = std::chrono::steady_clock::now();
+	for (auto& client : clientManager.GetClientsNonConst()) {
+		client.bandwidth.Refill(now, clientBytesPerSecond, burst);
 	}
 }
 
-void NetworkEngine::CheckAckTimeouts() 
+void NetworkEngine::SendDueReliable() 
 {
-	static constexpr int ACK_TIMEOUT_MS = 3000; // 3 second
-
-	for (auto& [eventID, pendingInfo] : pendingAcks) {
-		auto timeSinceBroadcast = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - pendingInfo.broadcastTime).count();
-		if (timeSinceBroadcast > ACK_TIMEOUT_MS) {
-			for (auto& client : clientManager.GetClients()) {
-				if (pendingInfo.acksReceived.find(client.clientID) == pendingInfo.acksReceived.end()) {
-					std::cerr << "[Host] ACK timeout for Event ID: " << eventID << " from Client " << client.clientID << std::endl;
-					// Resend the event to the client
-					SendToClient(client, pendingInfo.eventData);
-					pendingInfo.broadcastTime = std::chrono::steady_clock::now(); // Update the broadcast time
-				}
+	// Each client's stream resends on its own timeout; an event waits in its recipients' streams, not in a list.
+	// A message may overdraw the budget, but none goes out once it is spent.
+	const auto now = std::chrono::steady_clock::now();
+	for (auto& client : clientManager.GetClientsNonConst()) {
+		if (!client.isConnected) continue;
+		client.reliable.ForEachDue(now, [&](const ReliableSender::Entry& entry) {
+			if (client.bandwidth.Available() <= 0.0) {
+				++client.sendStats.reliableDeferred;
+				return false;
 			}
-		}
+			SendBudgeted(client, *entry.packet);
+			return true;
+		});
 	}
-}
\ No newline at end of file
+}
+
+void NetworkEngine::SendBudgeted(Client& client, const PacketBuffer& packet)
+{
+	if (!client.outbox.Fits(packet.size)) FlushToClient(client);
+	if (!client.outbox.Append(packet.data, packet.size)) return;
+
+	// The bundle length is charged too, near enough what the message adds to the datagram
+	client.bandwidth.Consume(packet.size + Schema::WireSize<BundleEntryMsg>);
+	++client.sendStats.messagesSent;
+}
+
+void NetworkEngine::FlushToClient(Client& client)
+{
+	client.outbox.Flush([&](PacketBuffer& datagram) {
+		socketManager.SendToClient(client.address, datagram);
+		client.sendStats.bytesSent += datagram.size;
+		++client.sendStats.datagramsSent;
+	});
+}
@@ -2,13 +2,23 @@
 
 #include <string>
 #include <vector>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <functional>
-#include "winsock2.h"
+#include "NetworkPlatform.hpp"
 #include "SocketManager.hpp"
 #include "ClientManager.hpp"
+#include "InterestManager.hpp"
+#include "ReliableChannel.hpp"
+#include "EventJitterBuffer.hpp"
+#include "SnapshotInterpolation.hpp"
+#include "ClockSync.hpp"
+#include "MessageAggregator.hpp"
+#include "Fragmentation.hpp"
+#include "ImpairedTransport.hpp"
 #include "../Events/Event.hpp" 
-#include <unordered_set>
+#include <array>
 #include <unordered_map>
 
 using Tick = uint32_t;
@@ -17,52 +27,79 @@ using EventID = uint32_t;
 using ClientID = uint32_t;
 using TimePoint = std::chrono::steady_clock::time_point;
 
+// How the host turns a submitted event into something every peer runs
+enum class EventDelivery {
+	Lockstep,  // BROADCAST_EVENT, wait for every recipient's ACK, then COMMIT_EVENT
+	Scheduled  // SCHEDULED_EVENT stamped with a tick a little ahead; everyone runs it on that tick
+};
+
 class NetworkEngine {
 public:
 
 	// Timeouts in milliseconds
-	static constexpr long long EVENT_TIMEOUT_MS = 3000; // 3 seconds for an event to get all ACKs
+	static constexpr long long ACK_DELAY_MS = RELIABLE_ACK_DELAY_MS; // Client waits this long for a packet to piggyback acks on
 	static constexpr long long CLIENT_TIMEOUT_MS = 10000; // 10 seconds without heartbeat = disconnect
 	static constexpr long long HEARTBEAT_INTERVAL_MS = 2000; // Client sends heartbeat every 2 seconds
+	static constexpr size_t EVENT_WINDOW = 1024; // Events that can wait for ACKs at once
+	static constexpr Tick MIN_INPUT_DELAY_TICKS = 2; // Scheduled events run at least this far ahead of the host
+	static constexpr Tick MAX_INPUT_DELAY_TICKS = 30;
+	static constexpr size_t HOST_TRAILER_SIZE = Schema::WireSize<ConnectionMsg> + Schema::WireSize<ReliableAckMsg>;
 
 	enum CMDID {
 		UNKNOWN = (unsigned char)0x0,
 		REQ_CONNECTION = (unsigned char)0x1,
 		RSP_CONNECTION = (unsigned char)0x2,
-		TICK_SYNC = (unsigned char)0x3,
-		GAME_DATA = (unsigned char)0x4, // State updates
+		CLOCK_PONG = (unsigned char)0x3, // Host -> Client answer to CLOCK_PING
+		PLAYER_INPUT = (unsigned char)0x4, // Client -> Host input commands for its player
 		GAME_EVENT = (unsigned char)0x5, // Client -> Host event
 		BROADCAST_EVENT = (unsigned char)0x6, // Host -> Client event broadcast
-		ACK_EVENT = (unsigned char)0x7, // Client -> Host event acknowledgement
+		ACK_EVENT = (unsigned char)0x7, // Client -> Host acks with nothing to piggyback on
 		COMMIT_EVENT = (unsigned char)0x8,  // Host -> Client command to process event
 		HEARTBEAT = (unsigned char)0x9, // Client -> Host keep-alive
 		PLAYER_LEFT = (unsigned char)0xA, // Host -> Client notification
-		INITIAL_STATE_OBJECT = (unsigned char)0xB, // Host -> New Client state sync
+		INITIAL_STATE_OBJECT = (unsigned char)0xB, // Host -> Client joining mid-match, the world so far (fragmented)
 		REQ_RECONNECT = (unsigned char)0xC,
 		RSP_RECONNECT = (unsigned char)0xD,
-		FULL_STATE_SNAPSHOT = (unsigned char)0xE
+		SNAPSHOT = (unsigned char)0xE, // Host -> Client world state, delta compressed
+		SNAPSHOT_ACK = (unsigned char)0xF, // Client -> Host latest snapshot received
+		SCHEDULED_EVENT = (unsigned char)0x10, // Host -> Client event to run on a given tick
+		CLOCK_PING = (unsigned char)0x11, // Client -> Host round trip for clock sync
+		BUNDLE = MessageAggregator::COMMAND, // Either way, several of the above in one datagram
+		FRAGMENT = (unsigned char)0x13 // Host -> Client part of a message too long for one packet
 	};
 	static NetworkEngine& GetInstance();
+	// Makes GetInstance() on this thread return engine, one match's own; nullptr goes back to the process-wide one
+	static void Bind(NetworkEngine* engine);
 
 	void Initialize();
 	void Update(double);
 	bool Host(std::string);
 	bool Connect(std::string, std::string, const std::string&);
 	void Exit();
+	void AdvanceTick(); // Once per fixed step; runs the scheduled events that are due
+
+	// Host: the next input command to run for a client's player this tick, false once there is none
+	bool NextPlayerInput(NetworkID playerID, uint8_t& buttons);
+
+	// Host: RTT and tick offset of the client controlling playerID, false until it has synced
+	bool GetClientClock(NetworkID playerID, ClientClock& result) const;
+	// Host: how many ticks behind ours the client controlling playerID sees other objects, 0 if unknown
+	double GetClientViewDelay(NetworkID playerID) const;
 
 	void AttemptReconnect();
 
 	void SendEventToServer(std::unique_ptr<GameEvent> event); // Client function
-	void SendToAllClients(std::vector<char> packet);
-	void SendToClient(const Client& client, const std::vector<char>& packet); // Specific client send
-	void SendtoClientSameEvent(const Client& client, EventID eid, const std::vector<char>& packet);
-	void SendToOtherClients(const sockaddr_in& reqClient, std::vector<char> packet);
-	void HandleIncomingConnection(const std::vector<char>& data, const sockaddr_in& clientAddr);
-	void HandleClientEvent(const std::vector<char>& data); //tmp hack for server to send to itself
-	void SendTickSync();
-	void ProcessTickSync(Tick&, Tick&);
-	void SendFullStateSnapshot(const sockaddr_in& clientAddr);
-	void HandleFullStateSnapshot(const std::vector<char>& data);
+	void SendToAllClients(const PacketBuffer& packet);
+	void SendToAllClients(const char* data, size_t size); // One fan-out call for every client
+	void SendToClient(const Client& client, const PacketBuffer& packet); // Specific client send
+	void SendtoClientSameEvent(Client& client, EventID eid, const PacketBuffer& packet);
+	bool SendToHost(const PacketBuffer& packet); // Client, goes out with this frame's other messages and our acks
+	void SendToOtherClients(const sockaddr_in& reqClient, const char* data, size_t size);
+	void HandleIncomingConnection(const char* data, size_t size, const sockaddr_in& clientAddr);
+	void HandleClientEvent(const char* data, size_t size);
+	inline void HandleClientEvent(const PacketBuffer& packet) { HandleClientEvent(packet.data, packet.size); } //tmp hack for server to send to itself
+	void SendSnapshots(); // Host, one delta per connected client
+	void HandleSnapshot(const char* data, size_t size, TimePoint receivedTime); // Client side
 	//void SendPacket(std::vector<char>);
 	size_t GetNumConnectedClients() const;
 	void ServerBroadcastEvent(std::unique_ptr<GameEvent> event);
@@ -73,16 +110,35 @@ public:
 
 	bool isHosting = false;
 	bool isClient = false;
+	bool useIoThread = false; // Set before Host/Connect: the socket runs on its own thread (ThreadedTransport)
+	ImpairmentSettings impairment; // Set before Host/Connect: the socket sits behind a simulated network (ImpairedTransport)
+	size_t maxClients = 0; // Host only, 0 = no limit
 	ClientManager clientManager;
 	SocketManager socketManager;
+	InterestManager interest; // Host, decides what each client is sent
+	Tick snapshotIntervalTicks = 2; // Host sends each client a snapshot this often
+	double clientBytesPerSecond = 64.0 * 1024.0; // Host, each client's send budget
+	InterpolationClock interpolation; // Client, the render time of remote objects
+	ClockSync clock; // Client, the host's tick and how far ahead of it localTick runs
 
 	Tick simulationTick = 0; // global tick tracker
-	Tick localTick = simulationTick; // for client
+	Tick localTick = simulationTick; // Client, kept ClockSync::GetLeadTicks() ahead of the host's tick
+	double fixedDeltaTime = 1.0 / 60.0; // Seconds per tick, for turning network delays into ticks
+
+	// Client: the host's tick as far as we can tell, what scheduled events run by
+	inline Tick GetHostTick() const { return localTick - static_cast<Tick>(std::lround(clock.GetLeadTicks())); }
+	// Client: how fast fixed steps should run to keep localTick where it should be, for Timer::SetTimeScale
+	inline double GetTickRate() const { return clock.GetRate(); }
+
+	EventDelivery eventDelivery = EventDelivery::Scheduled; // Host
+	inline Tick GetInputDelay() const { return inputDelayTicks; }
 
 	bool isAttemptingReconnect = false;
 	std::chrono::steady_clock::time_point lastServerResponseTime{};
 	std::unordered_map<NetworkID, std::string> playerNames;
 private:
+	friend class ServerMatch; // Owns one per match
+	friend class BotClient;   // And one per bot
 	NetworkEngine() = default;
 	~NetworkEngine() = default;
 
@@ -90,29 +146,126 @@ private:
 	NetworkID nextID = 1; //reserve 0 for server
 
 	EventID nextEventID = 0;
-	TimePoint lastHeartbeatSentTime; // Client tracks when it last sent a heartbeat
+	std::atomic<TimePoint> lastSentToHost{}; // Client, a heartbeat only goes out after HEARTBEAT_INTERVAL_MS of nothing
 
-	void HandleAckEvent(const std::vector<char>&data, const sockaddr_in & clientAddr);
-	void HandleHeartbeat(const sockaddr_in& clientAddr); // Host handles heartbeat
-	void HandleBroadcastEvent(const std::vector<char>&data); // Client side
-	void HandleCommitEvent(const std::vector<char>&data);    // Client side
-	//void HandleInitialStateObject(const std::vector<char>& data); // Client handles incoming state
+	void SendConnectionResponse(const Client& client); // Host, RSP_CONNECTION with its connection ID
+	void HandleReliableAck(const ReliableAckMsg& ack, Client& client);
+	void HandleHeartbeat(Client& client, TimePoint receivedTime); // Host, any datagram from the client counts as one
+	void HandleClientMessage(const char* data, size_t size, Client& client); // Host, one message of a datagram
+	void HandleHostMessage(const char* data, size_t size, TimePoint receivedTime); // Client, one message of a datagram
+	void HandleBroadcastEvent(const char* data, size_t size); // Client side
+	void HandleCommitEvent(const char* data, size_t size);    // Client side
+	void HandleSnapshotAck(const char* data, size_t size, Client& client);
+	void HandlePlayerInput(const char* data, size_t size, Client& client);
+	void HandleClockPing(const char* data, size_t size, Client& client);
+	void HandleClockPong(const char* data, size_t size, TimePoint receivedTime); // Client
+	void UpdateClock(); // Client, pings and steers localTick
+	void MarkAckPending(); // Client
+	void HandleFragment(const char* data, size_t size, TimePoint receivedTime); // Client
+	void HandleInitialState(const char* data, size_t size); // Client, spawns what it did not know of yet
 	
-	void CheckAckTimeouts(); // Host checks periodically for ACK timeouts
+	void RefillBandwidth(); // Host, tops up every client's byte budget
+	void SendDueReliable(); // Host sends queued reliable messages and resends unacknowledged ones, within budget
+	void SendBudgeted(Client& client, const PacketBuffer& packet); // Host, queues and charges client's budget
+
+	// Once per frame, and early when a datagram is full: what is queued for a peer goes out
+	void FlushToClient(Client& client); // Host
+	void FlushToHost();                 // Client, with the trailer
+
+	// Calls visit(message, size) for each message in a datagram: every one in a BUNDLE, else the datagram itself
+	template <typename Char, typename Visit>
+	static void ForEachMessage(Char* data, size_t size, Visit&& visit) {
+		if (static_cast<CMDID>(data[0]) == BUNDLE) MessageAggregator::ForEach(data, size, visit);
+		else visit(data, size);
+	}
 
 	void CheckTimeoutsAndHeartbeats(); // Host checks periodically
-	//void SendInitialState(const Client & newClient); // Host sends current game state
+
+	// Writes the BROADCAST_EVENT body [EventID][EventType + SpecificData] into out
+	void WriteBroadcastBody(PacketBuffer& out, EventID eventID, const char* eventData, size_t size) const;
+	void SendInitialState(Client& client); // Host, the world so far to a client that joins mid-match
+
+	// Queues message, from its CMDID on, as FRAGMENT messages on client's reliable stream. Any message but a
+	// reliable one can be sent this way; false if it is over FragmentAssembler::MAX_MESSAGE_SIZE or the stream is full.
+	bool SendFragmented(Client& client, const char* message, size_t size);
+
+	// Queues [command][ReliableHeaderMsg][body] on client's reliable stream. If it has too much unacknowledged, the
+	// client would miss the message and fall out of step, so it is disconnected instead and this returns false.
+	bool SendReliable(Client& client, CMDID command, const PacketBuffer& body, EventID eventID, bool isBroadcast);
+	void DropReliable(Client& client); // Stops waiting on a client that is gone
+	void DisconnectClient(Client& client); // Host, marks it gone now; CheckTimeoutsAndHeartbeats removes it
+	std::vector<ConnectionID> disconnectedClients; // Host, to remove at the next check
 
 	struct PendingEventInfo {
-		std::vector<char> eventData; // Store the original event data (EventType + specific data)
-		std::unordered_set<ClientID> acksReceived; // Store the client IDs that have acknowledged the event
-		
-		TimePoint broadcastTime;
+		EventID eventID = 0;
+		bool isPending = false;
+		PacketHandle eventData; // Store the original event data (EventType + specific data)
+		std::vector<ClientID> recipients; // Clients the event was sent to; only their ACKs are waited for
+		size_t acksOutstanding = 0;
 	};
-	std::unordered_map<EventID, PendingEventInfo> pendingAcks; // Store pending events that need to be acknowledged by clients
+
+	// Tracks eventData under eventID and broadcasts it to the clients it is relevant to
+	void BroadcastPendingEvent(EventID eventID, PacketHandle eventData);
+	PendingEventInfo& ClaimPendingEvent(EventID eventID);
+	void OnEventDelivered(EventID eventID); // One recipient has the event, commits it after the last
+	void CommitEvent(PendingEventInfo& pendingInfo); // Sends COMMIT_EVENT and processes it locally
+	bool WantsEvent(const Client& client, const PacketBuffer& eventData) const;
+
+	// Runs a committed or scheduled event: eventData is EventType + specific data
+	void ProcessHostEvent(EventID eventID, NetworkID networkID, const PacketBuffer& eventData);
+	void ProcessClientEvent(EventID eventID, NetworkID networkID, const PacketBuffer& eventData);
+
+	// Scheduled delivery
+	void ScheduleEvent(EventID eventID, PacketHandle eventData); // Host
+	void HandleScheduledEvent(const char* data, size_t size);    // Client
+	void UpdateInputDelay();                                     // Host, from the clients' clock estimates
+	EventJitterBuffer scheduledEvents; // Both sides, events waiting for their tick
+	Tick inputDelayTicks = MIN_INPUT_DELAY_TICKS;
+	TimePoint lastTickTime{}; // Host, when simulationTick last advanced
+
+	std::array<PendingEventInfo, EVENT_WINDOW> pendingEvents; // Indexed by EventID % EVENT_WINDOW
+
+	std::vector<sockaddr_in> fanoutAddrs; // Reused destination list for SendToAllClients/SendToOtherClients
+
+	// Snapshot replication
+	Tick lastSnapshotTick = 0; // Host
+	SnapshotHistory receivedSnapshots; // Client, baselines the host may delta against
+	SnapshotSequence lastReceivedSnapshot = 0; // Client
 
 	// Client specific state for lockstep
-	std::unordered_map<EventID, std::vector<char>> pendingClientEvents; // Store raw event data (EventType + specific data)
+	std::unordered_map<EventID, PacketHandle> pendingClientEvents; // Store raw event data (EventType + specific data)
+	ReliableReceiver reliableReceiver;
+	std::atomic<ConnectionID> connectionID{ 0 }; // Client, what the host knows us by; 0 until the handshake
+	std::atomic<uint32_t> connectionNonce{ 0 };  // Client, sent with it; stored before it
+
+	// Network I/O thread, with useIoThread. The host answers clock pings there; the client acks reliable
+	// messages and sends heartbeats from there, so none of them wait for a frame.
+	// Also puts the socket behind the simulated network first, if impairment is on.
+	void StartIoThread(bool host);
+	bool HostIoReceive(Datagram& datagram, Transport& socket);
+	bool ClientIoReceive(Datagram& datagram, Transport& socket);
+	void ClientIoPoll(Transport& socket);
+	bool ioThreaded = false;
+	std::atomic<uint64_t> publishedTick{ 0 }; // Host: simulationTick << 32 | when it began, steady clock in µs
+	bool ioAckDue = false; // I/O thread
+
+	// Client, on whichever thread receives: records a message on the reliable stream as arrived, false if it is a repeat
+	bool AcceptReliable(const char* data, size_t size);
+	static inline bool IsReliable(CMDID command) {
+		return command == BROADCAST_EVENT || command == COMMIT_EVENT || command == SCHEDULED_EVENT || command == FRAGMENT;
+	}
+	void WriteHostTrailer(PacketWriter& writer) const; // Client, [ConnectionMsg][ReliableAckMsg]
+	void WriteClockPong(PacketBuffer& out, const ClockPingMsg& ping, Tick tick, double phase) const;
+	MessageAggregator hostOutbox{ HOST_TRAILER_SIZE }; // Client, this frame's messages to the host
+
+	// Messages longer than one packet
+	FragmentAssembler fragments; // Client
+	uint16_t nextFragmentedID = 0; // Host
+	std::vector<char> largeMessage; // Host, reused to build them in
+	std::array<NetworkID, 256> recentlyDestroyed{}; // Client, so a world state that was slow to arrive does not bring them back
+	size_t nextDestroyed = 0;
+	bool ackPending = false; // Received reliable messages since our acks last went out
+	TimePoint ackPendingSince;
 
 	// client stuff
 	//bool isClient = false;
@@ -123,8 +276,5 @@ private:
 	//bool isHost = false;
 	//SOCKET udpListeningSocket = INVALID_SOCKET;
 	//std::vector<Client> clientConnections;
-
-	// Game state access - Needs to be set or passed somehow
-	std::function<std::unordered_map<NetworkID, NetworkObject*>& ()> getNetworkedObjectsCallback;
 };
 
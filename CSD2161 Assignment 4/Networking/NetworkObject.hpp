@@ -1,16 +1,7 @@
 #pragma once
 
-#include <vector>
+#include <cstdint>
 
+// Identifiers shared by everything that is replicated. The entities themselves live in EntityStore.
 using Tick = uint32_t;
 using NetworkID = uint32_t;
-
-class NetworkObject {
-public:
-	virtual std::vector<char> Serialize() = 0;
-	virtual void Deserialize(const char*) = 0;
-	bool isLocal = false;
-	Tick lastReceivedTick = 0;
-	NetworkID networkID = 0; // to be assigned by host/server
-};
-
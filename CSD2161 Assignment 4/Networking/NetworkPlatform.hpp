@@ -0,0 +1,36 @@
+#pragma once
+
+// Socket headers and the few Winsock names the rest of the networking code relies on,
+// so that everything above the transport layer builds unchanged on Windows and Linux.
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>		// getaddrinfo(), inet_ntop()
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+
+using SOCKET = int;
+#define INVALID_SOCKET  (-1)
+#define SOCKET_ERROR    (-1)
+
+inline int closesocket(SOCKET sock) { return ::close(sock); }
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+// Build-time transport selection. Define one of these in the project settings to override the default.
+#if !defined(NET_TRANSPORT_WINSOCK) && !defined(NET_TRANSPORT_EPOLL)
+#if defined(_WIN32)
+#define NET_TRANSPORT_WINSOCK
+#elif defined(__linux__)
+#define NET_TRANSPORT_EPOLL
+#else
+#error "No socket transport available for this platform"
+#endif
+#endif
@@ -0,0 +1,83 @@
+#include "PacketBuffer.hpp"
+
+#include <mutex>
+
+PacketPool& PacketPool::GetInstance() {
+	// One per thread, so server matches running on different threads never share a free list.
+	// Never destroyed: handles owned by other singletons (NetworkEngine, EventQueue) are
+	// released during static destruction, possibly after a function-local pool would be gone,
+	// and a match's packets may be released after the thread that ran it has exited
+	if (!current) current = Create();
+	return *current;
+}
+
+thread_local PacketPool* PacketPool::current = nullptr;
+
+PacketPool* PacketPool::Create() {
+	// Every thread's pool stays on this list, so none is ever unreachable
+	static std::mutex lock;
+	static std::vector<PacketPool*>* pools = new std::vector<PacketPool*>();
+
+	std::lock_guard<std::mutex> guard(lock);
+	pools->push_back(new PacketPool());
+	return pools->back();
+}
+
+void PacketPool::Grow() {
+	auto block = std::make_unique<PacketBuffer[]>(BLOCK_SIZE);
+	for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+		block[i].nextFree = freeList;
+		block[i].owner = this;
+		freeList = &block[i];
+	}
+	blocks.push_back(std::move(block));
+	capacity += BLOCK_SIZE;
+}
+
+PacketHandle PacketPool::Acquire() {
+	if (!freeList && Reclaim() == 0) Grow();
+
+	PacketBuffer* buffer = freeList;
+	freeList = buffer->nextFree;
+	buffer->nextFree = nullptr;
+	buffer->size = 0;
+	++inUse;
+	return PacketHandle(buffer);
+}
+
+void PacketPool::Release(PacketBuffer* buffer) {
+	if (this == current) {
+		buffer->nextFree = freeList;
+		freeList = buffer;
+		--inUse;
+		return;
+	}
+
+	// Another thread's packet: onto its return list, where only its owner ever takes from
+	PacketBuffer* head = returned.load(std::memory_order_relaxed);
+	do {
+		buffer->nextFree = head;
+	} while (!returned.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+}
+
+size_t PacketPool::Reclaim() {
+	PacketBuffer* buffer = returned.exchange(nullptr, std::memory_order_acquire);
+	size_t count = 0;
+	while (buffer) {
+		PacketBuffer* next = buffer->nextFree;
+		buffer->nextFree = freeList;
+		freeList = buffer;
+		buffer = next;
+		++count;
+	}
+	inUse -= count;
+	return count;
+}
+
+PacketHandle PacketHandle::Copy(const char* data, size_t size) {
+	PacketHandle packet = PacketPool::GetInstance().Acquire();
+	if (size > MAX_PACKET_SIZE) size = MAX_PACKET_SIZE;
+	std::memcpy(packet->data, data, size);
+	packet->size = size;
+	return packet;
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include "Transport.hpp"
+
+/**
+ * \brief One MTU-sized packet. Lives on the stack for immediate sends or in the PacketPool
+ *        when it has to outlive the current call (pending events, queued state updates).
+ */
+class PacketPool;
+
+struct PacketBuffer {
+	char data[MAX_PACKET_SIZE];
+	size_t size = 0;
+	PacketBuffer* nextFree = nullptr; // PacketPool free list link
+	PacketPool* owner = nullptr;      // The pool it is returned to, whichever thread releases it
+};
+
+class PacketHandle;
+
+/**
+ * \brief Free list of PacketBuffers. Grows in blocks while warming up and never frees,
+ *        so once the working set is reached acquiring and releasing a packet does not allocate.
+ *
+ * Each thread has its own, and a packet always goes back to the pool it came from. Released on the owning
+ * thread it goes straight onto the free list; released on any other (say the I/O thread sent it) it is pushed
+ * onto the owner's lock-free return list, which the owner takes in whole the next time its free list runs dry.
+ * Until then it still counts as in use.
+ */
+class PacketPool {
+public:
+	static constexpr size_t BLOCK_SIZE = 64;
+
+	static PacketPool& GetInstance();
+
+	PacketHandle Acquire();
+	void Release(PacketBuffer* buffer); // Any thread; buffer must have come from this pool
+
+	// Only meaningful on the owning thread
+	inline size_t GetCapacity() const { return capacity; }
+	inline size_t GetInUse() const { return inUse; }
+
+private:
+	PacketPool() = default;
+	static PacketPool* Create();
+	void Grow();
+	size_t Reclaim(); // Owning thread, moves what other threads returned onto the free list
+
+	static thread_local PacketPool* current; // The calling thread's pool, nullptr until it asks for one
+
+	std::vector<std::unique_ptr<PacketBuffer[]>> blocks;
+	PacketBuffer* freeList = nullptr;
+	std::atomic<PacketBuffer*> returned{ nullptr }; // Released by other threads, pushed by them, taken by the owner
+	size_t capacity = 0;
+	size_t inUse = 0;
+};
+
+/**
+ * \brief Owning, move-only reference to a pooled PacketBuffer. Returns it to the pool on destruction.
+ */
+class PacketHandle {
+public:
+	PacketHandle() = default;
+	explicit PacketHandle(PacketBuffer* buf) : buffer(buf) {}
+	PacketHandle(PacketHandle&& other) noexcept : buffer(other.buffer) { other.buffer = nullptr; }
+	PacketHandle& operator=(PacketHandle&& other) noexcept {
+		if (this != &other) {
+			Reset();
+			buffer = other.buffer;
+			other.buffer = nullptr;
+		}
+		return *this;
+	}
+	PacketHandle(const PacketHandle&) = delete;
+	PacketHandle& operator=(const PacketHandle&) = delete;
+	~PacketHandle() { Reset(); }
+
+	void Reset() {
+		if (buffer) {
+			buffer->owner->Release(buffer);
+			buffer = nullptr;
+		}
+	}
+
+	// Acquires a new pooled packet holding a copy of data
+	static PacketHandle Copy(const char* data, size_t size);
+
+	inline explicit operator bool() const { return buffer != nullptr; }
+	inline PacketBuffer& operator*() const { return *buffer; }
+	inline PacketBuffer* operator->() const { return buffer; }
+
+	inline const char* Data() const { return buffer->data; }
+	inline size_t Size() const { return buffer->size; }
+
+private:
+	PacketBuffer* buffer = nullptr;
+};
+
+/**
+ * \brief Appends bytes to a PacketBuffer; typed fields go through Schema::Encode (PacketSchema.hpp).
+ *        Writes past MAX_PACKET_SIZE are dropped and flag the writer as failed instead of growing the packet.
+ */
+class PacketWriter {
+public:
+	explicit PacketWriter(PacketBuffer& buf) : buffer(buf) { buffer.size = 0; }
+
+	// Continues after what buf already holds instead of starting it over
+	static PacketWriter Append(PacketBuffer& buf) {
+		const size_t size = buf.size;
+		PacketWriter writer(buf);
+		buf.size = size;
+		return writer;
+	}
+
+	void WriteU8(uint8_t value) { WriteBytes(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+	void WriteBytes(const char* bytes, size_t count) {
+		if (char* out = Reserve(count)) std::memcpy(out, bytes, count);
+	}
+
+	// Claims count bytes at the end of the packet for the caller to fill, nullptr if they do not fit
+	char* Reserve(size_t count) {
+		if (failed || buffer.size + count > MAX_PACKET_SIZE) {
+			failed = true;
+			return nullptr;
+		}
+		char* out = buffer.data + buffer.size;
+		buffer.size += count;
+		return out;
+	}
+
+	inline char* Current() { return buffer.data + buffer.size; }
+	inline size_t Size() const { return buffer.size; }
+	inline size_t Remaining() const { return MAX_PACKET_SIZE - buffer.size; }
+	inline bool Ok() const { return !failed; }
+
+private:
+	PacketBuffer& buffer;
+	bool failed = false;
+};
+
+/**
+ * \brief Reads bytes from a received packet; typed fields go through Schema::Decode (PacketSchema.hpp).
+ *        Reads past the end return zero and flag the reader as failed, so callers can check Ok() once after decoding.
+ */
+class PacketReader {
+public:
+	PacketReader(const char* packet, size_t packetSize) : data(packet), size(packetSize) {}
+	explicit PacketReader(const PacketBuffer& buf) : data(buf.data), size(buf.size) {}
+
+	uint8_t ReadU8() { uint8_t v = 0; ReadBytes(reinterpret_cast<char*>(&v), sizeof(v)); return v; }
+
+	void ReadBytes(char* out, size_t count) {
+		if (const char* in = Consume(count)) std::memcpy(out, in, count);
+		else std::memset(out, 0, count);
+	}
+
+	void Skip(size_t count) { Consume(count); }
+
+	// Steps over count bytes and returns where they start, nullptr if the packet is too short
+	const char* Consume(size_t count) {
+		if (failed || count > size - offset) {
+			failed = true;
+			offset = size;
+			return nullptr;
+		}
+		const char* in = data + offset;
+		offset += count;
+		return in;
+	}
+
+	inline const char* Current() const { return data + offset; }
+	inline size_t Offset() const { return offset; }
+	inline size_t Remaining() const { return size - offset; }
+	inline bool Ok() const { return !failed; }
+
+private:
+	const char* data;
+	size_t size;
+	size_t offset = 0;
+	bool failed = false;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <glm/vec3.hpp>
+#include "PacketBuffer.hpp"
+
+/**
+ * \brief Compile-time packet layouts.
+ *
+ * A message is a plain struct plus a MessageSchema specialisation listing its fields in wire order:
+ *
+ *   template <> struct MessageSchema<SnapshotAckMsg> : FieldList<Field<&SnapshotAckMsg::sequence, U32>> {};
+ *
+ * Size, Encode and Decode are generated from that list. The whole message is bounds checked once,
+ * then every field is stored/loaded at a fixed offset in network byte order.
+ */
+namespace Schema {
+
+	// Wire types. Multi-byte values are big endian, floats travel as their IEEE-754 bits.
+	struct U8 {
+		static constexpr size_t Size = 1;
+		template <typename T> static void Store(char* out, T value) { out[0] = static_cast<char>(static_cast<uint8_t>(value)); }
+		template <typename T> static void Load(const char* in, T& value) { value = static_cast<T>(static_cast<uint8_t>(in[0])); }
+	};
+
+	struct U16 {
+		static constexpr size_t Size = 2;
+		template <typename T> static void Store(char* out, T value) {
+			const uint16_t v = static_cast<uint16_t>(value);
+			out[0] = static_cast<char>(v >> 8);
+			out[1] = static_cast<char>(v);
+		}
+		template <typename T> static void Load(const char* in, T& value) {
+			const auto* b = reinterpret_cast<const unsigned char*>(in);
+			value = static_cast<T>(static_cast<uint16_t>((b[0] << 8) | b[1]));
+		}
+	};
+
+	struct U32 {
+		static constexpr size_t Size = 4;
+		template <typename T> static void Store(char* out, T value) {
+			const uint32_t v = static_cast<uint32_t>(value);
+			out[0] = static_cast<char>(v >> 24);
+			out[1] = static_cast<char>(v >> 16);
+			out[2] = static_cast<char>(v >> 8);
+			out[3] = static_cast<char>(v);
+		}
+		template <typename T> static void Load(const char* in, T& value) {
+			const auto* b = reinterpret_cast<const unsigned char*>(in);
+			value = static_cast<T>((uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | uint32_t(b[3]));
+		}
+	};
+
+	struct F32 {
+		static constexpr size_t Size = 4;
+		static void Store(char* out, float value) { uint32_t bits; std::memcpy(&bits, &value, sizeof(bits)); U32::Store(out, bits); }
+		static void Load(const char* in, float& value) { uint32_t bits; U32::Load(in, bits); std::memcpy(&value, &bits, sizeof(value)); }
+	};
+
+	// x and y only, z is left untouched on load
+	struct Vec2 {
+		static constexpr size_t Size = 8;
+		static void Store(char* out, const glm::vec3& v) { F32::Store(out, v.x); F32::Store(out + 4, v.y); }
+		static void Load(const char* in, glm::vec3& v) { F32::Load(in, v.x); F32::Load(in + 4, v.y); }
+	};
+
+	struct Vec3 {
+		static constexpr size_t Size = 12;
+		static void Store(char* out, const glm::vec3& v) { F32::Store(out, v.x); F32::Store(out + 4, v.y); F32::Store(out + 8, v.z); }
+		static void Load(const char* in, glm::vec3& v) { F32::Load(in, v.x); F32::Load(in + 4, v.y); F32::Load(in + 8, v.z); }
+	};
+
+	/**
+	 * \brief One struct member and the wire type it is sent as.
+	 */
+	template <auto Member, typename Wire>
+	struct Field {
+		static constexpr size_t Size = Wire::Size;
+
+		template <typename Msg> static void Store(char*& out, const Msg& msg) { Wire::Store(out, msg.*Member); out += Size; }
+		template <typename Msg> static void Load(const char*& in, Msg& msg) { Wire::Load(in, msg.*Member); in += Size; }
+	};
+
+	/**
+	 * \brief Generated codec for a list of fields.
+	 */
+	template <typename... Fields>
+	struct FieldList {
+		static constexpr size_t Size = (Fields::Size + ... + 0);
+
+		template <typename Msg>
+		static bool Encode(PacketWriter& writer, const Msg& msg) {
+			char* out = writer.Reserve(Size);
+			if (!out) return false;
+			Store(out, msg);
+			return true;
+		}
+
+		template <typename Msg>
+		static void Store(char* out, const Msg& msg) {
+			(Fields::Store(out, msg), ...);
+		}
+
+		template <typename Msg>
+		static bool Decode(PacketReader& reader, Msg& msg) {
+			const char* in = reader.Consume(Size);
+			if (!in) return false;
+			(Fields::Load(in, msg), ...);
+			return true;
+		}
+	};
+
+	// Specialised for every message in Messages.hpp
+	template <typename Msg>
+	struct MessageSchema;
+
+	template <typename Msg>
+	inline constexpr size_t WireSize = MessageSchema<Msg>::Size;
+
+	template <typename Msg>
+	inline bool Encode(PacketWriter& writer, const Msg& msg) {
+		return MessageSchema<Msg>::Encode(writer, msg);
+	}
+
+	// Writes msg to out, which must have WireSize<Msg> bytes; for buffers larger than a PacketBuffer
+	template <typename Msg>
+	inline void Store(char* out, const Msg& msg) {
+		MessageSchema<Msg>::Store(out, msg);
+	}
+
+	// Leaves msg partially filled and returns false if the packet is too short
+	template <typename Msg>
+	inline bool Decode(PacketReader& reader, Msg& msg) {
+		return MessageSchema<Msg>::Decode(reader, msg);
+	}
+}
@@ -0,0 +1,52 @@
+#include "PlayerInput.hpp"
+
+void PlayerInputQueue::Receive(Tick newestTick, const uint8_t* buttons, size_t count, Tick latestTick) {
+	// Commands claiming ticks the client has not reached are not kept
+	const int32_t early = static_cast<int32_t>(newestTick - latestTick);
+	if (early > 0) {
+		if (static_cast<size_t>(early) >= count) return;
+		count -= static_cast<size_t>(early);
+		newestTick = latestTick;
+	}
+
+	if (count == 0 || static_cast<int32_t>(newestTick - lastProcessed) <= 0) return; // All of them already ran
+
+	// Too far ahead to hold: the commands in between are lost, carry on from the oldest one we can keep
+	if (static_cast<int32_t>(newestTick - lastProcessed) > static_cast<int32_t>(WINDOW)) {
+		lastProcessed = newestTick - WINDOW;
+	}
+
+	const Tick oldestTick = newestTick - static_cast<Tick>(count - 1);
+	for (size_t i = 0; i < count; ++i) {
+		const Tick tick = oldestTick + static_cast<Tick>(i);
+		if (static_cast<int32_t>(tick - lastProcessed) <= 0) continue;
+		slots[tick % WINDOW] = Slot{ tick, buttons[i] };
+	}
+	if (static_cast<int32_t>(newestTick - newestReceived) > 0) newestReceived = newestTick;
+}
+
+bool PlayerInputQueue::Next(Tick hostTick, uint8_t& buttons) {
+	const int32_t waiting = static_cast<int32_t>(newestReceived - lastProcessed);
+	if (waiting <= 0) return false;
+	if (ranAny && lastRunTick == hostTick && (waiting <= static_cast<int32_t>(MAX_BUFFERED) || ranOnTick >= MAX_PER_TICK)) return false;
+
+	++lastProcessed;
+	const Slot& slot = slots[lastProcessed % WINDOW];
+	if (slot.tick == lastProcessed) lastButtons = slot.buttons;
+
+	ranOnTick = ranAny && lastRunTick == hostTick ? ranOnTick + 1 : 1;
+	lastRunTick = hostTick;
+	ranAny = true;
+	buttons = lastButtons;
+	return true;
+}
+
+void PlayerInputQueue::Reset() {
+	slots.fill(Slot{});
+	lastProcessed = 0;
+	newestReceived = 0;
+	lastButtons = 0;
+	lastRunTick = 0;
+	ranOnTick = 0;
+	ranAny = false;
+}
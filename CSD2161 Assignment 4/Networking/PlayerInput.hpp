@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "Messages.hpp"
+
+// Buttons held during one client tick; one byte of these is the whole input command for that tick
+enum PlayerButton : uint8_t {
+	BUTTON_ROTATE_LEFT = 1 << 0,
+	BUTTON_ROTATE_RIGHT = 1 << 1,
+	BUTTON_THRUST = 1 << 2
+};
+
+/**
+ * \brief Host side of one client's input commands, by the client's own input tick.
+ *
+ * The client resends every command until a snapshot acknowledges it, so a lost packet only makes commands
+ * arrive late. One command runs per host tick; once more than MAX_BUFFERED are waiting up to MAX_PER_TICK run
+ * on one tick, so a burst after a stall catches up within a few ticks but never all at once. Commands for ticks
+ * past what the caller allows are dropped, which keeps a client from running ahead of its own clock.
+ */
+class PlayerInputQueue {
+public:
+	static constexpr size_t WINDOW = 64;
+	static constexpr size_t MAX_BUFFERED = 3;
+	static constexpr size_t MAX_PER_TICK = 3;
+	static constexpr Tick MAX_LEAD_TICKS = 8; // How far past its estimated clock a client's commands may be
+
+	// Stores the commands for newestTick - count + 1 .. newestTick that have not run yet, up to latestTick
+	void Receive(Tick newestTick, const uint8_t* buttons, size_t count, Tick latestTick);
+
+	// The next command to run on hostTick, false once there is none. A command that never arrived is run
+	// as a repeat of the one before it.
+	bool Next(Tick hostTick, uint8_t& buttons);
+
+	inline Tick GetLastProcessed() const { return lastProcessed; }
+	void Reset();
+
+private:
+	struct Slot {
+		Tick tick = 0;
+		uint8_t buttons = 0;
+	};
+
+	std::array<Slot, WINDOW> slots{};
+	Tick lastProcessed = 0;   // Acknowledged back to the client in its snapshots
+	Tick newestReceived = 0;
+	uint8_t lastButtons = 0;
+	Tick lastRunTick = 0;
+	size_t ranOnTick = 0; // Commands run on lastRunTick
+	bool ranAny = false;
+};
@@ -0,0 +1,68 @@
+#include "ReliableChannel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+ReliableSender::Entry& ReliableSender::Push(PacketHandle packet, EventID eventID, bool isBroadcast) {
+	Entry& entry = ring[nextSequence % WINDOW];
+	entry.packet = std::move(packet);
+	entry.eventID = eventID;
+	entry.isBroadcast = isBroadcast;
+	entry.resendTime = Clock::now(); // Due at once
+	entry.retransmits = 0;
+	entry.sent = false;
+	entry.inFlight = true;
+	nextResendTime = std::min(nextResendTime, entry.resendTime);
+	++nextSequence;
+	return entry;
+}
+
+ReliableSender::Clock::duration ReliableSender::Backoff(uint8_t retransmits) const {
+	const double seconds = std::min(std::ldexp(rto, std::min<int>(retransmits, 8)), MAX_RTO);
+	return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+void ReliableSender::SampleRtt(double rtt) {
+	// RFC 6298 smoothing
+	if (!rttSampled) {
+		smoothedRtt = rtt;
+		rttVariance = rtt / 2.0;
+		rttSampled = true;
+	}
+	else {
+		rttVariance = 0.75 * rttVariance + 0.25 * std::abs(smoothedRtt - rtt);
+		smoothedRtt = 0.875 * smoothedRtt + 0.125 * rtt;
+	}
+	rto = std::clamp(smoothedRtt + std::max(RTO_GRANULARITY, 4.0 * rttVariance), MIN_RTO, MAX_RTO);
+}
+
+bool ReliableReceiver::Accept(ReliableSequence sequence) {
+	const uint64_t packed = state.load(std::memory_order_relaxed);
+	ReliableSequence cumulative = static_cast<ReliableSequence>(packed >> 32);
+	uint32_t pending = static_cast<uint32_t>(packed);
+
+	const int32_t distance = SequenceDistance(cumulative, sequence);
+	if (distance <= 0) return false;
+
+	if (distance == 1) {
+		// Closes the gap, then takes in whatever had already arrived right behind it
+		cumulative = sequence;
+		for (bool next = true; next;) {
+			next = pending & 1;
+			pending >>= 1;
+			if (next) ++cumulative;
+		}
+	}
+	else {
+		const int32_t bit = distance - 2;
+		if (bit >= 32 || (pending & (1u << bit))) return false;
+		pending |= 1u << bit;
+	}
+
+	state.store((static_cast<uint64_t>(cumulative) << 32) | pending, std::memory_order_release);
+	return true;
+}
+
+void ReliableReceiver::Reset() {
+	state.store(0, std::memory_order_release);
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "PacketBuffer.hpp"
+#include "Messages.hpp"
+
+using ReliableSequence = uint16_t; // Wraps; compared with SequenceDistance
+
+// How far past the last in-order message a receiver can record arrivals: the one after it, plus the 32 in ackBits
+constexpr size_t RELIABLE_RECEIVE_WINDOW = 1 + 32;
+
+// Longest a receiver holds its ack back, waiting for a packet of its own to carry it
+constexpr long long RELIABLE_ACK_DELAY_MS = 50;
+
+// Signed distance from a to b, correct while the two are less than half the sequence space apart
+inline int32_t SequenceDistance(ReliableSequence a, ReliableSequence b) {
+	return static_cast<int16_t>(static_cast<uint16_t>(b - a));
+}
+
+// Counters of one reliable stream since its last ResetStats
+struct ReliableStats {
+	uint64_t sent = 0;        // First sends
+	uint64_t retransmits = 0;
+	uint64_t delivered = 0;
+};
+
+/**
+ * \brief Host side of one client's reliable stream, and its send queue. Every message takes the next sequence
+ *        number and stays in a ring slot, as the packet it goes out as, until the client acknowledges it.
+ *
+ * Acks are cumulative plus a bitfield (ReliableAckMsg), so one ack settles many messages and a lost ack is
+ * covered by the next one. Retiring a message is O(1); only messages still in flight are ever walked, and
+ * only once the earliest of their send times has come.
+ *
+ * A message is first sent on the next ForEachDue, then resent after the retransmission timeout of RFC 6298
+ * (smoothed RTT plus four deviations), doubled for every time that message has already been resent. Only the
+ * RELIABLE_RECEIVE_WINDOW messages from the oldest unacknowledged one go out; anything later would be refused by
+ * the receiver, so it waits for acks to move the window on. WINDOW is how many can be queued.
+ */
+class ReliableSender {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr size_t WINDOW = 256; // Messages queued at once, well inside half the sequence space
+	static constexpr double INITIAL_RTO = 0.25; // Seconds, until the first RTT sample
+	static constexpr double RTO_GRANULARITY = 0.02; // The host looks for overdue messages about once a tick
+	// A message can go unacked for the whole ack delay even when RTT samples from piggybacked acks are short;
+	// resending any sooner is always spurious
+	static constexpr double MIN_RTO = RELIABLE_ACK_DELAY_MS / 1000.0 + 2.0 * RTO_GRANULARITY;
+	static constexpr double MAX_RTO = 2.0;
+
+	struct Entry {
+		PacketHandle packet;
+		EventID eventID = 0;
+		bool isBroadcast = false; // Delivering it counts as the client's ACK for eventID
+		Clock::time_point sentTime;
+		Clock::time_point resendTime; // When it is next due
+		uint8_t retransmits = 0; // Its ack could be for any send, so a resent message gives no RTT sample
+		bool sent = false;
+		bool inFlight = false;     // Queued or sent, and not acknowledged yet
+	};
+
+	inline ReliableSequence NextSequence() const { return nextSequence; }
+	inline bool IsFull() const { return SequenceDistance(oldestUnacked, nextSequence) >= static_cast<int32_t>(WINDOW); }
+	inline size_t GetRoom() const { return WINDOW - static_cast<size_t>(SequenceDistance(oldestUnacked, nextSequence)); }
+	inline bool HasInFlight() const { return oldestUnacked != nextSequence; }
+
+	// Round trip to this client, from acks of messages sent once (includes how long the client holds its acks)
+	inline bool HasRttSample() const { return rttSampled; }
+	inline double GetSmoothedRtt() const { return smoothedRtt; }  // Seconds
+	inline double GetRttVariance() const { return rttVariance; }  // Mean deviation, seconds
+	inline double GetRto() const { return rto; }                  // Seconds, before any backoff
+
+	inline const ReliableStats& GetStats() const { return stats; }
+	inline void ResetStats() { stats = ReliableStats{}; }
+
+	// Queues packet, which must carry NextSequence() in its ReliableHeaderMsg, and returns the stored entry
+	Entry& Push(PacketHandle packet, EventID eventID, bool isBroadcast);
+
+	// Retires everything ack covers, calling delivered(entry) once for each
+	template <typename Delivered>
+	void Acknowledge(const ReliableAckMsg& ack, Delivered&& delivered) {
+		const int32_t cumulative = SequenceDistance(oldestUnacked, ack.ack);
+		const int32_t inFlight = SequenceDistance(oldestUnacked, nextSequence);
+		if (cumulative >= inFlight) return; // Acks something never sent
+
+		const auto now = Clock::now();
+		for (int32_t i = 0; i <= cumulative; ++i) {
+			Retire(static_cast<ReliableSequence>(oldestUnacked + i), now, delivered);
+		}
+		for (uint32_t bits = ack.ackBits, i = 0; bits != 0; bits >>= 1, ++i) {
+			if (!(bits & 1)) continue;
+			const ReliableSequence sequence = static_cast<ReliableSequence>(ack.ack + 2 + i);
+			if (SequenceDistance(sequence, nextSequence) <= 0) break;
+			if (SequenceDistance(oldestUnacked, sequence) >= 0) Retire(sequence, now, delivered);
+		}
+		const ReliableSequence oldest = oldestUnacked;
+		while (HasInFlight() && !ring[oldestUnacked % WINDOW].inFlight) ++oldestUnacked;
+		if (oldestUnacked != oldest) nextResendTime = std::min(nextResendTime, now); // Messages held back may fit now
+	}
+
+	// Calls send(entry) for every queued message and every one whose resend time has come, oldest first, and
+	// backs the timer of each resent one off. Stops at the first send(entry) that returns false (out of budget);
+	// that message and the rest stay due.
+	template <typename Send>
+	void ForEachDue(Clock::time_point now, Send&& send) {
+		if (!HasInFlight() || now < nextResendTime) return;
+
+		nextResendTime = Clock::time_point::max();
+		const ReliableSequence end = SequenceDistance(oldestUnacked, nextSequence) > static_cast<int32_t>(RELIABLE_RECEIVE_WINDOW)
+			? static_cast<ReliableSequence>(oldestUnacked + RELIABLE_RECEIVE_WINDOW) : nextSequence;
+		for (ReliableSequence sequence = oldestUnacked; sequence != end; ++sequence) {
+			Entry& entry = ring[sequence % WINDOW];
+			if (!entry.inFlight) continue;
+			if (entry.resendTime <= now) {
+				if (!send(entry)) {
+					nextResendTime = now;
+					return;
+				}
+				if (!entry.sent) {
+					entry.sent = true;
+					entry.sentTime = now;
+					++stats.sent;
+				}
+				else {
+					if (entry.retransmits < UINT8_MAX) ++entry.retransmits;
+					++stats.retransmits;
+				}
+				entry.resendTime = now + Backoff(entry.retransmits);
+			}
+			if (entry.resendTime < nextResendTime) nextResendTime = entry.resendTime;
+		}
+	}
+
+	// Drops every message still in flight, calling dropped(entry) for each
+	template <typename Dropped>
+	void Clear(Dropped&& dropped) {
+		for (; oldestUnacked != nextSequence; ++oldestUnacked) {
+			Entry& entry = ring[oldestUnacked % WINDOW];
+			if (!entry.inFlight) continue;
+			entry.inFlight = false;
+			entry.packet.Reset();
+			dropped(entry);
+		}
+	}
+
+private:
+	template <typename Delivered>
+	void Retire(ReliableSequence sequence, Clock::time_point now, Delivered& delivered) {
+		Entry& entry = ring[sequence % WINDOW];
+		if (!entry.inFlight) return;
+		entry.inFlight = false;
+		entry.packet.Reset();
+		if (entry.sent && entry.retransmits == 0) SampleRtt(std::chrono::duration<double>(now - entry.sentTime).count());
+		++stats.delivered;
+		delivered(entry);
+	}
+
+	void SampleRtt(double rtt);
+	Clock::duration Backoff(uint8_t retransmits) const; // RTO doubled per retransmit, up to MAX_RTO
+
+	std::array<Entry, WINDOW> ring;
+	ReliableSequence nextSequence = 1;
+	ReliableSequence oldestUnacked = 1;
+
+	Clock::time_point nextResendTime = Clock::time_point::max(); // Earliest resendTime in flight, or sooner
+
+	bool rttSampled = false;
+	double smoothedRtt = 0.0;
+	double rttVariance = 0.0;
+	double rto = INITIAL_RTO;
+
+	ReliableStats stats;
+};
+
+/**
+ * \brief Client side of the reliable stream: which sequence numbers have arrived, in the form they are acked in.
+ *
+ * Accept is for one thread at a time, the one that receives; GetAck may be called from any other, since the
+ * whole state is one atomic word.
+ */
+class ReliableReceiver {
+public:
+	// True the first time sequence is seen. Duplicates, and messages too far ahead to record, are refused;
+	// the host resends anything unacknowledged.
+	bool Accept(ReliableSequence sequence);
+
+	inline ReliableAckMsg GetAck() const {
+		const uint64_t packed = state.load(std::memory_order_acquire);
+		return ReliableAckMsg{ static_cast<ReliableSequence>(packed >> 32), static_cast<uint32_t>(packed) };
+	}
+	void Reset();
+
+private:
+	// cumulative << 32 | pending. Everything up to cumulative has arrived; bit i of pending: cumulative + 2 + i
+	// has arrived too (cumulative + 1 is missing by definition).
+	std::atomic<uint64_t> state{ 0 };
+};
@@ -0,0 +1,261 @@
+#include "Snapshot.hpp"
+
+#include <algorithm>
+#include "BitStream.hpp"
+
+using StateEncoding::QuantizedState;
+using Q = StateEncoding::Quantization;
+
+const QuantizedState* Snapshot::Find(NetworkID id) const {
+	auto it = std::lower_bound(states.begin(), states.end(), id,
+		[](const QuantizedState& state, NetworkID value) { return state.networkID < value; });
+	return (it != states.end() && it->networkID == id) ? &*it : nullptr;
+}
+
+Snapshot& SnapshotHistory::Insert(SnapshotSequence sequence, Tick tick) {
+	Snapshot& slot = slots[sequence % HISTORY_SIZE];
+	slot.sequence = sequence;
+	slot.tick = tick;
+	slot.states.clear();
+	return slot;
+}
+
+const Snapshot* SnapshotHistory::Find(SnapshotSequence sequence) const {
+	if (sequence == 0) return nullptr;
+	const Snapshot& slot = slots[sequence % HISTORY_SIZE];
+	return slot.sequence == sequence ? &slot : nullptr;
+}
+
+void SnapshotHistory::Clear() {
+	for (Snapshot& slot : slots) {
+		slot.sequence = 0;
+		slot.states.clear();
+	}
+}
+
+namespace SnapshotEncoding {
+
+	namespace {
+		constexpr unsigned COUNT_GROUP_BITS = 7;
+		constexpr unsigned POSITION_DELTA_GROUP_BITS = 3;
+
+		constexpr size_t FULL_FIELD_BITS = 2 * Q::POSITION_BITS + Q::ROTATION_BITS + 2 * Q::VELOCITY_BITS;
+		constexpr size_t MAX_DELTA_BITS = 2 * StateEncoding::VarintBits(COUNT_GROUP_BITS)
+			+ MAX_OBJECTS * StateEncoding::VarintBits(Q::ID_GROUP_BITS)                                            // removals
+			+ MAX_OBJECTS * (StateEncoding::VarintBits(Q::ID_GROUP_BITS) + 3 + 1 + FULL_FIELD_BITS);             // changes
+		static_assert((MAX_DELTA_BITS + 7) / 8 + 1 + Schema::WireSize<SnapshotHeaderMsg> <= MAX_PACKET_SIZE,
+			"A worst case snapshot no longer fits in one packet, lower MAX_OBJECTS");
+
+		size_t SignedVarintBits(int32_t value, unsigned groupBits) {
+			uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+			size_t bits = groupBits + 1;
+			while (zigzag >>= groupBits) bits += groupBits + 1;
+			return bits;
+		}
+
+		void WriteFull(BitWriter& bits, const QuantizedState& state) {
+			bits.WriteBits(state.objectType, Q::TYPE_BITS);
+			bits.WriteBits(state.position[0], Q::POSITION_BITS);
+			bits.WriteBits(state.position[1], Q::POSITION_BITS);
+			bits.WriteBits(state.rotation, Q::ROTATION_BITS);
+			bits.WriteBits(state.velocity[0], Q::VELOCITY_BITS);
+			bits.WriteBits(state.velocity[1], Q::VELOCITY_BITS);
+		}
+
+		void WriteChanges(BitWriter& bits, const QuantizedState& base, const QuantizedState& state) {
+			const bool positionChanged = !state.SamePosition(base);
+			const bool rotationChanged = state.rotation != base.rotation;
+			const bool velocityChanged = !state.SameVelocity(base);
+			bits.WriteBool(positionChanged);
+			bits.WriteBool(rotationChanged);
+			bits.WriteBool(velocityChanged);
+
+			if (positionChanged) {
+				// Moving objects usually travel a few steps per snapshot, so send the difference when that is shorter
+				const int32_t dx = static_cast<int32_t>(state.position[0] - base.position[0]);
+				const int32_t dy = static_cast<int32_t>(state.position[1] - base.position[1]);
+				const bool relative = SignedVarintBits(dx, POSITION_DELTA_GROUP_BITS) + SignedVarintBits(dy, POSITION_DELTA_GROUP_BITS)
+					< 2 * Q::POSITION_BITS;
+				bits.WriteBool(relative);
+				if (relative) {
+					bits.WriteSignedVarint(dx, POSITION_DELTA_GROUP_BITS);
+					bits.WriteSignedVarint(dy, POSITION_DELTA_GROUP_BITS);
+				}
+				else {
+					bits.WriteBits(state.position[0], Q::POSITION_BITS);
+					bits.WriteBits(state.position[1], Q::POSITION_BITS);
+				}
+			}
+			if (rotationChanged) bits.WriteBits(state.rotation, Q::ROTATION_BITS);
+			if (velocityChanged) {
+				bits.WriteBits(state.velocity[0], Q::VELOCITY_BITS);
+				bits.WriteBits(state.velocity[1], Q::VELOCITY_BITS);
+			}
+		}
+
+		void ReadFull(BitReader& bits, QuantizedState& state) {
+			state.objectType = static_cast<uint8_t>(bits.ReadBits(Q::TYPE_BITS));
+			state.position[0] = bits.ReadBits(Q::POSITION_BITS);
+			state.position[1] = bits.ReadBits(Q::POSITION_BITS);
+			state.rotation = bits.ReadBits(Q::ROTATION_BITS);
+			state.velocity[0] = bits.ReadBits(Q::VELOCITY_BITS);
+			state.velocity[1] = bits.ReadBits(Q::VELOCITY_BITS);
+		}
+
+		bool ReadChanges(BitReader& bits, QuantizedState& state) {
+			const bool positionChanged = bits.ReadBool();
+			const bool rotationChanged = bits.ReadBool();
+			const bool velocityChanged = bits.ReadBool();
+
+			if (positionChanged) {
+				if (bits.ReadBool()) {
+					const uint32_t x = state.position[0] + static_cast<uint32_t>(bits.ReadSignedVarint(POSITION_DELTA_GROUP_BITS));
+					const uint32_t y = state.position[1] + static_cast<uint32_t>(bits.ReadSignedVarint(POSITION_DELTA_GROUP_BITS));
+					if (x > Q::POSITION_STEPS || y > Q::POSITION_STEPS) return false;
+					state.position[0] = x;
+					state.position[1] = y;
+				}
+				else {
+					state.position[0] = bits.ReadBits(Q::POSITION_BITS);
+					state.position[1] = bits.ReadBits(Q::POSITION_BITS);
+				}
+			}
+			if (rotationChanged) state.rotation = bits.ReadBits(Q::ROTATION_BITS);
+			if (velocityChanged) {
+				state.velocity[0] = bits.ReadBits(Q::VELOCITY_BITS);
+				state.velocity[1] = bits.ReadBits(Q::VELOCITY_BITS);
+			}
+			return true;
+		}
+	}
+
+	bool EncodeDelta(PacketWriter& writer, const Snapshot* baseline, const Snapshot& current) {
+		static const Snapshot empty;
+		const std::vector<QuantizedState>& base = (baseline ? *baseline : empty).states;
+		const std::vector<QuantizedState>& next = current.states;
+		if (next.size() > MAX_OBJECTS || base.size() > MAX_OBJECTS) return false;
+
+		// Both lists are sorted, so removals and changes fall out of one merge walk each. Changes do not carry
+		// the type, so an object whose type changed is sent as removed and added again.
+		uint32_t removed = 0;
+		uint32_t changed = 0;
+		for (size_t b = 0, n = 0; b < base.size() || n < next.size();) {
+			if (n == next.size() || (b < base.size() && base[b].networkID < next[n].networkID)) { ++removed; ++b; }
+			else if (b == base.size() || next[n].networkID < base[b].networkID) { ++changed; ++n; }
+			else {
+				if (base[b].objectType != next[n].objectType) ++removed;
+				if (!(base[b] == next[n])) ++changed;
+				++b; ++n;
+			}
+		}
+
+		BitWriter bits(writer.Current(), writer.Remaining());
+
+		bits.WriteVarint(removed, COUNT_GROUP_BITS);
+		NetworkID previousID = 0;
+		for (size_t b = 0, n = 0; b < base.size(); ++b) {
+			while (n < next.size() && next[n].networkID < base[b].networkID) ++n;
+			if (n < next.size() && next[n].networkID == base[b].networkID && next[n].objectType == base[b].objectType) continue;
+			bits.WriteSignedVarint(static_cast<int32_t>(base[b].networkID - previousID), Q::ID_GROUP_BITS);
+			previousID = base[b].networkID;
+		}
+
+		bits.WriteVarint(changed, COUNT_GROUP_BITS);
+		previousID = 0;
+		for (size_t b = 0, n = 0; n < next.size(); ++n) {
+			while (b < base.size() && base[b].networkID < next[n].networkID) ++b;
+			const bool same = b < base.size() && base[b].networkID == next[n].networkID;
+			if (same && base[b] == next[n]) continue;
+			const bool known = same && base[b].objectType == next[n].objectType;
+
+			bits.WriteSignedVarint(static_cast<int32_t>(next[n].networkID - previousID), Q::ID_GROUP_BITS);
+			previousID = next[n].networkID;
+			if (known) WriteChanges(bits, base[b], next[n]);
+			else WriteFull(bits, next[n]);
+		}
+
+		if (!bits.Finish()) return false;
+		return writer.Reserve(bits.BytesUsed()) != nullptr;
+	}
+
+	size_t EntryBits(const QuantizedState* base, const QuantizedState& state) {
+		constexpr size_t ID_BITS = 2 * (Q::ID_GROUP_BITS + 1);
+		if (!base) return ID_BITS + Q::TYPE_BITS + FULL_FIELD_BITS;
+		if (*base == state) return 0;
+		if (base->objectType != state.objectType) return 2 * ID_BITS + Q::TYPE_BITS + FULL_FIELD_BITS; // Removed and added
+
+		size_t bits = ID_BITS + 3;
+		if (!state.SamePosition(*base)) {
+			const size_t relative = SignedVarintBits(static_cast<int32_t>(state.position[0] - base->position[0]), POSITION_DELTA_GROUP_BITS)
+				+ SignedVarintBits(static_cast<int32_t>(state.position[1] - base->position[1]), POSITION_DELTA_GROUP_BITS);
+			bits += 1 + std::min(relative, static_cast<size_t>(2 * Q::POSITION_BITS));
+		}
+		if (state.rotation != base->rotation) bits += Q::ROTATION_BITS;
+		if (!state.SameVelocity(*base)) bits += 2 * Q::VELOCITY_BITS;
+		return bits;
+	}
+
+	size_t OverheadBits(size_t removed) {
+		return 2 * StateEncoding::VarintBits(COUNT_GROUP_BITS) + removed * 2 * (Q::ID_GROUP_BITS + 1);
+	}
+
+	bool DecodeDelta(PacketReader& reader, const Snapshot* baseline, Snapshot& current) {
+		static const Snapshot empty;
+		const std::vector<QuantizedState>& base = (baseline ? *baseline : empty).states;
+		current.states.clear();
+
+		BitReader bits(reader.Current(), reader.Remaining());
+
+		// Removed IDs, strictly increasing and all present in the baseline
+		NetworkID removedIDs[MAX_OBJECTS];
+		const uint32_t removed = bits.ReadVarint(COUNT_GROUP_BITS);
+		if (!bits.Ok() || removed > base.size()) return false;
+		NetworkID previousID = 0;
+		for (uint32_t i = 0; i < removed; ++i) {
+			const NetworkID id = previousID + static_cast<uint32_t>(bits.ReadSignedVarint(Q::ID_GROUP_BITS));
+			if ((i > 0 && id <= previousID) || !baseline || !baseline->Find(id)) return false;
+			removedIDs[i] = id;
+			previousID = id;
+		}
+
+		// Copies baseline objects below id that were not removed
+		size_t b = 0;
+		size_t r = 0;
+		auto carryUntil = [&](NetworkID id, bool all) {
+			for (; b < base.size() && (all || base[b].networkID < id); ++b) {
+				if (r < removed && removedIDs[r] == base[b].networkID) { ++r; continue; }
+				current.states.push_back(base[b]);
+			}
+		};
+
+		const uint32_t changed = bits.ReadVarint(COUNT_GROUP_BITS);
+		if (!bits.Ok() || changed > MAX_OBJECTS) return false;
+		previousID = 0;
+		for (uint32_t i = 0; i < changed; ++i) {
+			const NetworkID id = previousID + static_cast<uint32_t>(bits.ReadSignedVarint(Q::ID_GROUP_BITS));
+			if (!bits.Ok() || (i > 0 && id <= previousID)) return false;
+			previousID = id;
+
+			carryUntil(id, false);
+			if (b < base.size() && base[b].networkID == id && r < removed && removedIDs[r] == id) {
+				++b; // Removed and added again: sent in full below
+				++r;
+			}
+			if (b < base.size() && base[b].networkID == id) {
+				QuantizedState state = base[b++];
+				if (!ReadChanges(bits, state)) return false;
+				current.states.push_back(state);
+			}
+			else {
+				QuantizedState state;
+				state.networkID = id;
+				ReadFull(bits, state);
+				current.states.push_back(state);
+			}
+		}
+		carryUntil(0, true);
+
+		if (!bits.Ok() || current.states.size() > MAX_OBJECTS) return false;
+		return reader.Consume(bits.BytesUsed()) != nullptr;
+	}
+}
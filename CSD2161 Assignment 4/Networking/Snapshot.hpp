@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include "StateEncoding.hpp"
+
+using SnapshotSequence = uint32_t; // 0 = no snapshot
+
+/**
+ * \brief World state as one client knows it: the quantized states of every replicated object, sorted by networkID.
+ */
+struct Snapshot {
+	SnapshotSequence sequence = 0;
+	Tick tick = 0;
+	std::vector<StateEncoding::QuantizedState> states;
+
+	const StateEncoding::QuantizedState* Find(NetworkID id) const;
+};
+
+/**
+ * \brief The last HISTORY_SIZE snapshots by sequence number. The host keeps one per client (what it sent),
+ *        the client keeps one for what it received; both sides resolve a delta's baseline through it.
+ *        Slots are reused, so once warmed up recording a snapshot does not allocate.
+ */
+class SnapshotHistory {
+public:
+	static constexpr size_t HISTORY_SIZE = 32;
+
+	// Claims the slot for sequence, dropping whatever it held
+	Snapshot& Insert(SnapshotSequence sequence, Tick tick);
+	const Snapshot* Find(SnapshotSequence sequence) const;
+	void Clear();
+
+private:
+	std::array<Snapshot, HISTORY_SIZE> slots;
+};
+
+/**
+ * \brief Snapshot deltas. A snapshot is sent as the changes from a baseline both ends already have:
+ *
+ *   [removed count varint] then [id delta zigzag] per object gone since the baseline
+ *   [changed count varint] then per new or changed object
+ *     [id delta zigzag] then, for objects the baseline did not have: [type 2][pos x][pos y][rotation][vel x][vel y]
+ *                            otherwise: [position changed 1][rotation changed 1][velocity changed 1] and each changed field,
+ *                            positions as [relative 1] then either two zigzag step deltas or two absolute values
+ *
+ * Unchanged objects cost nothing. Without a baseline every object is new, and one whose type changed is
+ * removed and new at once.
+ */
+namespace SnapshotEncoding {
+	// Kept small enough that a full snapshot plus removing a full baseline always fits one packet
+	constexpr size_t MAX_OBJECTS = 64;
+
+	bool EncodeDelta(PacketWriter& writer, const Snapshot* baseline, const Snapshot& current);
+
+	// About what state adds to a delta against base (nullptr if the baseline does not have it), for budgeting.
+	// Exact but for its ID, which is counted as close to the one before it.
+	size_t EntryBits(const StateEncoding::QuantizedState* base, const StateEncoding::QuantizedState& state);
+
+	// About what a delta takes besides its changed entries, with removed baseline objects left out of it
+	size_t OverheadBits(size_t removed);
+
+	// Rebuilds current from baseline plus the delta; current.sequence and tick are left to the caller
+	bool DecodeDelta(PacketReader& reader, const Snapshot* baseline, Snapshot& current);
+}
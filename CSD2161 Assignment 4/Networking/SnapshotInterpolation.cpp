@@ -0,0 +1,121 @@
+#include "SnapshotInterpolation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+
+namespace {
+	float LerpRotation(float a, float b, float t) {
+		float delta = std::fmod(b - a + glm::pi<float>(), glm::two_pi<float>());
+		if (delta < 0.f) delta += glm::two_pi<float>();
+		return a + (delta - glm::pi<float>()) * t;
+	}
+}
+
+void InterpolationClock::Reset() {
+	*this = InterpolationClock{};
+}
+
+void InterpolationClock::OnSnapshot(Tick tick, double arrivalSeconds, double tickSeconds) {
+	++stats.snapshots;
+	const double transit = arrivalSeconds / tickSeconds - static_cast<double>(tick);
+	if (!started) {
+		started = true;
+		newestTick = tick;
+		lastTransit = transit;
+		renderTick = static_cast<double>(tick) - delay;
+		return;
+	}
+
+	const int32_t step = static_cast<int32_t>(tick - newestTick);
+	if (step <= 0) return;
+	newestTick = tick;
+
+	interval += (static_cast<double>(step) - interval) / 16.0;
+	jitter += (std::abs(transit - lastTransit) - jitter) / 16.0;
+	lastTransit = transit;
+	delay = std::clamp(interval + JITTER_MULTIPLIER * jitter, MIN_DELAY_TICKS, MAX_DELAY_TICKS);
+
+	// Far off (first snapshots after a stall, a host restart): start over rather than drift all the way
+	const double error = static_cast<double>(tick) - delay - renderTick;
+	if (std::abs(error) > MAX_DELAY_TICKS) {
+		renderTick = static_cast<double>(tick) - delay;
+		drift = 0.0;
+		return;
+	}
+	drift += (error - drift) * 0.1;
+}
+
+void InterpolationClock::Advance() {
+	if (!started) return;
+
+	const double adjust = std::clamp(drift * 0.05, -MAX_RATE_ADJUST, MAX_RATE_ADJUST);
+	renderTick += 1.0 + adjust;
+	drift -= adjust;
+
+	stats.depthTicks = static_cast<double>(newestTick) - renderTick;
+	if (stats.depthTicks < 0.0) ++stats.underruns;
+}
+
+void InterpolationBuffer::Push(const Sample& sample) {
+	if (count > 0 && static_cast<int32_t>(sample.tick - At(count - 1).tick) <= 0) return;
+
+	if (count == CAPACITY) {
+		head = (head + 1) % CAPACITY;
+		--count;
+	}
+	samples[(head + count) % CAPACITY] = sample;
+	++count;
+}
+
+void InterpolationBuffer::Clear() {
+	head = 0;
+	count = 0;
+}
+
+InterpolationBuffer::Result InterpolationBuffer::Evaluate(double renderTick, double tickSeconds, double maxExtrapolationTicks,
+	glm::vec3& position, float& rotation) const {
+	if (count == 0) return Result::Empty;
+
+	const Sample& newest = At(count - 1);
+	const double pastNewest = renderTick - static_cast<double>(newest.tick);
+	if (pastNewest >= 0.0) {
+		const float ahead = static_cast<float>(std::min(pastNewest, maxExtrapolationTicks) * tickSeconds);
+		position = newest.position + newest.velocity * ahead;
+		rotation = newest.rotation;
+		return pastNewest > 0.0 ? Result::Extrapolated : Result::Interpolated;
+	}
+
+	// Before the oldest sample there is nothing to blend from yet, hold it
+	const Sample& oldest = At(0);
+	if (renderTick <= static_cast<double>(oldest.tick)) {
+		position = oldest.position;
+		rotation = oldest.rotation;
+		return Result::Interpolated;
+	}
+
+	size_t next = 1;
+	while (static_cast<double>(At(next).tick) <= renderTick) ++next;
+	const Sample& a = At(next - 1);
+	const Sample& b = At(next);
+
+	const double span = static_cast<double>(b.tick - a.tick);
+	const float s = static_cast<float>((renderTick - static_cast<double>(a.tick)) / span);
+	if (glm::distance(a.position, b.position) > TELEPORT_DISTANCE) {
+		position = a.position;
+		rotation = a.rotation;
+		return Result::Interpolated;
+	}
+
+	// Cubic Hermite, the velocities scaled to the span as tangents
+	const float h = static_cast<float>(span * tickSeconds);
+	const float s2 = s * s;
+	const float s3 = s2 * s;
+	position = (2.f * s3 - 3.f * s2 + 1.f) * a.position
+		+ (s3 - 2.f * s2 + s) * h * a.velocity
+		+ (-2.f * s3 + 3.f * s2) * b.position
+		+ (s3 - s2) * h * b.velocity;
+	rotation = LerpRotation(a.rotation, b.rotation, s);
+	return Result::Interpolated;
+}
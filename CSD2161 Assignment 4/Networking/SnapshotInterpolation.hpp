@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include "Messages.hpp"
+
+/**
+ * \brief Client-side view of how remote objects are being shown, for the network UI and tuning.
+ */
+struct InterpolationStats {
+	double depthTicks = 0.0;     // How far the newest snapshot is ahead of render time, at the last step
+	uint64_t underruns = 0;      // Steps on which render time had passed the newest snapshot
+	uint64_t extrapolations = 0; // Moving remote objects shown past their newest state
+	uint64_t samples = 0;        // Remote objects shown, over all steps
+	uint64_t snapshots = 0;      // Applied
+};
+
+/**
+ * \brief Client-side clock remote objects are shown on: host ticks, a little behind the newest snapshot.
+ *
+ * How far behind follows the measured snapshot interval plus JITTER_MULTIPLIER times the jitter in their
+ * arrival (RFC 3550 style), so a sample is usually there before it is needed. Render time advances one tick
+ * per fixed step and is sped up or slowed down by at most MAX_RATE_ADJUST to drift towards that delay,
+ * rather than jumping.
+ */
+class InterpolationClock {
+public:
+	static constexpr double MIN_DELAY_TICKS = 1.0;
+	static constexpr double MAX_DELAY_TICKS = 30.0;
+	static constexpr double JITTER_MULTIPLIER = 3.0;
+	static constexpr double MAX_EXTRAPOLATION_TICKS = 15.0; // Past a remote object's newest state
+	static constexpr double MAX_RATE_ADJUST = 0.1;          // Fraction of a tick per step
+
+	void Reset();
+
+	// For every snapshot applied: the host tick it was taken on and when it arrived, in seconds
+	void OnSnapshot(Tick tick, double arrivalSeconds, double tickSeconds);
+
+	// Once per fixed step
+	void Advance();
+
+	inline bool IsRunning() const { return started; }
+	inline double GetRenderTick() const { return renderTick; }
+	inline double GetDelay() const { return delay; }     // Ticks
+	inline double GetJitter() const { return jitter; }   // Ticks
+	inline double GetInterval() const { return interval; } // Ticks between snapshots
+
+	InterpolationStats stats;
+
+private:
+	bool started = false;
+	Tick newestTick = 0;
+	double renderTick = 0.0;
+	double delay = 3.0;
+	double interval = 2.0;
+	double jitter = 0.0;
+	double lastTransit = 0.0;
+	double drift = 0.0; // Smoothed distance from where render time should be, still to be made up
+};
+
+/**
+ * \brief The last few replicated states of one remote object, oldest first, and where that puts it at a
+ *        given render time: cubic Hermite between the two states around it (using their velocities), or
+ *        moved on by the newest velocity once render time is past it.
+ */
+class InterpolationBuffer {
+public:
+	static constexpr size_t CAPACITY = 8;
+	static constexpr float TELEPORT_DISTANCE = 20.f; // Farther apart than this (screen wrap) is not blended
+
+	struct Sample {
+		Tick tick = 0;
+		glm::vec3 position{ 0.f };
+		glm::vec3 velocity{ 0.f };
+		float rotation = 0.f;
+	};
+
+	enum class Result {
+		Empty,
+		Interpolated,
+		Extrapolated // Render time was past the newest sample
+	};
+
+	// Samples must come newest last; one that is not newer than the newest is ignored
+	void Push(const Sample& sample);
+	void Clear();
+	inline size_t Size() const { return count; }
+
+	Result Evaluate(double renderTick, double tickSeconds, double maxExtrapolationTicks, glm::vec3& position, float& rotation) const;
+
+private:
+	inline const Sample& At(size_t i) const { return samples[(head + i) % CAPACITY]; }
+
+	std::array<Sample, CAPACITY> samples{};
+	size_t head = 0; // Oldest
+	size_t count = 0;
+};
@@ -1,10 +1,10 @@
 #include "SocketManager.hpp"
 #include <iostream>
-#include "ws2tcpip.h"
+#include <algorithm>
 
-#pragma comment(lib, "ws2_32.lib")
-
-#define MAX_PACKET_SIZE 1472
+bool SocketManager::Initialize() {
+    return transport->Startup();
+}
 
 bool SocketManager::Host(const std::string& port) {
 	char hostname[256];
@@ -21,25 +21,21 @@ bool SocketManager::Host(const std::string& port) {
         return false;
     }
 
-    udpListeningSocket = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
-    if (udpListeningSocket == INVALID_SOCKET) {
-        std::cerr << "Failed to create host socket.\n";
-        freeaddrinfo(info);
-        return false;
-    }
+    // Bind to every interface on the requested port; the hostname lookup is only used
+    // to report an address clients can reach (it may resolve to a loopback alias on Linux).
+    sockaddr_in bindAddr{};
+    memcpy(&bindAddr, info->ai_addr, sizeof(bindAddr));
+    bindAddr.sin_addr.s_addr = htonl(INADDR_ANY);
 
-    if (bind(udpListeningSocket, info->ai_addr, static_cast<int>(info->ai_addrlen)) != 0) {
+    if (!transport->Open(&bindAddr)) {
         std::cerr << "Failed to bind host socket.\n";
         freeaddrinfo(info);
-        closesocket(udpListeningSocket);
-        udpListeningSocket = INVALID_SOCKET;
         return false;
     }
 
     inet_ntop(AF_INET, &(((sockaddr_in*)info->ai_addr)->sin_addr), hostname, sizeof(hostname));
     localIP = hostname;
 
-    SetNonBlocking(udpListeningSocket);
     freeaddrinfo(info);
     return true;
 }
@@ -56,8 +52,7 @@ bool SocketManager::Connect(const std::string& ip, const std::string& port)
         return false;
     }
 
-    clientSocket = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
-    if (clientSocket == INVALID_SOCKET) {
+    if (!transport->Open(nullptr)) {
         std::cerr << "Failed to create client socket.\n";
         freeaddrinfo(info);
         return false;
@@ -72,47 +67,41 @@ bool SocketManager::Connect(const std::string& ip, const std::string& port)
 }
 
 bool SocketManager::ConnectWithHandshake(const std::string& ip, const std::string& port, uint8_t sendCommand, uint8_t expectedResponse,
-    const std::string& playerName)
+    const std::string& playerName, PacketBuffer* response)
 {
     if (!Connect(ip, port)) return false;
 
     const int maxRetries = 10;
+    const int timeoutMs = 1000; // 1 second timeout
     int retryCount = 0;
     bool connectionEstablished = false;
     uint8_t cmd = sendCommand;
-    fd_set readfds;
-    timeval timeout = { 1, 0 }; // 1 second timeout
 
     while (!connectionEstablished && retryCount < maxRetries) {
-        std::vector<char> packet;
-        packet.push_back(static_cast<char>(cmd));
+        PacketBuffer packet;
+        PacketWriter writer(packet);
+        writer.WriteU8(cmd);
 
         uint8_t nameLen = static_cast<uint8_t>(std::min<size_t>(playerName.size(), 255));
-        packet.push_back(static_cast<char>(nameLen));
+        writer.WriteU8(nameLen);
 
-        packet.insert(packet.end(), playerName.begin(), playerName.begin() + nameLen);
+        writer.WriteBytes(playerName.data(), nameLen);
 
 
         bool success = SendToHost(packet);
         if (!success) {
-            std::cerr << "sendto() failed. Error: " << WSAGetLastError() << "\n";
+            std::cerr << "sendto() failed.\n";
             break;
         }
 
-        FD_ZERO(&readfds);
-        FD_SET(clientSocket, &readfds);
-        int selResult = select(0, &readfds, NULL, NULL, &timeout);
-        if (selResult > 0 && FD_ISSET(clientSocket, &readfds)) {
-            char response;
+        if (transport->WaitForData(timeoutMs)) {
+            PacketBuffer reply;
             sockaddr_in serverAddr;
-            int addrLen = sizeof(serverAddr);
-            int recvResult = recvfrom(clientSocket, &response, sizeof(response), 0,
-                reinterpret_cast<sockaddr*>(&serverAddr), &addrLen);
-            if (recvResult > 0 && static_cast<uint8_t>(response) == expectedResponse) {
+            int recvResult = transport->ReceiveFrom(reply.data, sizeof(reply.data), serverAddr);
+            if (recvResult > 0 && static_cast<uint8_t>(reply.data[0]) == expectedResponse) {
                 connectionEstablished = true;
-                //serverInfo.ipAddress = ip;
-                //serverInfo.port = std::stoi(port);
-                //memcpy(&serverInfo.address, &serverAddr, sizeof(serverAddr));
+                reply.size = static_cast<size_t>(recvResult);
+                if (response) *response = reply;
                 std::cout << "Handshake response received from server.\n";
                 break;
             }
@@ -123,57 +112,47 @@ bool SocketManager::ConnectWithHandshake(const std::string& ip, const std::strin
 
     if (!connectionEstablished) {
         std::cerr << "Handshake failed after retries.\n";
-        closesocket(clientSocket);
-        clientSocket = INVALID_SOCKET;
+        transport->Close();
         return false;
     }
 
-    SetNonBlocking(clientSocket);
     return true;
 }
 
 void SocketManager::Cleanup()
 {
-    if (udpListeningSocket != INVALID_SOCKET) {
-        closesocket(udpListeningSocket);
-        udpListeningSocket = INVALID_SOCKET;
-    }
-    if (clientSocket != INVALID_SOCKET) {
-        closesocket(clientSocket);
-        clientSocket = INVALID_SOCKET;
-    }
+    transport->Close();
+}
+
+void SocketManager::Shutdown()
+{
+    transport->Shutdown();
 }
 
-bool SocketManager::SendToClient(const sockaddr_in& clientAddr, const std::vector<char>& data)
+bool SocketManager::SendToClient(const sockaddr_in& clientAddr, const PacketBuffer& packet)
 {
-    return sendto(udpListeningSocket, data.data(), static_cast<int>(data.size()), 0,
-        reinterpret_cast<const sockaddr*>(&clientAddr), sizeof(clientAddr)) != SOCKET_ERROR;
+    return transport->SendTo(clientAddr, packet.data, packet.size);
 }
 
 bool SocketManager::SendToClient(const sockaddr_in& clientAddr, const char& data)
 {
-    return sendto(udpListeningSocket, &data, sizeof(data), 0,
-        reinterpret_cast<const sockaddr*>(&clientAddr), sizeof(clientAddr)) != SOCKET_ERROR;
+    return transport->SendTo(clientAddr, &data, sizeof(data));
 }
 
-bool SocketManager::SendToHost(const std::vector<char>& data)
+bool SocketManager::SendToHost(const PacketBuffer& packet)
 {
-    return sendto(clientSocket, data.data(), static_cast<int>(data.size()), 0,
-        reinterpret_cast<sockaddr*>(&serverInfo.address), sizeof(serverInfo.address)) != SOCKET_ERROR;
+    return transport->SendTo(serverInfo.address, packet.data, packet.size);
 }
 
 bool SocketManager::SendToHost(const char& data)
 {
-    return sendto(clientSocket, &data, sizeof(data), 0,
-        reinterpret_cast<sockaddr*>(&serverInfo.address), sizeof(serverInfo.address)) != SOCKET_ERROR;
+    return transport->SendTo(serverInfo.address, &data, sizeof(data));
 }
 
 bool SocketManager::ReceiveFromClient(std::vector<char>& outData, sockaddr_in& outAddr)
 {
     char buffer[MAX_PACKET_SIZE];
-    int addrLen = sizeof(outAddr);
-    int result = recvfrom(udpListeningSocket, buffer, sizeof(buffer), 0,
-        reinterpret_cast<sockaddr*>(&outAddr), &addrLen);
+    int result = transport->ReceiveFrom(buffer, sizeof(buffer), outAddr);
     if (result > 0) {
         outData.assign(buffer, buffer + result);
         return true;
@@ -184,9 +163,7 @@ bool SocketManager::ReceiveFromClient(std::vector<char>& outData, sockaddr_in& o
 bool SocketManager::ReceiveFromHost(std::vector<char>& outData)
 {
     char buffer[MAX_PACKET_SIZE];
-    int addrLen = sizeof(serverInfo.address);
-    int result = recvfrom(clientSocket, buffer, sizeof(buffer), 0,
-        reinterpret_cast<sockaddr*>(&serverInfo.address), &addrLen);
+    int result = transport->ReceiveFrom(buffer, sizeof(buffer), serverInfo.address);
     if (result > 0) {
         outData.assign(buffer, buffer + result);
         return true;
@@ -194,8 +171,18 @@ bool SocketManager::ReceiveFromHost(std::vector<char>& outData)
     return false;
 }
 
-void SocketManager::SetNonBlocking(SOCKET sock)
+bool SocketManager::SendToClients(const sockaddr_in* clientAddrs, size_t count, const char* data, size_t size)
+{
+    if (count == 0) return true;
+    return transport->SendToMany(clientAddrs, count, data, size);
+}
+
+size_t SocketManager::ReceiveBatch()
+{
+    return transport->ReceiveMany(receiveRing.data(), receiveRing.size());
+}
+
+void SocketManager::Flush()
 {
-    u_long mode = 1;
-    ioctlsocket(sock, FIONBIO, &mode);
+    transport->Flush();
 }
@@ -2,41 +2,68 @@
 
 #include <string>
 #include <vector>
-#include "WinSock2.h"
+#include <memory>
+#include <array>
+#include "NetworkPlatform.hpp"
+#include "Transport.hpp"
+#include "PacketBuffer.hpp"
 
 class SocketManager {
+public:
+	static constexpr size_t RECEIVE_RING_SIZE = 64;
+
+private:
 	struct Server {
 		sockaddr_in address;
 		std::string ipAddress;
 		uint16_t port = 0;
 	};
 public:
+	SocketManager() : transport(Transport::Create()) {}
+
+	bool Initialize();
 	bool Host(const std::string& port);
 	bool Connect(const std::string& ip, const std::string& port);
+	// response, if given, receives the host's whole answer
 	bool ConnectWithHandshake(const std::string& ip, const std::string& port, 
 		uint8_t sendCommand, uint8_t expectedResponse,
-		const std::string& playerName);
+		const std::string& playerName, PacketBuffer* response = nullptr);
 	void Cleanup();
+	void Shutdown();
 
-	bool SendToClient(const sockaddr_in& clientAddr, const std::vector<char>& data);
+	bool SendToClient(const sockaddr_in& clientAddr, const PacketBuffer& packet);
 	bool SendToClient(const sockaddr_in& clientAddr, const char& data);
-	bool SendToHost(const std::vector<char>& data);
+	bool SendToHost(const PacketBuffer& packet);
 	bool SendToHost(const char& data);
 
 	bool ReceiveFromClient(std::vector<char>& outData, sockaddr_in& outAddr);
 	bool ReceiveFromHost(std::vector<char>& outData);
 
+	// Sends one payload to every address in one go (sendmmsg fan-out on the epoll transport)
+	bool SendToClients(const sockaddr_in* clientAddrs, size_t count, const char* data, size_t size);
+
+	// Drains up to RECEIVE_RING_SIZE pending datagrams into the receive ring, valid until the next call
+	size_t ReceiveBatch();
+	inline const Datagram& GetReceived(size_t index) const { return receiveRing[index]; }
+
+	// Pushes out sends that the transport batched during this frame
+	void Flush();
+
+	// The host is done with the client that joined from clientAddr
+	inline void ReleaseClient(const sockaddr_in& clientAddr) { transport->ReleasePeer(clientAddr); }
+
+	// Swaps the underlying transport, e.g. to wrap it. Must be called before Host/Connect.
+	void SetTransport(std::unique_ptr<Transport> newTransport) { transport = std::move(newTransport); }
+	Transport& GetTransport() { return *transport; }
+
 	inline std::string GetLocalIP() const {
 		return localIP;
 	}
 
 	Server serverInfo;
 private:
-	SOCKET udpListeningSocket = INVALID_SOCKET;
-	SOCKET clientSocket = INVALID_SOCKET;
+	std::unique_ptr<Transport> transport;
+	std::array<Datagram, RECEIVE_RING_SIZE> receiveRing;
 
 	std::string localIP;
-
-	void SetNonBlocking(SOCKET sock);
 };
-
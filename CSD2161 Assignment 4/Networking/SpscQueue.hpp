@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * \brief Bounded lock-free queue between exactly one producer thread and one consumer thread.
+ *
+ * Items are filled and read in place (BeginPush/EndPush, Front/Pop), so large ones such as Datagrams are not
+ * copied through temporaries. head and tail count up forever and each side caches the other's last value, so
+ * an uncontended push or pop touches no cache line the other thread is writing.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	// Producer: the slot to fill, or nullptr when the queue is full
+	T* BeginPush() {
+		const size_t position = tail.load(std::memory_order_relaxed);
+		if (position - cachedHead == Capacity) {
+			cachedHead = head.load(std::memory_order_acquire);
+			if (position - cachedHead == Capacity) return nullptr;
+		}
+		return &slots[position & (Capacity - 1)];
+	}
+	// Producer: publishes the slot BeginPush returned
+	void EndPush() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+	// Consumer: the oldest item, or nullptr when the queue is empty
+	T* Front() {
+		const size_t position = head.load(std::memory_order_relaxed);
+		if (position == cachedTail) {
+			cachedTail = tail.load(std::memory_order_acquire);
+			if (position == cachedTail) return nullptr;
+		}
+		return &slots[position & (Capacity - 1)];
+	}
+	// Consumer: hands the slot Front returned back to the producer
+	void Pop() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+private:
+	alignas(64) std::atomic<size_t> head{ 0 }; // Written by the consumer
+	size_t cachedTail = 0;                      // Consumer's copy
+	alignas(64) std::atomic<size_t> tail{ 0 }; // Written by the producer
+	size_t cachedHead = 0;                      // Producer's copy
+	alignas(64) std::array<T, Capacity> slots;
+};
@@ -0,0 +1,59 @@
+#include "StateEncoding.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+namespace StateEncoding {
+
+	namespace {
+		using Q = Quantization;
+
+		uint32_t QuantizeRange(float value, float range, float precision, uint32_t steps) {
+			if (!(value == value)) value = 0.f; // NaN
+			value = std::clamp(value, -range, range);
+			return std::min(static_cast<uint32_t>(std::lround((value + range) / precision)), steps);
+		}
+
+		float DequantizeRange(uint32_t value, float range, float precision, uint32_t steps) {
+			return static_cast<float>(std::min(value, steps)) * precision - range;
+		}
+
+		uint32_t QuantizeRotation(float rotation) {
+			constexpr uint32_t steps = 1u << Q::ROTATION_BITS;
+			float turns = std::fmod(rotation, glm::two_pi<float>()) / glm::two_pi<float>();
+			if (!(turns == turns)) turns = 0.f;
+			if (turns < 0.f) turns += 1.f;
+			return static_cast<uint32_t>(std::lround(turns * steps)) & (steps - 1);
+		}
+
+		float DequantizeRotation(uint32_t value) {
+			return static_cast<float>(value) * (glm::two_pi<float>() / static_cast<float>(1u << Q::ROTATION_BITS));
+		}
+	}
+
+	QuantizedState Quantize(const ObjectStateMsg& state) {
+		QuantizedState q;
+		q.networkID = state.networkID;
+		q.objectType = state.objectType;
+		q.position[0] = QuantizeRange(state.position.x, Q::POSITION_RANGE, Q::POSITION_PRECISION, Q::POSITION_STEPS);
+		q.position[1] = QuantizeRange(state.position.y, Q::POSITION_RANGE, Q::POSITION_PRECISION, Q::POSITION_STEPS);
+		q.rotation = QuantizeRotation(state.rotation);
+		q.velocity[0] = QuantizeRange(state.velocity.x, Q::VELOCITY_RANGE, Q::VELOCITY_PRECISION, Q::VELOCITY_STEPS);
+		q.velocity[1] = QuantizeRange(state.velocity.y, Q::VELOCITY_RANGE, Q::VELOCITY_PRECISION, Q::VELOCITY_STEPS);
+		return q;
+	}
+
+	ObjectStateMsg Dequantize(const QuantizedState& q, Tick tick) {
+		ObjectStateMsg state;
+		state.networkID = q.networkID;
+		state.tick = tick;
+		state.objectType = q.objectType;
+		state.position.x = DequantizeRange(q.position[0], Q::POSITION_RANGE, Q::POSITION_PRECISION, Q::POSITION_STEPS);
+		state.position.y = DequantizeRange(q.position[1], Q::POSITION_RANGE, Q::POSITION_PRECISION, Q::POSITION_STEPS);
+		state.rotation = DequantizeRotation(q.rotation);
+		state.velocity.x = DequantizeRange(q.velocity[0], Q::VELOCITY_RANGE, Q::VELOCITY_PRECISION, Q::VELOCITY_STEPS);
+		state.velocity.y = DequantizeRange(q.velocity[1], Q::VELOCITY_RANGE, Q::VELOCITY_PRECISION, Q::VELOCITY_STEPS);
+		return state;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "PacketBuffer.hpp"
+#include "Messages.hpp"
+
+/**
+ * \brief Quantization of ObjectStateMsg fields to fixed-width integers, as snapshots send them (Snapshot.hpp).
+ *
+ * Positions and velocities are clamped to their range and quantized to their precision, so within range the
+ * decoded value is off by at most half a step; rotations are wrapped to [0, 2pi) and off by at most
+ * pi / 2^ROTATION_BITS. Both ends must be built with the same settings.
+ */
+namespace StateEncoding {
+
+	constexpr unsigned BitsFor(uint32_t maxValue) {
+		unsigned bits = 0;
+		while (bits < 32 && (maxValue >> bits) != 0) ++bits;
+		return bits;
+	}
+
+	constexpr uint32_t StepsFor(float range, float precision) {
+		return static_cast<uint32_t>(2.f * range / precision + 0.5f);
+	}
+
+	struct Quantization {
+		static constexpr float POSITION_RANGE = 128.f;      // World units either side of the origin
+		static constexpr float POSITION_PRECISION = 0.01f;
+		static constexpr float VELOCITY_RANGE = 16.f;       // Players top out around 8.3 units/s
+		static constexpr float VELOCITY_PRECISION = 1.f / 64.f;
+		static constexpr unsigned ROTATION_BITS = 11;
+
+		static constexpr uint32_t POSITION_STEPS = StepsFor(POSITION_RANGE, POSITION_PRECISION);
+		static constexpr uint32_t VELOCITY_STEPS = StepsFor(VELOCITY_RANGE, VELOCITY_PRECISION);
+		static constexpr unsigned POSITION_BITS = BitsFor(POSITION_STEPS);
+		static constexpr unsigned VELOCITY_BITS = BitsFor(VELOCITY_STEPS);
+		static constexpr unsigned TYPE_BITS = 2;
+		static constexpr unsigned ID_GROUP_BITS = 4;
+	};
+
+	static_assert(Quantization::ROTATION_BITS >= 10 && Quantization::ROTATION_BITS <= 12, "Rotation is sent with 10-12 bits");
+	static_assert(Quantization::POSITION_BITS <= 32 && Quantization::VELOCITY_BITS <= 32, "Quantized field wider than 32 bits");
+
+	// Longest a varint of a 32-bit value gets, in groupBits groups each with a continuation bit; used to size snapshots
+	constexpr size_t VarintBits(unsigned groupBits) { return ((32 + groupBits - 1) / groupBits) * (groupBits + 1); }
+
+	/**
+	 * \brief An ObjectStateMsg as it travels, in quantization steps. Two states that compare equal
+	 *        decode to the same values, which is what snapshot deltas compare against.
+	 */
+	struct QuantizedState {
+		NetworkID networkID = 0;
+		uint8_t objectType = 0;
+		uint32_t position[2] = {};
+		uint32_t rotation = 0;
+		uint32_t velocity[2] = {};
+
+		bool SamePosition(const QuantizedState& other) const { return position[0] == other.position[0] && position[1] == other.position[1]; }
+		bool SameVelocity(const QuantizedState& other) const { return velocity[0] == other.velocity[0] && velocity[1] == other.velocity[1]; }
+		bool operator==(const QuantizedState& other) const {
+			return networkID == other.networkID && objectType == other.objectType && rotation == other.rotation
+				&& SamePosition(other) && SameVelocity(other);
+		}
+	};
+
+	QuantizedState Quantize(const ObjectStateMsg& state);
+	ObjectStateMsg Dequantize(const QuantizedState& state, Tick tick);
+}
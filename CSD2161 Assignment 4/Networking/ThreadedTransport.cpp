@@ -0,0 +1,141 @@
+#include "ThreadedTransport.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+ThreadedTransport::ThreadedTransport(std::unique_ptr<Transport> inner, IoHandler handler)
+	: inner(std::move(inner)), handler(std::move(handler)) {}
+
+ThreadedTransport::~ThreadedTransport() {
+	Close();
+}
+
+void ThreadedTransport::Shutdown() {
+	Close();
+	inner->Shutdown();
+}
+
+bool ThreadedTransport::Open(const sockaddr_in* localAddr) {
+	Close();
+	if (!inner->Open(localAddr)) return false;
+
+	// Whatever an earlier connection left in the queues is dropped with it
+	while (inbound->Front()) inbound->Pop();
+	while (outbound->Front()) outbound->Pop();
+
+	running.store(true);
+	thread = std::thread(&ThreadedTransport::Run, this);
+	return true;
+}
+
+void ThreadedTransport::Close() {
+	running.store(false);
+	if (thread.joinable()) thread.join();
+	inner->Close();
+}
+
+bool ThreadedTransport::SendTo(const sockaddr_in& to, const char* data, size_t size) {
+	if (size > MAX_PACKET_SIZE) return false;
+
+	Datagram* slot = outbound->BeginPush();
+	if (!slot) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	slot->addr = to;
+	slot->size = size;
+	std::memcpy(slot->data, data, size);
+	outbound->EndPush();
+	return true;
+}
+
+int ThreadedTransport::ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) {
+	Datagram* datagram = inbound->Front();
+	if (!datagram) return 0;
+
+	const size_t size = std::min(datagram->size, capacity);
+	std::memcpy(buffer, datagram->data, size);
+	from = datagram->addr;
+	inbound->Pop();
+	return static_cast<int>(size);
+}
+
+bool ThreadedTransport::WaitForData(int timeoutMs) {
+	// Only the handshake waits; the I/O thread does the real waiting on the socket
+	const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (!inbound->Front()) {
+		if (std::chrono::steady_clock::now() >= until) return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+	}
+	return true;
+}
+
+size_t ThreadedTransport::ReceiveMany(Datagram* out, size_t maxCount) {
+	CollectStats();
+
+	size_t count = 0;
+	while (count < maxCount) {
+		Datagram* datagram = inbound->Front();
+		if (!datagram) break;
+		out[count].addr = datagram->addr;
+		out[count].size = datagram->size;
+		out[count].receivedTime = datagram->receivedTime;
+		std::memcpy(out[count].data, datagram->data, datagram->size);
+		inbound->Pop();
+		++count;
+	}
+	return count;
+}
+
+void ThreadedTransport::Run() {
+	while (running.load(std::memory_order_relaxed)) {
+		// What the simulation queued goes out first
+		while (Datagram* datagram = outbound->Front()) {
+			inner->SendTo(datagram->addr, datagram->data, datagram->size);
+			outbound->Pop();
+		}
+
+		size_t received;
+		while ((received = inner->ReceiveMany(batch.data(), batch.size())) > 0) {
+			for (size_t i = 0; i < received; ++i) {
+				Datagram& datagram = batch[i];
+				if (handler.receive && handler.receive(datagram, *inner)) continue;
+
+				Datagram* slot = inbound->BeginPush();
+				if (!slot) {
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					continue;
+				}
+				slot->addr = datagram.addr;
+				slot->size = datagram.size;
+				slot->receivedTime = datagram.receivedTime;
+				std::memcpy(slot->data, datagram.data, datagram.size);
+				inbound->EndPush();
+			}
+		}
+
+		if (handler.poll) handler.poll(*inner);
+		inner->Flush();
+		PublishStats();
+
+		inner->WaitForData(POLL_MS);
+	}
+}
+
+void ThreadedTransport::PublishStats() {
+	const TransportStats& io = inner->GetStats();
+	ioSyscalls.fetch_add(io.syscalls, std::memory_order_relaxed);
+	ioDatagramsSent.fetch_add(io.datagramsSent, std::memory_order_relaxed);
+	ioDatagramsReceived.fetch_add(io.datagramsReceived, std::memory_order_relaxed);
+	ioBytesSent.fetch_add(io.bytesSent, std::memory_order_relaxed);
+	ioBytesReceived.fetch_add(io.bytesReceived, std::memory_order_relaxed);
+	inner->ResetStats();
+}
+
+void ThreadedTransport::CollectStats() {
+	stats.syscalls += ioSyscalls.exchange(0, std::memory_order_relaxed);
+	stats.datagramsSent += ioDatagramsSent.exchange(0, std::memory_order_relaxed);
+	stats.datagramsReceived += ioDatagramsReceived.exchange(0, std::memory_order_relaxed);
+	stats.bytesSent += ioBytesSent.exchange(0, std::memory_order_relaxed);
+	stats.bytesReceived += ioBytesReceived.exchange(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include "Transport.hpp"
+#include "SpscQueue.hpp"
+
+/**
+ * \brief Runs another transport on a dedicated network I/O thread.
+ *
+ * The I/O thread owns the inner socket. It takes datagrams off it as they arrive and queues them, stamped, for
+ * the simulation thread, and sends what the simulation queued; the two threads share nothing but the two
+ * SpscQueues. So receive times no longer depend on when the next frame runs, and a slow frame does not hold up
+ * the socket.
+ *
+ * An IoHandler, run on the I/O thread, can answer datagrams (and keep them from the simulation) and send on
+ * its own timer, for the replies that should not wait for a frame at all.
+ */
+class ThreadedTransport : public Transport {
+public:
+	static constexpr size_t QUEUE_SIZE = 256; // Datagrams each way
+	static constexpr int POLL_MS = 1;         // Longest a queued send waits for the I/O thread
+
+	struct IoHandler {
+		// I/O thread: true if it dealt with datagram and the simulation should not see it. It may also
+		// rewrite the datagram before the simulation gets it.
+		std::function<bool(Datagram& datagram, Transport& socket)> receive;
+		// I/O thread: after every pass over the socket
+		std::function<void(Transport& socket)> poll;
+	};
+
+	ThreadedTransport(std::unique_ptr<Transport> inner, IoHandler handler);
+	~ThreadedTransport() override;
+
+	bool Startup() override { return inner->Startup(); }
+	void Shutdown() override;
+
+	bool Open(const sockaddr_in* localAddr) override; // Starts the I/O thread
+	void Close() override;                            // Stops it
+	bool IsOpen() const override { return running.load(std::memory_order_relaxed); }
+
+	// Queued for the I/O thread; false if the queue is full
+	bool SendTo(const sockaddr_in& to, const char* data, size_t size) override;
+	int ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) override;
+	bool WaitForData(int timeoutMs) override;
+	size_t ReceiveMany(Datagram* out, size_t maxCount) override;
+
+	// Datagrams lost because a queue was full, either way
+	inline uint64_t GetDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+	void Run();
+	void PublishStats(); // I/O thread, hands the inner transport's counters over
+	void CollectStats(); // Simulation thread, adds them to stats
+
+	std::unique_ptr<Transport> inner;
+	IoHandler handler;
+	std::thread thread;
+	std::atomic<bool> running{ false };
+	std::atomic<uint64_t> dropped{ 0 };
+
+	using Queue = SpscQueue<Datagram, QUEUE_SIZE>;
+	std::unique_ptr<Queue> inbound = std::make_unique<Queue>();  // I/O thread -> simulation
+	std::unique_ptr<Queue> outbound = std::make_unique<Queue>(); // Simulation -> I/O thread
+	std::array<Datagram, 64> batch; // I/O thread's receive batch
+
+	// The inner transport's counters since the simulation last collected them
+	std::atomic<uint64_t> ioSyscalls{ 0 }, ioDatagramsSent{ 0 }, ioDatagramsReceived{ 0 }, ioBytesSent{ 0 }, ioBytesReceived{ 0 };
+};
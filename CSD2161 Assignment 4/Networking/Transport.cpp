@@ -0,0 +1,34 @@
+#include "Transport.hpp"
+#include "WinsockTransport.hpp"
+#include "EpollTransport.hpp"
+
+std::unique_ptr<Transport> Transport::Create() {
+#if defined(NET_TRANSPORT_EPOLL)
+	return std::make_unique<EpollTransport>();
+#else
+	return std::make_unique<WinsockTransport>();
+#endif
+}
+
+// Fallbacks for backends without a native batch call, one datagram per syscall
+
+size_t Transport::ReceiveMany(Datagram* out, size_t maxCount) {
+	const auto now = std::chrono::steady_clock::now();
+	size_t count = 0;
+	while (count < maxCount) {
+		int result = ReceiveFrom(out[count].data, sizeof(out[count].data), out[count].addr);
+		if (result <= 0) break;
+		out[count].size = static_cast<size_t>(result);
+		out[count].receivedTime = now;
+		++count;
+	}
+	return count;
+}
+
+bool Transport::SendToMany(const sockaddr_in* to, size_t count, const char* data, size_t size) {
+	bool allSent = true;
+	for (size_t i = 0; i < count; ++i) {
+		allSent &= SendTo(to[i], data, size);
+	}
+	return allSent;
+}
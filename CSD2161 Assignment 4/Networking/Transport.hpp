@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include "NetworkPlatform.hpp"
+
+#define MAX_PACKET_SIZE 1472
+
+/**
+ * \brief One received datagram, its sender, and when it was taken off the socket.
+ */
+struct Datagram {
+	sockaddr_in addr;
+	size_t size = 0;
+	std::chrono::steady_clock::time_point receivedTime{};
+	char data[MAX_PACKET_SIZE];
+};
+
+/**
+ * \brief Running I/O counters of a transport, reset by the owner whenever it takes a sample.
+ */
+struct TransportStats {
+	uint64_t syscalls = 0;			// send/recv/wait calls made into the OS
+	uint64_t datagramsSent = 0;
+	uint64_t datagramsReceived = 0;
+	uint64_t bytesSent = 0;
+	uint64_t bytesReceived = 0;
+};
+
+/**
+ * \brief A single non-blocking UDP endpoint.
+ *
+ * SocketManager talks to the OS only through this interface. The concrete backend
+ * (Winsock or epoll) is picked at build time by Transport::Create().
+ */
+class Transport {
+public:
+	virtual ~Transport() = default;
+
+	/**
+	 * \brief Process-wide socket library setup and teardown (WSAStartup/WSACleanup on Windows).
+	 */
+	virtual bool Startup() = 0;
+	virtual void Shutdown() = 0;
+
+	/**
+	 * \brief Opens a non-blocking UDP socket, replacing any socket already open.
+	 * \param localAddr Address to bind to (host), or nullptr for an ephemeral port (client).
+	 */
+	virtual bool Open(const sockaddr_in* localAddr) = 0;
+	virtual void Close() = 0;
+	virtual bool IsOpen() const = 0;
+
+	/**
+	 * \brief Sends one datagram. Backends may queue it until Flush().
+	 */
+	virtual bool SendTo(const sockaddr_in& to, const char* data, size_t size) = 0;
+
+	/**
+	 * \brief Reads one pending datagram without blocking.
+	 * \return Number of bytes written to buffer, 0 when nothing is pending.
+	 */
+	virtual int ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) = 0;
+
+	/**
+	 * \brief Blocks for up to timeoutMs until a datagram can be read. Flushes queued sends first.
+	 */
+	virtual bool WaitForData(int timeoutMs) = 0;
+
+	/**
+	 * \brief Pushes out any datagrams queued by SendTo().
+	 */
+	virtual void Flush() {}
+
+	/**
+	 * \brief Reads up to maxCount pending datagrams straight into out without blocking, and stamps them.
+	 * \return Number of datagrams read, 0 when nothing is pending.
+	 */
+	virtual size_t ReceiveMany(Datagram* out, size_t maxCount);
+
+	/**
+	 * \brief Sends the same payload to count destinations.
+	 */
+	virtual bool SendToMany(const sockaddr_in* to, size_t count, const char* data, size_t size);
+
+	/**
+	 * \brief Tells the transport the host is done with the peer that joined from addr. Nothing to do for a
+	 *        socket of its own; a port shared between matches hands the place back.
+	 */
+	virtual void ReleasePeer(const sockaddr_in&) {}
+
+	const TransportStats& GetStats() const { return stats; }
+	void ResetStats() { stats = TransportStats{}; }
+
+	/**
+	 * \brief Creates the transport selected for this build (NET_TRANSPORT_WINSOCK or NET_TRANSPORT_EPOLL).
+	 */
+	static std::unique_ptr<Transport> Create();
+
+protected:
+	TransportStats stats;
+};
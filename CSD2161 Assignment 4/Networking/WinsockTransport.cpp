@@ -0,0 +1,102 @@
+#include "WinsockTransport.hpp"
+
+#ifdef NET_TRANSPORT_WINSOCK
+
+#include <iostream>
+
+// Tell the Visual Studio linker to include the following library in linking.
+// Alternatively, we could add this file to the linker command-line parameters,
+// but including it in the source code simplifies the configuration.
+#pragma comment(lib, "ws2_32.lib")
+
+#ifndef WINSOCK_VERSION
+#define WINSOCK_VERSION     2
+#endif
+#define WINSOCK_SUBVERSION  2
+
+WinsockTransport::~WinsockTransport() {
+	Close();
+}
+
+bool WinsockTransport::Startup() {
+	if (started) return true;
+
+	WSADATA wsaData{};
+	SecureZeroMemory(&wsaData, sizeof(wsaData));
+
+	int errorCode = WSAStartup(MAKEWORD(WINSOCK_VERSION, WINSOCK_SUBVERSION), &wsaData);
+	if (NO_ERROR != errorCode) {
+		std::cerr << "WSAStartup() failed.\n";
+		return false;
+	}
+	started = true;
+	return true;
+}
+
+void WinsockTransport::Shutdown() {
+	Close();
+	if (started) {
+		WSACleanup();
+		started = false;
+	}
+}
+
+bool WinsockTransport::Open(const sockaddr_in* localAddr) {
+	Close();
+
+	sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock == INVALID_SOCKET) {
+		std::cerr << "socket() failed. Error: " << WSAGetLastError() << "\n";
+		return false;
+	}
+
+	if (localAddr && bind(sock, reinterpret_cast<const sockaddr*>(localAddr), sizeof(*localAddr)) != 0) {
+		std::cerr << "bind() failed. Error: " << WSAGetLastError() << "\n";
+		Close();
+		return false;
+	}
+
+	u_long mode = 1;
+	ioctlsocket(sock, FIONBIO, &mode);
+	return true;
+}
+
+void WinsockTransport::Close() {
+	if (sock != INVALID_SOCKET) {
+		closesocket(sock);
+		sock = INVALID_SOCKET;
+	}
+}
+
+bool WinsockTransport::SendTo(const sockaddr_in& to, const char* data, size_t size) {
+	++stats.syscalls;
+	if (sendto(sock, data, static_cast<int>(size), 0,
+		reinterpret_cast<const sockaddr*>(&to), sizeof(to)) == SOCKET_ERROR) return false;
+
+	++stats.datagramsSent;
+	stats.bytesSent += size;
+	return true;
+}
+
+int WinsockTransport::ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) {
+	int addrLen = sizeof(from);
+	++stats.syscalls;
+	int result = recvfrom(sock, buffer, static_cast<int>(capacity), 0,
+		reinterpret_cast<sockaddr*>(&from), &addrLen);
+	if (result <= 0) return 0;
+
+	++stats.datagramsReceived;
+	stats.bytesReceived += static_cast<uint64_t>(result);
+	return result;
+}
+
+bool WinsockTransport::WaitForData(int timeoutMs) {
+	fd_set readfds;
+	FD_ZERO(&readfds);
+	FD_SET(sock, &readfds);
+	timeval timeout = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+	++stats.syscalls;
+	return select(0, &readfds, NULL, NULL, &timeout) > 0 && FD_ISSET(sock, &readfds);
+}
+
+#endif
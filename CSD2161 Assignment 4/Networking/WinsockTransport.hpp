@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Transport.hpp"
+
+#ifdef NET_TRANSPORT_WINSOCK
+
+/**
+ * \brief Winsock backend. Every SendTo/ReceiveFrom is a single sendto/recvfrom call.
+ */
+class WinsockTransport : public Transport {
+public:
+	~WinsockTransport() override;
+
+	bool Startup() override;
+	void Shutdown() override;
+
+	bool Open(const sockaddr_in* localAddr) override;
+	void Close() override;
+	bool IsOpen() const override { return sock != INVALID_SOCKET; }
+
+	bool SendTo(const sockaddr_in& to, const char* data, size_t size) override;
+	int ReceiveFrom(char* buffer, size_t capacity, sockaddr_in& from) override;
+	bool WaitForData(int timeoutMs) override;
+
+private:
+	SOCKET sock = INVALID_SOCKET;
+	bool started = false;
+};
+
+#endif
@@ -2,30 +2,46 @@
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#ifndef HEADLESS_SERVER
 #include "InputManager.hpp"
+#endif
 #include "Networking/NetworkEngine.hpp"
 #include "Events/Event.hpp"
 #include <iostream>
 #include <glm/geometric.hpp>
 #include <glm/gtc/constants.hpp>
+#include <glm/trigonometric.hpp>
 #include "Events/EventQueue.hpp"
-
-
-// utility function to be moved
-float LerpAngle(float a, float b, float t) {
-    float delta = fmodf(b - a + glm::pi<float>(), glm::two_pi<float>()) - glm::pi<float>();
-    return a + delta * t;
-}
-
-Player::Player() {
-    prevPos = position;
-    prevRot = rotation;
-    targetPos = position;
+#include "Networking/Messages.hpp"
+#include "Networking/PlayerInput.hpp"
+#include "EntityStore.hpp"
+#include "PlayerPrediction.hpp"
+
+
+namespace {
+    const float rotationSpeed = glm::radians(180.f);
+    const float thrust = 10.f;
+    const float drag = 0.98f;
+
+    // Players wrap around horizontally instead of leaving the play area
+    void Wrap(glm::vec3& position) {
+        if (position.x > 46.f)
+            position.x = -45.f;
+        else if (position.x < -46.f)
+            position.x = 45.f;
+    }
 }
 
-void Player::Update(double)
+void Player::Update([[maybe_unused]] PlayerPool& players, double)
 {
-    if (isLocal) {
+#ifndef HEADLESS_SERVER
+    for (uint32_t i = 0; i < players.Size(); ++i) {
+        Player& player = players.extra[i];
+        if (!player.isLocal) continue;
+
+        const glm::vec3& position = players.position[i];
+        const float rotation = players.rotation[i];
+        const NetworkID networkID = players.networkID[i];
         InputManager& input = InputManager::GetInstance();
 
         if (input.GetKeyDown(GLFW_KEY_SPACE)) {
@@ -39,86 +55,95 @@ void Player::Update(double)
  				NetworkEngine::GetInstance().ServerBroadcastEvent(std::move(fireEvent));
             }
             else if(NetworkEngine::GetInstance().isHosting){
-                EventQueue::GetInstance().Push(std::make_unique<FireBulletEvent>(position, rotation, networkID));
-            }
-        }
-
-        if (glm::length(position - prevPos) > 1.f || std::abs(rotation - prevRot) > 0.1f) {
-            if (NetworkEngine::GetInstance().isClient) {
-                NetworkEngine::GetInstance().socketManager.SendToHost(Serialize());
-                prevPos = position;
-                prevRot = rotation;
-            } else {
-                NetworkEngine::GetInstance().SendToAllClients(Serialize());
-                prevPos = position;
-                prevRot = rotation;
+                fireEvent->id = NetworkEngine::GetInstance().GenerateID(); // No commit to hand one out
+                EventQueue::GetInstance().Push(std::move(fireEvent));
             }
         }
     }
+#endif
 }
 
-void Player::FixedUpdate(double fixedDt) {
-    if (isLocal) {
-        InputManager& input = InputManager::GetInstance();
-
-        // Rotate left/right
-        if (input.GetKey(GLFW_KEY_A)) {
-            rotation += rotationSpeed * static_cast<float>(fixedDt);
-        }
-        if (input.GetKey(GLFW_KEY_D)) {
-            rotation -= rotationSpeed * static_cast<float>(fixedDt);
-        }
+void Player::Simulate(glm::vec3& position, glm::vec3& velocity, float& rotation, uint8_t buttons, float fixedDt) {
+    // Rotate left/right
+    if (buttons & BUTTON_ROTATE_LEFT) {
+        rotation += rotationSpeed * fixedDt;
+    }
+    if (buttons & BUTTON_ROTATE_RIGHT) {
+        rotation -= rotationSpeed * fixedDt;
+    }
 
-        if (input.GetKey(GLFW_KEY_W)) {
-            glm::vec2 forward = glm::vec2(cos(rotation), sin(rotation));
-            velocity += glm::vec3(forward * thrust * static_cast<float>(fixedDt), 0.0f);
-        }
+    if (buttons & BUTTON_THRUST) {
+        glm::vec2 forward = glm::vec2(cos(rotation), sin(rotation));
+        velocity += glm::vec3(forward * thrust * fixedDt, 0.0f);
+    }
 
-        velocity *= drag;
+    velocity *= drag;
 
-        position += velocity * static_cast<float>(fixedDt);
-    } else {
-        float interpolationSpeed = 2.0f;
+    position += velocity * fixedDt;
+    Wrap(position);
+}
 
-        uint32_t currentTick = NetworkEngine::GetInstance().localTick;
-        int tickDelta = static_cast<int>(currentTick) - static_cast<int>(lastReceivedTick);
-        tickDelta = glm::clamp(tickDelta, 0, 15); // clamp to prevent over-extrapolation
+void Player::FixedUpdate(PlayerPool& players, PlayerPrediction& prediction, double fixedDt) {
+    NetworkEngine& ne = NetworkEngine::GetInstance();
+    const float dt = static_cast<float>(fixedDt);
+
+    for (uint32_t i = 0; i < players.Size(); ++i) {
+        Player& player = players.extra[i];
+        glm::vec3& position = players.position[i];
+        glm::vec3& velocity = players.velocity[i];
+        float& rotation = players.rotation[i];
+
+        if (player.isLocal) {
+#ifndef HEADLESS_SERVER
+            InputManager& input = InputManager::GetInstance();
+            uint8_t buttons = 0;
+            if (input.GetKey(GLFW_KEY_A)) buttons |= BUTTON_ROTATE_LEFT;
+            if (input.GetKey(GLFW_KEY_D)) buttons |= BUTTON_ROTATE_RIGHT;
+            if (input.GetKey(GLFW_KEY_W)) buttons |= BUTTON_THRUST;
+#else
+            const uint8_t buttons = player.heldButtons; // A bot's script (BotClient)
+#endif
+
+            Simulate(position, velocity, rotation, buttons, dt);
+
+            // Clients predict: the host runs the same command and tells us if it ended up somewhere else
+            if (ne.isClient) {
+                prediction.Record(buttons, dt, position, velocity, rotation);
+
+                PacketBuffer packet;
+                PacketWriter writer(packet);
+                writer.WriteU8(NetworkEngine::CMDID::PLAYER_INPUT);
+                if (prediction.WriteUnacknowledged(writer)) ne.SendToHost(packet);
+            }
+            continue;
+        }
 
-        float extrapolationTime = static_cast<float>(tickDelta) / 60.0f;
+        if (ne.isHosting) {
+            // A client's ship only moves by the commands it sent, one a tick
+            uint8_t buttons = 0;
+            while (ne.NextPlayerInput(players.networkID[i], buttons)) {
+                Simulate(position, velocity, rotation, buttons, dt);
+            }
+            continue;
+        }
 
-        // predict where the player should be based on last known velocity
-        glm::vec3 extrapolatedTarget = targetPos + lastReceivedVelocity * extrapolationTime;
+        // Everyone else's ship, shown where its snapshots put it a little while ago
+        InterpolationClock& clock = ne.interpolation;
+        if (!clock.IsRunning()) continue;
 
-        // smoothly move towards extrapolated target
-        position = glm::mix(position, extrapolatedTarget, interpolationSpeed * static_cast<float>(fixedDt));
+        const auto result = player.snapshots.Evaluate(clock.GetRenderTick(), fixedDt, InterpolationClock::MAX_EXTRAPOLATION_TICKS, position, rotation);
+        if (result == InterpolationBuffer::Result::Empty) continue;
+        ++clock.stats.samples;
+        if (result == InterpolationBuffer::Result::Extrapolated && velocity != glm::vec3(0.f)) ++clock.stats.extrapolations;
 
-        if (std::abs(rotation - targetRot) > 0.01f)
-            rotation = LerpAngle(rotation, targetRot, interpolationSpeed * static_cast<float>(fixedDt));
+        Wrap(position);
     }
 }
 
-std::vector<char> Player::Serialize() {
-    std::vector<char> packet;
-    packet.push_back(NetworkEngine::CMDID::GAME_DATA);
-
-    NetworkUtils::WriteToPacket(packet, networkID, NetworkUtils::DATA_TYPE::DT_LONG);
-    NetworkUtils::WriteToPacket(packet, NetworkEngine::GetInstance().localTick, NetworkUtils::DATA_TYPE::DT_LONG);
-    NetworkUtils::WriteVec2(packet, position);
-    NetworkUtils::WriteToPacket(packet, NetworkUtils::FloatToNetwork(rotation), NetworkUtils::DATA_TYPE::DT_LONG);
-    NetworkUtils::WriteVec2(packet, velocity);
-
-    return packet;
-}
+void Player::Deserialize(PlayerPool& players, uint32_t index, const ObjectStateMsg& state) {
+    if (state.tick < players.lastReceivedTick[index]) return;
 
-void Player::Deserialize(const char* packet) {
-    uint32_t packetTick{};
-    NetworkUtils::ReadFromPacket(packet, 5, packetTick, NetworkUtils::DATA_TYPE::DT_LONG);
-    if (packetTick < lastReceivedTick) return;
-
-    lastReceivedTick = packetTick;
-    NetworkUtils::ReadVec2(packet, 9, targetPos);
-    uint32_t tempRot{};
-    NetworkUtils::ReadFromPacket(packet, 17, tempRot, NetworkUtils::DATA_TYPE::DT_LONG);
-    targetRot = NetworkUtils::NetworkToFloat(tempRot);
-    NetworkUtils::ReadVec2(packet, 21, lastReceivedVelocity);
+    players.lastReceivedTick[index] = state.tick;
+    players.velocity[index] = state.velocity;
+    players.extra[index].snapshots.Push(InterpolationBuffer::Sample{ state.tick, state.position, state.velocity, state.rotation });
 }
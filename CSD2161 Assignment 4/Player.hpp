@@ -1,28 +1,32 @@
 ﻿#pragma once
 
-#include "GameObject.hpp"
-#include "Networking/NetworkObject.hpp"
-#include <glm/trigonometric.hpp>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include "EntityPool.hpp"
+#include "Networking/SnapshotInterpolation.hpp"
 
-class Player : public GameObject, public NetworkObject {
-	glm::vec3 prevPos;
-	float prevRot;
+struct ObjectStateMsg;
+class PlayerPrediction;
 
-	glm::vec3 targetPos;
-	float targetRot = 0.f;
+/**
+ * \brief Components only players have, and the player systems that run over every player at once.
+ */
+struct Player {
+	bool isLocal = false;
+	// Headless clients: the PlayerButtons the local player holds, set by whatever drives it instead of a keyboard
+	uint8_t heldButtons = 0;
 
-	glm::vec3 lastReceivedVelocity = glm::vec3(0.f);
-	glm::vec3 velocity = glm::vec3(0.f);
+	// Remote players on a client: recent snapshot states, shown a little in the past
+	InterpolationBuffer snapshots;
 
-	float rotationSpeed = glm::radians(180.f);
-	float thrust = 10.f;
-	float drag = 0.98f;
-public:
-	Player();
-	void Update(double) override;
-	void FixedUpdate(double) override;
-
-	std::vector<char> Serialize() override;
-	void Deserialize(const char*) override;
+	static void Update(EntityPool<Player>& players, double dt);               // Local input: firing
+	// Local movement (predicted and sent to the host on a client), clients' commands on the host,
+	// remote smoothing on a client
+	static void FixedUpdate(EntityPool<Player>& players, PlayerPrediction& prediction, double fixedDt);
+	// One tick of movement under the given PlayerButtons. Host and client run exactly this on the same
+	// command, which is what lets a client predict its own ship.
+	static void Simulate(glm::vec3& position, glm::vec3& velocity, float& rotation, uint8_t buttons, float fixedDt);
+	static void Deserialize(EntityPool<Player>& players, uint32_t index, const ObjectStateMsg& state);
 };
 
+using PlayerPool = EntityPool<Player>;
@@ -1,21 +1,17 @@
 #pragma once
 
-#include "GameObject.hpp"
-#include "Networking/NetworkObject.hpp"
 #include <glm/vec3.hpp>
+#include "EntityPool.hpp"
 
-class PlayerBullet : public GameObject, public NetworkObject {
-public:
-	uint32_t playerID = 0;
-	glm::vec3 dir;
-	float speed;
+/**
+ * \brief Bullets fly in a straight line at SPEED. Their velocity is the firing direction times SPEED and
+ *        their owner the player who fired. They are never replicated, every machine moves its own copy.
+ */
+struct PlayerBullet {
+	static constexpr float SPEED = 50.f;
+	static constexpr float SIZE = 0.2f;
 
-	PlayerBullet(glm::vec3 pos, glm::vec3 dir, uint32_t ownerID);
+	bool hitPending = false; // Host: its collision is already on the way, it just has not run yet
 
-	void Update(double) override;
-	void FixedUpdate(double) override;
-
-	std::vector<char> Serialize() override;
-	void Deserialize(const char*) override;
+	static void Update(EntityPool<PlayerBullet>& bullets, double dt);
 };
-
@@ -0,0 +1,60 @@
+#include "PlayerPrediction.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/vec2.hpp>
+#include <glm/geometric.hpp>
+#include "Player.hpp"
+#include "Networking/PacketBuffer.hpp"
+
+void PlayerPrediction::Reset() {
+	moves.fill(Move{});
+	newestTick = 0;
+	ackedTick = 0;
+}
+
+Tick PlayerPrediction::Record(uint8_t buttons, float fixedDt, const glm::vec3& position, const glm::vec3& velocity, float rotation) {
+	++newestTick;
+	moves[newestTick % WINDOW] = Move{ newestTick, buttons, fixedDt, position, velocity, rotation };
+	return newestTick;
+}
+
+bool PlayerPrediction::WriteUnacknowledged(PacketWriter& writer) const {
+	const size_t count = std::min(static_cast<size_t>(newestTick - ackedTick), MAX_RESEND);
+	if (count == 0) return false;
+
+	Schema::Encode(writer, PlayerInputMsg{ newestTick, static_cast<uint8_t>(count) });
+	for (Tick tick = newestTick - static_cast<Tick>(count - 1); tick != newestTick + 1; ++tick) {
+		writer.WriteU8(moves[tick % WINDOW].buttons);
+	}
+	return writer.Ok();
+}
+
+bool PlayerPrediction::Reconcile(const PlayerStateAckMsg& ack, glm::vec3& position, glm::vec3& velocity, float& rotation) {
+	if (ack.inputTick == 0 || static_cast<int32_t>(ack.inputTick - ackedTick) <= 0) return false; // Older than one already taken
+	if (static_cast<int32_t>(newestTick - ack.inputTick) < 0) return false; // From before our last Reset
+	ackedTick = ack.inputTick;
+
+	const Move& predicted = moves[ack.inputTick % WINDOW];
+	if (predicted.tick == ack.inputTick &&
+		glm::length(glm::vec2(predicted.position - ack.position)) <= TOLERANCE &&
+		glm::length(glm::vec2(predicted.velocity - ack.velocity)) <= TOLERANCE &&
+		std::abs(predicted.rotation - ack.rotation) <= TOLERANCE) {
+		return false;
+	}
+
+	// Rewind to the host's state and run the commands it has not seen yet again
+	position = glm::vec3(ack.position.x, ack.position.y, position.z);
+	velocity = glm::vec3(ack.velocity.x, ack.velocity.y, velocity.z);
+	rotation = ack.rotation;
+	for (Tick tick = ack.inputTick + 1; tick != newestTick + 1; ++tick) {
+		Move& move = moves[tick % WINDOW];
+		if (move.tick != tick) continue; // Overwritten, only once we are a whole window ahead of the host
+		Player::Simulate(position, velocity, rotation, move.buttons, move.fixedDt);
+		move.position = position;
+		move.velocity = velocity;
+		move.rotation = rotation;
+	}
+	++corrections;
+	return true;
+}
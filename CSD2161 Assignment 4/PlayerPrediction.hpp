@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include "Networking/Messages.hpp"
+
+class PacketWriter;
+
+/**
+ * \brief The local player's input commands on a client, each with the state it left the ship in, kept
+ *        until the host has run them too.
+ *
+ * The ship moves on our own input straight away. When a snapshot says the host's run of a command ended
+ * somewhere else, the ship is put where the host has it and every command after that one is replayed.
+ */
+class PlayerPrediction {
+public:
+	static constexpr size_t WINDOW = 128;      // Commands kept, about two seconds at 60 Hz
+	static constexpr size_t MAX_RESEND = 32;   // Unacknowledged commands repeated per PLAYER_INPUT
+	static constexpr float TOLERANCE = 0.001f; // Closer than this the host agrees with us
+
+	void Reset();
+
+	// Stores the command run this tick and the state it produced, returns its input tick
+	Tick Record(uint8_t buttons, float fixedDt, const glm::vec3& position, const glm::vec3& velocity, float rotation);
+
+	// PLAYER_INPUT payload: the newest commands the host has not acknowledged, false if there are none
+	bool WriteUnacknowledged(PacketWriter& writer) const;
+
+	// Takes the host's result for ack.inputTick. Returns true if the ship had to be moved there and the later
+	// commands replayed, in which case position, velocity and rotation hold the new prediction.
+	bool Reconcile(const PlayerStateAckMsg& ack, glm::vec3& position, glm::vec3& velocity, float& rotation);
+
+	inline uint32_t GetCorrections() const { return corrections; }
+
+private:
+	struct Move {
+		Tick tick = 0;
+		uint8_t buttons = 0;
+		float fixedDt = 0.f;
+		glm::vec3 position{ 0.f };
+		glm::vec3 velocity{ 0.f };
+		float rotation = 0.f;
+	};
+
+	std::array<Move, WINDOW> moves{};
+	Tick newestTick = 0;
+	Tick ackedTick = 0;
+	uint32_t corrections = 0;
+};
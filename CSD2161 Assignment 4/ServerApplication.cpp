@@ -0,0 +1,363 @@
+#include "ServerApplication.hpp"
+
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "Core/Timer.hpp"
+#include "Core/AllocationCounter.hpp"
+#include "Core/CpuTime.hpp"
+#include "ServerMatch.hpp"
+#include "Networking/MatchRouter.hpp"
+#include "HighScoreManager.hpp"
+
+namespace {
+	std::atomic<bool> serverRunning{ true }; // Lock-free, so the signal handler may store to it
+
+	void OnShutdownSignal(int) {
+		serverRunning.store(false);
+	}
+
+	void PrintUsage(const char* exe) {
+		std::cout << "Usage: " << exe << " [--port <port>] [--tick-rate <hz>] [--max-players <n>] [--auto-start <n>] [--stats <seconds>]"
+			<< " [--interest-radius <units>] [--cull-radius <units>] [--event-mode <scheduled|lockstep>]"
+			<< " [--snapshot-interval <ticks>] [--rewind-ms <ms>] [--client-rate <kB/s>] [--io-thread <0|1>]"
+			<< " [--matches <n>] [--workers <n>] [--impair-send <spec>] [--impair-receive <spec>] [--impair-seed <n>]\n"
+			<< "  <spec> is latency=<ms>,jitter=<ms>,loss=<%>,burst=<n>,duplicate=<%>,reorder=<%>,reorder-delay=<ms>,rate=<kB/s>,queue=<ms>\n";
+	}
+
+	// Per-tick averages of the transport counters and the time spent in NetworkEngine::Update.
+	// allocs is the number of heap allocations over the whole interval (TRACK_ALLOCATIONS builds only).
+	// label names the match when there are several.
+	void PrintNetworkStats(std::ostream& out, const std::string& label, NetworkEngine& ne, uint64_t ticks, double netMicros, double seconds, uint64_t allocs) {
+		const TransportStats& io = ne.socketManager.GetTransport().GetStats();
+		const double perTick = ticks ? 1.0 / static_cast<double>(ticks) : 0.0;
+		const size_t clients = ne.GetNumConnectedClients();
+
+		out << "[Stats] " << label << "clients=" << clients
+			<< " ticks=" << ticks
+			<< " net_us/tick=" << netMicros * perTick
+			<< " syscalls/tick=" << static_cast<double>(io.syscalls) * perTick
+			<< " dgrams_in/tick=" << static_cast<double>(io.datagramsReceived) * perTick
+			<< " dgrams_out/tick=" << static_cast<double>(io.datagramsSent) * perTick
+			<< " kB/s_in=" << static_cast<double>(io.bytesReceived) / 1024.0 / seconds
+			<< " kB/s_out=" << static_cast<double>(io.bytesSent) / 1024.0 / seconds
+			<< " B/s_out/client=" << (clients ? static_cast<double>(io.bytesSent) / seconds / static_cast<double>(clients) : 0.0)
+			<< " packets=" << PacketPool::GetInstance().GetInUse() << "/" << PacketPool::GetInstance().GetCapacity();
+
+		// Reliable streams: retransmits against first sends, and the clients' current timeouts
+		uint64_t reliableSent = 0, retransmits = 0;
+		double rtoSum = 0.0, rtoMax = 0.0;
+		for (auto& client : ne.clientManager.GetClientsNonConst()) {
+			if (!client.isConnected) continue;
+			reliableSent += client.reliable.GetStats().sent;
+			retransmits += client.reliable.GetStats().retransmits;
+			rtoSum += client.reliable.GetRto();
+			rtoMax = std::max(rtoMax, client.reliable.GetRto());
+			client.reliable.ResetStats();
+		}
+		out << " reliable_sent=" << reliableSent << " retransmits=" << retransmits
+			<< " rto_ms_avg=" << (clients ? rtoSum * 1000.0 / static_cast<double>(clients) : 0.0)
+			<< " rto_ms_max=" << rtoMax * 1000.0;
+
+		if (AllocationCounter::IsEnabled()) {
+			out << " allocs/tick=" << static_cast<double>(allocs) * perTick;
+		}
+		out << "\n";
+		// Send scheduler, per client: what it got, and what its budget held back
+		for (auto& client : ne.clientManager.GetClientsNonConst()) {
+			if (!client.isConnected) continue;
+			const BandwidthStats& sent = client.sendStats;
+			out << "[Stats]   " << label << "client=" << client.clientID
+				<< " B/s=" << static_cast<double>(sent.bytesSent) / seconds
+				<< " msgs=" << sent.messagesSent
+				<< " dgrams=" << sent.datagramsSent
+				<< " snapshots=" << sent.snapshotsSent
+				<< " skipped=" << sent.snapshotsSkipped
+				<< " objects_deferred=" << sent.objectsDeferred
+				<< " reliable_deferred=" << sent.reliableDeferred
+				<< " max_stale=" << sent.maxStaleRounds << "\n";
+			client.sendStats = BandwidthStats{};
+		}
+
+		ne.socketManager.GetTransport().ResetStats();
+	}
+
+	// Keeps a worker on one core, so the matches it runs stay in that core's caches
+	void PinToCore(std::thread& thread, unsigned core) {
+#ifdef _WIN32
+		SetThreadAffinityMask(thread.native_handle(), static_cast<DWORD_PTR>(1) << core);
+#elif defined(__linux__)
+		cpu_set_t cores;
+		CPU_ZERO(&cores);
+		CPU_SET(core, &cores);
+		pthread_setaffinity_np(thread.native_handle(), sizeof(cores), &cores);
+#endif
+	}
+
+	std::mutex statsOutput; // Workers print their reports whole
+
+	void PrintSettings(const ServerConfig& config, Tick rewindTicks) {
+		std::cout << "[Server] Running at " << config.tickRate << " Hz, max players: " << config.maxPlayers
+			<< ", auto-start: " << config.autoStartPlayers
+			<< ", interest radius: " << config.interest.radius << "/" << config.interest.cullRadius
+			<< ", events: " << (config.eventDelivery == EventDelivery::Scheduled ? "scheduled" : "lockstep")
+			<< ", snapshot every " << config.snapshotInterval << " ticks"
+			<< ", rewind up to " << rewindTicks << " ticks"
+			<< ", " << config.clientRate << " kB/s per client"
+			<< (config.ioThread ? ", network I/O thread" : "") << "\n";
+		if (config.impairment.IsEnabled()) {
+			std::cout << "[Server] Simulated network, seed " << config.impairment.seed
+				<< ", send: " << config.impairment.send.ToString() << ", receive: " << config.impairment.receive.ToString() << "\n";
+		}
+	}
+
+	// Runs every match in matches each tick on the calling thread until shutdown. Each report opens with how much
+	// of the tick budget this worker spent, and so how many matches like these one core could run at this tick
+	// rate, and the CPU the whole process used (100% = one core).
+	void RunWorker(const ServerConfig& config, size_t worker, const std::vector<ServerMatch*>& matches) {
+		Timer timer;
+		timer.SetFixedDeltaTime(1.0 / config.tickRate);
+		timer.Start();
+
+		const auto tickDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(timer.GetFixedDT()));
+		auto nextTick = std::chrono::steady_clock::now();
+
+		const bool shared = config.matches > 1;
+		const auto statsInterval = std::chrono::seconds(config.statsInterval);
+		auto statsStart = nextTick;
+		uint64_t statsTicks = 0;
+		double busyMicros = 0.0, busyMaxMicros = 0.0; // Running this worker's matches, per frame
+		uint64_t statsAllocBase = AllocationCounter::GetCount();
+		double statsCpuBase = CpuTime::GetProcessSeconds();
+		for (ServerMatch* match : matches) match->GetNetwork().socketManager.GetTransport().ResetStats();
+
+		while (serverRunning.load(std::memory_order_relaxed)) {
+			timer.Update();
+
+			const auto busyStart = std::chrono::steady_clock::now();
+			for (ServerMatch* match : matches) match->Frame(timer);
+			const auto busyEnd = std::chrono::steady_clock::now();
+
+			if (config.statsInterval > 0) {
+				const double busy = std::chrono::duration<double, std::micro>(busyEnd - busyStart).count();
+				busyMicros += busy;
+				busyMaxMicros = std::max(busyMaxMicros, busy);
+				statsTicks += timer.GetFixedSteps();
+
+				if (busyEnd - statsStart >= statsInterval) {
+					const double seconds = std::chrono::duration<double>(busyEnd - statsStart).count();
+					const uint64_t allocs = AllocationCounter::GetCount() - statsAllocBase;
+					const double cpu = CpuTime::GetProcessSeconds();
+					std::ostringstream report;
+					const double budget = 1.0e6 / config.tickRate;
+					const double perTick = statsTicks ? busyMicros / static_cast<double>(statsTicks) : 0.0;
+					report << "[Stats] worker=" << worker << " matches=" << matches.size() << " ticks=" << statsTicks
+						<< " busy_us/tick=" << perTick << " busy_us_max=" << busyMaxMicros
+						<< " load=" << perTick / budget * 100.0 << "%"
+						<< " matches/core=" << (perTick > 0.0 ? static_cast<double>(matches.size()) * budget / perTick : 0.0)
+						<< " process_cpu=" << (cpu - statsCpuBase) / seconds * 100.0 << "%\n";
+					for (ServerMatch* match : matches) {
+						const std::string label = shared ? "match=" + std::to_string(match->GetIndex()) + " " : "";
+						PrintNetworkStats(report, label, match->GetNetwork(), match->statsTicks, match->statsNetMicros, seconds, allocs);
+						match->statsTicks = 0;
+						match->statsNetMicros = 0.0;
+					}
+					{
+						std::lock_guard<std::mutex> lock(statsOutput);
+						std::cout << report.str() << std::flush;
+					}
+					statsAllocBase = AllocationCounter::GetCount(); // Printing allocates, start after it
+					statsCpuBase = cpu;
+					statsStart = busyEnd;
+					statsTicks = 0;
+					busyMicros = busyMaxMicros = 0.0;
+				}
+			}
+
+			// Sleep until the next tick instead of spinning; if we fell behind, resync rather than burst
+			nextTick += tickDuration;
+			auto now = std::chrono::steady_clock::now();
+			if (nextTick < now) nextTick = now;
+			else std::this_thread::sleep_until(nextTick);
+		}
+	}
+
+	// Adds every player's score to the high score table; with several matches, names carry the match too
+	void SaveScores(const std::vector<ServerMatch*>& matches, bool nameMatch) {
+		std::vector<HighScore> currentHighscores;
+		for (const ServerMatch* match : matches) {
+			const std::string prefix = nameMatch ? std::to_string(match->GetIndex()) + "-" : "";
+			for (const auto& score : match->GetScene().GetAllScores()) {
+				currentHighscores.push_back(HighScore{ prefix + std::to_string(score.first), score.second });
+			}
+		}
+		SaveHighScores(currentHighscores);
+	}
+}
+
+ServerConfig ServerConfig::FromCommandLine(int argc, char* argv[]) {
+	ServerConfig cfg;
+
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+		if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+			PrintUsage(argv[0]);
+			std::exit(0);
+		}
+		if (!value) {
+			std::cerr << "[Server] Missing value for " << arg << "\n";
+			break;
+		}
+
+		if (std::strcmp(arg, "--port") == 0) {
+			cfg.port = value;
+		} else if (std::strcmp(arg, "--tick-rate") == 0) {
+			cfg.tickRate = std::max(1, std::atoi(value));
+		} else if (std::strcmp(arg, "--max-players") == 0) {
+			cfg.maxPlayers = static_cast<size_t>(std::max(0, std::atoi(value)));
+		} else if (std::strcmp(arg, "--auto-start") == 0) {
+			cfg.autoStartPlayers = static_cast<size_t>(std::max(0, std::atoi(value)));
+		} else if (std::strcmp(arg, "--stats") == 0) {
+			cfg.statsInterval = std::max(0, std::atoi(value));
+		} else if (std::strcmp(arg, "--interest-radius") == 0) {
+			cfg.interest.radius = std::max(0.f, static_cast<float>(std::atof(value)));
+		} else if (std::strcmp(arg, "--cull-radius") == 0) {
+			cfg.interest.cullRadius = std::max(0.f, static_cast<float>(std::atof(value)));
+		} else if (std::strcmp(arg, "--snapshot-interval") == 0) {
+			cfg.snapshotInterval = std::max(1, std::atoi(value));
+		} else if (std::strcmp(arg, "--rewind-ms") == 0) {
+			cfg.rewindMs = std::max(0, std::atoi(value));
+		} else if (std::strcmp(arg, "--client-rate") == 0) {
+			cfg.clientRate = std::max(1.0, std::atof(value));
+		} else if (std::strcmp(arg, "--io-thread") == 0) {
+			cfg.ioThread = std::atoi(value) != 0;
+		} else if (std::strcmp(arg, "--matches") == 0) {
+			cfg.matches = std::clamp<size_t>(static_cast<size_t>(std::max(1, std::atoi(value))), 1, MatchRouter::MAX_MATCHES);
+		} else if (std::strcmp(arg, "--workers") == 0) {
+			cfg.workers = static_cast<size_t>(std::max(0, std::atoi(value)));
+		} else if (std::strcmp(arg, "--impair-send") == 0 || std::strcmp(arg, "--impair-receive") == 0) {
+			LinkImpairment& link = std::strcmp(arg, "--impair-send") == 0 ? cfg.impairment.send : cfg.impairment.receive;
+			if (!link.Parse(value)) {
+				std::cerr << "[Server] Could not read " << arg << " " << value << "\n";
+				PrintUsage(argv[0]);
+			}
+		} else if (std::strcmp(arg, "--impair-seed") == 0) {
+			cfg.impairment.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		} else if (std::strcmp(arg, "--event-mode") == 0) {
+			if (std::strcmp(value, "scheduled") == 0) {
+				cfg.eventDelivery = EventDelivery::Scheduled;
+			} else if (std::strcmp(value, "lockstep") == 0) {
+				cfg.eventDelivery = EventDelivery::Lockstep;
+			} else {
+				std::cerr << "[Server] Unknown event mode " << value << ", keeping the default\n";
+			}
+		} else {
+			std::cerr << "[Server] Unknown option " << arg << "\n";
+			PrintUsage(argv[0]);
+			continue;
+		}
+		++i; // consumed the value
+	}
+
+	if (cfg.maxPlayers != 0 && cfg.autoStartPlayers > cfg.maxPlayers) {
+		std::cerr << "[Server] --auto-start exceeds --max-players, clamping to " << cfg.maxPlayers << "\n";
+		cfg.autoStartPlayers = cfg.maxPlayers;
+	}
+	if (cfg.matches > 1 && cfg.ioThread) {
+		std::cerr << "[Server] --io-thread is for a single match; with several, the port has a thread of its own anyway\n";
+		cfg.ioThread = false;
+	}
+	if (cfg.interest.cullRadius < cfg.interest.radius) {
+		std::cerr << "[Server] --cull-radius is below --interest-radius, raising it to " << cfg.interest.radius << "\n";
+		cfg.interest.cullRadius = cfg.interest.radius;
+	}
+	return cfg;
+}
+
+int ServerApplication::Run() {
+	std::signal(SIGINT, OnShutdownSignal);
+	std::signal(SIGTERM, OnShutdownSignal);
+
+	if (config.matches > 1) return RunMatches();
+
+	auto match = std::make_unique<ServerMatch>(0, config);
+	if (!match->Start(nullptr)) return 1;
+
+	PrintSettings(config, match->GetScene().lagCompensation.GetDepth());
+	RunWorker(config, 0, { match.get() });
+
+	std::cout << "[Server] Shutting down\n";
+	SaveScores({ match.get() }, false);
+	match->Exit();
+	return 0;
+}
+
+int ServerApplication::RunMatches() {
+	const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+	const size_t workerCount = std::min(config.matches, config.workers != 0 ? config.workers : cores);
+
+	// Every port exists before the router starts handing datagrams to them, and outlives it
+	// A match set to start at so many players is sent that many
+	MatchRouter router(config.matches, config.autoStartPlayers != 0 ? config.autoStartPlayers : config.maxPlayers);
+	std::vector<std::unique_ptr<ServerMatch>> matches;
+	std::vector<std::unique_ptr<MatchRouter::Port>> ports;
+	for (size_t i = 0; i < config.matches; ++i) {
+		matches.push_back(std::make_unique<ServerMatch>(i, config));
+		ports.push_back(router.CreatePort(i));
+	}
+	if (!router.Open(config.port, config.impairment)) {
+		std::cerr << "[Server] Failed to host on port " << config.port << "\n";
+		return 1;
+	}
+
+	PrintSettings(config, static_cast<Tick>(static_cast<long long>(config.rewindMs) * config.tickRate / 1000));
+	std::cout << "[Server] " << config.matches << " matches on " << workerCount << " worker thread(s) of "
+		<< cores << " cores, sharing port " << config.port << "\n";
+
+	// Match i is started, run and exited by worker i % workerCount alone, so its packets stay in one thread's pool
+	std::vector<std::thread> workers;
+	for (size_t worker = 0; worker < workerCount; ++worker) {
+		std::vector<ServerMatch*> mine;
+		std::vector<std::unique_ptr<MatchRouter::Port>> minePorts;
+		for (size_t i = worker; i < matches.size(); i += workerCount) {
+			mine.push_back(matches[i].get());
+			minePorts.push_back(std::move(ports[i]));
+		}
+
+		workers.emplace_back([this, worker, mine = std::move(mine), minePorts = std::move(minePorts)]() mutable {
+			std::vector<ServerMatch*> started;
+			for (size_t i = 0; i < mine.size(); ++i) {
+				if (mine[i]->Start(std::move(minePorts[i]))) started.push_back(mine[i]);
+			}
+			RunWorker(config, worker, started);
+			for (ServerMatch* match : started) match->Exit();
+		});
+		PinToCore(workers.back(), static_cast<unsigned>(worker % cores));
+	}
+
+	while (serverRunning.load(std::memory_order_relaxed)) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	std::cout << "[Server] Shutting down\n";
+	for (auto& worker : workers) worker.join();
+	router.Close();
+
+	std::vector<ServerMatch*> all;
+	for (auto& match : matches) all.push_back(match.get());
+	SaveScores(all, true);
+	return 0;
+}
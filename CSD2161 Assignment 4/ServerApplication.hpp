@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include "Networking/InterestManager.hpp"
+#include "Networking/NetworkEngine.hpp"
+
+/**
+ * \brief Settings for the dedicated server, parsed from the command line.
+ *
+ * Usage: AsteroidServer [--port <port>] [--tick-rate <hz>] [--max-players <n>] [--auto-start <n>] [--stats <seconds>]
+ *                      [--interest-radius <units>] [--cull-radius <units>] [--event-mode <scheduled|lockstep>]
+ *                      [--snapshot-interval <ticks>] [--rewind-ms <ms>] [--client-rate <kB/s>] [--io-thread <0|1>]
+ *                      [--matches <n>] [--workers <n>] [--impair-send <spec>] [--impair-receive <spec>] [--impair-seed <n>]
+ */
+struct ServerConfig {
+	std::string port = "1234";
+	int tickRate = 60;			// Fixed simulation steps per second
+	size_t maxPlayers = 8;		// Connection requests beyond this are ignored (0 = unlimited)
+	size_t autoStartPlayers = 0;	// Start the match once this many clients are connected (0 = never)
+	int statsInterval = 0;		// Seconds between network I/O reports (0 = off)
+	InterestSettings interest;	// What each client is sent, by distance from its player
+	EventDelivery eventDelivery = EventDelivery::Scheduled; // How game events reach every peer
+	int snapshotInterval = 2;	// Ticks between snapshots to each client
+	int rewindMs = 500;			// How far back a client's bullets can be tested against what it saw (0 = off)
+	double clientRate = 64.0;	// kB/s the host may send each client
+	bool ioThread = false;		// Run the socket on its own thread
+	size_t matches = 1;			// Independent matches in this process, all on the one port
+	size_t workers = 0;			// Threads the matches are spread over, one per core (0 = as many as there are cores)
+	ImpairmentSettings impairment; // A simulated network in front of the port, for testing (see LinkImpairment::Parse)
+
+	static ServerConfig FromCommandLine(int argc, char* argv[]);
+};
+
+/**
+ * \brief Headless host loop. Runs the scene simulation and the network engine at a
+ *        fixed tick rate without creating a window, a GL context or ImGui.
+ *
+ * With --matches above 1, every match is a ServerMatch, each worker thread runs its share of them every tick
+ * on a core of its own, and a MatchRouter reads the port for all of them.
+ */
+class ServerApplication {
+public:
+	explicit ServerApplication(const ServerConfig& cfg) : config(cfg) {}
+	~ServerApplication() = default;
+
+	int Run();
+
+private:
+	int RunMatches(); // More than one match
+	ServerConfig config;
+};
@@ -0,0 +1,83 @@
+#include "ServerMatch.hpp"
+
+#include <iostream>
+#include <chrono>
+
+extern thread_local AsteroidScene* g_AsteroidScene;
+
+ServerMatch::ServerMatch(size_t index, const ServerConfig& config) : index(index), config(config) {}
+
+bool ServerMatch::Start(std::unique_ptr<MatchRouter::Port> port) {
+	Bind();
+
+	network.maxClients = config.maxPlayers;
+	network.interest.settings = config.interest;
+	network.eventDelivery = config.eventDelivery;
+	network.snapshotIntervalTicks = static_cast<Tick>(config.snapshotInterval);
+	network.clientBytesPerSecond = config.clientRate * 1024.0;
+	network.fixedDeltaTime = 1.0 / config.tickRate; // Before hosting, the I/O thread reads it
+	if (port) {
+		// The router's thread reads the socket; connection IDs say which match a packet is for
+		sharedPort = port.get();
+		network.socketManager.SetTransport(std::move(port));
+		network.clientManager.SetConnectionTag(static_cast<uint8_t>(index + 1));
+	}
+	else {
+		network.useIoThread = config.ioThread;
+		network.impairment = config.impairment;
+	}
+	network.Initialize();
+
+	if (!network.Host(config.port)) {
+		std::cerr << "[Server] Match " << index << " failed to host on port " << config.port << "\n";
+		network.Exit();
+		return false;
+	}
+
+	scene.Initialize();
+	scene.lagCompensation.SetDepth(static_cast<Tick>(static_cast<long long>(config.rewindMs) * config.tickRate / 1000));
+	return true;
+}
+
+void ServerMatch::Frame(const Timer& timer) {
+	Bind();
+
+	scene.Update(timer.GetDeltaTime());
+	for (int i = 0; i < timer.GetFixedSteps(); ++i) {
+		scene.FixedUpdate(timer.GetFixedDT());
+
+		network.AdvanceTick();
+	}
+	scene.ProcessEvents();
+
+	const auto netStart = std::chrono::steady_clock::now();
+	network.Update(timer.GetDeltaTime());
+	statsNetMicros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - netStart).count();
+	statsTicks += timer.GetFixedSteps();
+
+	if (!matchStarted && config.autoStartPlayers > 0 && network.GetNumConnectedClients() >= config.autoStartPlayers) {
+		std::cout << "[Server] " << network.GetNumConnectedClients() << " players connected, starting match " << index << "\n";
+		events.Push(std::make_unique<RequestStartGameEvent>());
+		matchStarted = true;
+		if (sharedPort) sharedPort->SetOpen(false); // Players who come later go to another match
+	}
+}
+
+void ServerMatch::Exit() {
+	Bind();
+	scene.Exit();
+	network.Exit();
+	Unbind();
+}
+
+void ServerMatch::Bind() {
+	NetworkEngine::Bind(&network);
+	EventQueue::Bind(&events);
+	g_AsteroidScene = &scene;
+}
+
+void ServerMatch::Unbind() {
+	NetworkEngine::Bind(nullptr);
+	EventQueue::Bind(nullptr);
+	g_AsteroidScene = nullptr;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include "ServerApplication.hpp"
+#include "AsteroidScene.hpp"
+#include "Core/Timer.hpp"
+#include "Events/EventQueue.hpp"
+#include "Networking/NetworkEngine.hpp"
+#include "Networking/MatchRouter.hpp"
+
+/**
+ * \brief One match on the dedicated server, with a scene, network session and event queue of its own.
+ *
+ * The game code reaches these through NetworkEngine::GetInstance(), EventQueue::GetInstance() and
+ * g_AsteroidScene, which resolve per thread: a match binds its own before it runs, so one thread can run
+ * several matches in turn and several threads can run matches at once.
+ */
+class ServerMatch {
+public:
+	ServerMatch(size_t index, const ServerConfig& config);
+
+	// Hosts on config.port: through port when sharing it with other matches, else on a socket of its own
+	bool Start(std::unique_ptr<MatchRouter::Port> port);
+	// Runs the frame timer has just measured: the scene, its fixed steps and events, then the network
+	void Frame(const Timer& timer);
+	void Exit();
+
+	void Bind();          // Makes this the match the calling thread runs
+	static void Unbind(); // And back to the process-wide instances
+
+	inline size_t GetIndex() const { return index; }
+	inline NetworkEngine& GetNetwork() { return network; }
+	inline const AsteroidScene& GetScene() const { return scene; }
+
+	// Since the last stats report
+	uint64_t statsTicks = 0;
+	double statsNetMicros = 0.0; // In NetworkEngine::Update
+
+private:
+	size_t index;
+	ServerConfig config;
+	NetworkEngine network;
+	EventQueue events;
+	AsteroidScene scene;
+	MatchRouter::Port* sharedPort = nullptr; // Owned by network's SocketManager
+	bool matchStarted = false;
+};
@@ -0,0 +1,133 @@
+#include "Test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../BotClient.hpp"
+#include "../Core/AllocationCounter.hpp"
+#include "../ServerMatch.hpp"
+
+TEST(PacketPoolReusesBuffers) {
+	REQUIRE(AllocationCounter::IsEnabled()); // The project defines TRACK_ALLOCATIONS
+
+	PacketPool& pool = PacketPool::GetInstance();
+	{
+		std::vector<PacketHandle> held;
+		for (size_t i = 0; i < PacketPool::BLOCK_SIZE * 2; ++i) held.push_back(pool.Acquire());
+	}
+	const size_t capacity = pool.GetCapacity();
+	const size_t inUse = pool.GetInUse();
+
+	// Once grown, the pool hands the same buffers out again without touching the heap
+	std::vector<PacketHandle> held;
+	held.reserve(PacketPool::BLOCK_SIZE * 2);
+	const uint64_t before = AllocationCounter::GetThreadCount();
+	for (int round = 0; round < 100; ++round) {
+		for (size_t i = 0; i < PacketPool::BLOCK_SIZE * 2; ++i) held.push_back(pool.Acquire());
+		held.clear();
+	}
+	CHECK(AllocationCounter::GetThreadCount() == before);
+	CHECK(pool.GetCapacity() == capacity);
+	CHECK(pool.GetInUse() == inUse);
+}
+
+// Packets handed to another thread and released there go back to the pool they came from: its count returns to
+// where it was and it hands the same buffers out again, without growing
+TEST(PacketPoolTakesBackPacketsReleasedElsewhere) {
+	PacketPool& pool = PacketPool::GetInstance();
+	std::vector<PacketHandle> held;
+	for (size_t i = 0; i < PacketPool::BLOCK_SIZE; ++i) held.push_back(pool.Acquire());
+	held.clear();
+	const size_t capacity = pool.GetCapacity();
+	const size_t inUse = pool.GetInUse();
+
+	for (int round = 0; round < 10; ++round) {
+		while (pool.GetCapacity() - pool.GetInUse() > 0) held.push_back(pool.Acquire()); // Free list empty
+		const size_t acquired = held.size();
+		std::thread([&]() { held.clear(); }).join();
+		CHECK(pool.GetInUse() == inUse + acquired); // Not taken back yet
+
+		held.push_back(pool.Acquire()); // Takes back the lot
+		CHECK(pool.GetInUse() == inUse + 1);
+		held.clear();
+		CHECK(pool.GetInUse() == inUse);
+	}
+	CHECK(pool.GetCapacity() == capacity);
+}
+
+// A real match on loopback: a host thread running ServerMatch at 60 Hz, and bots flying about and sending input on
+// this one. Once the match has started and every client's snapshot history has been round once, the host's ticks
+// must not allocate until the next game event, the first asteroid 5 seconds in.
+TEST(HostTicksDoNotAllocate) {
+	constexpr size_t BOTS = 4;
+	constexpr int MEASURED_TICKS = 120;
+
+	ServerConfig config;
+	config.port = "47500";
+	config.maxPlayers = BOTS;
+	config.autoStartPlayers = BOTS;
+	const int WARMUP_TICKS = static_cast<int>(SnapshotHistory::HISTORY_SIZE) * config.snapshotInterval + 30;
+
+	// The game code prints for every event it runs
+	std::streambuf* console = std::cout.rdbuf(nullptr);
+	std::streambuf* errors = std::cerr.rdbuf(nullptr);
+
+	std::atomic<bool> hosting{ false }, stop{ false };
+	std::atomic<int> measuredTicks{ -1 };
+	std::atomic<uint64_t> measuredAllocs{ 0 };
+	std::thread host([&]() {
+		ServerMatch match(0, config);
+		if (!match.Start(nullptr)) {
+			stop = true;
+			return;
+		}
+		hosting = true;
+
+		Timer timer;
+		timer.SetFixedDeltaTime(1.0 / config.tickRate);
+		timer.Start();
+		int started = -1, tick = 0; // Frames, about a tick each
+		uint64_t base = 0;
+		while (!stop) {
+			timer.Update();
+			match.Frame(timer);
+			++tick;
+
+			if (started < 0 && match.GetScene().entities.players.Size() == BOTS) started = tick;
+			if (started >= 0 && tick == started + WARMUP_TICKS) base = AllocationCounter::GetThreadCount();
+			if (started >= 0 && tick == started + WARMUP_TICKS + MEASURED_TICKS) {
+				measuredAllocs = AllocationCounter::GetThreadCount() - base;
+				measuredTicks = MEASURED_TICKS;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(16));
+		}
+		match.Exit();
+	});
+	while (!hosting && !stop) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	BotBehaviour behaviour;
+	behaviour.fireRate = 0.0; // Shots are game events, and events allocate
+	std::vector<std::unique_ptr<BotClient>> bots;
+	for (size_t i = 0; i < BOTS && !stop; ++i) {
+		bots.push_back(std::make_unique<BotClient>(i, behaviour, static_cast<uint32_t>(i)));
+		CHECK(bots.back()->Connect("127.0.0.1", config.port, config.tickRate));
+	}
+
+	const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (measuredTicks < 0 && !stop && std::chrono::steady_clock::now() < until) {
+		for (auto& bot : bots) if (bot->IsConnected()) bot->Frame();
+		std::this_thread::sleep_for(std::chrono::milliseconds(16));
+	}
+	stop = true;
+	host.join();
+	for (auto& bot : bots) bot->Exit();
+	std::cout.rdbuf(console);
+	std::cerr.rdbuf(errors);
+
+	REQUIRE(measuredTicks == MEASURED_TICKS);
+	std::cout << "  " << measuredAllocs << " allocations over " << MEASURED_TICKS << " host ticks with " << BOTS << " bots\n";
+	CHECK(measuredAllocs == 0);
+}
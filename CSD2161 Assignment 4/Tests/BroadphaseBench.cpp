@@ -0,0 +1,94 @@
+#include "Test.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../Core/SpatialGrid.hpp"
+
+// The collision pass the scene used to run, every pair of objects with a type check, against the grid broadphase
+// it runs now: asteroids into a SpatialGrid, then each bullet queries the cells around it.
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	struct Body {
+		bool bullet;
+		glm::vec2 position;
+		float scale;
+	};
+
+	// Half bullets, half asteroids, spread over the play area
+	std::vector<Body> MakeBodies(size_t count, std::mt19937& random) {
+		std::uniform_real_distribution<float> x(-50.f, 50.f), y(-30.f, 30.f), asteroidScale(1.f, 5.f);
+		std::vector<Body> bodies(count);
+		for (size_t i = 0; i < count; ++i) {
+			bodies[i].bullet = i % 2 == 0;
+			bodies[i].position = glm::vec2(x(random), y(random));
+			bodies[i].scale = bodies[i].bullet ? 0.5f : asteroidScale(random);
+		}
+		return bodies;
+	}
+
+	size_t PairLoop(const std::vector<Body>& bodies) {
+		size_t hits = 0;
+		for (size_t i = 0; i < bodies.size(); ++i) {
+			for (size_t j = i + 1; j < bodies.size(); ++j) {
+				if (bodies[i].bullet == bodies[j].bullet) continue;
+				if (glm::length(bodies[i].position - bodies[j].position) < (bodies[i].scale + bodies[j].scale) * 0.5f) ++hits;
+			}
+		}
+		return hits;
+	}
+
+	size_t Grid(const std::vector<Body>& bodies, SpatialGrid& grid, std::vector<uint32_t>& bullets) {
+		grid.Clear();
+		bullets.clear();
+		float maxScale = 0.f;
+		for (uint32_t i = 0; i < bodies.size(); ++i) {
+			if (bodies[i].bullet) {
+				bullets.push_back(i);
+			}
+			else {
+				grid.Insert(i, bodies[i].position);
+				maxScale = std::max(maxScale, bodies[i].scale);
+			}
+		}
+		grid.Build();
+
+		size_t hits = 0;
+		for (uint32_t b : bullets) {
+			const Body& bullet = bodies[b];
+			grid.Query(bullet.position, (bullet.scale + maxScale) * 0.5f, [&](uint32_t a, float distance) {
+				if (distance < (bullet.scale + bodies[a].scale) * 0.5f) ++hits;
+			});
+		}
+		return hits;
+	}
+}
+
+BENCHMARK(BenchBroadphase) {
+	std::mt19937 random(9);
+	SpatialGrid grid(8.f);
+	std::vector<uint32_t> bullets;
+
+	std::printf("        n   pair loop      grid      hits\n");
+	for (size_t count : { size_t(100), size_t(1000), size_t(10000) }) {
+		const std::vector<Body> bodies = MakeBodies(count, random);
+		const int rounds = count >= 10000 ? 3 : 20;
+
+		size_t pairHits = 0, gridHits = 0;
+		auto start = Clock::now();
+		for (int round = 0; round < rounds; ++round) pairHits = PairLoop(bodies);
+		const double pairMicros = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / rounds;
+
+		Grid(bodies, grid, bullets); // Warms the grid's arrays up, as the scene's are after the first tick
+		start = Clock::now();
+		for (int round = 0; round < rounds; ++round) gridHits = Grid(bodies, grid, bullets);
+		const double gridMicros = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / rounds;
+
+		std::printf("  %7zu  %9.1f us  %7.1f us  %zu\n", count, pairMicros, gridMicros, gridHits);
+		CHECK(gridHits == pairHits);
+	}
+}
@@ -0,0 +1,132 @@
+#include "Test.hpp"
+#include "LocalMatch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+	// The port the match has client at, 0 if it has no client
+	uint16_t PortOfOnlyClient(ServerMatch& match) {
+		const auto& clients = match.GetNetwork().clientManager.GetClients();
+		return clients.size() == 1 ? clients[0].udpPort : 0;
+	}
+
+	sockaddr_in FakeAddress(uint32_t index) {
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(0x0A000000u | (index >> 8));
+		addr.sin_port = htons(static_cast<uint16_t>(20000 + (index & 0xFF)));
+		return addr;
+	}
+}
+
+// Connection IDs are a slot and a generation, easy to guess. Naming one is not enough to move its client to
+// another address; the nonce it was issued with has to come too.
+TEST(ClientMovesOnlyWithItsNonce) {
+	LocalMatch::Quiet quiet;
+	ServerConfig config;
+	config.port = "47520";
+	ServerMatch match(0, config);
+	REQUIRE(match.Start(nullptr));
+	Timer timer;
+	timer.SetFixedDeltaTime(1.0 / config.tickRate);
+	timer.Start();
+
+	const sockaddr_in host = Loopback::Address(47520);
+	auto client = Loopback::Open(47521);
+	auto other = Loopback::Open(47522);
+	REQUIRE(client && other);
+	const ConnectionMsg connection = LocalMatch::Handshake(match, timer, *client, host);
+	REQUIRE(connection.connectionID != 0);
+	REQUIRE(PortOfOnlyClient(match) == 47521);
+
+	auto frames = [&]() {
+		for (int frame = 0; frame < 10; ++frame) {
+			LocalMatch::Frame(match, timer);
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	};
+
+	// Every other nonce from another address: the client stays where it is
+	for (uint32_t guess : { 0u, connection.nonce + 1, connection.nonce ^ 0x80000000u }) {
+		LocalMatch::SendBare(*other, host, NetworkEngine::HEARTBEAT, ConnectionMsg{ connection.connectionID, guess });
+	}
+	LocalMatch::SendBare(*other, host, NetworkEngine::PLAYER_LEFT, ConnectionMsg{ connection.connectionID, connection.nonce + 2 });
+	frames();
+	CHECK(PortOfOnlyClient(match) == 47521);
+
+	// The client itself, after its NAT mapping changed
+	LocalMatch::SendBare(*other, host, NetworkEngine::HEARTBEAT, connection);
+	frames();
+	CHECK(PortOfOnlyClient(match) == 47522);
+	match.Exit();
+}
+
+// The host's work per datagram before it handles any message: decode the trailer, find the client it names and
+// check the nonce and address. By connection ID as the host does now, by address through the AddressIndex, and
+// by walking the client list comparing addresses, which is what the host did before it kept an index.
+BENCHMARK(BenchClientLookup) {
+	constexpr int DATAGRAMS = 200000;
+	std::mt19937 random(19);
+
+	std::printf("  clients   by ID      by address   linear scan\n");
+	for (uint32_t count : { 8u, 64u, 1024u }) {
+		ClientManager manager;
+		std::vector<sockaddr_in> senders;
+		std::vector<PacketBuffer> datagrams(count);
+		{
+			LocalMatch::Quiet quiet;
+			for (uint32_t i = 0; i < count; ++i) {
+				senders.push_back(FakeAddress(i));
+				const Client& client = manager.AddClient(senders.back())->get();
+				PacketWriter writer(datagrams[i]);
+				writer.WriteU8(NetworkEngine::HEARTBEAT);
+				Schema::Encode(writer, ConnectionMsg{ client.connectionID, client.connectionNonce });
+				Schema::Encode(writer, ReliableAckMsg{ static_cast<ReliableSequence>(i), 0 });
+			}
+		}
+
+		std::vector<uint32_t> order(DATAGRAMS);
+		for (uint32_t& i : order) i = random() % count;
+
+		double nanos[3] = {};
+		size_t found = 0;
+		for (int mode = 0; mode < 3; ++mode) {
+			const int datagramsRun = mode == 2 && count > 64 ? DATAGRAMS / 20 : DATAGRAMS;
+			const auto start = std::chrono::steady_clock::now();
+			for (int d = 0; d < datagramsRun; ++d) {
+				const uint32_t i = order[d];
+				const PacketBuffer& datagram = datagrams[i];
+				const sockaddr_in& sender = senders[i];
+
+				PacketReader trailer(datagram.data + datagram.size - NetworkEngine::HOST_TRAILER_SIZE, NetworkEngine::HOST_TRAILER_SIZE);
+				ConnectionMsg connection;
+				ReliableAckMsg ack;
+				Schema::Decode(trailer, connection);
+				Schema::Decode(trailer, ack);
+
+				const Client* client = nullptr;
+				if (mode == 0) {
+					if (auto byID = manager.GetClientByConnection(connection.connectionID)) client = &byID->get();
+				}
+				else if (mode == 1) {
+					if (auto byAddress = manager.GetClientByAddr(sender)) client = &byAddress->get();
+				}
+				else {
+					for (const Client& each : manager.GetClients()) {
+						if (each == sender) {
+							client = &each;
+							break;
+						}
+					}
+				}
+				if (client && connection.nonce == client->connectionNonce && *client == sender && ack.ackBits == 0) ++found;
+			}
+			nanos[mode] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / datagramsRun;
+		}
+		std::printf("  %7u  %6.1f ns   %8.1f ns   %9.1f ns\n", count, nanos[0], nanos[1], nanos[2]);
+		CHECK(found == static_cast<size_t>(DATAGRAMS * 2 + (count > 64 ? DATAGRAMS / 20 : DATAGRAMS)));
+	}
+}
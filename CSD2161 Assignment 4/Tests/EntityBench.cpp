@@ -0,0 +1,65 @@
+#include "Test.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include "../ServerMatch.hpp"
+
+extern thread_local AsteroidScene* g_AsteroidScene;
+
+// A full fixed step of the scene over 10k entities in their pools: 100 players, 4950 asteroids and 4950 bullets,
+// kept apart so nothing collides and nothing leaves the play area. The client step is the systems and bounds
+// culling; the host step adds recording the lag compensation frame and the broadphase.
+
+BENCHMARK(BenchFixedStep) {
+	constexpr size_t PLAYERS = 100, ASTEROIDS = 4950, BULLETS = 4950;
+	constexpr int STEPS = 200;
+	constexpr double FIXED_DT = 1.0 / 60.0;
+
+	// A match for its bound engine and event queue; its socket sits idle
+	ServerConfig config;
+	config.port = "47600";
+	ServerMatch match(0, config);
+	REQUIRE(match.Start(nullptr));
+	NetworkEngine& network = match.GetNetwork();
+	AsteroidScene& scene = *g_AsteroidScene;
+
+	std::mt19937 random(10);
+	std::uniform_real_distribution<float> x(-45.f, 45.f), below(-30.f, -1.f), above(1.f, 30.f);
+	NetworkID id = 1;
+	for (size_t i = 0; i < PLAYERS; ++i) {
+		const uint32_t index = scene.entities.Create(ENTITY_PLAYER, id++);
+		scene.entities.players.position[index] = glm::vec3(x(random), above(random), 0.f);
+	}
+	for (size_t i = 0; i < ASTEROIDS; ++i) {
+		const uint32_t index = scene.entities.Create(ENTITY_ASTEROID, id++);
+		scene.entities.asteroids.position[index] = glm::vec3(x(random), below(random), 0.f);
+	}
+	for (size_t i = 0; i < BULLETS; ++i) {
+		const uint32_t index = scene.entities.Create(ENTITY_BULLET, id++);
+		scene.entities.bullets.position[index] = glm::vec3(x(random), above(random), 0.f);
+		scene.entities.bullets.scale[index] = glm::vec3(0.5f);
+		scene.entities.bullets.owner[index] = static_cast<uint32_t>(1 + i % PLAYERS);
+	}
+	const size_t entities = scene.entities.Size();
+
+	std::printf("  %zu entities\n", entities);
+	for (bool host : { false, true }) {
+		network.isHosting = host;
+		scene.FixedUpdate(FIXED_DT); // Warm up
+		double total = 0.0, best = 1e30;
+		for (int step = 0; step < STEPS; ++step) {
+			const auto start = std::chrono::steady_clock::now();
+			scene.FixedUpdate(FIXED_DT);
+			const double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+			total += micros;
+			best = std::min(best, micros);
+			++network.simulationTick;
+		}
+		std::printf("  %s step: mean %.1f us, best %.1f us\n", host ? "host" : "client", total / STEPS, best);
+	}
+	CHECK(scene.entities.Size() == entities);
+
+	network.isHosting = true;
+	match.Exit();
+}
@@ -0,0 +1,239 @@
+#include "Test.hpp"
+#include "LocalMatch.hpp"
+#include "../BotClient.hpp"
+#include "../Networking/ImpairedTransport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+	// Under an ImpairedTransport: keeps the number each datagram carries, in the order they went out
+	class RecordingTransport : public Transport {
+	public:
+		explicit RecordingTransport(std::vector<uint32_t>& sent) : sent(sent) {}
+
+		bool Startup() override { return true; }
+		void Shutdown() override {}
+		bool Open(const sockaddr_in*) override { return true; }
+		void Close() override {}
+		bool IsOpen() const override { return true; }
+
+		bool SendTo(const sockaddr_in&, const char* data, size_t size) override {
+			uint32_t number = 0;
+			std::memcpy(&number, data, std::min(size, sizeof(number)));
+			sent.push_back(number);
+			return true;
+		}
+		int ReceiveFrom(char*, size_t, sockaddr_in&) override { return 0; }
+		bool WaitForData(int) override { return false; }
+
+	private:
+		std::vector<uint32_t>& sent;
+	};
+
+	struct Run {
+		ImpairmentStats stats;
+		std::vector<uint32_t> delivered;
+	};
+
+	// Sends datagrams 0 to count - 1 over link as a game would, a flush after each, then waits for what is held
+	Run SendThrough(const LinkImpairment& link, uint32_t seed, uint32_t count) {
+		Run run;
+		ImpairmentSettings settings;
+		settings.send = link;
+		settings.seed = seed;
+		ImpairedTransport transport(std::make_unique<RecordingTransport>(run.delivered), settings);
+
+		const sockaddr_in to = Loopback::Address(1);
+		for (uint32_t i = 0; i < count; ++i) {
+			transport.SendTo(to, reinterpret_cast<const char*>(&i), sizeof(i));
+			transport.Flush();
+		}
+		const double heldMs = link.latencyMs + link.jitterMs + link.reorderDelayMs + 50.0;
+		const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(heldMs);
+		while (std::chrono::steady_clock::now() < until) {
+			transport.Flush();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		run.stats = transport.GetSendStats();
+		return run;
+	}
+
+	// Datagrams that came after one sent later than them
+	size_t CountLate(const std::vector<uint32_t>& delivered) {
+		size_t late = 0;
+		uint32_t newest = 0;
+		for (uint32_t number : delivered) {
+			if (number < newest) ++late;
+			newest = std::max(newest, number);
+		}
+		return late;
+	}
+}
+
+// Loss, duplication and reordering at the rates asked for, and every datagram accounted for
+TEST(ImpairmentCountsFollowTheSettings) {
+	constexpr uint32_t COUNT = 20000;
+	LinkImpairment link;
+	link.lossPercent = 10.0;
+	link.duplicatePercent = 5.0;
+	link.reorderPercent = 5.0;
+	link.reorderDelayMs = 5.0;
+	const Run run = SendThrough(link, 25, COUNT);
+
+	CHECK(run.stats.lost >= 1700 && run.stats.lost <= 2300);
+	CHECK(run.stats.duplicated >= 700 && run.stats.duplicated <= 1100);     // 5% of the 18000 kept
+	CHECK(run.stats.reordered >= 750 && run.stats.reordered <= 1150);       // 5% of the 18900 copies
+	CHECK(run.stats.queueDrops == 0);
+	CHECK(run.stats.passed == COUNT - run.stats.lost + run.stats.duplicated);
+	CHECK(run.delivered.size() == run.stats.passed);
+
+	std::vector<uint32_t> copies(COUNT, 0);
+	for (uint32_t number : run.delivered) ++copies[number];
+	CHECK(static_cast<uint64_t>(std::count(copies.begin(), copies.end(), 0u)) == run.stats.lost);
+	CHECK(static_cast<uint64_t>(std::count(copies.begin(), copies.end(), 2u)) == run.stats.duplicated);
+	CHECK(std::count(copies.begin(), copies.end(), 3u) == 0);
+
+	// Only a datagram held back can be overtaken
+	const size_t late = CountLate(run.delivered);
+	CHECK(late > 0 && late <= run.stats.reordered);
+}
+
+// Jitter alone delays datagrams by different amounts but never reorders or loses them
+TEST(ImpairmentJitterKeepsOrder) {
+	LinkImpairment link;
+	link.latencyMs = 2.0;
+	link.jitterMs = 2.0;
+	const Run run = SendThrough(link, 25, 2000);
+	REQUIRE(run.delivered.size() == 2000);
+	CHECK(CountLate(run.delivered) == 0);
+	CHECK(run.stats.lost == 0 && run.stats.duplicated == 0 && run.stats.reordered == 0);
+}
+
+// With a burst length, losses come in runs of about that many, at the same rate overall
+TEST(ImpairmentBurstLossComesInRuns) {
+	constexpr uint32_t COUNT = 20000;
+	auto meanRun = [](const Run& run) {
+		std::vector<bool> arrived(COUNT, false);
+		for (uint32_t number : run.delivered) arrived[number] = true;
+		size_t runs = 0, lost = 0;
+		for (uint32_t i = 0; i < COUNT; ++i) {
+			if (arrived[i]) continue;
+			++lost;
+			if (i == 0 || arrived[i - 1]) ++runs;
+		}
+		return runs ? static_cast<double>(lost) / static_cast<double>(runs) : 0.0;
+	};
+
+	LinkImpairment link;
+	link.lossPercent = 10.0;
+	const Run independent = SendThrough(link, 25, COUNT);
+	link.burstLength = 4.0;
+	const Run bursty = SendThrough(link, 25, COUNT);
+
+	CHECK(bursty.stats.lost >= 1400 && bursty.stats.lost <= 2600);
+	CHECK(meanRun(independent) < 1.3);
+	CHECK(meanRun(bursty) > 3.0 && meanRun(bursty) < 5.0);
+}
+
+// The seed alone decides what happens to each datagram: the same seed again gives the same run, another a different one
+TEST(ImpairmentRepeatsForTheSameSeed) {
+	constexpr uint32_t COUNT = 5000;
+	LinkImpairment link;
+	link.lossPercent = 10.0;
+	link.burstLength = 2.0;
+	link.duplicatePercent = 5.0;
+	link.reorderPercent = 5.0;
+	link.reorderDelayMs = 5.0;
+	link.jitterMs = 1.0;
+
+	auto fates = [&](uint32_t seed) {
+		Run run = SendThrough(link, seed, COUNT);
+		std::sort(run.delivered.begin(), run.delivered.end()); // When each is handed on still depends on the clock
+		return run;
+	};
+	const Run first = fates(7), again = fates(7), other = fates(8);
+	CHECK(first.stats.lost == again.stats.lost);
+	CHECK(first.stats.duplicated == again.stats.duplicated);
+	CHECK(first.stats.reordered == again.stats.reordered);
+	CHECK(first.delivered == again.delivered);
+	CHECK(first.delivered != other.delivered);
+}
+
+// A match played with the host's side of the link losing 10%, duplicating and reordering. The start of the match
+// and every shot reach the bots as reliable lockstep events, so every bot must get its ship and see its shots
+// come back as bullets, bar the last one if it is still on its way. A shot goes up to the host once, unreliably,
+// so that direction only has latency.
+TEST(ReliableDeliveryUnderImpairment) {
+	constexpr size_t BOTS = 2;
+	constexpr int PLAY_SECONDS = 8;
+
+	LinkImpairment up, down;
+	up.latencyMs = down.latencyMs = 20.0;
+	up.jitterMs = down.jitterMs = 5.0;
+	down.lossPercent = 10.0;
+	down.duplicatePercent = 5.0;
+	down.reorderPercent = 5.0;
+
+	ServerConfig config;
+	config.port = "47540";
+	config.maxPlayers = BOTS;
+	config.autoStartPlayers = BOTS;
+
+	LocalMatch::Quiet quiet;
+	std::atomic<bool> hosting{ false }, stop{ false };
+	std::atomic<uint64_t> retransmits{ 0 };
+	std::thread host([&]() {
+		ServerMatch match(0, config);
+		if (!match.Start(nullptr)) {
+			stop = true;
+			return;
+		}
+		hosting = true;
+
+		Timer timer;
+		timer.SetFixedDeltaTime(1.0 / config.tickRate);
+		timer.Start();
+		while (!stop) {
+			LocalMatch::Frame(match, timer);
+			std::this_thread::sleep_for(std::chrono::milliseconds(16));
+		}
+		for (const Client& client : match.GetNetwork().clientManager.GetClients()) retransmits += client.reliable.GetStats().retransmits;
+		match.Exit();
+	});
+	while (!hosting && !stop) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	BotBehaviour behaviour;
+	behaviour.fireRate = 1.0;
+	std::vector<std::unique_ptr<BotClient>> bots;
+	for (size_t i = 0; i < BOTS && !stop; ++i) {
+		ImpairmentSettings impairment;
+		impairment.send = up;
+		impairment.receive = down;
+		impairment.seed = static_cast<uint32_t>(100 + i);
+		bots.push_back(std::make_unique<BotClient>(i, behaviour, static_cast<uint32_t>(i)));
+		CHECK(bots.back()->Connect("127.0.0.1", config.port, config.tickRate, impairment));
+	}
+
+	const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(PLAY_SECONDS);
+	while (!stop && std::chrono::steady_clock::now() < until) {
+		for (auto& bot : bots) if (bot->IsConnected()) bot->Frame();
+		std::this_thread::sleep_for(std::chrono::milliseconds(16));
+	}
+	stop = true;
+	host.join();
+
+	for (auto& bot : bots) {
+		const BotMetrics& metrics = bot->CollectMetrics();
+		CHECK(bot->IsPlaying());
+		CHECK(metrics.shotsFired >= PLAY_SECONDS / 2);
+		CHECK(metrics.shotsCommitted + 1 >= metrics.shotsFired);
+		bot->Exit();
+	}
+	CHECK(retransmits > 0); // The link did lose some
+}
@@ -0,0 +1,112 @@
+#include "Test.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../EntityStore.hpp"
+#include "../Networking/InterestManager.hpp"
+
+// Snapshot bytes per client per second as the match grows: players on a grid 60 units apart, ten drifting
+// asteroids around each, a snapshot every other tick at 60 Hz, each acked at once. The host's own interest
+// settings against radius and cull radius wide enough to take in the whole world, where the nearest
+// MAX_OBJECTS are all that fit.
+
+namespace {
+	constexpr double TICK_RATE = 60.0;
+	constexpr int SNAPSHOT_INTERVAL = 2;
+	constexpr int SNAPSHOTS = 300;
+	constexpr float SPACING = 60.f;
+	constexpr size_t ASTEROIDS_PER_PLAYER = 10;
+
+	struct World {
+		EntityStore entities;
+		float size = 0.f; // Positions wrap around at +-size / 2
+	};
+
+	World MakeWorld(size_t players, std::mt19937& random) {
+		World world;
+		const size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(players))));
+		world.size = side * SPACING;
+		std::uniform_real_distribution<float> spread(-SPACING / 2.f, SPACING / 2.f), drift(-2.f, 2.f), speed(-6.f, 6.f);
+
+		NetworkID id = 1;
+		for (size_t p = 0; p < players; ++p) {
+			const glm::vec3 centre((p % side + 0.5f) * SPACING - world.size / 2.f, (p / side + 0.5f) * SPACING - world.size / 2.f, 0.f);
+			const uint32_t player = world.entities.Create(ENTITY_PLAYER, id++);
+			world.entities.players.position[player] = centre;
+			world.entities.players.velocity[player] = glm::vec3(speed(random), speed(random), 0.f);
+			for (size_t a = 0; a < ASTEROIDS_PER_PLAYER; ++a) {
+				const uint32_t asteroid = world.entities.Create(ENTITY_ASTEROID, id++);
+				world.entities.asteroids.position[asteroid] = centre + glm::vec3(spread(random), spread(random), 0.f);
+				world.entities.asteroids.velocity[asteroid] = glm::vec3(drift(random), drift(random), 0.f);
+			}
+		}
+		return world;
+	}
+
+	template <typename Pool>
+	void Move(Pool& pool, float size, float dt, float turn) {
+		for (uint32_t i = 0; i < pool.Size(); ++i) {
+			glm::vec3& position = pool.position[i];
+			position += pool.velocity[i] * dt;
+			for (int axis = 0; axis < 2; ++axis) {
+				if (position[axis] > size / 2.f) position[axis] -= size;
+				else if (position[axis] < -size / 2.f) position[axis] += size;
+			}
+			pool.rotation[i] += turn * dt;
+		}
+	}
+
+	// Average snapshot bytes per client per second
+	double Measure(size_t players, const InterestSettings& settings, std::mt19937 random) {
+		World world = MakeWorld(players, random);
+		InterestManager interest;
+		interest.settings = settings;
+
+		std::vector<Client> clients(players);
+		for (size_t i = 0; i < players; ++i) clients[i].playerID = world.entities.players.networkID[i];
+
+		constexpr size_t overhead = 1 + Schema::WireSize<SnapshotHeaderMsg> + Schema::WireSize<PlayerStateAckMsg>;
+		constexpr size_t budgetBits = (MAX_PACKET_SIZE - overhead - 2) * 8;
+		size_t bytes = 0;
+		Tick tick = 0;
+		for (int round = 0; round < SNAPSHOTS; ++round) {
+			const float dt = static_cast<float>(SNAPSHOT_INTERVAL / TICK_RATE);
+			tick += SNAPSHOT_INTERVAL;
+			Move(world.entities.players, world.size, dt, 1.f);
+			Move(world.entities.asteroids, world.size, dt, 0.f);
+			interest.Capture(world.entities, tick);
+
+			for (Client& client : clients) {
+				const SnapshotSequence sequence = ++client.lastSnapshotSent;
+				Snapshot& snapshot = client.sentSnapshots.Insert(sequence, tick);
+				const Snapshot* baseline = client.sentSnapshots.Find(client.lastSnapshotAcked);
+				interest.Select(client, baseline, snapshot, budgetBits);
+
+				PacketBuffer packet;
+				PacketWriter writer(packet);
+				CHECK(SnapshotEncoding::EncodeDelta(writer, baseline, snapshot));
+				bytes += overhead + packet.size;
+				client.lastSnapshotAcked = sequence;
+			}
+		}
+
+		const double seconds = SNAPSHOTS * SNAPSHOT_INTERVAL / TICK_RATE;
+		return static_cast<double>(bytes) / seconds / static_cast<double>(players);
+	}
+}
+
+BENCHMARK(BenchInterestBandwidth) {
+	InterestSettings everything;
+	everything.radius = everything.cullRadius = 10000.f;
+
+	std::printf("  players  objects   default B/s   everything B/s\n");
+	for (size_t players : { size_t(2), size_t(4), size_t(8), size_t(16), size_t(32), size_t(64) }) {
+		const std::mt19937 random(8);
+		const double filtered = Measure(players, InterestSettings(), random);
+		const double all = Measure(players, everything, random);
+		std::printf("  %7zu  %7zu   %11.0f   %14.0f\n", players, players * (ASTEROIDS_PER_PLAYER + 1), filtered, all);
+		CHECK(filtered <= all);
+	}
+}
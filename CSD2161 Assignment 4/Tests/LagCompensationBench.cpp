@@ -0,0 +1,60 @@
+#include "Test.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include "../LagCompensation.hpp"
+
+// Recording a tick of asteroid positions, and a bullet's query against the current tick and one rewound most of
+// the way back, at the default depth of 30 ticks
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	double NanosSince(Clock::time_point start) {
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+	}
+}
+
+BENCHMARK(BenchLagCompensation) {
+	constexpr int QUERIES = 20000;
+	std::mt19937 random(16);
+	std::uniform_real_distribution<float> x(-50.f, 50.f), y(-30.f, 30.f), drift(-0.1f, 0.1f), scale(1.f, 5.f);
+
+	std::printf("  asteroids  record/tick   current query   rewound query\n");
+	for (size_t count : { size_t(50), size_t(1000), size_t(20000) }) {
+		EntityPool<Asteroid> asteroids;
+		for (size_t i = 0; i < count; ++i) {
+			asteroids.Add(static_cast<NetworkID>(i + 1));
+			asteroids.position[i] = glm::vec3(x(random), y(random), 0.f);
+			asteroids.scale[i] = glm::vec3(scale(random));
+		}
+
+		LagCompensation history;
+		history.SetDepth(LagCompensation::DEFAULT_DEPTH_TICKS);
+		const Tick ticks = LagCompensation::DEFAULT_DEPTH_TICKS * 3;
+		double recordNanos = 0.0;
+		for (Tick tick = 1; tick <= ticks; ++tick) {
+			for (size_t i = 0; i < count; ++i) asteroids.position[i] += glm::vec3(drift(random), drift(random), 0.f);
+			const auto start = Clock::now();
+			history.Record(tick, asteroids);
+			if (tick > LagCompensation::DEFAULT_DEPTH_TICKS) recordNanos += NanosSince(start); // Once the ring is warm
+		}
+
+		double queryNanos[2] = {};
+		size_t found = 0;
+		for (int rewound = 0; rewound < 2; ++rewound) {
+			const Tick seen = ticks - (rewound ? LagCompensation::DEFAULT_DEPTH_TICKS - 2 : 0);
+			const float radius = (0.5f + history.GetMaxSize(seen)) * 0.5f;
+			const auto start = Clock::now();
+			for (int q = 0; q < QUERIES; ++q) {
+				history.Query(seen, glm::vec2(x(random), y(random)), radius, [&](NetworkID, float, float) { ++found; });
+			}
+			queryNanos[rewound] = NanosSince(start) / QUERIES;
+		}
+
+		std::printf("  %9zu  %8.2f us   %10.0f ns   %10.0f ns\n", count,
+			recordNanos / 1000.0 / (ticks - LagCompensation::DEFAULT_DEPTH_TICKS), queryNanos[0], queryNanos[1]);
+		CHECK(found > 0);
+	}
+}
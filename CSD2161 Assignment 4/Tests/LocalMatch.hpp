@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include "Loopback.hpp"
+#include "../ServerMatch.hpp"
+
+/**
+ * \brief A ServerMatch run on the test's own thread, and a raw transport talking to it the way a client would.
+ */
+namespace LocalMatch {
+	// One frame of the match
+	inline void Frame(ServerMatch& match, Timer& timer) {
+		timer.Update();
+		match.Frame(timer);
+	}
+
+	// Asks the match to let transport in and returns the connection it hands out, ID 0 if none
+	inline ConnectionMsg Handshake(ServerMatch& match, Timer& timer, Transport& transport, const sockaddr_in& host) {
+		const char request[] = { NetworkEngine::REQ_CONNECTION, 3, 'b', 'o', 't' };
+		transport.SendTo(host, request, sizeof(request));
+		transport.Flush();
+
+		Datagram reply;
+		for (int frame = 0; frame < 100; ++frame) {
+			Frame(match, timer);
+			while (transport.ReceiveMany(&reply, 1) > 0) {
+				if (reply.size == 0 || reply.data[0] != NetworkEngine::RSP_CONNECTION) continue;
+				PacketReader reader(reply.data + 1, reply.size - 1);
+				ConnectionMsg connection;
+				if (Schema::Decode(reader, connection)) return connection;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+		return ConnectionMsg{};
+	}
+
+	// Sends command with no payload and the trailer naming connection
+	inline void SendBare(Transport& transport, const sockaddr_in& host, NetworkEngine::CMDID command, const ConnectionMsg& connection) {
+		char packet[1 + NetworkEngine::HOST_TRAILER_SIZE] = { static_cast<char>(command) };
+		Schema::Store(packet + 1, connection);
+		Schema::Store(packet + 1 + Schema::WireSize<ConnectionMsg>, ReliableAckMsg{});
+		transport.SendTo(host, packet, sizeof(packet));
+		transport.Flush();
+	}
+
+	// Mutes the console while in scope; the game code prints for every packet it turns away
+	struct Quiet {
+		std::streambuf* console = std::cout.rdbuf(nullptr);
+		std::streambuf* errors = std::cerr.rdbuf(nullptr);
+		~Quiet() {
+			std::cout.rdbuf(console);
+			std::cerr.rdbuf(errors);
+		}
+	};
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include "../Networking/Transport.hpp"
+
+/**
+ * \brief Sockets on 127.0.0.1 for tests that go through a real transport. Each test uses its own ports.
+ */
+namespace Loopback {
+	inline sockaddr_in Address(uint16_t port) {
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons(port);
+		return addr;
+	}
+
+	// A started transport bound to port, or to an ephemeral one with port 0
+	inline std::unique_ptr<Transport> Open(uint16_t port, std::unique_ptr<Transport> transport = Transport::Create()) {
+		transport->Startup();
+		const sockaddr_in addr = Address(port);
+		if (!transport->Open(port != 0 ? &addr : nullptr)) return nullptr;
+		return transport;
+	}
+
+	// Reads from transport until count datagrams came or timeoutMs passed
+	inline size_t Receive(Transport& transport, Datagram* out, size_t count, int timeoutMs = 1000) {
+		const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		size_t received = 0;
+		while (received < count && std::chrono::steady_clock::now() < until) {
+			transport.WaitForData(10);
+			received += transport.ReceiveMany(out + received, count - received);
+		}
+		return received;
+	}
+}
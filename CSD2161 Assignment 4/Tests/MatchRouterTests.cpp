@@ -0,0 +1,175 @@
+#include "Test.hpp"
+#include "LocalMatch.hpp"
+#include "../BotClient.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	using Matches = std::vector<std::unique_ptr<ServerMatch>>;
+
+	// Frames every match until transport's REQ_CONNECTION is answered, and returns the match that answered, -1 if none
+	int Join(Matches& matches, Timer& timer, Transport& transport, const sockaddr_in& host) {
+		const char request[] = { NetworkEngine::REQ_CONNECTION, 3, 'b', 'o', 't' };
+		transport.SendTo(host, request, sizeof(request));
+		transport.Flush();
+
+		Datagram reply;
+		for (int frame = 0; frame < 100; ++frame) {
+			for (auto& match : matches) LocalMatch::Frame(*match, timer);
+			while (transport.ReceiveMany(&reply, 1) > 0) {
+				if (reply.size == 0 || reply.data[0] != NetworkEngine::RSP_CONNECTION) continue;
+				PacketReader reader(reply.data + 1, reply.size - 1);
+				ConnectionMsg connection;
+				if (Schema::Decode(reader, connection)) return ClientManager::GetConnectionTag(connection.connectionID) - 1;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+		return -1;
+	}
+
+	// Has match drop the client at port as if it had stopped sending, and gives the router time to hear of it
+	void TimeOut(ServerMatch& match, Timer& timer, uint16_t port) {
+		for (auto& client : match.GetNetwork().clientManager.GetClientsNonConst()) {
+			if (client.udpPort == port) client.lastHeartbeatTime -= std::chrono::milliseconds(NetworkEngine::CLIENT_TIMEOUT_MS + 1000);
+		}
+		LocalMatch::Frame(match, timer);
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+}
+
+// Two matches of one player each. A player who leaves frees their place for whoever comes next, and on coming
+// back is placed by room like anyone new rather than sent to the full match they were in.
+TEST(RouterGivesPlacesBackWhenPlayersLeave) {
+	LocalMatch::Quiet quiet;
+	ServerConfig config;
+	config.port = "47530";
+	config.matches = 2;
+
+	// The matches own the ports, so they are declared first and outlive the router's thread
+	Matches matches;
+	for (size_t i = 0; i < config.matches; ++i) matches.push_back(std::make_unique<ServerMatch>(i, config));
+	MatchRouter router(config.matches, 1);
+	std::vector<std::unique_ptr<MatchRouter::Port>> ports;
+	for (size_t i = 0; i < config.matches; ++i) ports.push_back(router.CreatePort(i));
+	REQUIRE(router.Open(config.port));
+	for (size_t i = 0; i < config.matches; ++i) REQUIRE(matches[i]->Start(std::move(ports[i])));
+	Timer timer;
+	timer.SetFixedDeltaTime(1.0 / config.tickRate);
+	timer.Start();
+
+	const sockaddr_in host = Loopback::Address(47530);
+	auto first = Loopback::Open(47531);
+	auto second = Loopback::Open(47532);
+	REQUIRE(first && second);
+
+	CHECK(Join(matches, timer, *first, host) == 0);
+	TimeOut(*matches[0], timer, 47531);
+	CHECK(matches[0]->GetNetwork().clientManager.GetClients().empty());
+
+	CHECK(Join(matches, timer, *second, host) == 0);
+	CHECK(Join(matches, timer, *first, host) == 1);
+	CHECK(Join(matches, timer, *first, host) == 1); // Asking again while in, it stays where it is
+	CHECK(router.GetUnroutable() == 0);
+
+	router.Close();
+	for (auto& match : matches) match->Exit();
+}
+
+// What one match costs its worker: matches of two bots each run by one thread at 60 Hz the way
+// ServerApplication::RunWorker does, busy time per tick measured once every match is playing. matches/core is how
+// many such matches would fill the tick budget.
+BENCHMARK(BenchMatchesPerCore) {
+	constexpr size_t BOTS_PER_MATCH = 2;
+	constexpr int WARMUP_TICKS = 60;
+	constexpr uint64_t MEASURED_TICKS = 300;
+
+	std::printf("  matches   us/tick   us/match   matches/core\n");
+	uint16_t port = 47610;
+	for (size_t count : { 1u, 4u, 8u }) {
+		ServerConfig config;
+		config.port = std::to_string(port++);
+		config.matches = count;
+		config.maxPlayers = BOTS_PER_MATCH;
+		config.autoStartPlayers = BOTS_PER_MATCH;
+
+		std::atomic<bool> hosting{ false }, stop{ false };
+		std::atomic<double> perTick{ -1.0 };
+		{
+			LocalMatch::Quiet quiet;
+			Matches matches;
+			for (size_t i = 0; i < count; ++i) matches.push_back(std::make_unique<ServerMatch>(i, config));
+			MatchRouter router(count, BOTS_PER_MATCH);
+			std::vector<std::unique_ptr<MatchRouter::Port>> ports;
+			for (size_t i = 0; i < count; ++i) ports.push_back(router.CreatePort(i));
+			REQUIRE(router.Open(config.port));
+
+			// Started, run and exited on the one thread, as a worker does
+			std::thread worker([&]() {
+				for (size_t i = 0; i < count; ++i) {
+					if (!matches[i]->Start(std::move(ports[i]))) stop = true;
+				}
+				hosting = true;
+
+				Timer timer;
+				timer.SetFixedDeltaTime(1.0 / config.tickRate);
+				timer.Start();
+				const auto tickDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					std::chrono::duration<double>(timer.GetFixedDT()));
+				auto nextTick = std::chrono::steady_clock::now();
+				int playing = -1, frame = 0;
+				uint64_t ticks = 0;
+				double busy = 0.0;
+				while (!stop) {
+					timer.Update();
+					const auto start = std::chrono::steady_clock::now();
+					for (auto& match : matches) match->Frame(timer);
+					const double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+					if (playing < 0) {
+						bool all = true;
+						for (auto& match : matches) all &= match->GetScene().entities.players.Size() == BOTS_PER_MATCH;
+						if (all) playing = frame;
+					}
+					else if (frame >= playing + WARMUP_TICKS && ticks < MEASURED_TICKS) {
+						busy += micros;
+						ticks += timer.GetFixedSteps();
+						if (ticks >= MEASURED_TICKS) perTick = busy / static_cast<double>(ticks);
+					}
+					++frame;
+
+					nextTick += tickDuration;
+					std::this_thread::sleep_until(nextTick);
+				}
+				for (auto& match : matches) match->Exit();
+			});
+			while (!hosting && !stop) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+			std::vector<std::unique_ptr<BotClient>> bots;
+			for (size_t i = 0; i < count * BOTS_PER_MATCH && !stop; ++i) {
+				bots.push_back(std::make_unique<BotClient>(i, BotBehaviour{}, static_cast<uint32_t>(i)));
+				bots.back()->Connect("127.0.0.1", config.port, config.tickRate);
+			}
+
+			const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+			while (perTick < 0.0 && !stop && std::chrono::steady_clock::now() < until) {
+				for (auto& bot : bots) if (bot->IsConnected()) bot->Frame();
+				std::this_thread::sleep_for(std::chrono::milliseconds(16));
+			}
+			stop = true;
+			worker.join();
+			for (auto& bot : bots) bot->Exit();
+			router.Close();
+		}
+
+		REQUIRE(perTick > 0.0);
+		const double budget = 1.0e6 / config.tickRate;
+		std::printf("  %7zu   %7.1f   %8.1f   %12.0f\n", count, perTick.load(), perTick / static_cast<double>(count),
+			static_cast<double>(count) * budget / perTick);
+	}
+}
@@ -0,0 +1,59 @@
+#include "Test.hpp"
+
+#include <vector>
+#include "../Networking/PlayerInput.hpp"
+
+namespace {
+	// How many commands the queue runs on hostTick
+	size_t RunTick(PlayerInputQueue& queue, Tick hostTick) {
+		uint8_t buttons = 0;
+		size_t ran = 0;
+		while (queue.Next(hostTick, buttons)) ++ran;
+		return ran;
+	}
+}
+
+TEST(PlayerInputRunsOneCommandPerTick) {
+	PlayerInputQueue queue;
+	const uint8_t thrust[] = { BUTTON_THRUST };
+	for (Tick tick = 1; tick <= 20; ++tick) {
+		queue.Receive(tick, thrust, 1, tick + PlayerInputQueue::MAX_LEAD_TICKS);
+		CHECK(RunTick(queue, tick) == 1);
+	}
+	CHECK(queue.GetLastProcessed() == 20);
+}
+
+TEST(PlayerInputCatchUpIsCappedPerTick) {
+	PlayerInputQueue queue;
+	const std::vector<uint8_t> burst(PlayerInputQueue::WINDOW, BUTTON_THRUST);
+	queue.Receive(PlayerInputQueue::WINDOW, burst.data(), burst.size(), PlayerInputQueue::WINDOW);
+
+	// A stall's worth arriving at once is worked off a few a tick, and then one a tick again
+	Tick hostTick = 1;
+	size_t total = 0;
+	while (queue.GetLastProcessed() < PlayerInputQueue::WINDOW) {
+		const size_t ran = RunTick(queue, hostTick++);
+		CHECK(ran >= 1 && ran <= PlayerInputQueue::MAX_PER_TICK);
+		total += ran;
+	}
+	CHECK(total == PlayerInputQueue::WINDOW);
+	CHECK(RunTick(queue, hostTick) == 0);
+}
+
+// A client claiming ticks ahead of its clock to run more commands than the host runs ticks
+TEST(PlayerInputDropsCommandsAheadOfTheClientClock) {
+	PlayerInputQueue queue;
+	const std::vector<uint8_t> commands(PlayerInputQueue::WINDOW, BUTTON_THRUST);
+	constexpr Tick CLIENT_START = 1000;
+
+	size_t total = 0;
+	for (Tick hostTick = 1; hostTick <= 600; ++hostTick) {
+		const Tick clientTick = CLIENT_START + hostTick;
+		const Tick claimed = clientTick + 4 * hostTick; // Running five times as fast
+		queue.Receive(claimed, commands.data(), commands.size(), clientTick + PlayerInputQueue::MAX_LEAD_TICKS);
+		total += RunTick(queue, hostTick);
+		CHECK(static_cast<int32_t>(queue.GetLastProcessed() - (clientTick + PlayerInputQueue::MAX_LEAD_TICKS)) <= 0);
+	}
+	// No more than one a tick, once the first window is worked off
+	CHECK(total <= 600 + PlayerInputQueue::WINDOW + PlayerInputQueue::MAX_LEAD_TICKS);
+}
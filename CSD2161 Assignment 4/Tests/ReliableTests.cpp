@@ -0,0 +1,179 @@
+#include "Test.hpp"
+#include "LocalMatch.hpp"
+#include "../Networking/ReliableChannel.hpp"
+#include "../Networking/Fragmentation.hpp"
+#include "../Events/Event.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+// A message near the largest a client is ever sent, split the way SendFragmented splits it and carried by the
+// reliable stream over a link that loses one packet in ten each way. Every part must arrive and go back
+// together, and none may be sent so far ahead that the receiver has nowhere to note it.
+TEST(FragmentedMessageSurvivesLoss) {
+	using Clock = std::chrono::steady_clock;
+	constexpr size_t SIZE = 100 * 1024;
+	constexpr int LOSS_PERCENT = 10;
+
+	std::vector<char> message(SIZE);
+	for (size_t i = 0; i < SIZE; ++i) message[i] = static_cast<char>(i * 7 + (i >> 8));
+
+	ReliableSender sender;
+	ReliableReceiver receiver;
+	FragmentAssembler assembler;
+
+	const size_t count = (SIZE + FragmentAssembler::PAYLOAD_SIZE - 1) / FragmentAssembler::PAYLOAD_SIZE;
+	REQUIRE(count <= FragmentAssembler::MAX_FRAGMENTS && count <= sender.GetRoom());
+	for (size_t index = 0; index < count; ++index) {
+		const size_t offset = index * FragmentAssembler::PAYLOAD_SIZE;
+		const size_t length = std::min(FragmentAssembler::PAYLOAD_SIZE, SIZE - offset);
+		PacketHandle packet = PacketPool::GetInstance().Acquire();
+		PacketWriter writer(*packet);
+		writer.WriteU8(0);
+		Schema::Encode(writer, ReliableHeaderMsg{ sender.NextSequence() });
+		Schema::Encode(writer, FragmentHeaderMsg{ 1, static_cast<uint16_t>(index), static_cast<uint16_t>(count) });
+		writer.WriteBytes(message.data() + offset, length);
+		sender.Push(std::move(packet), 0, false);
+	}
+
+	std::mt19937 random(22);
+	auto lost = [&]() { return static_cast<int>(random() % 100) < LOSS_PERCENT; };
+
+	std::set<ReliableSequence> seen;
+	size_t refusedUnseen = 0;
+	std::vector<char> assembled;
+	const auto deadline = Clock::now() + std::chrono::seconds(20);
+	while (assembled.empty() && Clock::now() < deadline) {
+		const auto now = Clock::now();
+		sender.ForEachDue(now, [&](ReliableSender::Entry& entry) {
+			if (lost()) return true;
+			PacketReader reader(entry.packet->data + 1, entry.packet->size - 1);
+			ReliableHeaderMsg reliable;
+			FragmentHeaderMsg header;
+			Schema::Decode(reader, reliable);
+			if (!Schema::Decode(reader, header)) return true;
+
+			if (!receiver.Accept(reliable.sequence)) {
+				if (!seen.count(reliable.sequence)) ++refusedUnseen;
+				return true;
+			}
+			seen.insert(reliable.sequence);
+			if (const std::vector<char>* whole = assembler.Add(header, reader.Current(), reader.Remaining(), now)) assembled = *whole;
+			return true;
+		});
+
+		// The client acks once per frame, and the ack can be lost too
+		if (!lost()) sender.Acknowledge(receiver.GetAck(), [](const ReliableSender::Entry&) {});
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	REQUIRE(assembled.size() == SIZE);
+	CHECK(std::memcmp(assembled.data(), message.data(), SIZE) == 0);
+	CHECK(refusedUnseen == 0);
+	CHECK(seen.size() == count);
+	CHECK(sender.GetStats().sent == count);
+}
+
+// However many messages are queued, a single ForEachDue hands out no more than the receiver can record
+TEST(ReliableSenderKeepsToReceiveWindow) {
+	ReliableSender sender;
+	for (size_t i = 0; i < 100; ++i) {
+		PacketHandle packet = PacketPool::GetInstance().Acquire();
+		PacketWriter writer(*packet);
+		Schema::Encode(writer, ReliableHeaderMsg{ sender.NextSequence() });
+		sender.Push(std::move(packet), 0, false);
+	}
+
+	size_t sent = 0;
+	sender.ForEachDue(ReliableSender::Clock::now(), [&](ReliableSender::Entry&) { return ++sent, true; });
+	CHECK(sent == RELIABLE_RECEIVE_WINDOW);
+
+	// Acking the first ten lets the next ten out at once, without waiting on a resend timer
+	sent = 0;
+	sender.Acknowledge(ReliableAckMsg{ 10, 0 }, [](const ReliableSender::Entry&) {});
+	sender.ForEachDue(ReliableSender::Clock::now(), [&](ReliableSender::Entry&) { return ++sent, true; });
+	CHECK(sent == 10);
+}
+
+// A message a tick on a link that loses nothing. At first the client has input of its own every frame and acks at
+// once, so RTT samples are tiny; then it goes idle and holds each ack the full RELIABLE_ACK_DELAY_MS. Every ack
+// still beats the resend timer.
+TEST(DelayedAcksCauseNoRetransmits) {
+	using Clock = std::chrono::steady_clock;
+	constexpr int ACTIVE_TICKS = 30, IDLE_TICKS = 60;
+
+	ReliableSender sender;
+	ReliableReceiver receiver;
+	bool ackPending = false;
+	Clock::time_point ackPendingSince;
+
+	for (int tick = 0; tick < ACTIVE_TICKS + IDLE_TICKS; ++tick) {
+		PacketHandle packet = PacketPool::GetInstance().Acquire();
+		PacketWriter writer(*packet);
+		Schema::Encode(writer, ReliableHeaderMsg{ sender.NextSequence() });
+		sender.Push(std::move(packet), 0, false);
+
+		// Host frame, then client frame
+		const auto now = Clock::now();
+		sender.ForEachDue(now, [&](ReliableSender::Entry& entry) {
+			PacketReader reader(*entry.packet);
+			ReliableHeaderMsg header;
+			Schema::Decode(reader, header);
+			if (receiver.Accept(header.sequence) && !ackPending) {
+				ackPending = true;
+				ackPendingSince = Clock::now();
+			}
+			return true;
+		});
+		const bool idle = tick >= ACTIVE_TICKS;
+		if (ackPending && (!idle || Clock::now() - ackPendingSince >= std::chrono::milliseconds(RELIABLE_ACK_DELAY_MS))) {
+			sender.Acknowledge(receiver.GetAck(), [](const ReliableSender::Entry&) {});
+			ackPending = false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(16));
+	}
+
+	CHECK(sender.GetStats().sent == ACTIVE_TICKS + IDLE_TICKS);
+	CHECK(sender.GetStats().retransmits == 0);
+	CHECK(sender.GetRto() >= ReliableSender::MIN_RTO);
+}
+
+// A client that stops acking fills its reliable stream. The next event it would get cannot be queued, and a
+// client that misses one is out of step, so the host drops it rather than carry on without it.
+TEST(HostDropsClientWithFullReliableWindow) {
+	LocalMatch::Quiet quiet;
+	ServerConfig config;
+	config.port = "47550";
+	ServerMatch match(0, config);
+	REQUIRE(match.Start(nullptr));
+	Timer timer;
+	timer.SetFixedDeltaTime(1.0 / config.tickRate);
+	timer.Start();
+
+	auto client = Loopback::Open(47551);
+	REQUIRE(client);
+	REQUIRE(LocalMatch::Handshake(match, timer, *client, Loopback::Address(47550)).connectionID != 0);
+
+	NetworkEngine& network = match.GetNetwork();
+	const std::vector<Client>& clients = network.clientManager.GetClients();
+	REQUIRE(clients.size() == 1);
+	auto fire = [&]() { network.ServerBroadcastEvent(std::make_unique<FireBulletEvent>(glm::vec3(0.f), 0.f, 0u)); };
+
+	// Right up to the last free slot it stays
+	for (size_t room = clients[0].reliable.GetRoom(); room > 0; --room) fire();
+	REQUIRE(clients.size() == 1);
+	CHECK(clients[0].isConnected && clients[0].reliable.IsFull());
+	LocalMatch::Frame(match, timer);
+	CHECK(clients.size() == 1);
+
+	fire();
+	CHECK(clients.empty() || !clients[0].isConnected);
+	LocalMatch::Frame(match, timer);
+	CHECK(clients.empty());
+	match.Exit();
+}
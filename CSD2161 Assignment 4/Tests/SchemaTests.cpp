@@ -0,0 +1,227 @@
+#include "Test.hpp"
+#include "LocalMatch.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../BotClient.hpp"
+#include "../Networking/Messages.hpp"
+
+namespace {
+	template <typename... Msgs>
+	struct MessageList {};
+
+	using AllMessages = MessageList<ConnectRequestMsg, ConnectionMsg, ClockPingMsg, ClockPongMsg, ReliableHeaderMsg,
+		ReliableAckMsg, FragmentHeaderMsg, BundleEntryMsg, EventHeaderMsg, CommitEventMsg, ScheduledEventMsg,
+		SnapshotHeaderMsg, SnapshotAckMsg, PlayerInputMsg, PlayerStateAckMsg, FireBulletMsg, CollisionMsg,
+		SpawnAsteroidMsg, WorldStateMsg, WorldPlayerMsg, RosterHeaderMsg, RosterEntryMsg>;
+
+	template <typename... Msgs, typename Check>
+	void ForEachMessage(MessageList<Msgs...>, Check&& check) {
+		(check(Msgs{}), ...);
+	}
+
+	// Any bytes decode to a message that encodes back to the same bytes: every wire type keeps every bit
+	template <typename Msg>
+	void CheckByteRoundTrip(std::mt19937& random) {
+		constexpr size_t size = Schema::WireSize<Msg>;
+		for (int round = 0; round < 1000; ++round) {
+			PacketBuffer wire;
+			wire.size = size;
+			for (size_t i = 0; i < size; ++i) wire.data[i] = static_cast<char>(random());
+
+			PacketReader reader(wire);
+			Msg msg;
+			CHECK(Schema::Decode(reader, msg));
+			CHECK(reader.Ok() && reader.Remaining() == 0);
+
+			PacketBuffer again;
+			PacketWriter writer(again);
+			CHECK(Schema::Encode(writer, msg));
+			CHECK(writer.Size() == size);
+			CHECK(std::memcmp(wire.data, again.data, size) == 0);
+		}
+	}
+
+	// Every length short of the message fails without reading past it; the reader sits at the very end of a heap
+	// block, so under ASan a read one byte too far would stop the test
+	template <typename Msg>
+	void CheckTruncated() {
+		constexpr size_t size = Schema::WireSize<Msg>;
+		std::vector<char> bytes(size - 1, '\x5a');
+		for (size_t length = 0; length < size; ++length) {
+			PacketReader reader(bytes.data() + bytes.size() - length, length);
+			Msg msg;
+			CHECK(!Schema::Decode(reader, msg));
+			CHECK(!reader.Ok());
+			CHECK(reader.Remaining() == 0);
+		}
+
+		// Nor is one written where it does not fit
+		PacketBuffer full;
+		PacketWriter writer(full);
+		std::vector<char> filler(MAX_PACKET_SIZE - size + 1);
+		writer.WriteBytes(filler.data(), filler.size());
+		CHECK(!Schema::Encode(writer, Msg{}));
+		CHECK(!writer.Ok());
+		CHECK(writer.Size() == filler.size());
+	}
+
+	// A datagram of random length after a command byte that is mostly a real one
+	size_t RandomMessage(std::mt19937& random, char* out, size_t maxBody) {
+		out[0] = static_cast<char>(random() % 4 == 0 ? random() : random() % (NetworkEngine::FRAGMENT + 1));
+		const size_t body = random() % (maxBody + 1);
+		for (size_t i = 1; i <= body; ++i) out[i] = static_cast<char>(random());
+		return body + 1;
+	}
+}
+
+TEST(SchemaLayoutIsBigEndianAtFixedOffsets) {
+	PacketBuffer packet;
+	PacketWriter writer(packet);
+	CHECK(Schema::Encode(writer, ScheduledEventMsg{ 0x01020304u, 0x0A0B0C0Du, 0x11223344u }));
+	CHECK(Schema::Encode(writer, ReliableAckMsg{ 0xBEEF, 0x80000001u }));
+	const unsigned char expected[] = { 1, 2, 3, 4, 10, 11, 12, 13, 0x11, 0x22, 0x33, 0x44, 0xBE, 0xEF, 0x80, 0, 0, 1 };
+	REQUIRE(packet.size == sizeof(expected));
+	CHECK(std::memcmp(packet.data, expected, sizeof(expected)) == 0);
+
+	PacketReader reader(packet);
+	ScheduledEventMsg event;
+	ReliableAckMsg ack;
+	CHECK(Schema::Decode(reader, event) && Schema::Decode(reader, ack));
+	CHECK(event.eventID == 0x01020304u && event.networkID == 0x0A0B0C0Du && event.executeTick == 0x11223344u);
+	CHECK(ack.ack == 0xBEEF && ack.ackBits == 0x80000001u);
+}
+
+TEST(SchemaRoundTripsFloatsAndVectors) {
+	SpawnAsteroidMsg spawn{ 42, glm::vec3(-1.5f, 3.25e-3f, 7.f), glm::vec3(5.f, 5.f, 1.f), glm::vec3(-0.f, 1e30f, -2.f) };
+	PacketBuffer packet;
+	PacketWriter writer(packet);
+	CHECK(Schema::Encode(writer, spawn));
+	CHECK(packet.size == Schema::WireSize<SpawnAsteroidMsg>);
+
+	SpawnAsteroidMsg decoded;
+	PacketReader reader(packet);
+	CHECK(Schema::Decode(reader, decoded));
+	CHECK(decoded.networkID == 42);
+	CHECK(decoded.position == spawn.position && decoded.scale == spawn.scale && decoded.velocity == spawn.velocity);
+
+	// Vec2 fields carry x and y and leave z alone
+	PlayerStateAckMsg state{ 9, glm::vec3(1.f, 2.f, 3.f), 0.5f, glm::vec3(4.f, 5.f, 6.f) };
+	PacketBuffer statePacket;
+	PacketWriter stateWriter(statePacket);
+	CHECK(Schema::Encode(stateWriter, state));
+	PlayerStateAckMsg stateDecoded;
+	stateDecoded.position.z = stateDecoded.velocity.z = -7.f;
+	PacketReader stateReader(statePacket);
+	CHECK(Schema::Decode(stateReader, stateDecoded));
+	CHECK(stateDecoded.position == glm::vec3(1.f, 2.f, -7.f) && stateDecoded.velocity == glm::vec3(4.f, 5.f, -7.f));
+	CHECK(stateDecoded.inputTick == 9 && stateDecoded.rotation == 0.5f);
+}
+
+TEST(SchemaRoundTripsEveryMessage) {
+	std::mt19937 random(5);
+	ForEachMessage(AllMessages{}, [&](auto msg) { CheckByteRoundTrip<decltype(msg)>(random); });
+}
+
+TEST(SchemaRejectsTruncatedMessages) {
+	ForEachMessage(AllMessages{}, [](auto msg) { CheckTruncated<decltype(msg)>(); });
+}
+
+// Malformed and truncated datagrams of every command, with a valid trailer so they get past the connection lookup,
+// against a running match. The host must stay up and still let players in afterwards.
+TEST(HostSurvivesMalformedPackets) {
+	LocalMatch::Quiet quiet;
+	ServerConfig config;
+	config.port = "47510";
+	config.autoStartPlayers = 1;
+	ServerMatch match(0, config);
+	REQUIRE(match.Start(nullptr));
+	Timer timer;
+	timer.SetFixedDeltaTime(1.0 / config.tickRate);
+	timer.Start();
+
+	auto client = Loopback::Open(0);
+	REQUIRE(client);
+	const sockaddr_in host = Loopback::Address(47510);
+
+	// A REQ_CONNECTION whose name runs past the packet is turned away, then a real one is let in
+	const char shortName[] = { NetworkEngine::REQ_CONNECTION, 20, 'b', 'o' };
+	client->SendTo(host, shortName, sizeof(shortName));
+	const ConnectionMsg connection = LocalMatch::Handshake(match, timer, *client, host);
+	REQUIRE(connection.connectionID != 0);
+	CHECK(match.GetNetwork().GetNumConnectedClients() == 1);
+
+	std::mt19937 random(11);
+	char datagram[MAX_PACKET_SIZE];
+	Datagram reply;
+	for (int round = 0; round < 400; ++round) {
+		for (int i = 0; i < 40; ++i) {
+			size_t size = RandomMessage(random, datagram, 80);
+			Schema::Store(datagram + size, connection);
+			Schema::Store(datagram + size + Schema::WireSize<ConnectionMsg>,
+				ReliableAckMsg{ static_cast<uint16_t>(random()), static_cast<uint32_t>(random()) });
+			size += NetworkEngine::HOST_TRAILER_SIZE;
+			if (random() % 8 == 0) size = random() % size; // Cut short, trailer and all
+			client->SendTo(host, datagram, size);
+		}
+		client->Flush();
+		LocalMatch::Frame(match, timer);
+		while (client->ReceiveMany(&reply, 1) > 0) {}
+	}
+
+	// Garbage may well have said PLAYER_LEFT, so it is a newcomer that shows the host is still serving
+	auto newcomer = Loopback::Open(0);
+	REQUIRE(newcomer);
+	CHECK(LocalMatch::Handshake(match, timer, *newcomer, host).connectionID != 0);
+	match.Exit();
+}
+
+// The same the other way: a fake host answers a client's handshake, then sends it garbage
+TEST(ClientSurvivesMalformedPackets) {
+	LocalMatch::Quiet quiet;
+	auto host = Loopback::Open(47511);
+	REQUIRE(host);
+
+	std::atomic<bool> done{ false };
+	std::atomic<bool> answered{ false };
+	std::thread fakeHost([&]() {
+		std::mt19937 random(13);
+		Datagram request;
+		sockaddr_in client{};
+		while (!answered && !done) {
+			if (Loopback::Receive(*host, &request, 1, 50) == 0) continue;
+			if (request.data[0] != NetworkEngine::REQ_CONNECTION) continue;
+			client = request.addr;
+			char reply[1 + Schema::WireSize<ConnectionMsg>] = { NetworkEngine::RSP_CONNECTION };
+			Schema::Store(reply + 1, ConnectionMsg{ 0x00010001u });
+			host->SendTo(client, reply, sizeof(reply));
+			host->Flush();
+			answered = true;
+		}
+
+		char datagram[MAX_PACKET_SIZE];
+		for (int round = 0; round < 400 && !done; ++round) {
+			for (int i = 0; i < 40; ++i) host->SendTo(client, datagram, RandomMessage(random, datagram, 120));
+			host->Flush();
+			while (host->ReceiveMany(&request, 1) > 0) {}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		done = true;
+	});
+
+	BotBehaviour behaviour;
+	behaviour.fireRate = 0.0;
+	BotClient bot(0, behaviour, 1);
+	const bool connected = bot.Connect("127.0.0.1", "47511", 60);
+	CHECK(connected);
+	while (connected && !done) {
+		if (bot.IsConnected()) bot.Frame();
+		else std::this_thread::yield();
+	}
+	done = true;
+	fakeHost.join();
+	bot.Exit();
+}
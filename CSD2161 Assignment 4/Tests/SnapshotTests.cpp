@@ -0,0 +1,191 @@
+#include "Test.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../Networking/BitStream.hpp"
+#include "../Networking/Snapshot.hpp"
+
+namespace {
+	using StateEncoding::QuantizedState;
+	using Q = StateEncoding::Quantization;
+
+	QuantizedState RandomState(std::mt19937& random, NetworkID id) {
+		QuantizedState state;
+		state.networkID = id;
+		state.objectType = static_cast<uint8_t>(random() % 4);
+		state.position[0] = random() % (Q::POSITION_STEPS + 1);
+		state.position[1] = random() % (Q::POSITION_STEPS + 1);
+		state.rotation = random() % (1u << Q::ROTATION_BITS);
+		state.velocity[0] = random() % (Q::VELOCITY_STEPS + 1);
+		state.velocity[1] = random() % (Q::VELOCITY_STEPS + 1);
+		return state;
+	}
+
+	// Count objects with increasing IDs, some close together and some far apart
+	Snapshot RandomSnapshot(std::mt19937& random, size_t count) {
+		Snapshot snapshot;
+		NetworkID id = random() % 100;
+		for (size_t i = 0; i < count; ++i) {
+			id += 1 + random() % (random() % 4 == 0 ? 100000 : 3);
+			snapshot.states.push_back(RandomState(random, id));
+		}
+		return snapshot;
+	}
+
+	// Baseline moved on by a tick: some objects gone, some new, and each kept one nudged, moved far, turned,
+	// sped up, replaced by a random state (possibly of another type) or left alone
+	Snapshot NextSnapshot(std::mt19937& random, const Snapshot& baseline) {
+		Snapshot next;
+		for (const QuantizedState& base : baseline.states) {
+			if (random() % 8 == 0) continue;
+			QuantizedState state = base;
+			switch (random() % 6) {
+			case 0: state.position[0] = std::min(state.position[0] + static_cast<uint32_t>(random() % 5), Q::POSITION_STEPS); break;
+			case 1: state.position[1] = random() % (Q::POSITION_STEPS + 1); break;
+			case 2: state.rotation = random() % (1u << Q::ROTATION_BITS); break;
+			case 3: state.velocity[0] = random() % (Q::VELOCITY_STEPS + 1); break;
+			case 4: state = RandomState(random, base.networkID); break;
+			default: break;
+			}
+			next.states.push_back(state);
+		}
+		const size_t added = random() % 6;
+		for (size_t i = 0; i < added && next.states.size() < SnapshotEncoding::MAX_OBJECTS; ++i) {
+			const NetworkID id = static_cast<NetworkID>(random() % 200000 + 1);
+			auto at = std::lower_bound(next.states.begin(), next.states.end(), id,
+				[](const QuantizedState& state, NetworkID value) { return state.networkID < value; });
+			if (at != next.states.end() && at->networkID == id) continue;
+			next.states.insert(at, RandomState(random, id));
+		}
+		return next;
+	}
+
+	// Encodes current against baseline into packet, and checks it decodes back to current using every byte
+	void CheckRoundTrip(const Snapshot* baseline, const Snapshot& current, PacketBuffer& packet) {
+		packet.size = 0;
+		PacketWriter writer(packet);
+		REQUIRE(SnapshotEncoding::EncodeDelta(writer, baseline, current));
+
+		PacketReader reader(packet);
+		Snapshot decoded;
+		REQUIRE(SnapshotEncoding::DecodeDelta(reader, baseline, decoded));
+		CHECK(reader.Remaining() == 0);
+		CHECK(decoded.states == current.states);
+	}
+}
+
+// Deltas with objects added, removed, retyped and changed in every field decode back to exactly what was encoded
+TEST(SnapshotDeltaRoundTrips) {
+	std::mt19937 random(7);
+	PacketBuffer packet;
+
+	for (int round = 0; round < 200; ++round) {
+		Snapshot snapshot = RandomSnapshot(random, random() % (SnapshotEncoding::MAX_OBJECTS + 1));
+		CheckRoundTrip(nullptr, snapshot, packet);
+		for (int tick = 0; tick < 10; ++tick) {
+			Snapshot next = NextSnapshot(random, snapshot);
+			CheckRoundTrip(&snapshot, next, packet);
+			snapshot = std::move(next);
+		}
+	}
+
+	// Nothing changed, everything new, and everything gone
+	const Snapshot full = RandomSnapshot(random, SnapshotEncoding::MAX_OBJECTS);
+	const Snapshot other = RandomSnapshot(random, SnapshotEncoding::MAX_OBJECTS);
+	CheckRoundTrip(&full, full, packet);
+	CHECK(packet.size == 2);
+	CheckRoundTrip(nullptr, full, packet);
+	CheckRoundTrip(&other, full, packet);
+	CheckRoundTrip(&full, Snapshot(), packet);
+}
+
+// A full set of objects replacing a full baseline is the largest delta there is, and it still fits one packet
+TEST(SnapshotDeltaFitsOnePacketAtMaxObjects) {
+	std::mt19937 random(8);
+	Snapshot baseline, current;
+	for (NetworkID i = 0; i < SnapshotEncoding::MAX_OBJECTS; ++i) {
+		baseline.states.push_back(RandomState(random, 1 + i * 400000));
+		current.states.push_back(RandomState(random, 200000 + i * 400000));
+	}
+
+	PacketBuffer packet;
+	PacketWriter writer(packet);
+	writer.WriteU8(0);
+	Schema::Encode(writer, SnapshotHeaderMsg{});
+	REQUIRE(SnapshotEncoding::EncodeDelta(writer, &baseline, current));
+
+	PacketReader reader(packet);
+	reader.ReadU8();
+	SnapshotHeaderMsg header;
+	REQUIRE(Schema::Decode(reader, header));
+	Snapshot decoded;
+	REQUIRE(SnapshotEncoding::DecodeDelta(reader, &baseline, decoded));
+	CHECK(decoded.states == current.states);
+
+	// One more object than that is refused rather than split
+	current.states.push_back(RandomState(random, 0xFFFFFFFFu));
+	PacketBuffer over;
+	PacketWriter overWriter(over);
+	CHECK(!SnapshotEncoding::EncodeDelta(overWriter, nullptr, current));
+	CHECK(over.size == 0);
+}
+
+// Every cut short delta is refused, and random bytes never decode to more than MAX_OBJECTS or out of order
+TEST(SnapshotDeltaRejectsTruncatedAndGarbageInput) {
+	std::mt19937 random(9);
+	const Snapshot baseline = RandomSnapshot(random, 40);
+	const Snapshot current = NextSnapshot(random, baseline);
+	PacketBuffer packet;
+	PacketWriter writer(packet);
+	REQUIRE(SnapshotEncoding::EncodeDelta(writer, &baseline, current));
+
+	Snapshot decoded;
+	for (size_t length = 0; length < packet.size; ++length) {
+		PacketReader reader(packet.data, length);
+		CHECK(!SnapshotEncoding::DecodeDelta(reader, &baseline, decoded));
+	}
+
+	for (int round = 0; round < 20000; ++round) {
+		PacketBuffer garbage;
+		garbage.size = random() % 64;
+		for (size_t i = 0; i < garbage.size; ++i) garbage.data[i] = static_cast<char>(random());
+		PacketReader reader(garbage);
+		if (!SnapshotEncoding::DecodeDelta(reader, round % 2 ? &baseline : nullptr, decoded)) continue;
+		CHECK(decoded.states.size() <= SnapshotEncoding::MAX_OBJECTS);
+		CHECK(std::adjacent_find(decoded.states.begin(), decoded.states.end(),
+			[](const QuantizedState& a, const QuantizedState& b) { return a.networkID >= b.networkID; }) == decoded.states.end());
+	}
+
+	// Well formed but inconsistent with the baseline: removing an object it does not have, and IDs out of order
+	auto decodes = [&](auto&& write) {
+		PacketBuffer bad;
+		BitWriter bits(bad.data, MAX_PACKET_SIZE);
+		write(bits);
+		CHECK(bits.Finish());
+		bad.size = bits.BytesUsed();
+		PacketReader reader(bad);
+		return SnapshotEncoding::DecodeDelta(reader, &baseline, decoded);
+	};
+	CHECK(!decodes([&](BitWriter& bits) {
+		bits.WriteVarint(1, 7);
+		bits.WriteSignedVarint(static_cast<int32_t>(baseline.states.back().networkID + 1), Q::ID_GROUP_BITS);
+		bits.WriteVarint(0, 7);
+	}));
+	CHECK(!decodes([&](BitWriter& bits) {
+		bits.WriteVarint(2, 7);
+		bits.WriteSignedVarint(static_cast<int32_t>(baseline.states[1].networkID), Q::ID_GROUP_BITS);
+		bits.WriteSignedVarint(static_cast<int32_t>(baseline.states[0].networkID - baseline.states[1].networkID), Q::ID_GROUP_BITS);
+		bits.WriteVarint(0, 7);
+	}));
+	CHECK(!decodes([&](BitWriter& bits) {
+		bits.WriteVarint(0, 7);
+		bits.WriteVarint(SnapshotEncoding::MAX_OBJECTS + 1, 7);
+	}));
+	CHECK(decodes([&](BitWriter& bits) {
+		bits.WriteVarint(1, 7);
+		bits.WriteSignedVarint(static_cast<int32_t>(baseline.states[0].networkID), Q::ID_GROUP_BITS);
+		bits.WriteVarint(0, 7);
+	}));
+	CHECK(decoded.states.size() == baseline.states.size() - 1);
+}
@@ -0,0 +1,159 @@
+#include "Test.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glm/gtc/constants.hpp>
+#include "../Networking/Snapshot.hpp"
+#include "../Networking/StateEncoding.hpp"
+
+namespace {
+	using Q = StateEncoding::Quantization;
+
+	// What the host sent per object before quantizing: ID, tick, type, then position, rotation and velocity as floats
+	constexpr size_t FLOAT_STATE_BYTES = 4 + 4 + 1 + 2 * 4 + 4 + 2 * 4;
+
+	ObjectStateMsg RandomState(std::mt19937& random, NetworkID id, Tick tick) {
+		std::uniform_real_distribution<float> position(-Q::POSITION_RANGE, Q::POSITION_RANGE);
+		std::uniform_real_distribution<float> velocity(-Q::VELOCITY_RANGE, Q::VELOCITY_RANGE);
+		std::uniform_real_distribution<float> rotation(-20.f, 20.f);
+		ObjectStateMsg state;
+		state.networkID = id;
+		state.tick = tick;
+		state.objectType = static_cast<uint8_t>(random() % 4);
+		state.position = glm::vec3(position(random), position(random), 0.f);
+		state.rotation = rotation(random);
+		state.velocity = glm::vec3(velocity(random), velocity(random), 0.f);
+		return state;
+	}
+
+	// Distance between two angles the short way round
+	float AngleError(float a, float b) {
+		const float difference = std::fmod(std::fabs(a - b), glm::two_pi<float>());
+		return std::min(difference, glm::two_pi<float>() - difference);
+	}
+}
+
+// The bounds StateEncoding.hpp promises, for states sent the way the host sends them: quantized, then carried in a
+// full snapshot and dequantized at the snapshot's tick. Half a step for positions and velocities, pi / 2^ROTATION_BITS
+// for rotations, and IDs and types exact.
+TEST(StateEncodingStaysWithinDocumentedBounds) {
+	constexpr Tick TICK = 70000;
+	std::mt19937 random(6);
+
+	// A little over half a step, for the float rounding of values around 128
+	const float positionBound = Q::POSITION_PRECISION / 2.f + 1e-4f;
+	const float velocityBound = Q::VELOCITY_PRECISION / 2.f + 1e-5f;
+	const float rotationBound = glm::pi<float>() / static_cast<float>(1u << Q::ROTATION_BITS) + 1e-5f;
+
+	float positionError = 0.f, velocityError = 0.f, rotationError = 0.f;
+	bool exact = true;
+	for (int round = 0; round < 200; ++round) {
+		std::vector<ObjectStateMsg> sent;
+		Snapshot snapshot;
+		NetworkID id = random() % 1000;
+		for (size_t i = 0; i < SnapshotEncoding::MAX_OBJECTS; ++i) {
+			id += 1 + random() % (i % 8 == 0 ? 100000 : 5);
+			sent.push_back(RandomState(random, id, TICK));
+			snapshot.states.push_back(StateEncoding::Quantize(sent.back()));
+		}
+
+		PacketBuffer packet;
+		PacketWriter writer(packet);
+		REQUIRE(SnapshotEncoding::EncodeDelta(writer, nullptr, snapshot));
+		Snapshot received;
+		PacketReader reader(packet);
+		REQUIRE(SnapshotEncoding::DecodeDelta(reader, nullptr, received));
+		REQUIRE(received.states.size() == sent.size());
+
+		for (size_t i = 0; i < sent.size(); ++i) {
+			const ObjectStateMsg state = StateEncoding::Dequantize(received.states[i], TICK);
+			exact &= state.networkID == sent[i].networkID && state.tick == TICK && state.objectType == sent[i].objectType;
+			positionError = std::max({ positionError, std::fabs(state.position.x - sent[i].position.x), std::fabs(state.position.y - sent[i].position.y) });
+			velocityError = std::max({ velocityError, std::fabs(state.velocity.x - sent[i].velocity.x), std::fabs(state.velocity.y - sent[i].velocity.y) });
+			rotationError = std::max(rotationError, AngleError(state.rotation, sent[i].rotation));
+		}
+	}
+	CHECK(exact);
+	CHECK_NEAR(positionError, 0.0, positionBound);
+	CHECK_NEAR(velocityError, 0.0, velocityBound);
+	CHECK_NEAR(rotationError, 0.0, rotationBound);
+}
+
+// The ends of each range and rotations a whole number of turns apart quantize the same way every time
+TEST(StateEncodingQuantizesRangeEnds) {
+	ObjectStateMsg state;
+	state.position = glm::vec3(-Q::POSITION_RANGE, Q::POSITION_RANGE, 0.f);
+	state.velocity = glm::vec3(-Q::VELOCITY_RANGE, Q::VELOCITY_RANGE, 0.f);
+	const StateEncoding::QuantizedState q = StateEncoding::Quantize(state);
+	CHECK(q.position[0] == 0 && q.position[1] == Q::POSITION_STEPS);
+	CHECK(q.velocity[0] == 0 && q.velocity[1] == Q::VELOCITY_STEPS);
+
+	for (float rotation : { 0.f, 1.f, 3.f, 6.2f }) {
+		ObjectStateMsg turned = state;
+		state.rotation = rotation;
+		turned.rotation = rotation - 2.f * glm::two_pi<float>();
+		const uint32_t a = StateEncoding::Quantize(state).rotation, b = StateEncoding::Quantize(turned).rotation;
+		CHECK(std::min((a - b) & ((1u << Q::ROTATION_BITS) - 1), (b - a) & ((1u << Q::ROTATION_BITS) - 1)) <= 1);
+		CHECK(a < (1u << Q::ROTATION_BITS));
+	}
+}
+
+TEST(StateEncodingClampsOutOfRangeValues) {
+	ObjectStateMsg state;
+	state.position = glm::vec3(1000.f, -1000.f, 0.f);
+	state.velocity = glm::vec3(-50.f, std::nanf(""), 0.f);
+	const ObjectStateMsg decoded = StateEncoding::Dequantize(StateEncoding::Quantize(state), 0);
+	CHECK_NEAR(decoded.position.x, Q::POSITION_RANGE, Q::POSITION_PRECISION);
+	CHECK_NEAR(decoded.position.y, -Q::POSITION_RANGE, Q::POSITION_PRECISION);
+	CHECK_NEAR(decoded.velocity.x, -Q::VELOCITY_RANGE, Q::VELOCITY_PRECISION);
+	CHECK_NEAR(decoded.velocity.y, 0.0, Q::VELOCITY_PRECISION);
+}
+
+// Bytes per client per second at 60 Hz for a world of moving objects, sent as floats every tick, as full
+// quantized snapshots every tick, and as snapshot deltas against the previous tick
+BENCHMARK(BenchStateBandwidth) {
+	constexpr double TICK_RATE = 60.0;
+	constexpr int TICKS = 600;
+	std::mt19937 random(8);
+
+	for (size_t objects : { size_t(8), size_t(32), size_t(64) }) {
+		std::vector<ObjectStateMsg> world(objects);
+		for (size_t i = 0; i < objects; ++i) {
+			world[i] = RandomState(random, static_cast<NetworkID>(i + 1), 0);
+			world[i].position *= 0.3f;
+			if (i % 2 == 0) world[i].velocity = glm::vec3(0.f); // Half the asteroids drift, half sit still
+		}
+
+		size_t floatBytes = 0, fullBytes = 0, deltaBytes = 0;
+		Snapshot previous, current;
+		for (int tick = 1; tick <= TICKS; ++tick) {
+			current.states.clear();
+			for (ObjectStateMsg& state : world) {
+				state.tick = static_cast<Tick>(tick);
+				state.position += state.velocity / static_cast<float>(TICK_RATE);
+				current.states.push_back(StateEncoding::Quantize(state));
+			}
+			floatBytes += 1 + objects * FLOAT_STATE_BYTES;
+
+			PacketBuffer full;
+			PacketWriter fullWriter(full);
+			fullWriter.WriteU8(0);
+			SnapshotEncoding::EncodeDelta(fullWriter, nullptr, current);
+			fullBytes += full.size;
+
+			PacketBuffer delta;
+			PacketWriter deltaWriter(delta);
+			deltaWriter.WriteU8(0);
+			SnapshotEncoding::EncodeDelta(deltaWriter, tick > 1 ? &previous : nullptr, current);
+			deltaBytes += delta.size;
+			std::swap(previous, current);
+		}
+
+		const double seconds = TICKS / TICK_RATE;
+		std::cout << "  " << objects << " objects: floats " << static_cast<size_t>(floatBytes / seconds)
+			<< " B/s, full snapshots " << static_cast<size_t>(fullBytes / seconds)
+			<< " B/s, snapshot deltas " << static_cast<size_t>(deltaBytes / seconds) << " B/s per client\n";
+	}
+}
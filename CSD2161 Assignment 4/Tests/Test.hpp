@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * \brief The AsteroidTests runner: TEST(name) registers a check that runs by default, BENCHMARK(name) a driver that
+ *        prints its own figures and runs only with --bench. No framework, so the project builds wherever the game does.
+ *
+ * CHECK records a failure and carries on; REQUIRE also leaves the test, for when the rest would only crash.
+ */
+namespace Test {
+	struct Case {
+		const char* name;
+		void (*run)();
+		bool benchmark;
+	};
+
+	std::vector<Case>& Registry();
+	void Fail(const char* file, int line, const std::string& what);
+
+	struct Registrar {
+		Registrar(const char* name, void (*run)(), bool benchmark) { Registry().push_back(Case{ name, run, benchmark }); }
+	};
+}
+
+#define TEST(name) \
+	static void name(); \
+	static Test::Registrar name##Registrar(#name, &name, false); \
+	static void name()
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static Test::Registrar name##Registrar(#name, &name, true); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) Test::Fail(__FILE__, __LINE__, #condition); } while (0)
+
+#define REQUIRE(condition) \
+	do { if (!(condition)) { Test::Fail(__FILE__, __LINE__, #condition); return; } } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+	do { \
+		const double checkActual = static_cast<double>(actual), checkExpected = static_cast<double>(expected); \
+		if (!(std::fabs(checkActual - checkExpected) <= static_cast<double>(tolerance))) { \
+			std::ostringstream checkWhat; \
+			checkWhat << #actual << " = " << checkActual << ", expected " << checkExpected << " +- " << (tolerance); \
+			Test::Fail(__FILE__, __LINE__, checkWhat.str()); \
+		} \
+	} while (0)
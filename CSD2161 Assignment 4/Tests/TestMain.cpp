@@ -0,0 +1,45 @@
+#include "Test.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+	size_t failures = 0;
+}
+
+std::vector<Test::Case>& Test::Registry() {
+	static std::vector<Case> cases;
+	return cases;
+}
+
+void Test::Fail(const char* file, int line, const std::string& what) {
+	++failures;
+	// Through stdio, so a test that mutes std::cout still reports
+	std::printf("  %s:%d: failed: %s\n", file, line, what.c_str());
+}
+
+// Usage: AsteroidTests [--bench] [name filter]
+// Runs every test, or with --bench every benchmark, whose name contains the filter.
+int main(int argc, char* argv[]) {
+	bool benchmarks = false;
+	const char* filter = "";
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--bench") == 0) benchmarks = true;
+		else filter = argv[i];
+	}
+
+	size_t run = 0, failed = 0;
+	for (const Test::Case& test : Test::Registry()) {
+		if (test.benchmark != benchmarks || !std::strstr(test.name, filter)) continue;
+
+		std::cout << "[Test] " << test.name << std::endl;
+		const size_t before = failures;
+		test.run();
+		++run;
+		if (failures != before) ++failed;
+	}
+
+	std::cout << "[Test] " << run - failed << "/" << run << (benchmarks ? " benchmarks" : " tests") << " passed\n";
+	return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include "Test.hpp"
+#include "Loopback.hpp"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// Batched datagram I/O against one call per datagram, over loopback. "One at a time" flushes or reads after
+// every datagram, which is what the transport did before it batched.
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	double MicrosSince(Clock::time_point start) {
+		return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+	}
+
+	void Drain(std::vector<std::unique_ptr<Transport>>& sockets) {
+		static Datagram sink[64];
+		for (auto& socket : sockets) while (socket->ReceiveMany(sink, 64) > 0) {}
+	}
+}
+
+BENCHMARK(BenchFanOut) {
+	constexpr int ROUNDS = 200;
+	char payload[200] = {};
+
+	std::cout << "  clients  one at a time          queued + Flush         SendToMany\n";
+	for (size_t clientCount : { 8, 32, 128 }) {
+		auto host = Loopback::Open(47200);
+		std::vector<std::unique_ptr<Transport>> clients;
+		std::vector<sockaddr_in> addrs;
+		for (size_t i = 0; i < clientCount; ++i) {
+			clients.push_back(Loopback::Open(static_cast<uint16_t>(47201 + i)));
+			addrs.push_back(Loopback::Address(static_cast<uint16_t>(47201 + i)));
+		}
+
+		double micros[3] = {};
+		double syscalls[3] = {};
+		for (int mode = 0; mode < 3; ++mode) {
+			host->ResetStats();
+			double total = 0.0;
+			for (int round = 0; round < ROUNDS; ++round) {
+				const auto start = Clock::now();
+				if (mode == 2) {
+					host->SendToMany(addrs.data(), addrs.size(), payload, sizeof(payload));
+				}
+				else {
+					for (const sockaddr_in& addr : addrs) {
+						host->SendTo(addr, payload, sizeof(payload));
+						if (mode == 0) host->Flush();
+					}
+				}
+				host->Flush();
+				total += MicrosSince(start);
+				Drain(clients); // Untimed, so no socket buffer fills up
+			}
+			const double datagrams = static_cast<double>(ROUNDS * clientCount);
+			micros[mode] = total / datagrams;
+			syscalls[mode] = static_cast<double>(host->GetStats().syscalls) / datagrams;
+		}
+		std::printf("  %7zu", clientCount);
+		for (int mode = 0; mode < 3; ++mode) std::printf("  %6.3f us %5.3f calls", micros[mode], syscalls[mode]);
+		std::printf("   per datagram\n");
+	}
+}
+
+BENCHMARK(BenchReceive) {
+	constexpr int ROUNDS = 200;
+	constexpr size_t BURST = 64; // A frame's worth at a busy host
+	char payload[200] = {};
+
+	auto host = Loopback::Open(47400);
+	auto client = Loopback::Open(0);
+	const sockaddr_in to = Loopback::Address(47400);
+	std::vector<Datagram> batch(BURST);
+
+	std::cout << "  one at a time           ReceiveMany\n ";
+	for (size_t perCall : { size_t(1), BURST }) {
+		host->ResetStats();
+		double total = 0.0;
+		size_t received = 0;
+		for (int round = 0; round < ROUNDS; ++round) {
+			for (size_t i = 0; i < BURST; ++i) client->SendTo(to, payload, sizeof(payload));
+			client->Flush();
+			host->WaitForData(100);
+			std::this_thread::sleep_for(std::chrono::microseconds(200)); // Let the whole burst land
+
+			const auto start = Clock::now();
+			size_t count;
+			while ((count = host->ReceiveMany(batch.data(), perCall)) > 0) received += count;
+			total += MicrosSince(start);
+		}
+		const double datagrams = static_cast<double>(received);
+		std::printf(" %6.3f us %5.3f calls", total / datagrams, static_cast<double>(host->GetStats().syscalls) / datagrams);
+	}
+	std::printf("   per datagram\n");
+}
@@ -0,0 +1,105 @@
+#include "Test.hpp"
+#include "Loopback.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+	void Fill(char* data, size_t size, int seed) {
+		for (size_t i = 0; i < size; ++i) data[i] = static_cast<char>(seed * 31 + static_cast<int>(i));
+	}
+}
+
+TEST(TransportLoopbackRoundTrip) {
+	auto host = Loopback::Open(47100);
+	auto client = Loopback::Open(0);
+	REQUIRE(host && client);
+	CHECK(host->IsOpen() && client->IsOpen());
+
+	char sent[MAX_PACKET_SIZE];
+	Fill(sent, sizeof(sent), 1);
+	CHECK(client->SendTo(Loopback::Address(47100), sent, sizeof(sent)));
+	client->Flush();
+	REQUIRE(host->WaitForData(1000));
+
+	// The host answers whoever asked, through the address the datagram came from
+	char received[MAX_PACKET_SIZE];
+	sockaddr_in from{};
+	CHECK(host->ReceiveFrom(received, sizeof(received), from) == static_cast<int>(sizeof(sent)));
+	CHECK(std::memcmp(sent, received, sizeof(sent)) == 0);
+	CHECK(host->ReceiveFrom(received, sizeof(received), from) == 0); // Nothing else pending
+
+	CHECK(host->SendTo(from, "pong", 4));
+	host->Flush();
+	REQUIRE(client->WaitForData(1000));
+	CHECK(client->ReceiveFrom(received, sizeof(received), from) == 4);
+	CHECK(std::memcmp(received, "pong", 4) == 0);
+	CHECK(from.sin_port == htons(47100));
+
+	CHECK(client->GetStats().datagramsSent == 1 && client->GetStats().bytesSent == sizeof(sent));
+	CHECK(host->GetStats().datagramsReceived == 1 && host->GetStats().bytesReceived == sizeof(sent));
+}
+
+TEST(TransportReceiveManyKeepsOrderAndSizes) {
+	auto host = Loopback::Open(47101);
+	auto client = Loopback::Open(0);
+	REQUIRE(host && client);
+
+	// More than one batch's worth, queued and flushed together; small, so the socket's receive buffer holds them all
+	constexpr int COUNT = 100;
+	char payload[MAX_PACKET_SIZE];
+	for (int i = 0; i < COUNT; ++i) {
+		const size_t size = 1 + static_cast<size_t>(i * 7) % 200;
+		Fill(payload, size, i);
+		payload[0] = static_cast<char>(i);
+		CHECK(client->SendTo(Loopback::Address(47101), payload, size));
+	}
+	client->Flush();
+
+	std::vector<Datagram> received(COUNT);
+	REQUIRE(Loopback::Receive(*host, received.data(), COUNT) == COUNT);
+	for (int i = 0; i < COUNT; ++i) {
+		const size_t size = 1 + static_cast<size_t>(i * 7) % 200;
+		Fill(payload, size, i);
+		payload[0] = static_cast<char>(i);
+		CHECK(received[i].size == size);
+		CHECK(std::memcmp(received[i].data, payload, size) == 0);
+		CHECK(received[i].receivedTime != std::chrono::steady_clock::time_point{});
+	}
+	CHECK(host->GetStats().datagramsReceived == COUNT);
+#ifdef NET_TRANSPORT_EPOLL
+	CHECK(host->GetStats().syscalls < COUNT); // recvmmsg: batches, not one call each
+#endif
+}
+
+TEST(TransportSendToManyFansOut) {
+	auto host = Loopback::Open(47102);
+	REQUIRE(host);
+	std::vector<std::unique_ptr<Transport>> clients;
+	std::vector<sockaddr_in> addrs;
+	for (uint16_t port = 47103; port < 47108; ++port) {
+		clients.push_back(Loopback::Open(port));
+		REQUIRE(clients.back());
+		addrs.push_back(Loopback::Address(port));
+	}
+
+	CHECK(host->SendToMany(addrs.data(), addrs.size(), "state", 5));
+	host->Flush();
+	CHECK(host->GetStats().datagramsSent == addrs.size());
+	for (auto& client : clients) {
+		Datagram datagram;
+		REQUIRE(Loopback::Receive(*client, &datagram, 1) == 1);
+		CHECK(datagram.size == 5 && std::memcmp(datagram.data, "state", 5) == 0);
+		CHECK(datagram.addr.sin_port == htons(47102));
+	}
+}
+
+TEST(TransportRejectsOversizedDatagrams) {
+	auto client = Loopback::Open(0);
+	REQUIRE(client);
+	std::vector<char> tooBig(MAX_PACKET_SIZE + 1);
+	CHECK(!client->SendTo(Loopback::Address(47109), tooBig.data(), tooBig.size()));
+	client->Close();
+	CHECK(!client->IsOpen());
+	CHECK(!client->SendTo(Loopback::Address(47109), tooBig.data(), 1));
+}
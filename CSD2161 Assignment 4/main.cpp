@@ -1,10 +1,29 @@
+#ifdef _WIN32
 #include <crtdbg.h> // To check for memory leaks
+#endif
+#if defined(HEADLESS_BOTS)
+#include "BotApplication.hpp"
+#elif defined(HEADLESS_SERVER)
+#include "ServerApplication.hpp"
+#else
 #include "Application.hpp"
+#endif
 
-int main() {
+int main(int argc, char* argv[]) {
 
+#ifdef _WIN32
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
 
+#if defined(HEADLESS_BOTS)
+	BotApplication bots(BotConfig::FromCommandLine(argc, argv));
+	return bots.Run();
+#elif defined(HEADLESS_SERVER)
+	ServerApplication server(ServerConfig::FromCommandLine(argc, argv));
+	return server.Run();
+#else
+	argc, argv;
 	Application app;
 	app.Run();
+#endif
 }
\ No newline at end of file